@@ -41,14 +41,131 @@
 #include <string>
 #include <list>
 #include <vector>
+#include <cstdlib>
+#include <cstring>
 
 #include "SessionManagerImpl.h"
 #include <InvalidArgumentException.h>
 #include <InvalidStateException.h>
+#include <DeniedByDrmsException.h>
+#include <DrmCommunicationException.h>
+#include <InternalException.h>
+#include <InvalidSessionException.h>
+#include <OutOfResourceException.h>
+#include <TimeoutException.h>
+#include <TryLaterException.h>
+#include <UnsupportedAttributeException.h>
+#include <UnsupportedOperationException.h>
+#include <ConnectionPool.h>
+#include <CompletionQueue.h>
+#include <EventEngine.h>
+#include <PBSProSystem.h>
+#include <WorkerPool.h>
 
 using namespace std;
 using namespace drmaa2;
 
+/**
+ *  @brief  maps a C++ exception onto the matching drmaa2_error code
+ *
+ *  @param[in]	ex	-	exception raised by the C++ layer
+ *
+ *  @return drmaa2_error
+ */
+static drmaa2_error drmaa2_error_from_exception(const Drmaa2Exception &ex) {
+	return (drmaa2_error)toErrorCode(ex);
+}
+
+/**
+ *  @brief Job operation executed on the WorkerPool. The outcome is queued
+ *  as a drmaa2_completion on the caller supplied completion queue.
+ */
+class AsyncJobTask : public WorkerTask {
+	CompletionQueue *_queue;
+	drmaa2_completion _completion;
+	JobSession *_jobSession;
+	JobTemplate _jobTemplate;
+	Job *_job;
+
+	/**
+	 *  @brief  runs the control operation directly against the DRMS so
+	 *  		that the real failure reaches the completion
+	 */
+	void control() {
+		DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+		const Connection &conn_ = ConnectionPool::getInstance()->waitConnection();
+		try {
+			switch (_completion->op) {
+			case DRMAA2_ASYNC_SUSPEND:
+				drms->suspend(conn_, *_job);
+				break;
+			case DRMAA2_ASYNC_RESUME:
+				drms->resume(conn_, *_job);
+				break;
+			case DRMAA2_ASYNC_HOLD:
+				drms->hold(conn_, *_job);
+				break;
+			case DRMAA2_ASYNC_RELEASE:
+				drms->release(conn_, *_job);
+				break;
+			case DRMAA2_ASYNC_TERMINATE:
+				drms->terminate(conn_, *_job);
+				break;
+			default:
+				break;
+			}
+		} catch (const Drmaa2Exception &ex) {
+			ConnectionPool::getInstance()->returnConnection(conn_);
+			throw ;
+		}
+		ConnectionPool::getInstance()->returnConnection(conn_);
+	}
+public:
+	AsyncJobTask(CompletionQueue *queue_, const drmaa2_async_op op_,
+			void *tag_, JobSession *jobSession_, Job *job_) :
+			_queue(queue_), _jobSession(jobSession_), _job(job_) {
+		_completion = new drmaa2_completion_s();
+		_completion->op = op_;
+		_completion->tag = tag_;
+		_completion->job = (drmaa2_j)job_;
+		_queue->expect();
+	}
+
+	virtual ~AsyncJobTask() {
+		// Only set when the pool dropped the task without running it
+		if (_completion != NULL) {
+			free(_completion->jobSubState);
+			delete _completion;
+			_queue->cancel();
+		}
+	}
+
+	JobTemplate& getJobTemplate() {
+		return _jobTemplate;
+	}
+
+	virtual void run() {
+		try {
+			if (_completion->op == DRMAA2_ASYNC_RUN_JOB) {
+				const Job &j = _jobSession->runJob(_jobTemplate);
+				_completion->job = (drmaa2_j)const_cast<Job*>(&j);
+			} else if (_completion->op == DRMAA2_ASYNC_GET_STATE) {
+				string subState;
+				_completion->jobState = (drmaa2_jstate)_job->getState(subState);
+				_completion->jobSubState = strdup(subState.c_str());
+			} else {
+				control();
+			}
+		} catch (const Drmaa2Exception &ex) {
+			_completion->error = drmaa2_error_from_exception(ex);
+		} catch (...) {
+			_completion->error = DRMAA2_INTERNAL;
+		}
+		_queue->push(_completion);
+		_completion = NULL;
+	}
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -835,7 +952,12 @@ void drmaa2_rtemplate_free(drmaa2_rtemplate * rt) {
  *
  */
 void drmaa2_notification_free(drmaa2_notification * n) {
-	//TODO Add Code here
+	if(n == NULL || *n == NULL)
+		return;
+	free((*n)->jobId);
+	free((*n)->sessionName);
+	delete *n;
+	*n = NULL;
 }
 
 /**
@@ -1754,6 +1876,63 @@ drmaa2_string_list drmaa2_jsession_get_job_categories(
 	return jc;
 }
 
+/**
+ *  @brief  sets the environment every job of the drmaa2_job session
+ *  		starts with, the job template environment is added on top
+ *
+ *  @param[in]	js	-	pointer to drmaa2_job session js
+ *  @param[in]	env	-	base environment, NULL or empty to clear
+ *
+ *  @return
+ *  		DRMAA2_SUCCESS if successful
+ *  		DRMAA2_INVALID_ARGUMENT if js is NULL
+ *
+ */
+drmaa2_error drmaa2_jsession_set_base_environment(drmaa2_jsession js,
+		const drmaa2_dict env) {
+	if (js == NULL) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return lasterror;
+	}
+	map<string, string> environment;
+	if (env != NULL) {
+		drmaa2_list keys = drmaa2_dict_list(env);
+		long size = drmaa2_list_size(keys);
+		for (long i = 0; i < size; i++) {
+			const char *key = (const char*)drmaa2_list_get(keys, i);
+			environment[key] = drmaa2_dict_get(env, key);
+		}
+		drmaa2_list_free(&keys);
+	}
+	reinterpret_cast<JobSession *>(js)->setBaseEnvironment(environment);
+	return DRMAA2_SUCCESS;
+}
+
+/**
+ *  @brief  returns the base environment of the drmaa2_job session
+ *
+ *  @param[in]	js	-	pointer to drmaa2_job session js
+ *
+ *  @return
+ *  		drmaa2_dict - copy of the base environment
+ *  		NULL if js is NULL
+ *
+ */
+drmaa2_dict drmaa2_jsession_get_base_environment(const drmaa2_jsession js) {
+	if (js == NULL) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return NULL;
+	}
+	const map<string, string> &environment =
+			reinterpret_cast<JobSession *>(js)->getBaseEnvironment();
+	drmaa2_dict env = drmaa2_dict_create(drmaa2_dict_default_callback);
+	for (map<string, string>::const_iterator it = environment.begin();
+			it != environment.end(); ++it)
+		drmaa2_dict_set(env, strdup(it->first.c_str()),
+				strdup(it->second.c_str()));
+	return env;
+}
+
 /**
  *  @brief  returns list of jobs in the drmaa2_job session matching
  *  		the jobinfo filter
@@ -1857,32 +2036,18 @@ drmaa2_jarray drmaa2_jsession_get_job_array(const drmaa2_jsession js,
 }
 
 /**
- *  @brief  runs job in the job session with the drmaa2_job template specified
+ *  @brief  converts drmaa2_jtemplate into its C++ JobTemplate counterpart
  *
- *  @param[in]	js	-	pointer to drmaa2_job session
- *  @param[in]	jt	-	Job template that needs to be run
+ *  @param[in]	jt	-	Job template to be converted
+ *  @param[out]	jobTemplate	-	JobTemplate receiving the values
  *
- *  @return
- *  		drmaa2_j - returns pointer to job which is newly started
- *  					in the job session
- *  		NULL and sets last error to DRMAA2_INVALID_ARGUMENT
- *  					if any argument is invalid
- *  		NULL and sets last error to DRMAA2_INVALID_SESSION
- *  					if session name is invalid
+ *  @return - None
  */
-drmaa2_j drmaa2_jsession_run_job(const drmaa2_jsession js,
-		const drmaa2_jtemplate jt) {
+static void drmaa2_jtemplate_convert(const drmaa2_jtemplate jt,
+		JobTemplate &jobTemplate) {
 	char *tmp = NULL;
 	int size = 0, i = 0;
-	if(js == NULL || jt == NULL){
-		lasterror = DRMAA2_INVALID_ARGUMENT;
-		return NULL;
-	}
-	JobSession *jobSession = reinterpret_cast<JobSession *>(js);
-
-	/*conversion from drmaa2_jtemplate to JobTemplate*/
 	string key, value, intermediate;
-	JobTemplate jobTemplate;
 
 	if(jt->accountingId!=NULL)
 		jobTemplate.accountingId.assign(jt->accountingId);
@@ -2006,6 +2171,32 @@ drmaa2_j drmaa2_jsession_run_job(const drmaa2_jsession js,
 
 	if(jt->workingDirectory!=NULL)
 		jobTemplate.workingDirectory = jt->workingDirectory;
+}
+
+/**
+ *  @brief  runs job in the job session with the drmaa2_job template specified
+ *
+ *  @param[in]	js	-	pointer to drmaa2_job session
+ *  @param[in]	jt	-	Job template that needs to be run
+ *
+ *  @return
+ *  		drmaa2_j - returns pointer to job which is newly started
+ *  					in the job session
+ *  		NULL and sets last error to DRMAA2_INVALID_ARGUMENT
+ *  					if any argument is invalid
+ *  		NULL and sets last error to DRMAA2_INVALID_SESSION
+ *  					if session name is invalid
+ */
+drmaa2_j drmaa2_jsession_run_job(const drmaa2_jsession js,
+		const drmaa2_jtemplate jt) {
+	if(js == NULL || jt == NULL){
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return NULL;
+	}
+	JobSession *jobSession = reinterpret_cast<JobSession *>(js);
+
+	JobTemplate jobTemplate;
+	drmaa2_jtemplate_convert(jt, jobTemplate);
 
 	try{
 		const Job &j = jobSession->runJob(jobTemplate);
@@ -2017,6 +2208,41 @@ drmaa2_j drmaa2_jsession_run_job(const drmaa2_jsession js,
 	}
 }
 
+/**
+ *  @brief  runs job in the job session tagged with a client idempotency
+ *  		key, a submission whose reply is lost is only repeated when no
+ *  		job carrying the key exists
+ *
+ *  @param[in]	js	-	pointer to drmaa2_job session
+ *  @param[in]	jt	-	Job template that needs to be run
+ *  @param[in]	submit_key	-	caller chosen idempotency key
+ *
+ *  @return
+ *  		drmaa2_j - returns pointer to job which is newly started
+ *  					in the job session
+ *  		NULL and sets last error to DRMAA2_INVALID_ARGUMENT
+ *  					if any argument or the key is invalid
+ */
+drmaa2_j drmaa2_jsession_run_job_with_key(const drmaa2_jsession js,
+		const drmaa2_jtemplate jt, const char *submit_key) {
+	if(js == NULL || jt == NULL || submit_key == NULL){
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return NULL;
+	}
+	JobSession *jobSession = reinterpret_cast<JobSession *>(js);
+
+	JobTemplate jobTemplate;
+	drmaa2_jtemplate_convert(jt, jobTemplate);
+
+	try{
+		const Job &j = jobSession->runJob(jobTemplate, string(submit_key));
+		return (drmaa2_j)const_cast<Job*>(&j);
+	}catch(const Drmaa2Exception &ex){
+		lasterror = drmaa2_error_from_exception(ex);
+		return NULL;
+	}
+}
+
 /**
  *  @brief  Write description of function here.
  *
@@ -2038,140 +2264,14 @@ drmaa2_jarray drmaa2_jsession_run_bulk_jobs(const drmaa2_jsession js,
 		const drmaa2_jtemplate jt, const long long begin_index,
 		const long long end_index, const long long step,
 		const long long max_parallel) {
-	char *tmp = NULL;
-	int size = 0, i = 0;
 	if(js == NULL || jt == NULL){
 		lasterror = DRMAA2_INVALID_ARGUMENT;
 		return NULL;
 	}
 	JobSession *jobSession = reinterpret_cast<JobSession *>(js);
 
-	/*conversion from drmaa2_jtemplate to JobTemplate*/
-	string key, value, intermediate;
 	JobTemplate jobTemplate;
-
-	if(jt->accountingId!=NULL)
-		jobTemplate.accountingId.assign(jt->accountingId);
-
-	vector<string> slArgs;
-	size = drmaa2_list_size(jt->args);
-	for(i = 0 ; i < size ; ++i ){
-		intermediate.assign((char*)drmaa2_list_get(jt->args, i));
-		slArgs.push_back(intermediate);
-	}
-	jobTemplate.args = slArgs;
-
-	if(drmaa2_list_size(jt->candidateMachines) > 0) {
-		size = drmaa2_list_size(jt->candidateMachines);
-		for(i = 0; i < size; i++) {
-			jobTemplate.candidateMachines.push_back(string((char*)drmaa2_list_get(jt->candidateMachines, i)));
-		}
-	}
-
-	list<string> slEmail;
-	for(i = 0 ; i < drmaa2_list_size(jt->email) ; ++i ){
-		intermediate.assign((char*)drmaa2_list_get(jt->email, i));
-		slEmail.push_back(intermediate);
-	}
-	jobTemplate.email = slEmail;
-
-	jobTemplate.emailOnStarted = jt->emailOnStarted == DRMAA2_TRUE ? true : false;
-
-	jobTemplate.emailOnTerminated = jt->emailOnTerminated == DRMAA2_TRUE ? true : false;
-
-	if(jt->errorPath!=NULL)
-		jobTemplate.errorPath.assign(jt->errorPath);
-
-	if(jt->inputPath!=NULL)
-		jobTemplate.inputPath.assign(jt->inputPath);
-
-	if(jt->jobCategory!=NULL)
-		jobTemplate.jobCategory.assign(jt->jobCategory);
-
-	drmaa2_list lEnv;
-	lEnv = drmaa2_dict_list(jt->jobEnvironment);
-	map<string, string> dJobEnvironment;
-	size = drmaa2_list_size(lEnv);
-	for(i = 0 ; i < size ; i++){
-		tmp = (char*)drmaa2_list_get(lEnv, i);
-		key.assign(tmp);
-		value.assign(drmaa2_dict_get(jt->jobEnvironment,(char*)key.c_str()));
-		dJobEnvironment.insert(std::pair<string,string>(key, value));
-	}
-	drmaa2_list_free(&lEnv);
-	jobTemplate.jobEnvironment = dJobEnvironment;
-
-	if(jt->jobName!=NULL)
-		jobTemplate.jobName.assign(jt->jobName);
-
-	jobTemplate.joinFiles = jt->joinFiles == DRMAA2_TRUE ? true : false;
-
-	jobTemplate.machineArch = (drmaa2::CpuArchitecture)jt->machineArch;
-	jobTemplate.machineOS = (drmaa2::OperatingSystem)jt->machineOS;
-	jobTemplate.maxSlots = jt->maxSlots;
-	jobTemplate.minPhysMemory = jt->minPhysMemory;
-	jobTemplate.minSlots = jt->minSlots;
-
-	if(jt->outputPath!=NULL)
-		jobTemplate.outputPath.assign(jt->outputPath);
-
-	jobTemplate.priority = jt->priority;
-
-	if(jt->queueName!=NULL)
-		jobTemplate.queueName.assign(jt->queueName);
-
-	if(jt->remoteCommand!=NULL)
-		jobTemplate.remoteCommand.assign(jt->remoteCommand);
-
-	jobTemplate.rerunnable = jt->rerunnable == DRMAA2_TRUE ? true : false;
-
-	if(jt->reservationId!=NULL)
-		jobTemplate.reservationId.assign(jt->reservationId);
-
-	map<string, string> dResourceLimits;
-	drmaa2_list lResource;
-	lResource = drmaa2_dict_list(jt->resourceLimits);
-	size = drmaa2_list_size(lResource);
-	for(i = 0 ; i < size ; i++){
-		tmp = (char*)drmaa2_list_get(lResource, i);
-		key.assign(tmp);
-		value.assign(drmaa2_dict_get(jt->resourceLimits,(char*)key.c_str()));
-		dResourceLimits.insert(std::pair<string, string>(key, value));
-	}
-	drmaa2_list_free(&lResource);
-	jobTemplate.resourceLimits = dResourceLimits;
-
-	map<string, string> dStageInFiles;
-	drmaa2_list lStageIn;
-	lStageIn = drmaa2_dict_list(jt->stageInFiles);
-	size = drmaa2_list_size(lStageIn);
-	for(i = 0 ; i < size ; i++){
-		tmp = (char*)drmaa2_list_get(lStageIn, i);
-		key.assign(tmp);
-		value.assign(drmaa2_dict_get(jt->stageInFiles,(char*)key.c_str()));
-		dStageInFiles.insert(std::pair<string, string>(key, value));
-	}
-	drmaa2_list_free(&lStageIn);
-	jobTemplate.stageInFiles = dStageInFiles;
-
-	map<string, string> dStageOutFiles;
-	drmaa2_list lStageOut;
-	lStageOut = drmaa2_dict_list(jt->stageOutFiles);
-	size = drmaa2_list_size(lStageOut);
-	for(i = 0 ; i < size ; i++){
-		tmp = (char*)drmaa2_list_get(lStageOut, i);
-		key.assign(tmp);
-		value.assign(drmaa2_dict_get(jt->stageOutFiles,(char*)key.c_str()));
-		dStageOutFiles.insert(std::pair<string, string>(key, value));
-	}
-	drmaa2_list_free(&lStageOut);
-	jobTemplate.stageOutFiles = dStageOutFiles;
-
-	jobTemplate.startTime = jt->startTime;
-	jobTemplate.submitAsHold = jt->submitAsHold == DRMAA2_TRUE ? true : false;
-
-	if(jt->workingDirectory!=NULL)
-		jobTemplate.workingDirectory = jt->workingDirectory;
+	drmaa2_jtemplate_convert(jt, jobTemplate);
 
 	try{
 		const JobArray &ja = jobSession->runBulkJobs(jobTemplate, begin_index, end_index, step, max_parallel);
@@ -2183,6 +2283,39 @@ drmaa2_jarray drmaa2_jsession_run_bulk_jobs(const drmaa2_jsession js,
 	}
 }
 
+/**
+ *  @brief  blocks till any drmaa2_job of the list started or terminated
+ *
+ *  @param[in]	js	-	pointer to drmaa2_job session
+ *  @param[in]	l	-	list of drmaa2_jobs
+ *  @param[in]	timeout	-	seconds to wait or DRMAA2_INFINITE_TIME
+ *  @param[in]	terminated	-	wait for termination instead of start
+ *
+ *  @return
+ *  		drmaa2_j - the drmaa2_job which ended the wait
+ *  		NULL and sets last error, DRMAA2_TIMEOUT if timeout happens
+ */
+static drmaa2_j drmaa2_jsession_wait_any(const drmaa2_jsession js,
+		const drmaa2_j_list l, const time_t timeout, const bool terminated) {
+	if(js == NULL || l == NULL || l->type != DRMAA2_JOBLIST) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return NULL;
+	}
+	JobList jobList;
+	for(drmaa2_item item = (drmaa2_item)l->head; item != NULL;
+			item = item->next)
+		jobList.push_back((Job *)item->data.value);
+	try {
+		JobSession *session = reinterpret_cast<JobSession *>(js);
+		const Job &j = terminated ? session->waitAnyTerminated(jobList,
+				timeout) : session->waitAnyStarted(jobList, timeout);
+		return (drmaa2_j)const_cast<Job *>(&j);
+	} catch (const Drmaa2Exception &ex) {
+		lasterror = drmaa2_error_from_exception(ex);
+		return NULL;
+	}
+}
+
 /**
  *  @brief  blocks till the drmaa2_job in the drmaa2_job session started
  *  		or till the time out
@@ -2197,8 +2330,7 @@ drmaa2_jarray drmaa2_jsession_run_bulk_jobs(const drmaa2_jsession js,
  */
 drmaa2_j drmaa2_jsession_wait_any_started(const drmaa2_jsession js,
 		const drmaa2_j_list l, const time_t timeout) {
-	//TODO Add Code here
-	return NULL;
+	return drmaa2_jsession_wait_any(js, l, timeout, false);
 }
 
 /**
@@ -2215,8 +2347,7 @@ drmaa2_j drmaa2_jsession_wait_any_started(const drmaa2_jsession js,
  */
 drmaa2_j drmaa2_jsession_wait_any_terminated(const drmaa2_jsession js,
 		const drmaa2_j_list l, const time_t timeout) {
-	//TODO Add Code here
-	return NULL;
+	return drmaa2_jsession_wait_any(js, l, timeout, true);
 }
 
 /**
@@ -2559,7 +2690,16 @@ drmaa2_jinfo drmaa2_j_get_info(const drmaa2_j j) {
  * 		DRMAA2_TIMEOUT if timeout happened
  */
 drmaa2_error drmaa2_j_wait_started(const drmaa2_j j, const time_t timeout) {
-	//TODO Add Code here
+	if(j == NULL) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return lasterror;
+	}
+	try {
+		reinterpret_cast<Job *>(j)->waitStarted(timeout);
+	} catch (const Drmaa2Exception &ex) {
+		lasterror = drmaa2_error_from_exception(ex);
+		return lasterror;
+	}
 	return DRMAA2_SUCCESS;
 }
 
@@ -2575,7 +2715,17 @@ drmaa2_error drmaa2_j_wait_started(const drmaa2_j j, const time_t timeout) {
  * 		DRMAA2_TIMEOUT if timeout happened
  */
 drmaa2_error drmaa2_j_wait_terminated(const drmaa2_j j, const time_t timeout) {
-	//TODO Add Code here
+	if(j == NULL) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return lasterror;
+	}
+	TimeAmount timeAmount = timeout;
+	try {
+		reinterpret_cast<Job *>(j)->waitTerminated(timeAmount);
+	} catch (const Drmaa2Exception &ex) {
+		lasterror = drmaa2_error_from_exception(ex);
+		return lasterror;
+	}
 	return DRMAA2_SUCCESS;
 }
 
@@ -2859,8 +3009,10 @@ drmaa2_version drmaa2_get_drmaa_version(void) {
  *  @return drmaa2_bool
  */
 drmaa2_bool drmaa2_supports(const drmaa2_capability c) {
-	//TODO Add Code here
-	return DRMAA2_TRUE;
+	if (c == DRMAA2_UNSET_CAPABILITY)
+		return DRMAA2_FALSE;
+	return Singleton<SessionManager, SessionManagerImpl>::getInstance()->supports(
+			(DrmaaCapability)c) ? DRMAA2_TRUE : DRMAA2_FALSE;
 
 }
 
@@ -2882,11 +3034,16 @@ drmaa2_jsession drmaa2_create_jsession(const char *session_name,
 	}
 	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
 	try {
+		// Fills the connection pool on first use, C callers have no other way
+		sessionManagerObj_->initialize();
 		const JobSession &jobSessionObj_ = sessionManagerObj_->createJobSession(string(session_name), string(contact));
 		return (drmaa2_jsession)&jobSessionObj_;
 	} catch(InvalidArgumentException& ex) {
 		lasterror = DRMAA2_INVALID_ARGUMENT;
 		return NULL;
+	} catch(const Drmaa2Exception &ex) {
+		lasterror = drmaa2_error_from_exception(ex);
+		return NULL;
 	}
 }
 
@@ -3103,23 +3260,288 @@ drmaa2_string_list drmaa2_get_rsession_names(void) {
 }
 
 /**
- *  @brief  Registers a drmaa2_callback with the DRMS library.
- *  	    For the first phase of implementation we do not support this.
- *
- *  @param[in]	callback - a structure of type drmaa2_callback containing the
- *  						details of callback function, event etc
+ *  @brief Forwards the notifications of the EventEngine to the registered
+ *  drmaa2_callback as drmaa2_notification owned by the callback.
+ */
+class CallbackAdapter : public DrmaaCallback {
+	pthread_mutex_t _mutex;
+	drmaa2_callback _callback;
+public:
+	CallbackAdapter() : _callback(NULL) {
+		pthread_mutex_init(&_mutex, NULL);
+	}
+
+	void setCallback(const drmaa2_callback callback_) {
+		pthread_mutex_lock(&_mutex);
+		_callback = callback_;
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	virtual void notify(DrmaaNotification notification_) {
+		pthread_mutex_lock(&_mutex);
+		drmaa2_callback callback_ = _callback;
+		pthread_mutex_unlock(&_mutex);
+		if (callback_ == NULL)
+			return;
+		drmaa2_notification n = new drmaa2_notification_s();
+		n->event = (drmaa2_event)notification_.event;
+		n->jobId = strdup(notification_.jobId.c_str());
+		n->sessionName = strdup(notification_.sessionName.c_str());
+		n->jobState = (drmaa2_jstate)notification_.jobState;
+		callback_(&n);
+	}
+};
+
+static CallbackAdapter callbackAdapter;
 
+/**
+ *  @brief  Registers a drmaa2_callback with the DRMS library, replacing the
+ *  		previous one. The callback runs on a library thread and frees
+ *  		each notification with drmaa2_notification_free.
+ *
+ *  @param[in]	callback - function receiving the notifications, NULL to
+ *  						stop the notifications
+ *
  *  @return
  *   	DRMAA2_SUCCESS if succeeds
- *  	DRMAA2_UNSUPPORTED_OPERATION error if fails
+ *  	DRMAA2_OUT_OF_RESOURCE error if the event engine cannot start
  *
  */
 drmaa2_error drmaa2_register_event_notification(
 		const drmaa2_callback callback) {
-	//TODO Add Code here
+	callbackAdapter.setCallback(callback);
+	try {
+		EventEngine::getInstance()->setCallback(
+				callback == NULL ? NULL : &callbackAdapter);
+	} catch (const Drmaa2Exception &ex) {
+		lasterror = drmaa2_error_from_exception(ex);
+		return lasterror;
+	}
 	return DRMAA2_SUCCESS;
 }
 
+/**
+ *  @brief  frees a drmaa2_completion returned by drmaa2_cq_poll or
+ *  		drmaa2_cq_wait. The job handle it carries is not freed.
+ *
+ *  @param[in]	c	-	pointer to drmaa2_completion
+ *
+ *  @return - None
+ */
+void drmaa2_completion_free(drmaa2_completion * c) {
+	if(c == NULL || *c == NULL)
+		return;
+	free((*c)->jobSubState);
+	delete *c;
+	*c = NULL;
+}
+
+/**
+ *  @brief  creates a completion queue for the asynchronous job calls
+ *
+ *  @return
+ *  		drmaa2_cq - newly created completion queue
+ *  		NULL and sets last error to DRMAA2_OUT_OF_RESOURCE
+ *  				if no event descriptor is available
+ */
+drmaa2_cq drmaa2_cq_create(void) {
+	try {
+		return (drmaa2_cq)new CompletionQueue();
+	} catch (const Drmaa2Exception &ex) {
+		lasterror = drmaa2_error_from_exception(ex);
+		return NULL;
+	}
+}
+
+/**
+ *  @brief  waits for every outstanding operation of the queue, frees the
+ *  		completions which were never fetched and the queue itself
+ *
+ *  @param[in]	cq	-	pointer to completion queue
+ *
+ *  @return - None
+ */
+void drmaa2_cq_free(drmaa2_cq * cq) {
+	if(cq == NULL || *cq == NULL)
+		return;
+	CompletionQueue *queue = reinterpret_cast<CompletionQueue *>(*cq);
+	queue->drain();
+	drmaa2_completion c;
+	while((c = (drmaa2_completion)queue->poll()) != NULL)
+		drmaa2_completion_free(&c);
+	delete queue;
+	*cq = NULL;
+}
+
+/**
+ *  @brief  returns a descriptor which is readable while completions are
+ *  		queued, suitable for select/poll/epoll
+ *
+ *  @param[in]	cq	-	pointer to completion queue
+ *
+ *  @return
+ *  		descriptor if successful
+ *  		-1 and sets last error to DRMAA2_INVALID_ARGUMENT if cq is NULL
+ */
+int drmaa2_cq_get_fd(const drmaa2_cq cq) {
+	if(cq == NULL) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return -1;
+	}
+	return reinterpret_cast<CompletionQueue *>(cq)->getFd();
+}
+
+/**
+ *  @brief  fetches the next completion without blocking
+ *
+ *  @param[in]	cq	-	pointer to completion queue
+ *
+ *  @return
+ *  		drmaa2_completion - to be freed with drmaa2_completion_free
+ *  		NULL if no completion is queued
+ */
+drmaa2_completion drmaa2_cq_poll(drmaa2_cq cq) {
+	if(cq == NULL) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return NULL;
+	}
+	return (drmaa2_completion)reinterpret_cast<CompletionQueue *>(cq)->poll();
+}
+
+/**
+ *  @brief  fetches the next completion, blocking up to timeout
+ *
+ *  @param[in]	cq	-	pointer to completion queue
+ *  @param[in]	timeout	-	seconds to wait or DRMAA2_INFINITE_TIME
+ *
+ *  @return
+ *  		drmaa2_completion - to be freed with drmaa2_completion_free
+ *  		NULL and last error is set to DRMAA2_TIMEOUT if timeout happens
+ */
+drmaa2_completion drmaa2_cq_wait(drmaa2_cq cq, const time_t timeout) {
+	if(cq == NULL) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return NULL;
+	}
+	drmaa2_completion c = (drmaa2_completion)reinterpret_cast<
+			CompletionQueue *>(cq)->wait(timeout);
+	if(c == NULL)
+		lasterror = DRMAA2_TIMEOUT;
+	return c;
+}
+
+/**
+ *  @brief  hands the task to the worker pool
+ *
+ *  @param[in]	task	-	task to be run, ownership is taken
+ *
+ *  @return
+ *  		DRMAA2_SUCCESS if queued
+ *  		DRMAA2_OUT_OF_RESOURCE if no worker is available
+ */
+static drmaa2_error drmaa2_async_submit(AsyncJobTask *task) {
+	try {
+		WorkerPool::getInstance()->submit(task);
+	} catch (const Drmaa2Exception &ex) {
+		lasterror = drmaa2_error_from_exception(ex);
+		return lasterror;
+	}
+	return DRMAA2_SUCCESS;
+}
+
+/**
+ *  @brief  submits the job asynchronously, the new drmaa2_j is delivered
+ *  		in the completion carrying tag
+ *
+ *  @param[in]	js	-	pointer to drmaa2_job session
+ *  @param[in]	jt	-	Job template, copied before returning
+ *  @param[in]	cq	-	completion queue receiving the outcome
+ *  @param[in]	tag	-	caller cookie echoed in the completion
+ *
+ *  @return
+ *  		DRMAA2_SUCCESS if the submission was queued
+ *  		DRMAA2_INVALID_ARGUMENT if any argument is invalid
+ */
+drmaa2_error drmaa2_jsession_run_job_async(const drmaa2_jsession js,
+		const drmaa2_jtemplate jt, drmaa2_cq cq, void *tag) {
+	if(js == NULL || jt == NULL || cq == NULL) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return lasterror;
+	}
+	AsyncJobTask *task = new AsyncJobTask(
+			reinterpret_cast<CompletionQueue *>(cq), DRMAA2_ASYNC_RUN_JOB,
+			tag, reinterpret_cast<JobSession *>(js), NULL);
+	drmaa2_jtemplate_convert(jt, task->getJobTemplate());
+	return drmaa2_async_submit(task);
+}
+
+/**
+ *  @brief  queues a job operation on the worker pool
+ *
+ *  @param[in]	j	-	pointer to drmaa2_job structure
+ *  @param[in]	cq	-	completion queue receiving the outcome
+ *  @param[in]	tag	-	caller cookie echoed in the completion
+ *  @param[in]	op	-	operation to perform
+ *
+ *  @return
+ *  		DRMAA2_SUCCESS if the operation was queued
+ *  		DRMAA2_INVALID_ARGUMENT if any argument is invalid
+ */
+static drmaa2_error drmaa2_j_async(drmaa2_j j, drmaa2_cq cq, void *tag,
+		const drmaa2_async_op op) {
+	if(j == NULL || cq == NULL) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return lasterror;
+	}
+	return drmaa2_async_submit(new AsyncJobTask(
+			reinterpret_cast<CompletionQueue *>(cq), op, tag, NULL,
+			reinterpret_cast<Job *>(j)));
+}
+
+/**
+ * @brief  Suspends the drmaa2_job asynchronously, see drmaa2_j_async.
+ */
+drmaa2_error drmaa2_j_suspend_async(drmaa2_j j, drmaa2_cq cq, void *tag) {
+	return drmaa2_j_async(j, cq, tag, DRMAA2_ASYNC_SUSPEND);
+}
+
+/**
+ * @brief  Resumes the drmaa2_job asynchronously, see drmaa2_j_async.
+ */
+drmaa2_error drmaa2_j_resume_async(drmaa2_j j, drmaa2_cq cq, void *tag) {
+	return drmaa2_j_async(j, cq, tag, DRMAA2_ASYNC_RESUME);
+}
+
+/**
+ * @brief  Holds the drmaa2_job asynchronously, see drmaa2_j_async.
+ */
+drmaa2_error drmaa2_j_hold_async(drmaa2_j j, drmaa2_cq cq, void *tag) {
+	return drmaa2_j_async(j, cq, tag, DRMAA2_ASYNC_HOLD);
+}
+
+/**
+ * @brief  Releases the drmaa2_job asynchronously, see drmaa2_j_async.
+ */
+drmaa2_error drmaa2_j_release_async(drmaa2_j j, drmaa2_cq cq, void *tag) {
+	return drmaa2_j_async(j, cq, tag, DRMAA2_ASYNC_RELEASE);
+}
+
+/**
+ * @brief  Terminates the drmaa2_job asynchronously, see drmaa2_j_async.
+ */
+drmaa2_error drmaa2_j_terminate_async(drmaa2_j j, drmaa2_cq cq, void *tag) {
+	return drmaa2_j_async(j, cq, tag, DRMAA2_ASYNC_TERMINATE);
+}
+
+/**
+ * @brief  Fetches the drmaa2_job state asynchronously, state and substate
+ * 			are delivered in the completion, see drmaa2_j_async.
+ */
+drmaa2_error drmaa2_j_get_state_async(const drmaa2_j j, drmaa2_cq cq,
+		void *tag) {
+	return drmaa2_j_async(j, cq, tag, DRMAA2_ASYNC_GET_STATE);
+}
+
 #ifdef __cplusplus
 }
 
@@ -3127,3 +3549,73 @@ drmaa2_error drmaa2_register_event_notification(
 
 #endif
 	
+
+/**
+ *  @brief  applies a control operation to every drmaa2_job of the list,
+ *  		the jobs are processed in parallel batches over pooled
+ *  		connections and a failing job does not stop the others
+ *
+ *  @param[in]	js	-	pointer to drmaa2_job session
+ *  @param[in]	jobs	-	list of drmaa2_jobs
+ *  @param[in]	op	-	DRMAA2_ASYNC_SUSPEND, DRMAA2_ASYNC_RESUME,
+ *  					DRMAA2_ASYNC_HOLD, DRMAA2_ASYNC_RELEASE or
+ *  					DRMAA2_ASYNC_TERMINATE
+ *  @param[out]	errors	-	drmaa2_list_size(jobs) entries receiving the
+ *  					outcome of each job in list order, may be NULL
+ *
+ *  @return
+ *  		DRMAA2_SUCCESS if the operation succeeded for every job
+ *  		error of the first failed job otherwise, last error is set
+ *  		DRMAA2_INVALID_ARGUMENT if any argument is invalid
+ */
+drmaa2_error drmaa2_jsession_control_jobs(const drmaa2_jsession js,
+		const drmaa2_j_list jobs, const drmaa2_async_op op,
+		drmaa2_error *errors) {
+	JobOperation operation;
+	switch (op) {
+	case DRMAA2_ASYNC_SUSPEND:
+		operation = SUSPEND_JOB;
+		break;
+	case DRMAA2_ASYNC_RESUME:
+		operation = RESUME_JOB;
+		break;
+	case DRMAA2_ASYNC_HOLD:
+		operation = HOLD_JOB;
+		break;
+	case DRMAA2_ASYNC_RELEASE:
+		operation = RELEASE_JOB;
+		break;
+	case DRMAA2_ASYNC_TERMINATE:
+		operation = TERMINATE_JOB;
+		break;
+	default:
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return lasterror;
+	}
+	if(js == NULL || jobs == NULL || jobs->type != DRMAA2_JOBLIST) {
+		lasterror = DRMAA2_INVALID_ARGUMENT;
+		return lasterror;
+	}
+	JobList jobList;
+	for(drmaa2_item item = (drmaa2_item)jobs->head; item != NULL;
+			item = item->next)
+		jobList.push_back((Job *)item->data.value);
+	drmaa2_error error = DRMAA2_SUCCESS;
+	try {
+		vector<JobOperationResult> results = reinterpret_cast<JobSession *>(
+				js)->controlJobs(jobList, operation);
+		for(size_t i = 0; i < results.size(); i++) {
+			if(errors != NULL)
+				errors[i] = (drmaa2_error)results[i].error;
+			if(error == DRMAA2_SUCCESS)
+				error = (drmaa2_error)results[i].error;
+		}
+	} catch (const Drmaa2Exception &ex) {
+		error = drmaa2_error_from_exception(ex);
+		for(size_t i = 0; errors != NULL && i < jobList.size(); i++)
+			errors[i] = error;
+	}
+	if(error != DRMAA2_SUCCESS)
+		lasterror = error;
+	return error;
+}
@@ -688,6 +688,11 @@ drmaa2_string drmaa2_jsession_get_session_name(const drmaa2_jsession js);
 
 drmaa2_string_list drmaa2_jsession_get_job_categories(const drmaa2_jsession js);
 
+drmaa2_error drmaa2_jsession_set_base_environment(drmaa2_jsession js,
+		const drmaa2_dict env);
+
+drmaa2_dict drmaa2_jsession_get_base_environment(const drmaa2_jsession js);
+
 drmaa2_j_list drmaa2_jsession_get_jobs(const drmaa2_jsession js,
 		const drmaa2_jinfo filter);
 
@@ -697,6 +702,9 @@ drmaa2_jarray drmaa2_jsession_get_job_array(const drmaa2_jsession js,
 drmaa2_j drmaa2_jsession_run_job(const drmaa2_jsession js,
 		const drmaa2_jtemplate jt);
 
+drmaa2_j drmaa2_jsession_run_job_with_key(const drmaa2_jsession js,
+		const drmaa2_jtemplate jt, const char *submit_key);
+
 drmaa2_jarray drmaa2_jsession_run_bulk_jobs(const drmaa2_jsession js,
 		const drmaa2_jtemplate jt, const long long begin_index,
 		const long long end_index, const long long step,
@@ -783,6 +791,72 @@ drmaa2_string_list drmaa2_get_rsession_names(void);
 
 drmaa2_error drmaa2_register_event_notification(const drmaa2_callback callback);
 
+typedef enum drmaa2_async_op {
+	DRMAA2_UNSET_ASYNC_OP = -1,
+	DRMAA2_ASYNC_RUN_JOB = 0,
+	DRMAA2_ASYNC_SUSPEND = 1,
+	DRMAA2_ASYNC_RESUME = 2,
+	DRMAA2_ASYNC_HOLD = 3,
+	DRMAA2_ASYNC_RELEASE = 4,
+	DRMAA2_ASYNC_TERMINATE = 5,
+	DRMAA2_ASYNC_GET_STATE = 6
+} drmaa2_async_op;
+
+typedef struct completion_s {
+	void *tag;
+	drmaa2_async_op op;
+	drmaa2_error error;
+	drmaa2_j job;
+	drmaa2_jstate jobState;
+	drmaa2_string jobSubState;
+	completion_s() {
+		tag = NULL;
+		op = DRMAA2_UNSET_ASYNC_OP;
+		error = DRMAA2_SUCCESS;
+		job = NULL;
+		jobState = DRMAA2_UNSET_JSTATE;
+		jobSubState = NULL;
+	}
+} drmaa2_completion_s;
+
+typedef drmaa2_completion_s *drmaa2_completion;
+
+void drmaa2_completion_free(drmaa2_completion * c);
+
+struct drmaa2_cq_s;  /* forward */
+
+typedef struct drmaa2_cq_s *drmaa2_cq;
+
+drmaa2_cq drmaa2_cq_create(void);
+
+void drmaa2_cq_free(drmaa2_cq * cq);
+
+int drmaa2_cq_get_fd(const drmaa2_cq cq);
+
+drmaa2_completion drmaa2_cq_poll(drmaa2_cq cq);
+
+drmaa2_completion drmaa2_cq_wait(drmaa2_cq cq, const time_t timeout);
+
+drmaa2_error drmaa2_jsession_run_job_async(const drmaa2_jsession js,
+		const drmaa2_jtemplate jt, drmaa2_cq cq, void *tag);
+
+drmaa2_error drmaa2_j_suspend_async(drmaa2_j j, drmaa2_cq cq, void *tag);
+
+drmaa2_error drmaa2_j_resume_async(drmaa2_j j, drmaa2_cq cq, void *tag);
+
+drmaa2_error drmaa2_j_hold_async(drmaa2_j j, drmaa2_cq cq, void *tag);
+
+drmaa2_error drmaa2_j_release_async(drmaa2_j j, drmaa2_cq cq, void *tag);
+
+drmaa2_error drmaa2_j_terminate_async(drmaa2_j j, drmaa2_cq cq, void *tag);
+
+drmaa2_error drmaa2_j_get_state_async(const drmaa2_j j, drmaa2_cq cq,
+		void *tag);
+
+drmaa2_error drmaa2_jsession_control_jobs(const drmaa2_jsession js,
+		const drmaa2_j_list jobs, const drmaa2_async_op op,
+		drmaa2_error *errors);
+
 #ifdef	__cplusplus
 }
 #endif
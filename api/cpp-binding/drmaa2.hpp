@@ -101,6 +101,56 @@ enum JobState {
 	FAILED
 };
 
+/**
+ * @enum ErrorCode
+ *
+ * @brief enumeration identifies the exception class of a failed
+ * 			operation, values match drmaa2_error of the C binding
+ *
+ */
+enum ErrorCode {
+	ERROR_NONE,
+	ERROR_DENIED_BY_DRMS,
+	ERROR_DRM_COMMUNICATION,
+	ERROR_TRY_LATER,
+	ERROR_SESSION_MANAGEMENT,
+	ERROR_TIMEOUT,
+	ERROR_INTERNAL,
+	ERROR_INVALID_ARGUMENT,
+	ERROR_INVALID_SESSION,
+	ERROR_INVALID_STATE,
+	ERROR_OUT_OF_RESOURCE,
+	ERROR_UNSUPPORTED_ATTRIBUTE,
+	ERROR_UNSUPPORTED_OPERATION,
+	ERROR_IMPLEMENTATION_SPECIFIC
+};
+
+/**
+ * @enum JobOperation
+ *
+ * @brief enumeration defines the control operations which can be applied
+ * 			to a list of jobs at once
+ *
+ */
+enum JobOperation {
+	SUSPEND_JOB,
+	RESUME_JOB,
+	HOLD_JOB,
+	RELEASE_JOB,
+	TERMINATE_JOB
+};
+
+/**
+ * @enum OutputStream
+ *
+ * @brief enumeration selects the output file of a job to read
+ *
+ */
+enum OutputStream {
+	OUTPUT_STREAM,
+	ERROR_STREAM
+};
+
 /**
  * @enum OperatingSystem
  *
@@ -389,6 +439,7 @@ struct JobTemplate {
 	map<string, string> stageOutFiles; /*!< Stage out files*/
 	map<string, string> resourceLimits; /*!< Resource limits*/
 	string accountingId; /*!< Account id*/
+	string scriptBody; /*!< Job script content, submitted from memory instead of remoteCommand when set*/
 	JobTemplate() {
 		remoteCommand.empty();
 		args.empty();
@@ -420,9 +471,36 @@ struct JobTemplate {
 		stageOutFiles.empty();
 		resourceLimits.empty();
 		accountingId.empty();
+		scriptBody.empty();
 	}
 };
 
+/**
+ * @struct SweepPoint
+ * @brief one point of a parameter sweep, values override the base
+ * 			JobTemplate of the sweep
+ *
+ */
+struct SweepPoint {
+	vector<string> args; /*!< Replaces template args when not empty*/
+	map<string, string> jobEnvironment; /*!< Added to template job envs*/
+	map<string, string> resourceLimits; /*!< Added to template resource limits*/
+};
+
+typedef vector<SweepPoint> SweepTable;
+
+/**
+ * @struct JobGraphNode
+ * @brief one job of a dependency graph
+ *
+ */
+struct JobGraphNode {
+	JobTemplate jobTemplate; /*!< Job to run for this node*/
+	list<long> dependsOn; /*!< Nodes which must finish successfully first*/
+};
+
+typedef vector<JobGraphNode> JobGraphTemplate;
+
 /**
  * @struct MachineInfo
  * @brief describes the properties of a particular
@@ -494,6 +572,58 @@ class DrmaaReflective {
 	string describeAttribute(void *instance, string name);
 };
 
+/**
+ * @struct JobAlteration
+ * @brief attributes to change on submitted jobs, fields left at their
+ * 			default are not touched
+ *
+ */
+struct JobAlteration {
+	string jobName; /*!< New job name, empty keeps the current one*/
+	bool alterPriority; /*!< Flag indicating priority is to be changed*/
+	long priority; /*!< New job priority*/
+	string holdTypes; /*!< Hold types u, o and s, or n to clear them*/
+	map<string, string> resourceLimits; /*!< Limits to set, DRMAA2 names or DRMS resource names*/
+	JobAlteration() {
+		alterPriority = false;
+		priority = 0;
+	}
+};
+
+/**
+ * @struct OutputCursor
+ * @brief read position in an output stream of a job, a default
+ * 			constructed cursor starts at the first byte
+ *
+ */
+struct OutputCursor {
+	unsigned long long offset; /*!< Bytes of the current file consumed*/
+	unsigned long long file; /*!< Identity of the file read, 0 before the first read*/
+	OutputCursor() {
+		offset = 0;
+		file = 0;
+	}
+};
+
+/**
+ * @struct UsageSample
+ * @brief resources used by a running job at one point in time
+ *
+ */
+struct UsageSample {
+	time_t time; /*!< When the sample was taken*/
+	long cpuTime; /*!< CPU seconds used so far*/
+	long long memory; /*!< Memory in use, in kilobytes*/
+	time_t wallclockTime; /*!< Wallclock seconds so far*/
+	UsageSample() {
+		time = 0;
+		cpuTime = 0;
+		memory = 0;
+		wallclockTime = 0;
+	}
+};
+typedef vector<UsageSample> UsageSampleList;
+
 /**
  * @class Job
  * @brief Abstract class allows one to instruct the DRMS
@@ -601,6 +731,19 @@ public:
 	 */
 	virtual void terminate(void) const throw() = 0;
 
+	/**
+	 * @brief Changes attributes of a submitted Job
+	 *
+	 * @param[in] alteration_ - attributes to change
+	 *
+	 * @throw InvalidArgumentException - If alteration_ changes nothing
+	 * @throw InvalidStateException - If the Job can not be altered anymore
+	 * @throw ImplementationSpecificException - If the DRMS rejects it
+	 *
+	 * @return None
+	 */
+	virtual void alter(const JobAlteration& alteration_) const = 0;
+
 	/**
 	 * @brief Clean up any data about this job
 	 *
@@ -635,9 +778,210 @@ public:
 	 * @return None
 	 */
 	virtual void waitTerminated(TimeAmount& timeout_) = 0;
+
+	/**
+	 * @brief Returns the bytes written to an output stream of the Job since
+	 * 			cursor_ and advances the cursor past them. Only the new bytes
+	 * 			are read. A file truncated or replaced since the last call is
+	 * 			read again from its start
+	 *
+	 * @param[in] stream_ - OUTPUT_STREAM or ERROR_STREAM
+	 * @param[in,out] cursor_ - position reached by the previous call
+	 * @param[in] maxBytes_ - most bytes to return
+	 * @param[in] timeout_ - seconds to wait for new bytes, 0 returns at
+	 * 						once, negative waits until bytes arrive
+	 *
+	 * @throw InvalidArgumentException - If the JobTemplate names no file
+	 * 									for the stream
+	 *
+	 * @return new bytes, empty if none arrived in time
+	 */
+	virtual string readOutput(const OutputStream stream_,
+			OutputCursor& cursor_, const size_t maxBytes_,
+			const TimeAmount timeout_) const = 0;
+
+	/**
+	 * @brief Starts sampling the resources used by the Job. While the Job
+	 * 			runs its usage is sampled at a fixed interval together with
+	 * 			every other tracked job, the oldest samples are dropped
+	 * 			beyond a fixed number
+	 *
+	 * @param - None
+	 *
+	 * @return None
+	 */
+	virtual void trackUsage(void) const = 0;
+
+	/**
+	 * @brief Returns the usage samples kept for the Job, oldest first
+	 *
+	 * @param - None
+	 *
+	 * @return samples, empty if the Job is not tracked
+	 */
+	virtual UsageSampleList getUsage(void) const = 0;
 };
 typedef list<Job*> JobList;
 
+/**
+ * @struct JobOperationResult
+ * @brief outcome of a JobOperation for one job of a JobList
+ *
+ */
+struct JobOperationResult {
+	Job *job; /*!< Job the operation was applied to, NULL for filters*/
+	string jobId; /*!< Unique Job identification in DRMS */
+	ErrorCode error; /*!< ERROR_NONE if the operation succeeded*/
+	string message; /*!< Reason of the failure, empty on success*/
+	JobOperationResult() {
+		job = NULL;
+		error = ERROR_NONE;
+	}
+};
+
+/**
+ * @class JobOperationCallback
+ * @brief Abstract class informing the application about the progress of
+ * 			a JobOperation applied to the jobs matching a filter. Calls are
+ * 			serialized but made from library worker threads
+ * */
+class JobOperationCallback {
+public:
+	virtual ~JobOperationCallback() {
+	}
+
+	/**
+	 * @brief Reports a job the operation failed for
+	 *
+	 * @param[in] result_ - outcome of the job, job is NULL
+	 *
+	 * @return None
+	 */
+	virtual void failed(const JobOperationResult& result_) = 0;
+
+	/**
+	 * @brief Reports progress, called once per processed batch
+	 *
+	 * @param[in] done_ - Jobs processed so far
+	 * @param[in] failed_ - Jobs the operation failed for so far
+	 * @param[in] total_ - Jobs matching the filter
+	 *
+	 * @return None
+	 */
+	virtual void progress(const long done_, const long failed_,
+			const long total_) = 0;
+};
+
+/**
+ * @class JobGraph
+ * @brief Abstract class represents the jobs of a dependency graph.
+ * 			JobGraph instances are only created by the runJobGraph method
+ */
+class JobGraph {
+public:
+	/**
+	 * Destructor
+	 */
+	virtual ~JobGraph(void) {
+	}
+
+	/**
+	 * @brief Returns the jobs of the graph
+	 *
+	 * @param - None
+	 *
+	 * @return List of Job in the order of the JobGraphTemplate nodes
+	 */
+	virtual const JobList& getJobs(void) const = 0;
+
+	/**
+	 * @brief Returns how many jobs of the graph are in each state
+	 *
+	 * @param - None
+	 *
+	 * @return map of JobState to number of jobs
+	 */
+	virtual map<JobState, long> getStateSummary(void) const = 0;
+
+	/**
+	 * @brief Returns the aggregated state of the graph. FAILED if any job
+	 * 			failed, DONE once all jobs are done, RUNNING while any job
+	 * 			runs, QUEUED otherwise
+	 *
+	 * @param - None
+	 *
+	 * @return JobState
+	 */
+	virtual JobState getState(void) const = 0;
+
+	/**
+	 * @brief Terminates every job of the graph
+	 *
+	 * @param - None
+	 *
+	 * @return None
+	 */
+	virtual void terminate(void) const = 0;
+};
+
+/**
+ * @class JobWaitSet
+ * @brief Abstract class represents a reusable set of jobs to wait on. Jobs
+ * 			are added once, every wait returns the jobs which started or
+ * 			terminated since the previous one. JobWaitSet instances are only
+ * 			created by the createWaitSet method and are deleted by the caller
+ */
+class JobWaitSet {
+public:
+	/**
+	 * Destructor
+	 */
+	virtual ~JobWaitSet(void) {
+	}
+
+	/**
+	 * @brief Adds a job to the set, nothing if it is already in
+	 *
+	 * @param[in] job_ - Job to watch, must outlive its membership
+	 *
+	 * @return None
+	 */
+	virtual void add(const Job& job_) = 0;
+
+	/**
+	 * @brief Removes a job from the set, also if it is already reported
+	 * 			ready but not yet returned by wait
+	 *
+	 * @param[in] job_ - Job to forget
+	 *
+	 * @return None
+	 */
+	virtual void remove(const Job& job_) = 0;
+
+	/**
+	 * @brief Returns the number of jobs not yet returned by wait
+	 *
+	 * @param - None
+	 *
+	 * @return number of jobs
+	 */
+	virtual size_t size(void) const = 0;
+
+	/**
+	 * @brief Waits until jobs of the set started or terminated. Returned
+	 * 			jobs leave the set. Only one thread may wait at a time
+	 *
+	 * @param[in] timeout_ - Indicates call blocking duration
+	 *
+	 * @throw InvalidStateException - If the set is empty or another thread
+	 * 			waits on it
+	 * @throw TimeoutException - If no job got there in the given duration
+	 *
+	 * @return List of Job which got there since the previous wait
+	 */
+	virtual JobList wait(const TimeAmount timeout_) = 0;
+};
+
 /**
  * @class JobArray
  * @brief Abstract class represents a set of jobs created by one operation.
@@ -733,6 +1077,22 @@ public:
 	 */
 	virtual void terminate(void) const = 0;
 
+	/**
+	 * @brief Applies operation_ to the sub jobs of indices_. The indices
+	 * 			are compressed into sub job ranges, the DRMS gets one
+	 * 			request per range and the ranges are sent in parallel
+	 *
+	 * @param[in] indices_ - Array indices to act on
+	 * @param[in] operation_ - SUSPEND_JOB, RESUME_JOB or TERMINATE_JOB
+	 *
+	 * @throw UnsupportedOperationException - If the DRMS can not apply
+	 * 			operation_ to single sub jobs
+	 *
+	 * @return One result per range, jobId holds the range
+	 */
+	virtual vector<JobOperationResult> controlIndices(
+			const set<long>& indices_, const JobOperation operation_) const = 0;
+
 	/**
 	 * @brief Clean up any data about this JobArray
 	 *
@@ -876,6 +1236,40 @@ public:
 	virtual const Reservation& requestReservation(
 			const ReservationTemplate& reservationTemplate_) const = 0;
 
+	/**
+	 * @brief Requests all reservations of the list concurrently. Either
+	 * every request is accepted or the accepted ones are removed again.
+	 *
+	 * @param[in] reservationTemplates_ - reservation information
+	 *
+	 * @return ReservationList - reservations in template order
+	 */
+	virtual ReservationList requestReservations(
+			const list<ReservationTemplate>& reservationTemplates_) const = 0;
+
+	/**
+	 * @brief Waits until the DRMS decided on every reservation. All of them
+	 * are watched through one shared status query per poll.
+	 *
+	 * @param[in] reservations_ - reservations to wait for
+	 * @param[in] timeout_ - seconds to wait, negative waits forever
+	 *
+	 * @return ReservationList - the confirmed reservations, the others
+	 * 			were denied or removed
+	 */
+	virtual ReservationList waitConfirmed(const ReservationList& reservations_,
+			const TimeAmount timeout_) const = 0;
+
+	/**
+	 * @brief Removes all reservations of the list concurrently
+	 *
+	 * @param[in] reservations_ - reservations to remove
+	 *
+	 * @return ReservationList - the reservations which could not be removed
+	 */
+	virtual ReservationList terminateReservations(
+			const ReservationList& reservations_) const = 0;
+
 	/**
 	 * @brief Returns associated list of reservations
 	 *
@@ -958,6 +1352,27 @@ public:
 		return jobCategories;
 	}
 
+	/**
+	 * @brief Sets the environment every job of the session starts with.
+	 * 			JobTemplate::jobEnvironment entries are added on top and
+	 * 			win over base entries of the same name
+	 *
+	 * @param[in] environment_ - Base environment, empty to clear
+	 *
+	 * @return - None
+	 */
+	virtual void setBaseEnvironment(
+			const map<string, string>& environment_) = 0;
+
+	/**
+	 * @brief Returns the base environment of the session
+	 *
+	 * @param - None
+	 *
+	 * @return Base environment
+	 */
+	virtual const map<string, string>& getBaseEnvironment(void) const = 0;
+
 	/**
 	 * @brief Returns associated jobs
 	 *
@@ -989,6 +1404,24 @@ public:
 	 */
 	virtual const Job& runJob(const JobTemplate& jobTemplate_) const = 0;
 
+	/**
+	 * @brief Submit Job to DRMS tagged with a client idempotency key. A
+	 * 			submission whose reply is lost is only repeated when the
+	 * 			DRMS holds no job carrying the key
+	 *
+	 * @param[in] jobTemplate_ - Detailed job information
+	 * @param[in] submitKey_ - Caller chosen key, stored in the job
+	 * 			environment as DRMAA2_SUBMIT_KEY
+	 *
+	 * @throw InvalidArgumentException - If submitKey_ is empty or holds
+	 * 			white space, ',' or a backslash
+	 * @throw ImplementationSpecificException - If the submission fails
+	 *
+	 * @return Reference to Job object from the DRMS
+	 */
+	virtual const Job& runJob(const JobTemplate& jobTemplate_,
+			const string& submitKey_) const = 0;
+
 	/**
 	 * @brief Submit JobArray to DRMS
 	 *
@@ -1006,6 +1439,154 @@ public:
 			const long beginIndex_, const long endIndex_, const long step_,
 			const long maxParallel_) const = 0;
 
+	/**
+	 * @brief Submits a parameter sweep. Points sharing the same resource
+	 * 			limits are submitted together as one JobArray, arguments
+	 * 			and environment are looked up per array index.
+	 *
+	 * @param[in] jobTemplate_ - Base job information
+	 * @param[in] points_ - Per point overrides of jobTemplate_
+	 *
+	 * @throw ImplementationSpecificException - If DRMS rejects a
+	 * 			submission, the arrays already submitted are terminated
+	 * @throw InvalidArgumentException - If a point sets an environment
+	 * 			variable whose name is not [A-Za-z_][A-Za-z0-9_]*, or the
+	 * 			shebang of the scriptBody is not the absolute path of a
+	 * 			POSIX shell
+	 *
+	 * @return JobList - One Job per point, in the order of points_
+	 */
+	virtual JobList runJobSweep(const JobTemplate& jobTemplate_,
+			const SweepTable& points_) const = 0;
+
+	/**
+	 * @brief Submits a dependency graph. Nodes are submitted in
+	 * 			topological waves, each node depends on the jobs of
+	 * 			its dependsOn nodes
+	 *
+	 * @param[in] graph_ - Nodes of the graph
+	 *
+	 * @throw InvalidArgumentException - If the graph has a cycle or an
+	 * 			unknown node index
+	 * @throw ImplementationSpecificException - If DRMS rejects a submission
+	 *
+	 * @return JobGraph
+	 */
+	virtual JobGraph& runJobGraph(const JobGraphTemplate& graph_) const = 0;
+
+	/**
+	 * @brief Opens the write-ahead submission journal at path_. Requests
+	 * 			left pending by a previous process are submitted again.
+	 * 			For requests caught mid submission the DRMS is first
+	 * 			asked for a job carrying their key, finished jobs
+	 * 			included, and they are only resubmitted if none is found
+	 *
+	 * @param[in] path_ - Journal file, created if missing
+	 *
+	 * @throw InvalidStateException - If a journal is already open
+	 * @throw ImplementationSpecificException - If the file can not be used
+	 *
+	 * @return - None
+	 */
+	virtual void openJournal(const string& path_) = 0;
+
+	/**
+	 * @brief Stops the journal drainer, pending requests stay in the
+	 * 			journal file
+	 *
+	 * @param - None
+	 *
+	 * @return - None
+	 */
+	virtual void closeJournal(void) = 0;
+
+	/**
+	 * @brief Durably records a submission and returns without waiting
+	 * 			for the DRMS, the journal drainer submits it
+	 *
+	 * @param[in] jobTemplate_ - Detailed job information
+	 * @param[in] requestKey_ - Caller chosen idempotency key, generated
+	 * 			if empty. A key already journaled is not queued again
+	 *
+	 * @throw InvalidStateException - If no journal is open
+	 * @throw InvalidArgumentException - If requestKey_ holds white space,
+	 * 			',' or a backslash
+	 * @throw ImplementationSpecificException - If the journal write fails
+	 *
+	 * @return Request key
+	 */
+	virtual string enqueueJob(const JobTemplate& jobTemplate_,
+			const string& requestKey_ = string()) = 0;
+
+	/**
+	 * @brief Returns the job id the journal drainer got for requestKey_
+	 *
+	 * @param[in] requestKey_ - Key returned by enqueueJob
+	 *
+	 * @throw InvalidStateException - If no journal is open
+	 * @throw InvalidArgumentException - If the key is unknown
+	 * @throw ImplementationSpecificException - If the submission failed
+	 *
+	 * @return Job id, empty while the request is pending
+	 */
+	virtual string getEnqueuedJobId(const string& requestKey_) = 0;
+
+	/**
+	 * @brief Applies operation_ to every job of jobs_. The jobs are split
+	 * 			into batches running in parallel on pooled connections, a
+	 * 			failing job does not stop the others
+	 *
+	 * @param[in] jobs_ - List of Jobs
+	 * @param[in] operation_ - Operation to apply
+	 *
+	 * @return One result per job, in the order of jobs_
+	 */
+	virtual vector<JobOperationResult> controlJobs(const JobList& jobs_,
+			const JobOperation operation_) const = 0;
+
+	/**
+	 * @brief Applies alteration_ to every job of jobs_. The attribute list
+	 * 			is built once per batch and the batches run in parallel on
+	 * 			pooled connections, a failing job does not stop the others
+	 *
+	 * @param[in] jobs_ - List of Jobs
+	 * @param[in] alteration_ - attributes to change
+	 *
+	 * @throw InvalidArgumentException - If alteration_ changes nothing
+	 *
+	 * @return One result per job, in the order of jobs_
+	 */
+	virtual vector<JobOperationResult> alterJobs(const JobList& jobs_,
+			const JobAlteration& alteration_) const = 0;
+
+	/**
+	 * @brief Applies operation_ to every job matching filter_. The job ids
+	 * 			are selected by the DRMS, no Job object is created
+	 *
+	 * @param[in] filter_ - Only jobId, jobOwner, queueName and jobState
+	 * 			QUEUED, QUEUED_HELD, RUNNING or SUSPENDED may be set
+	 * @param[in] operation_ - Operation to apply
+	 * @param[in] callback_ - Receives failures and progress, may be NULL
+	 *
+	 * @throw UnsupportedAttributeException - If filter_ sets other fields
+	 * @throw ImplementationSpecificException - If the selection fails
+	 *
+	 * @return Number of jobs the operation failed for
+	 */
+	virtual long controlJobs(const JobInfo& filter_,
+			const JobOperation operation_,
+			JobOperationCallback *callback_ = NULL) const = 0;
+
+	/**
+	 * @brief Creates an empty wait set. Prefer it over waitAnyStarted and
+	 * 			waitAnyTerminated when waiting repeatedly on many jobs
+	 *
+	 * @param[in] terminated_ - Wait for termination instead of start
+	 *
+	 * @return JobWaitSet, deleted by the caller
+	 */
+	virtual JobWaitSet& createWaitSet(const bool terminated_) const = 0;
+
 	/**
 	 * @brief In a list of specified job ids waits until
 	 * 			any of the job is started
@@ -1402,17 +1983,29 @@ public:
 	virtual const StringList& getJobSessionNames(void) = 0;
 
 	/**
-	 * @brief registers for event from DRMS
+	 * @brief registers for event from DRMS, replacing the previous
+	 * 			callback. Notifications are delivered on library threads
+	 * 			for the jobs of the calling user
 
-	 * @param callback - call back details
+	 * @param callback - call back details, must outlive the registration
+	 * 			until unregisterEventNotification returns
 	 *
-	 * @throw UnsupportedOperationException - If the functionality is not
-	 * 											supported
+	 * @throw OutOfResourceException - If the event threads cannot start
 	 * @return None
 	 *
 	 */
 	virtual void registerEventNotification(const DrmaaCallback& callback) = 0;
 
+	/**
+	 * @brief unregisters the callback of registerEventNotification.
+	 * 			Returns once no notification is being delivered to it on
+	 * 			another thread, the callback may be freed then
+	 *
+	 * @return None
+	 *
+	 */
+	virtual void unregisterEventNotification(void) = 0;
+
 	/**
 	 * @brief Initializes SessionManager
 	 *
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_ACCOUNTINGLOG_H
+#define INC_ACCOUNTINGLOG_H
+
+#include <pthread.h>
+#include <sys/types.h>
+#include <ctime>
+#include <list>
+#include <map>
+#include <string>
+#include <drmaa2.hpp>
+
+using namespace std;
+
+#define ACCOUNTING_DIR_ENV "DRMAA2_ACCOUNTING_DIR"
+#define PBS_CONF_FILE_ENV "PBS_CONF_FILE"
+#define PBS_CONF_FILE_DEFAULT "/etc/pbs.conf"
+#define PBS_HOME_DEFAULT "/var/spool/pbs"
+#define ACCOUNTING_SUBDIR "/server_priv/accounting"
+#define ACCOUNTING_MAX_RECORDS 65536 /*!< Final records kept for lookups */
+
+namespace drmaa2 {
+
+/**
+ *  @brief What the final record of the accounting log tells about a job,
+ *  the end (E) record, or the delete (D) or abort (A) record of a job that
+ *  never ran to its end.
+ */
+struct AccountingRecord {
+	bool ended; /*!< E record, the figures below are set */
+	long exitStatus; /*!< Exit_status */
+	time_t finishTime; /*!< end, the record time for D and A */
+	long cpuTime; /*!< resources_used.cput in seconds */
+	time_t wallclockTime; /*!< resources_used.walltime in seconds */
+	AccountingRecord() : ended(true), exitStatus(0), finishTime(0),
+			cpuTime(0), wallclockTime(0) {
+	}
+	/**
+	 * @brief
+	 *      getState() - returns the final state of the job
+	 *
+	 * @return	DONE, or FAILED for a non zero exit status or a job
+	 *			deleted or aborted before its end
+	 */
+	JobState getState() const {
+		return ended && exitStatus == 0 ? DONE : FAILED;
+	}
+};
+
+/**
+ *  @brief Incremental reader of the PBS accounting log. The daily files are
+ *  named YYYYMMDD, the reader keeps its byte offset in the newest one and
+ *  moves on to the next file once the server rotates. New complete lines
+ *  are parsed in place in a read only mapping, only the final records are
+ *  kept. Useful on the server host or where the accounting directory is
+ *  mounted, elsewhere the directory is missing and the reader stays empty.
+ */
+class AccountingLog {
+private:
+	static pthread_mutex_t _instMutex;
+	static AccountingLog* _instance;
+	mutable pthread_mutex_t _mutex;
+	const string _directory;
+	const size_t _maxRecords;
+	string _file;
+	ino_t _inode;
+	off_t _offset;
+	bool _available;
+	map<string, AccountingRecord> _records;
+	list<string> _order;
+	/**
+	 * @brief
+	 *      AccountingLog() - copy constructor for AccountingLog
+	 *
+	 */
+	AccountingLog(AccountingLog& log_) : _maxRecords(0) {
+	}
+	/**
+	 * @brief
+	 *      latestFile() - finds the newest daily file
+	 *
+	 * @return	file name, empty if there is none
+	 */
+	string latestFile();
+	/**
+	 * @brief
+	 *      readFile() - parses the complete lines written to _file since
+	 *      _offset and advances it
+	 *
+	 * @param[out]  grown_ - set if the file had new bytes
+	 *
+	 * @return	number of final records read
+	 */
+	size_t readFile(bool& grown_);
+	/**
+	 * @brief
+	 *      parse() - parses complete lines in place
+	 *
+	 * @param[in]   begin_ - first byte of the first line
+	 * @param[in]   end_ - one past the newline of the last line
+	 *
+	 * @return	number of final records read
+	 */
+	size_t parse(const char *begin_, const char *end_);
+public:
+	/**
+	 * @brief
+	 *      AccountingLog() - constructor for AccountingLog, nothing is read
+	 *      before the first refresh()
+	 *
+	 * @param[in]   directory_ - accounting directory
+	 * @param[in]   maxRecords_ - final records kept, the oldest are dropped
+	 *
+	 */
+	AccountingLog(const string& directory_,
+			const size_t maxRecords_ = ACCOUNTING_MAX_RECORDS);
+	/**
+	 * @brief
+	 *      ~AccountingLog() - destructor for AccountingLog
+	 *
+	 */
+	~AccountingLog();
+	/**
+	 * @brief
+	 *	getInstance() - returns singleton Instance of AccountingLog reading
+	 *	DRMAA2_ACCOUNTING_DIR, or the accounting directory below PBS_HOME
+	 *
+	 * @return    pointer to AccountingLog object
+	 *
+	 */
+	static AccountingLog* getInstance();
+	/**
+	 * @brief
+	 *      refresh() - reads what the server appended since the last call
+	 *
+	 * @return	number of new final records
+	 */
+	size_t refresh();
+	/**
+	 * @brief
+	 *      isAvailable() - tells whether the log could be read last time
+	 *
+	 * @return	true if the accounting directory is readable
+	 */
+	bool isAvailable() const;
+	/**
+	 * @brief
+	 *      lookup() - finds the final record of a job
+	 *
+	 * @param[in]   jobId_ - job id as written by the server
+	 * @param[out]  record_ - receives the record
+	 *
+	 * @return	true if the job ended, or was deleted or aborted, in the
+	 *			part of the log read so far
+	 */
+	bool lookup(const string& jobId_, AccountingRecord& record_) const;
+};
+}
+#endif
@@ -115,6 +115,16 @@ public:
 	 */
 	virtual void setResource(char *resName_, char *resVal_);
 
+	/**
+	 * @brief Method to append the entries of chain_ which the list does not
+	 * 			set yet. Values are shared with chain_, not copied.
+	 *
+	 * @param[in] chain_ - attribute chain outliving this helper
+	 *
+	 * @return  void
+	 */
+	virtual void mergeAttributes(const ATTRL* chain_);
+
 	/**
 	 * @brief pure virtual method to override for different templates.
 	 */
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_COMPLETIONQUEUE_H
+#define INC_COMPLETIONQUEUE_H
+
+#include <pthread.h>
+#include <list>
+#include <drmaa2.hpp>
+#include <OutOfResourceException.h>
+
+using namespace std;
+
+#define EVENTFD_FAILED "Failed to create completion event descriptor"
+
+namespace drmaa2 {
+
+/**
+ *  @brief Thread safe queue of finished asynchronous operations.
+ *
+ *  Every queued entry is mirrored by one count on an eventfd, so the
+ *  descriptor stays readable while entries are pending and can be
+ *  handed to select/poll/epoll by the caller.
+ */
+class CompletionQueue {
+private:
+	pthread_mutex_t _queueMutex;
+	pthread_cond_t _queueCond;
+	int _eventFd;
+	long _outstanding;
+	list<void*> _entries;
+	/**
+	 * @brief
+	 *      CompletionQueue() - copy constructor for CompletionQueue
+	 *
+	 */
+	CompletionQueue(CompletionQueue& queue_) {
+	}
+	/**
+	 * @brief
+	 *      popEntry() - removes the head entry, caller holds _queueMutex
+	 *
+	 * @return	entry or NULL if queue is empty
+	 */
+	void* popEntry();
+public:
+	/**
+	 * @brief
+	 *      CompletionQueue() - constructor for CompletionQueue
+	 *
+	 * @throw OutOfResourceException - If eventfd cannot be created
+	 */
+	CompletionQueue() throw (OutOfResourceException);
+	/**
+	 * @brief
+	 *      ~CompletionQueue() - destructor, closes the eventfd. Entries
+	 *      still queued are owned by the caller and must be drained first.
+	 */
+	~CompletionQueue();
+	/**
+	 * @brief
+	 *      getFd() - returns descriptor readable while entries are queued
+	 *
+	 * @return	eventfd descriptor
+	 */
+	int getFd() const;
+	/**
+	 * @brief
+	 *      expect() - announces an operation which will later push()
+	 *
+	 * @return	void
+	 */
+	void expect();
+	/**
+	 * @brief
+	 *      push() - queues the result of an announced operation
+	 *
+	 * @param[in]   entry_ - opaque completion record
+	 *
+	 * @return	void
+	 */
+	void push(void *entry_);
+	/**
+	 * @brief
+	 *      cancel() - withdraws an announced operation which never ran
+	 *
+	 * @return	void
+	 */
+	void cancel();
+	/**
+	 * @brief
+	 *      poll() - dequeues an entry without blocking
+	 *
+	 * @return	entry or NULL if none is queued
+	 */
+	void* poll();
+	/**
+	 * @brief
+	 *      wait() - dequeues an entry, blocking up to timeout_ seconds
+	 *
+	 * @param[in]   timeout_ - seconds to wait, negative waits forever
+	 *
+	 * @return	entry or NULL on timeout
+	 */
+	void* wait(const TimeAmount timeout_);
+	/**
+	 * @brief
+	 *      drain() - blocks until every announced operation has pushed
+	 *
+	 * @return	void
+	 */
+	void drain();
+};
+}
+#endif
@@ -59,6 +59,7 @@ private:
 	static pthread_mutex_t _instMutex;
 	static ConnectionPool* _instance;
 	static pthread_mutex_t _connMutex;
+	static pthread_cond_t _connCond;
 	/**
 	 * @brief
 	 *      ConnectionPool() - constructor for ConnectionPool
@@ -103,6 +104,19 @@ public:
 	 */
 	const Connection& getConnection() throw (InternalException);
 
+	/**
+	 * @brief
+	 *      waitConnection() - returns a connection from the pool, blocking
+	 *      while all connections are in use.
+	 *
+	 * @param - None
+	 *
+	 * @throw InternalException - If pool holds no connections at all
+	 *
+	 * @return	Connection
+	 */
+	const Connection& waitConnection() throw (InternalException);
+
 	/**
 	 * @brief
 	 *      addConnection() - adds the connection passed and establishes connection.
@@ -129,7 +143,8 @@ public:
 	void returnConnection(const Connection& object);
 	/**
 	 * @brief
-	 *      reconnectConnection() - re-establishes connection to PBS.
+	 *      reconnectConnection() - re-establishes connection to PBS,
+	 *      releasing the previous descriptor first.
 	 *
 	 * @param[in]   object - Connection
 	 *
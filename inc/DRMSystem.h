@@ -41,12 +41,40 @@
 #include <drmaa2.hpp>
 #include <DeniedByDrmsException.h>
 #include <ImplementationSpecificException.h>
+#include <InvalidArgumentException.h>
 #include <InvalidStateException.h>
+#include <set>
 #include <string>
 #include <Connection.h>
 
 namespace drmaa2 {
 
+class EnvironmentEncoder;
+class JobAlterationAttrHelper;
+
+/**
+ * @struct JobSnapshot
+ * @brief Projected view of a job in one snapshot of the DRMS
+ */
+struct JobSnapshot {
+	JobState state; /*!< State derived from job_state and run history */
+	unsigned long digest; /*!< Hash of the other projected attributes */
+	JobSnapshot() : state(UNDETERMINED), digest(0) {
+	}
+};
+
+/**
+ * @struct JobUsage
+ * @brief State and resources_used of a job in one query of the DRMS
+ */
+struct JobUsage {
+	JobState state; /*!< State derived from job_state and run history */
+	bool sampled; /*!< The DRMS reported resources_used */
+	UsageSample usage; /*!< resources_used, time is left to the caller */
+	JobUsage() : state(UNDETERMINED), sampled(false) {
+	}
+};
+
 /**
  * @class DRMSystem
  * @brief An interface to DRMS system. Defines DRMS functionality
@@ -100,6 +128,7 @@ public:
 	 *
 	 * @param[in] connection_ - connection object
 	 * @param[in] jobTemplate_ - JobTemplate
+	 * @param[in] environment_ - session base environment, NULL for none
 	 *
 	 * @throw DrmCommunicationException - Communication errors while
 	 * 									sending/receiving data from/to DRMS
@@ -111,7 +140,72 @@ public:
 	 *
 	 */
 	virtual Job* runJob(const Connection & connection_,
-			const JobTemplate& jobTemplate_)
+			const JobTemplate& jobTemplate_,
+			const EnvironmentEncoder *environment_ = NULL)
+					throw (ImplementationSpecificException) = 0;
+
+	/**
+	 * @brief Submits the job so it only becomes eligible once every job
+	 * 			in afterOk_ finished successfully
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] jobTemplate_ - JobTemplate
+	 * @param[in] afterOk_ - ids of jobs the new job depends on
+	 * @param[in] environment_ - session base environment, NULL for none
+	 *
+	 * @throw DrmCommunicationException - Communication errors while
+	 * 									sending/receiving data from/to DRMS
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 * @warning Application has to handle Job memory deallocation
+	 *
+	 * @return Job - Job object
+	 *
+	 */
+	virtual Job* runJob(const Connection & connection_,
+			const JobTemplate& jobTemplate_, const list<string>& afterOk_,
+			const EnvironmentEncoder *environment_ = NULL)
+					throw (ImplementationSpecificException) = 0;
+
+	/**
+	 * @brief Submits the job tagged with a client idempotency key. A
+	 * 			failed submission is only repeated after findKeyedJob
+	 * 			showed that the DRMS did not create the job
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] jobTemplate_ - JobTemplate
+	 * @param[in] submitKey_ - client idempotency key
+	 * @param[in] environment_ - session base environment, NULL for none
+	 *
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 * @warning Application has to handle Job memory deallocation
+	 *
+	 * @return Job - Job object
+	 *
+	 */
+	virtual Job* runKeyedJob(const Connection & connection_,
+			const JobTemplate& jobTemplate_, const string& submitKey_,
+			const EnvironmentEncoder *environment_ = NULL)
+					throw (ImplementationSpecificException) = 0;
+
+	/**
+	 * @brief Looks up the job submitted with an idempotency key
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] submitKey_ - client idempotency key
+	 * @param[in] jobName_ - job name of the template, narrows the query
+	 * @param[in] queuedAfter_ - earliest queue time of the job, narrows
+	 * 			the query, 0 for none. Finished jobs are always searched
+	 *
+	 * @throw ImplementationSpecificException - If the query fails
+	 *
+	 * @return Job id, empty if no job carries the key
+	 *
+	 */
+	virtual string findKeyedJob(const Connection & connection_,
+			const string& submitKey_, const string& jobName_,
+			const time_t queuedAfter_ = 0)
 					throw (ImplementationSpecificException) = 0;
 
 	/**
@@ -217,6 +311,81 @@ public:
 			throw (InvalidStateException, DeniedByDrmsException,
 			ImplementationSpecificException) = 0;
 
+	/**
+	 * @brief Applies one operation to a batch of jobs over a single
+	 * 			connection, a failing job does not stop the batch
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] operation_ - operation to apply
+	 * @param[in,out] results_ - batch of results, jobId set by the
+	 * 			caller, error and message set for each failing job
+	 * @param[in] count_ - number of results in the batch
+	 *
+	 * @return - None
+	 *
+	 */
+	virtual void control(const Connection & connection_,
+			const JobOperation operation_, JobOperationResult *results_,
+			const size_t count_) throw () = 0;
+
+	/**
+	 * @brief Changes attributes of a submitted Job
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] job_ - Job to alter
+	 * @param[in] alteration_ - attributes to change
+	 *
+	 * @throw InvalidArgumentException - alteration_ changes nothing
+	 * @throw InvalidStateException - State is invalid to perform operation
+	 * @throw DeniedByDrmsException - DRMS denied the alteration
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 *
+	 * @return - None
+	 *
+	 */
+	virtual void alter(const Connection & connection_, const Job& job_,
+			const JobAlteration& alteration_) throw (InvalidArgumentException,
+			InvalidStateException, DeniedByDrmsException,
+			ImplementationSpecificException) = 0;
+
+	/**
+	 * @brief Changes attributes of a batch of jobs over a single
+	 * 			connection, a failing job does not stop the batch
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] attributes_ - attribute list parsed once from the
+	 * 			JobAlteration, shared by concurrent batches
+	 * @param[in,out] results_ - batch of results, jobId set by the
+	 * 			caller, error and message set for each failing job
+	 * @param[in] count_ - number of results in the batch
+	 *
+	 * @return - None
+	 *
+	 */
+	virtual void alter(const Connection & connection_,
+			JobAlterationAttrHelper& attributes_, JobOperationResult *results_,
+			const size_t count_) throw () = 0;
+
+	/**
+	 * @brief Selects the ids of the jobs matching filter_ on the DRMS
+	 * 			without fetching any job attribute
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] filter_ - jobId, jobOwner, queueName and jobState are
+	 * 			used, every other field must keep its default
+	 *
+	 * @throw UnsupportedAttributeException - If filter_ can not be
+	 * 			evaluated by the DRMS
+	 * @throw ImplementationSpecificException - If the selection fails
+	 *
+	 * @return - NULL terminated array of job ids to be released with
+	 * 			free(), NULL if no job matches
+	 *
+	 */
+	virtual char **selectJobs(const Connection & connection_,
+			const JobInfo& filter_) = 0;
+
 	/**
 	 * @brief Job clean up in DRMS
 	 *
@@ -250,6 +419,114 @@ public:
 	virtual JobState state(const Connection & connection_,
 			const Job& job_) throw () = 0;
 
+	/**
+	 * @brief Gets the states of the given jobs of the calling user with
+	 * 			one projected query over all of the user's jobs, finished
+	 * 			ones included while the DRMS keeps them
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] jobIds_ - ids of jobs whose state is needed
+	 *
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 *
+	 * @return - map of requested job id to JobState, jobs not reported are
+	 * 			missing
+	 *
+	 */
+	virtual map<string, JobState> getUserJobStates(
+			const Connection & connection_, const list<string>& jobIds_)
+			throw (ImplementationSpecificException) = 0;
+
+	/**
+	 * @brief Takes a snapshot of all jobs of the calling user with one
+	 * 			projected query. Only the hash of the attributes other than
+	 * 			the state is kept, enough to tell that they changed
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[out] snapshot_ - receives job id to JobSnapshot
+	 *
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 *
+	 * @return - None
+	 *
+	 */
+	virtual void getUserJobSnapshots(const Connection & connection_,
+			map<string, JobSnapshot>& snapshot_)
+			throw (ImplementationSpecificException) = 0;
+
+	/**
+	 * @brief Gets the states of several jobs with as few DRMS round
+	 * 			trips as possible
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] jobIds_ - ids of jobs to query
+	 *
+	 * @throw DrmCommunicationException - Communication errors while
+	 * 									sending/receiving data from/to DRMS
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 *
+	 * @return - map of job id to JobState, unknown jobs are UNDETERMINED
+	 *
+	 */
+	virtual map<string, JobState> getJobStates(const Connection & connection_,
+			const list<string>& jobIds_)
+			throw (ImplementationSpecificException) = 0;
+
+	/**
+	 * @brief Gets the states and resources used of several jobs with one
+	 * 			projected query per batch of ids
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] jobIds_ - ids of jobs to query
+	 *
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 *
+	 * @return - map of job id to JobUsage, jobs the DRMS forgot are missing
+	 *
+	 */
+	virtual map<string, JobUsage> getJobUsage(const Connection & connection_,
+			const list<string>& jobIds_)
+			throw (ImplementationSpecificException) = 0;
+
+	/**
+	 * @brief Gets the JobInfo of the jobs of the calling user modified at
+	 * 			or after since_, with one selection on mtime
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] since_ - DRMS modification time of the last sync, 0 for
+	 * 			all jobs
+	 * @param[out] changed_ - receives the JobInfo of the modified jobs
+	 *
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 *
+	 * @return - latest modification time reported, since_ if none
+	 *
+	 */
+	virtual time_t getChangedJobs(const Connection & connection_,
+			const time_t since_, map<string, JobInfo>& changed_)
+			throw (ImplementationSpecificException) = 0;
+
+	/**
+	 * @brief Gets the ids of all jobs of the calling user the DRMS still
+	 * 			knows, finished ones in the history included
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[out] jobIds_ - receives the ids
+	 *
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 *
+	 * @return - None
+	 *
+	 */
+	virtual void getUserJobIds(const Connection & connection_,
+			set<string>& jobIds_) throw (ImplementationSpecificException) = 0;
+
 	/**
 	 * @brief get Job from DRMS
 	 *
@@ -273,6 +550,7 @@ public:
 	 *
 	 * @param[in] connection_ - connection object
 	 * @param[in] jobTemplate_ - JobTemplate
+	 * @param[in] environment_ - session base environment, NULL for none
 	 *
 	 * @throw DrmCommunicationException - Communication errors while
 	 * 									sending/receiving data from/to DRMS
@@ -286,7 +564,37 @@ public:
 	virtual JobArray* runJobArray(const Connection & connection_,
 			const JobTemplate& jobTemplate_, const long beginIndex_,
 			const long endIndex_, const long step_,
-			const long maxParallel_) throw () = 0;
+			const long maxParallel_,
+			const EnvironmentEncoder *environment_ = NULL)
+			throw (ImplementationSpecificException) = 0;
+
+	/**
+	 * @brief runs a parameter sweep as a minimal set of JobArrays
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] jobTemplate_ - JobTemplate shared by all points
+	 * @param[in] points_ - per point overrides
+	 * @param[in] environment_ - session base environment, NULL for none
+	 *
+	 * @throw DrmCommunicationException - Communication errors while
+	 * 									sending/receiving data from/to DRMS
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors, the jobs already
+	 * 											submitted are terminated
+	 * @throw InvalidArgumentException - A point sets an environment
+	 * 									variable whose name is not valid,
+	 * 									or the scriptBody does not run in
+	 * 									a POSIX shell
+	 * @warning application has to handle Job memory deallocation
+	 *
+	 * @return JobList - Job per point, in the order of points_
+	 *
+	 */
+	virtual JobList runJobSweep(const Connection & connection_,
+			const JobTemplate& jobTemplate_, const SweepTable& points_,
+			const EnvironmentEncoder *environment_ = NULL)
+			throw (ImplementationSpecificException,
+			InvalidArgumentException) = 0;
 
 	/**
 	 * @brief Triggers a transition from QUEUED to QUEUED_HELD, or from
@@ -428,7 +736,8 @@ public:
 	 *
 	 */
 	virtual Reservation* submit(const Connection & connection_,
-			const ReservationTemplate& reservationTemplate_) throw () = 0;
+			const ReservationTemplate& reservationTemplate_)
+			throw (ImplementationSpecificException) = 0;
 
 	/**
 	 * @brief deletes reservation from DRMS
@@ -445,7 +754,8 @@ public:
 	 *
 	 */
 	virtual void remove(const Connection & connection_,
-			const Reservation& reservation_) throw () = 0;
+			const Reservation& reservation_)
+			throw (ImplementationSpecificException) = 0;
 
 	/**
 	 * @brief Gets all reservation from DRMS
@@ -463,6 +773,24 @@ public:
 	virtual ReservationList getAllReservations(
 			const Connection & connection_) throw (ImplementationSpecificException) = 0;
 
+	/**
+	 * @brief Sorts pending reservations by their confirmation state using
+	 * one projected query per batch of their ids
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in,out] pending_ - ids still awaiting confirmation, ids which
+	 * 						got confirmed or vanished are removed
+	 * @param[out] confirmed_ - receives the ids confirmed by the DRMS
+	 *
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 *
+	 * @return - None
+	 */
+	virtual void checkReservations(const Connection & connection_,
+			set<string>& pending_, set<string>& confirmed_)
+			throw (ImplementationSpecificException) = 0;
+
 	/**
 	 * @brief Get reservation from DRMS
 	 *
@@ -507,6 +835,25 @@ public:
 	virtual JobList getJobs(const Connection & connection_,
 			const JobInfo& filter_) throw (ImplementationSpecificException) = 0;
 
+	/**
+	 * @brief Gets the Jobs among jobIds_ matching filter_, with one query
+	 * 			per batch of ids instead of a scan of every job of the DRMS
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] filter_ - JobInfo
+	 * @param[in] jobIds_ - ids of jobs to consider
+	 * @param[out] gone_ - receives the ids the DRMS no longer knows
+	 *
+	 * @throw ImplementationSpecificException - Any implementation specific
+	 * 											errors
+	 *
+	 * @return - JobList
+	 *
+	 */
+	virtual JobList getJobs(const Connection & connection_,
+			const JobInfo& filter_, const list<string>& jobIds_,
+			list<string>& gone_) throw (ImplementationSpecificException) = 0;
+
 	/**
 	 * @brief Gets all machine info from DRMS
 	 *
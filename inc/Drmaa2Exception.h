@@ -38,6 +38,7 @@
 #ifndef INC_DRMAA2EXCEPTION_H_
 #define INC_DRMAA2EXCEPTION_H_
 
+#include <drmaa2.hpp>
 #include <Message.h>
 #include <SourceInfo.h>
 #include <exception>
@@ -120,6 +121,15 @@ private:
 
 };
 
+/**
+ * @brief Maps the class of an exception onto its ErrorCode
+ *
+ * @param ex_ - exception raised by the library
+ *
+ * @return - ErrorCode, ERROR_IMPLEMENTATION_SPECIFIC for unknown classes
+ */
+ErrorCode toErrorCode(const Drmaa2Exception &ex_);
+
 } /* namespace drmaa2 */
 
 #endif /* INC_DRMAA2EXCEPTION_H_ */
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_ENVIRONMENTENCODER_H
+#define INC_ENVIRONMENTENCODER_H
+
+#include <map>
+#include <string>
+
+using namespace std;
+
+namespace drmaa2 {
+
+/**
+ *  @brief Encodes job environments into the PBS Variable_List format.
+ *  A base environment is encoded once, only the entries a job adds or
+ *  changes are encoded per submission.
+ */
+class EnvironmentEncoder {
+	map<string, string> _base;
+	string _encoded;
+public:
+	/**
+	 * @brief
+	 *      EnvironmentEncoder() - constructor with an empty base
+	 *
+	 */
+	EnvironmentEncoder() {
+	}
+	/**
+	 * @brief
+	 *      EnvironmentEncoder() - constructor, encodes base_ once
+	 *
+	 * @param[in]   base_ - environment shared by every job
+	 *
+	 */
+	EnvironmentEncoder(const map<string, string>& base_);
+	/**
+	 * @brief
+	 *      setBase() - replaces the base environment and re-encodes it
+	 *
+	 * @param[in]   base_ - environment shared by every job
+	 *
+	 * @return	void
+	 */
+	void setBase(const map<string, string>& base_);
+	/**
+	 * @brief
+	 *      getBase() - returns the base environment
+	 *
+	 * @return	base environment
+	 */
+	const map<string, string>& getBase() const {
+		return _base;
+	}
+	/**
+	 * @brief
+	 *      encode() - encodes the base merged with environment_, entries
+	 *      of environment_ win over the base.
+	 *
+	 * @param[in]   environment_ - job specific environment
+	 * @param[out]  out_ - receives the Variable_List value
+	 *
+	 * @return	void
+	 */
+	void encode(const map<string, string>& environment_, string& out_) const;
+	/**
+	 * @brief
+	 *      encodeAll() - encodes environment_ without any base
+	 *
+	 * @param[in]   environment_ - environment to encode
+	 * @param[out]  out_ - receives the Variable_List value
+	 *
+	 * @return	void
+	 */
+	static void encodeAll(const map<string, string>& environment_,
+			string& out_);
+	/**
+	 * @brief
+	 *      appendEntry() - appends name_=value_ to out_, escaping commas
+	 *      and backslashes of the value with a backslash
+	 *
+	 * @param[in,out] out_ - Variable_List value being built
+	 * @param[in]   name_ - variable name
+	 * @param[in]   value_ - variable value
+	 *
+	 * @return	void
+	 */
+	static void appendEntry(string& out_, const string& name_,
+			const string& value_);
+};
+}
+#endif
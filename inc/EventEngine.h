@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_EVENTENGINE_H
+#define INC_EVENTENGINE_H
+
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <drmaa2.hpp>
+#include <DRMSystem.h>
+#include <OutOfResourceException.h>
+
+using namespace std;
+
+#define EVENT_POLL_MS 1000 /*!< Interval of the job snapshots */
+#define EVENT_CALLBACK_THREADS 4 /*!< Threads delivering notifications */
+#define EVENT_QUEUE_DEPTH 1024 /*!< Notifications queued per thread */
+#define EVENT_MAX_SESSION_JOBS 65536 /*!< Session names kept, oldest go first */
+#define EVENT_ENGINE_START_FAILED "Failed to start event engine thread"
+
+namespace drmaa2 {
+
+/**
+ *  @brief Bounded queue of notifications for one delivery thread. A
+ *  notification still queued for the same job and event is superseded in
+ *  place instead of queued again, a full queue blocks the producer.
+ */
+class EventQueue {
+private:
+	pthread_mutex_t _mutex;
+	pthread_cond_t _notEmpty;
+	pthread_cond_t _notFull;
+	list<DrmaaNotification> _events;
+	map<pair<string, int>, list<DrmaaNotification>::iterator> _index;
+	const size_t _depth;
+	/**
+	 * @brief
+	 *      EventQueue() - copy constructor for EventQueue
+	 *
+	 */
+	EventQueue(EventQueue& queue_) : _depth(0) {
+	}
+public:
+	/**
+	 * @brief
+	 *      EventQueue() - constructor for EventQueue
+	 *
+	 * @param[in]   depth_ - notifications kept before push() blocks
+	 *
+	 */
+	EventQueue(const size_t depth_);
+	/**
+	 * @brief
+	 *      ~EventQueue() - destructor for EventQueue
+	 *
+	 */
+	~EventQueue();
+	/**
+	 * @brief
+	 *      push() - queues a notification or supersedes the queued one of
+	 *      the same job and event, blocks while the queue is full
+	 *
+	 * @param[in]   notification_ - notification to deliver
+	 *
+	 * @return	void
+	 */
+	void push(const DrmaaNotification& notification_);
+	/**
+	 * @brief
+	 *      pop() - takes the oldest notification, blocks while empty
+	 *
+	 * @return	DrmaaNotification
+	 */
+	DrmaaNotification pop();
+};
+
+/**
+ *  @brief Library wide source of DrmaaCallback notifications. While a
+ *  callback is registered one thread takes a projected snapshot of the jobs
+ *  of the user every EVENT_POLL_MS, diffs it against the previous one and
+ *  emits NEW_STATE and ATTRIBUTE_CHANGE. Notifications of a job always go
+ *  to the same delivery thread, so they arrive in order.
+ */
+class EventEngine {
+private:
+	static pthread_mutex_t _instMutex;
+	static EventEngine* _instance;
+	static pthread_mutex_t _sessionMutex;
+	static map<string, string> _sessions;
+	static list<string> _sessionOrder;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	pthread_cond_t _delivered;
+	DrmaaCallback *_callback;
+	list<pair<pthread_t, DrmaaCallback*> > _delivering; /*!< Running notify */
+	map<string, JobSnapshot> _snapshot;
+	bool _baseline;
+	vector<EventQueue*> _queues;
+	bool _started;
+	/**
+	 * @brief
+	 *      EventEngine() - constructor for EventEngine, starts the poller
+	 *      and the delivery threads
+	 *
+	 */
+	EventEngine();
+	/**
+	 * @brief
+	 *      EventEngine() - copy constructor for EventEngine
+	 *
+	 */
+	EventEngine(EventEngine& engine_) {
+	}
+	/**
+	 * @brief
+	 *      pollerMain() - thread entry, runs poll() forever
+	 *
+	 * @param[in]   arg_ - pointer to the owning EventEngine
+	 *
+	 * @return	NULL
+	 */
+	static void* pollerMain(void *arg_);
+	/**
+	 * @brief
+	 *      deliveryMain() - thread entry, hands the notifications of one
+	 *      queue to the registered callback forever
+	 *
+	 * @param[in]   arg_ - pointer to the EventQueue to serve
+	 *
+	 * @return	NULL
+	 */
+	static void* deliveryMain(void *arg_);
+	/**
+	 * @brief
+	 *      poll() - takes and diffs the snapshots while a callback is set
+	 *
+	 * @return	void
+	 */
+	void poll();
+	/**
+	 * @brief
+	 *      diff() - emits the changes from _snapshot to snapshot_
+	 *
+	 * @param[in]   snapshot_ - newer snapshot
+	 *
+	 * @return	void
+	 */
+	void diff(const map<string, JobSnapshot>& snapshot_);
+	/**
+	 * @brief
+	 *      emit() - queues a notification on the queue of the job
+	 *
+	 * @return	void
+	 */
+	void emit(const DrmaaEvent event_, const string& jobId_,
+			const JobState state_);
+	/**
+	 * @brief
+	 *      deliver() - passes a notification to the current callback
+	 *
+	 * @return	void
+	 */
+	void deliver(const DrmaaNotification& notification_);
+public:
+	/**
+	 * @brief
+	 *	getInstance() - returns singleton Instance of EventEngine
+	 *
+	 * @return    pointer to EventEngine object
+	 *
+	 */
+	static EventEngine* getInstance() {
+		pthread_mutex_lock(&_instMutex);
+		if (_instance == 0) {
+			_instance = new EventEngine;
+		}
+		pthread_mutex_unlock(&_instMutex);
+		return _instance;
+	}
+	/**
+	 * @brief
+	 *      setCallback() - replaces the callback, NULL stops the snapshots.
+	 *      Returns once no other thread runs notify of the previous
+	 *      callback, so the caller may free it then
+	 *
+	 * @param[in]   callback_ - callback, owned by the caller, NULL to
+	 *              unregister
+	 *
+	 * @throw OutOfResourceException - If the engine threads could not start
+	 *
+	 * @return	void
+	 */
+	void setCallback(DrmaaCallback *callback_) throw (OutOfResourceException);
+	/**
+	 * @brief
+	 *      recordSession() - remembers the session a job was submitted
+	 *      from for the sessionName of its notifications
+	 *
+	 * @param[in]   jobId_ - job id
+	 * @param[in]   sessionName_ - name of the JobSession
+	 *
+	 * @return	void
+	 */
+	static void recordSession(const string& jobId_,
+			const string& sessionName_);
+};
+}
+#endif
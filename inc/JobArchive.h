@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_JOBARCHIVE_H
+#define INC_JOBARCHIVE_H
+
+#include <pthread.h>
+#include <sys/types.h>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include <drmaa2.hpp>
+
+using namespace std;
+
+#define JOB_ARCHIVE_ENV "DRMAA2_JOB_ARCHIVE"
+#define ARCHIVE_SEGMENT_PREFIX "segment."
+#define ARCHIVE_SEGMENT_RECORDS 65536 /*!< Records per segment file */
+
+namespace drmaa2 {
+
+/**
+ *  @brief Location and indexed columns of one archived JobInfo.
+ */
+struct ArchiveEntry {
+	size_t owner; /*!< Index in the interned names */
+	size_t queue; /*!< Index in the interned names */
+	JobState state;
+	time_t finishTime;
+	size_t segment;
+	off_t offset;
+	size_t length;
+};
+
+/**
+ *  @brief Optional on-disk archive of the JobInfo of finished jobs, kept
+ *  in the directory named by DRMAA2_JOB_ARCHIVE. Records are appended as
+ *  escaped tab separated lines to segment files of ARCHIVE_SEGMENT_RECORDS
+ *  records each. The index, rebuilt by one scan on start, holds job id,
+ *  owner, queue, state and finish time of every record with its location,
+ *  so a query reads only the records it returns.
+ */
+class JobArchive {
+private:
+	static pthread_mutex_t _instMutex;
+	static JobArchive* _instance;
+	mutable pthread_mutex_t _mutex;
+	const string _directory;
+	vector<ArchiveEntry> _entries;
+	map<string, size_t> _byId;
+	vector<string> _names;
+	map<string, size_t> _nameIndex;
+	map<size_t, vector<size_t> > _byOwner;
+	map<size_t, vector<size_t> > _byQueue;
+	multimap<time_t, size_t> _byFinish;
+	vector<int> _segments;
+	size_t _segmentRecords;
+	/**
+	 * @brief
+	 *      JobArchive() - copy constructor for JobArchive
+	 *
+	 */
+	JobArchive(JobArchive& archive_) {
+	}
+	/**
+	 * @brief
+	 *      intern() - returns the index of a name, adding it if new
+	 *
+	 * @return	index in _names
+	 */
+	size_t intern(const string& name_);
+	/**
+	 * @brief
+	 *      index() - adds a record to the in memory index
+	 *
+	 * @param[in]   info_ - archived information
+	 * @param[in]   segment_ - segment holding the record
+	 * @param[in]   offset_ - offset of the record in the segment
+	 * @param[in]   length_ - length of the record including the newline
+	 *
+	 * @return	void
+	 */
+	void index(const JobInfo& info_, const size_t segment_,
+			const off_t offset_, const size_t length_);
+	/**
+	 * @brief
+	 *      load() - scans the segments and rebuilds the index
+	 *
+	 * @return	void
+	 */
+	void load();
+	/**
+	 * @brief
+	 *      openSegment() - opens or creates a segment file
+	 *
+	 * @param[in]   segment_ - number of the segment
+	 *
+	 * @return	file descriptor, -1 on failure
+	 */
+	int openSegment(const size_t segment_) const;
+	/**
+	 * @brief
+	 *      read() - reads an archived record back
+	 *
+	 * @param[in]   entry_ - indexed location
+	 * @param[out]  info_ - receives the record
+	 *
+	 * @return	true on success
+	 */
+	bool read(const ArchiveEntry& entry_, JobInfo& info_) const;
+public:
+	/**
+	 * @brief
+	 *      JobArchive() - constructor for JobArchive, loads the segments
+	 *
+	 * @param[in]   directory_ - archive directory, empty disables it
+	 *
+	 */
+	JobArchive(const string& directory_);
+	/**
+	 * @brief
+	 *      ~JobArchive() - destructor for JobArchive
+	 *
+	 */
+	~JobArchive();
+	/**
+	 * @brief
+	 *	getInstance() - returns singleton Instance of JobArchive kept in
+	 *	DRMAA2_JOB_ARCHIVE, disabled if the variable is not set
+	 *
+	 * @return    pointer to JobArchive object
+	 *
+	 */
+	static JobArchive* getInstance();
+	/**
+	 * @brief
+	 *      isEnabled() - tells whether the archive is in use
+	 *
+	 * @return	true if the directory could be opened
+	 */
+	bool isEnabled() const;
+	/**
+	 * @brief
+	 *      isArchived() - tells whether a job is archived
+	 *
+	 * @return	true if archived
+	 */
+	bool isArchived(const string& jobId_) const;
+	/**
+	 * @brief
+	 *      add() - archives the information of a finished job, nothing if
+	 *      the job is not DONE or FAILED or already archived
+	 *
+	 * @param[in]   info_ - information of the job
+	 *
+	 * @return	void
+	 */
+	void add(const JobInfo& info_);
+	/**
+	 * @brief
+	 *      lookup() - reads the archived record of a job
+	 *
+	 * @param[in]   jobId_ - job id
+	 * @param[out]  info_ - receives the record
+	 *
+	 * @return	false if jobId_ is not archived
+	 */
+	bool lookup(const string& jobId_, JobInfo& info_) const;
+	/**
+	 * @brief
+	 *      find() - returns the archived jobs matching a filter. jobId,
+	 *      jobOwner, queueName and finishTime, an upper bound, come from
+	 *      the index, annotation is checked on the records
+	 *
+	 * @param[in]   filter_ - jobState must be DONE or FAILED
+	 * @param[in]   finishedAfter_ - lower bound of the finish time, 0 for
+	 *              none
+	 *
+	 * @return	matching records in finish time order
+	 */
+	JobInfoList find(const JobInfo& filter_,
+			const time_t finishedAfter_ = 0) const;
+	/**
+	 * @brief
+	 *      matchesFinished() - tells whether a filter only matches
+	 *      finished jobs, so the archive and one query over the finished
+	 *      jobs of the server can answer it
+	 *
+	 * @return	true for a DONE or FAILED filter
+	 */
+	static bool matchesFinished(const JobInfo& filter_);
+};
+}
+#endif
@@ -38,7 +38,10 @@
 #ifndef INC_JOBARRAYIMPL_H_
 #define INC_JOBARRAYIMPL_H_
 
+#include <list>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "drmaa2.hpp"
 
@@ -54,6 +57,8 @@ class JobArrayImpl : public JobArray {
 	const string _jobId;
 	JobTemplate _jt;
 	JobList _jobList;
+	list<string> _windows;
+	list<long> _windowStarts;
 	/**
 	 * Constructor
 	 */
@@ -78,6 +83,21 @@ public:
 	 */
 	virtual ~JobArrayImpl(void);
 
+	/**
+	 * @brief Adds a chained array submitted for the same bulk request,
+	 * 			control operations apply to every window
+	 *
+	 * @param[in] jobArrayId_ - id of the chained array
+	 * @param[in] firstIndex_ - lowest index of the chained array, windows
+	 * 			are added in ascending index order
+	 */
+	void addWindow(const string& jobArrayId_, const long firstIndex_);
+
+	/**
+	 * @brief Returns the ids of the chained arrays, in submission order
+	 */
+	const list<string>& getWindows(void) const;
+
 	/**
 	 * @brief Returns Job array ID
 	 *
@@ -160,6 +180,36 @@ public:
 	 */
 	virtual void terminate(void) const;
 
+	/**
+	 * @brief Applies operation_ to the sub jobs of indices_, each window
+	 * 			gets the compressed ranges of its own indices
+	 *
+	 * @param[in] indices_ - Array indices to act on
+	 * @param[in] operation_ - SUSPEND_JOB, RESUME_JOB or TERMINATE_JOB
+	 *
+	 * @throw UnsupportedOperationException - For HOLD_JOB and RELEASE_JOB,
+	 * 			PBS only holds and releases whole arrays
+	 *
+	 * @return One result per range, jobId holds the range
+	 */
+	virtual vector<JobOperationResult> controlIndices(
+			const set<long>& indices_, const JobOperation operation_) const;
+
+	/**
+	 * @brief Compresses sorted indices into the fewest PBS sub job range
+	 * 			expressions the greedy scan finds. Runs of three or more
+	 * 			indices with a constant step become "first-last:step",
+	 * 			consecutive indices "first-last"
+	 *
+	 * @param[in] first_ - first index
+	 * @param[in] last_ - one past the last index
+	 * @param[out] ranges_ - receives the range expressions
+	 *
+	 * @return - None
+	 */
+	static void compressIndices(set<long>::const_iterator first_,
+			set<long>::const_iterator last_, list<string>& ranges_);
+
 	/**
 	 * @brief Clean up any data about this JobArray
 	 *
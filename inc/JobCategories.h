@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_JOBCATEGORIES_H
+#define INC_JOBCATEGORIES_H
+
+#include <pthread.h>
+#include <istream>
+#include <list>
+#include <map>
+#include <string>
+#include <drmaa2.hpp>
+#include <PBSIFLExtend.h>
+
+using namespace std;
+
+#define JOB_CATEGORIES_ENV "DRMAA2_JOB_CATEGORIES"
+#define JOB_CATEGORIES_FILE "/etc/pbs_drmaa2_categories.conf"
+#define JOB_CATEGORY_QUEUE "queue"
+
+namespace drmaa2 {
+
+/**
+ *  @brief PBS attributes and resources of one job category, kept as a
+ *  ready attribute chain which is merged into a job without parsing
+ */
+class JobCategory {
+	string _queue;
+	list<string> _text;
+	list<ATTRL> _nodes;
+	/**
+	 * @brief
+	 *      JobCategory() - copy constructor, not available as the chain
+	 *      points into _text
+	 *
+	 */
+	JobCategory(const JobCategory& category_);
+public:
+	/**
+	 * @brief
+	 *      JobCategory() - constructor of an empty category
+	 *
+	 */
+	JobCategory() {
+	}
+	/**
+	 * @brief
+	 *      add() - sets an attribute, a later value replaces an earlier one
+	 *
+	 * @param[in]   name_ - PBS attribute name
+	 * @param[in]   resource_ - resource name, empty for plain attributes
+	 * @param[in]   value_ - attribute value
+	 *
+	 * @return	void
+	 */
+	void add(const string& name_, const string& resource_,
+			const string& value_);
+	/**
+	 * @brief
+	 *      setQueue() - sets the destination used when the template
+	 *      names no queue
+	 *
+	 * @param[in]   queue_ - destination queue
+	 *
+	 * @return	void
+	 */
+	void setQueue(const string& queue_) {
+		_queue.assign(queue_);
+	}
+	/**
+	 * @brief
+	 *      getQueue() - returns the destination queue, empty for none
+	 *
+	 * @return	queue name
+	 */
+	const string& getQueue() const {
+		return _queue;
+	}
+	/**
+	 * @brief
+	 *      getAttributes() - returns the head of the attribute chain
+	 *
+	 * @return	chain, NULL if the category sets no attribute
+	 */
+	const ATTRL* getAttributes() const {
+		return _nodes.empty() ? NULL : &_nodes.front();
+	}
+};
+
+/**
+ *  @brief Job categories read from a local configuration file. Each
+ *  "[name]" section lists "attribute = value" or
+ *  "attribute.resource = value" lines, plus "queue = name" for the
+ *  destination. Lines starting with '#' and lines which are neither
+ *  are ignored.
+ */
+class JobCategories {
+	static pthread_mutex_t _instMutex;
+	static JobCategories* _instance;
+	map<string, JobCategory*> _categories;
+	/**
+	 * @brief
+	 *      JobCategories() - copy constructor, not available
+	 *
+	 */
+	JobCategories(const JobCategories& categories_);
+	/**
+	 * @brief
+	 *      parse() - compiles the categories of a configuration stream
+	 *
+	 * @param[in]   in_ - configuration
+	 *
+	 * @return	void
+	 */
+	void parse(istream& in_);
+public:
+	/**
+	 * @brief
+	 *      JobCategories() - loads the categories of path_, a missing
+	 *      file gives no categories
+	 *
+	 * @param[in]   path_ - configuration file
+	 *
+	 */
+	JobCategories(const string& path_);
+	/**
+	 * @brief
+	 *      ~JobCategories() - destructor for JobCategories
+	 *
+	 */
+	~JobCategories();
+	/**
+	 * @brief
+	 *	getInstance() - returns the process wide categories, loaded on
+	 *	first use from $DRMAA2_JOB_CATEGORIES or JOB_CATEGORIES_FILE
+	 *
+	 * @return    pointer to JobCategories object
+	 *
+	 */
+	static JobCategories* getInstance();
+	/**
+	 * @brief
+	 *      getNames() - returns the names of all categories
+	 *
+	 * @return	category names
+	 */
+	StringList getNames() const;
+	/**
+	 * @brief
+	 *      find() - looks a category up
+	 *
+	 * @param[in]   name_ - category name
+	 *
+	 * @return	category, NULL if unknown
+	 */
+	const JobCategory* find(const string& name_) const;
+};
+}
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_JOBGRAPHIMPL_H_
+#define INC_JOBGRAPHIMPL_H_
+
+#include <map>
+#include <string>
+
+#include "drmaa2.hpp"
+
+using namespace std;
+
+namespace drmaa2 {
+/**
+ * @class JobGraphImpl
+ * @brief Implementation of JobGraph, owns the Job objects of the graph
+ *
+ */
+class JobGraphImpl : public JobGraph {
+	JobList _jobList;
+	/**
+	 * @brief Default constructor
+	 */
+	JobGraphImpl() {};
+	/**
+	 * @brief Copy constructor
+	 */
+	JobGraphImpl(const JobGraphImpl &jobGraphImpl_) {};
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param[in] jobList_ - Jobs of the graph in node order
+	 */
+	JobGraphImpl(const JobList& jobList_):_jobList(jobList_) {
+	}
+	/**
+	 * @brief Destructor, deletes the Job objects of the graph
+	 */
+	virtual ~JobGraphImpl(void);
+
+	/**
+	 * @brief overridden method from JobGraph
+	 */
+	virtual const JobList& getJobs(void) const;
+
+	/**
+	 * @brief overridden method from JobGraph
+	 */
+	virtual map<JobState, long> getStateSummary(void) const;
+
+	/**
+	 * @brief overridden method from JobGraph
+	 */
+	virtual JobState getState(void) const;
+
+	/**
+	 * @brief overridden method from JobGraph
+	 */
+	virtual void terminate(void) const;
+};
+
+} /* namespace drmaa2 */
+
+#endif /* INC_JOBGRAPHIMPL_H_ */
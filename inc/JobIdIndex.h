@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_JOBIDINDEX_H
+#define INC_JOBIDINDEX_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define JOBID_SEQUENCE_BITS 39 /*!< Bits of the sequence number in a key */
+
+namespace drmaa2 {
+
+/**
+ *  @brief Compact set of PBS job ids. An id <sequence>.<server> is kept
+ *  as one 64 bit key made of the interned server, the sequence number and
+ *  a flag for job arrays, so a session of many jobs costs eight bytes per
+ *  job. Subjob ids are kept as their array. Ids of any other form are
+ *  kept as strings.
+ */
+class JobIdIndex {
+private:
+	vector<string> _servers;
+	map<string, size_t> _serverIndex;
+	mutable vector<unsigned long long> _keys;
+	mutable bool _sorted;
+	list<string> _others;
+	/**
+	 * @brief
+	 *      toKey() - encodes a job id
+	 *
+	 * @param[in]   jobId_ - job id
+	 * @param[out]  key_ - receives the key
+	 * @param[in]   intern_ - add an unknown server instead of failing
+	 *
+	 * @return	false if jobId_ has no key
+	 */
+	bool toKey(const string& jobId_, unsigned long long& key_,
+			const bool intern_);
+	/**
+	 * @brief
+	 *      sort() - sorts the keys and drops duplicates once needed
+	 *
+	 * @return	void
+	 */
+	void sort() const;
+public:
+	/**
+	 * @brief
+	 *      JobIdIndex() - constructor for JobIdIndex
+	 *
+	 */
+	JobIdIndex() : _sorted(true) {
+	}
+	/**
+	 * @brief
+	 *      add() - adds a job id
+	 *
+	 * @param[in]   jobId_ - id of a job, job array or subjob
+	 *
+	 * @return	void
+	 */
+	void add(const string& jobId_);
+	/**
+	 * @brief
+	 *      remove() - removes job ids
+	 *
+	 * @param[in]   jobIds_ - ids to remove, unknown ones are ignored
+	 *
+	 * @return	void
+	 */
+	void remove(const list<string>& jobIds_);
+	/**
+	 * @brief
+	 *      ids() - returns the job ids
+	 *
+	 * @return	ids ordered by server and sequence number
+	 */
+	list<string> ids() const;
+	/**
+	 * @brief
+	 *      size() - returns the number of job ids
+	 *
+	 * @return	number of ids
+	 */
+	size_t size() const;
+};
+}
+#endif
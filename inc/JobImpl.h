@@ -55,31 +55,41 @@ private:
 	JobTemplate _jt;
 	mutable JobState _jobState;
 	mutable JobInfo _jobInfo;
+	bool _archived; /*!< _jobInfo comes from the JobArchive and is final */
 	/**
 	 * Constructor
 	 */
-	JobImpl() {
+	JobImpl() : _archived(false) {
 		_jobState = UNDETERMINED;
 	};
 	/**
 	 * Copy constructor
 	 */
-	JobImpl(const JobImpl &jobImpl_) {
+	JobImpl(const JobImpl &jobImpl_) : _archived(false) {
 		_jobState = UNDETERMINED;
 	};
 public:
 	/**
 	 * Parameterized constructor
 	 */
-	JobImpl(const string& jobId_):_jobId(jobId_) {
+	JobImpl(const string& jobId_):_jobId(jobId_), _archived(false) {
 		_jobState = UNDETERMINED;
 	}
 	/**
 	 * Parameterized constructor
 	 */
-	JobImpl(const string& jobId_, const JobTemplate& jt_):_jobId(jobId_), _jt(jt_) {
+	JobImpl(const string& jobId_, const JobTemplate& jt_):_jobId(jobId_), _jt(jt_),
+			_archived(false) {
 		_jobState = UNDETERMINED;
 	};
+	/**
+	 * Constructor for a finished job read back from the JobArchive, its
+	 * JobInfo is not queried from the server again
+	 */
+	JobImpl(const string& jobId_, const JobInfo& jobInfo_):_jobId(jobId_),
+			_jobInfo(jobInfo_), _archived(true) {
+		_jobState = jobInfo_.jobState;
+	};
 	/**
 	 * Destructor
 	 */
@@ -185,6 +195,19 @@ public:
 	 */
 	virtual void terminate(void) const throw();
 
+	/**
+	 * @brief Changes attributes of a submitted Job
+	 *
+	 * @param[in] alteration_ - attributes to change
+	 *
+	 * @throw InvalidArgumentException - If alteration_ changes nothing
+	 * @throw InvalidStateException - If the Job can not be altered anymore
+	 * @throw ImplementationSpecificException - If the DRMS rejects it
+	 *
+	 * @return None
+	 */
+	virtual void alter(const JobAlteration& alteration_) const;
+
 	/**
 	 * @brief Clean up any data about this job
 	 *
@@ -201,24 +224,62 @@ public:
 	/**
 	 * @brief Blocking call to wait until job starts
 	 *
-	 * @param[in] timeout_ - Indicates call blocking duration
+	 * @param[in] timeout_ - Seconds to wait, negative waits forever
 	 *
 	 * @throw TimeoutException - Fails to start in a given duration
 	 *
 	 * @return None
 	 */
-	virtual void waitStarted(const TimeAmount& timeout_) throw();
+	virtual void waitStarted(const TimeAmount& timeout_);
 
 	/**
 	 * @brief Blocking call to wait until job ends
 	 *
-	 * @param[in] timeout_ - Indicates call blocking duration
+	 * @param[in] timeout_ - Seconds to wait, negative waits forever
 	 *
 	 * @throw TimeoutException - Fails to terminate in a given duration
 	 *
 	 * @return None
 	 */
-	virtual void waitTerminated(TimeAmount& timeout_) throw();
+	virtual void waitTerminated(TimeAmount& timeout_);
+
+	/**
+	 * @brief Returns the bytes written to an output stream since cursor_
+	 *
+	 * @param[in] stream_ - OUTPUT_STREAM or ERROR_STREAM
+	 * @param[in,out] cursor_ - position reached by the previous call
+	 * @param[in] maxBytes_ - most bytes to return
+	 * @param[in] timeout_ - seconds to wait for new bytes, negative waits
+	 * 						until bytes arrive
+	 *
+	 * @throw InvalidArgumentException - If the JobTemplate names no file
+	 * 									for the stream
+	 *
+	 * @return new bytes, empty if none arrived in time
+	 */
+	virtual string readOutput(const OutputStream stream_,
+			OutputCursor& cursor_, const size_t maxBytes_,
+			const TimeAmount timeout_) const;
+
+	/**
+	 * @brief Starts sampling the resources used by the Job
+	 *
+	 * @param - None
+	 *
+	 * @throw OutOfResourceException - If the sampler could not start
+	 *
+	 * @return None
+	 */
+	virtual void trackUsage(void) const;
+
+	/**
+	 * @brief Returns the usage samples kept for the Job, oldest first
+	 *
+	 * @param - None
+	 *
+	 * @return samples, empty if the Job is not tracked
+	 */
+	virtual UsageSampleList getUsage(void) const;
 };
 
 } /* namespace drmaa2 */
@@ -38,20 +38,52 @@
 #ifndef INC_JOBSESSIONIMPL_H_
 #define INC_JOBSESSIONIMPL_H_
 
+#include <pthread.h>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <drmaa2.hpp>
 #include <ConnectionPool.h>
+#include <EnvironmentEncoder.h>
+#include <JobIdIndex.h>
+#include <SubmissionJournal.h>
 #include <PBSIFLExtend.h>
 
 using namespace std;
 
+#define CONTROL_BATCH_SIZE 500
+
 namespace drmaa2 {
 
+/**
+ * @brief Applies operation_ to the jobs of results_ in batches of at most
+ * 			CONTROL_BATCH_SIZE, each batch on one pooled connection of the
+ * 			WorkerPool
+ *
+ * @param[in] operation_ - operation to apply
+ * @param[in,out] results_ - jobId set by the caller, error and message
+ * 			set for each failing job
+ *
+ * @return - None
+ */
+void controlJobIds(const JobOperation operation_,
+		vector<JobOperationResult>& results_);
+
 class JobSessionImpl : public JobSession {
-	list<string> _sessionJobs;
+	mutable JobIdIndex _sessionJobs; /*!< Ids of the jobs submitted here */
+	mutable pthread_mutex_t _sessionMutex;
 	JobList _jobList;
+	EnvironmentEncoder _baseEnvironment;
+	SubmissionJournal *_journal;
+	/**
+	 * @brief Records a job submitted through this session
+	 *
+	 * @param[in] jobId_ - id of the job or job array
+	 *
+	 * @return - None
+	 */
+	void recordJob(const string& jobId_) const;
 public:
 	/**
 	 * @brief Parameterized Constructor
@@ -63,8 +95,20 @@ public:
 	 */
 	JobSessionImpl(const string& sessionName_,
 			const StringList& jobCategories_, const string& contact_ = string(pbs_default())) :
-				JobSession(sessionName_, jobCategories_, contact_) {
+				JobSession(sessionName_, jobCategories_, contact_), _journal(NULL) {
+		pthread_mutex_init(&_sessionMutex, NULL);
+	}
 
+	/**
+	 * @brief Copy constructor, the journal stays with obj_
+	 *
+	 * @param obj_ - JobSessionImpl to be copied
+	 *
+	 */
+	JobSessionImpl(const JobSessionImpl& obj_) : JobSession(obj_),
+			_sessionJobs(obj_._sessionJobs), _jobList(obj_._jobList),
+			_baseEnvironment(obj_._baseEnvironment), _journal(NULL) {
+		pthread_mutex_init(&_sessionMutex, NULL);
 	}
 
 	JobSessionImpl& operator=(const JobSessionImpl& obj_) {
@@ -74,10 +118,13 @@ public:
 	 * Destructor
 	 */
 	virtual ~JobSessionImpl(void) {
+		closeJournal();
+		pthread_mutex_destroy(&_sessionMutex);
 	}
 
 	/**
-	 * @brief Returns associated jobs
+	 * @brief Returns the jobs submitted through this session, only their
+	 * 			ids are queried from the DRMS
 	 *
 	 * @param[in] filter_ - Filter criteria
 	 *
@@ -85,6 +132,24 @@ public:
 	 */
 	virtual const JobList& getJobs(const JobInfo& filter_);
 
+	/**
+	 * @brief Sets the base environment, encoded once for all submissions
+	 *
+	 * @param[in] environment_ - Base environment, empty to clear
+	 *
+	 * @return - None
+	 */
+	virtual void setBaseEnvironment(const map<string, string>& environment_);
+
+	/**
+	 * @brief Returns the base environment of the session
+	 *
+	 * @param - None
+	 *
+	 * @return Base environment
+	 */
+	virtual const map<string, string>& getBaseEnvironment(void) const;
+
 	/**
 	 * @brief Returns JobArray
 	 *
@@ -107,6 +172,19 @@ public:
 	 */
 	virtual Job& runJob(const JobTemplate& jobTemplate_) const;
 
+	/**
+	 * @brief Submit Job to DRMS tagged with a client idempotency key
+	 *
+	 * @param[in] jobTemplate_ - Detailed job information
+	 * @param[in] submitKey_ - Caller chosen idempotency key
+	 *
+	 * @throw InvalidArgumentException - If submitKey_ is not a valid key
+	 *
+	 * @return valid job id returned from the DRMS
+	 */
+	virtual Job& runJob(const JobTemplate& jobTemplate_,
+			const string& submitKey_) const;
+
 	/**
 	 * @brief Submit JobArray to DRMS
 	 *
@@ -124,6 +202,141 @@ public:
 			const long beginIndex_, const long endIndex_, const long step_,
 			const long maxParallel_) const;
 
+	/**
+	 * @brief Submit parameter sweep to DRMS
+	 *
+	 * @param[in] jobTemplate_ - Base job information
+	 * @param[in] points_ - Per point overrides of jobTemplate_
+	 *
+	 * @throw ImplementationSpecificException - If DRMS rejects a submission
+	 *
+	 * @return JobList - One Job per point, in the order of points_
+	 */
+	virtual JobList runJobSweep(const JobTemplate& jobTemplate_,
+			const SweepTable& points_) const;
+
+	/**
+	 * @brief Submit dependency graph to DRMS. Root nodes are held until
+	 * 			the whole graph is known to the DRMS and then released
+	 *
+	 * @param[in] graph_ - Nodes of the graph
+	 *
+	 * @throw InvalidArgumentException - If the graph has a cycle or an
+	 * 			unknown node index
+	 * @throw ImplementationSpecificException - If DRMS rejects a submission
+	 *
+	 * @return JobGraph
+	 */
+	virtual JobGraph& runJobGraph(const JobGraphTemplate& graph_) const;
+
+	/**
+	 * @brief Opens the write-ahead submission journal at path_
+	 *
+	 * @param[in] path_ - Journal file, created if missing
+	 *
+	 * @throw InvalidStateException - If a journal is already open
+	 * @throw ImplementationSpecificException - If the file can not be used
+	 *
+	 * @return - None
+	 */
+	virtual void openJournal(const string& path_);
+
+	/**
+	 * @brief Stops the journal drainer and closes the journal
+	 *
+	 * @param - None
+	 *
+	 * @return - None
+	 */
+	virtual void closeJournal(void);
+
+	/**
+	 * @brief Durably records a submission for the journal drainer
+	 *
+	 * @param[in] jobTemplate_ - Detailed job information
+	 * @param[in] requestKey_ - Idempotency key, generated if empty
+	 *
+	 * @throw InvalidStateException - If no journal is open
+	 * @throw InvalidArgumentException - If requestKey_ holds white space,
+	 * 			',' or a backslash
+	 * @throw ImplementationSpecificException - If the journal write fails
+	 *
+	 * @return Request key
+	 */
+	virtual string enqueueJob(const JobTemplate& jobTemplate_,
+			const string& requestKey_ = string());
+
+	/**
+	 * @brief Returns the job id the journal drainer got for requestKey_
+	 *
+	 * @param[in] requestKey_ - Key returned by enqueueJob
+	 *
+	 * @throw InvalidStateException - If no journal is open
+	 * @throw InvalidArgumentException - If the key is unknown
+	 * @throw ImplementationSpecificException - If the submission failed
+	 *
+	 * @return Job id, empty while the request is pending
+	 */
+	virtual string getEnqueuedJobId(const string& requestKey_);
+
+	/**
+	 * @brief Applies operation_ to every job of jobs_. Jobs are split into
+	 * 			batches of at most CONTROL_BATCH_SIZE, each batch runs on
+	 * 			one pooled connection of the WorkerPool
+	 *
+	 * @param[in] jobs_ - List of Jobs
+	 * @param[in] operation_ - Operation to apply
+	 *
+	 * @throw InvalidArgumentException - If jobs_ holds a NULL job
+	 *
+	 * @return One result per job, in the order of jobs_
+	 */
+	virtual vector<JobOperationResult> controlJobs(const JobList& jobs_,
+			const JobOperation operation_) const;
+
+	/**
+	 * @brief Applies alteration_ to every job of jobs_, batched and run in
+	 * 			parallel like controlJobs
+	 *
+	 * @param[in] jobs_ - List of Jobs
+	 * @param[in] alteration_ - attributes to change
+	 *
+	 * @throw InvalidArgumentException - If alteration_ changes nothing or
+	 * 			jobs_ holds NULL
+	 *
+	 * @return One result per job, in the order of jobs_
+	 */
+	virtual vector<JobOperationResult> alterJobs(const JobList& jobs_,
+			const JobAlteration& alteration_) const;
+
+	/**
+	 * @brief Applies operation_ to every job whose id the DRMS selects for
+	 * 			filter_. The ids are fed to the batches of controlJobs
+	 * 			without creating Job objects
+	 *
+	 * @param[in] filter_ - Only jobId, jobOwner, queueName and jobState
+	 * 			may be set
+	 * @param[in] operation_ - Operation to apply
+	 * @param[in] callback_ - Receives failures and progress, may be NULL
+	 *
+	 * @throw UnsupportedAttributeException - If filter_ sets other fields
+	 * @throw ImplementationSpecificException - If the selection fails
+	 *
+	 * @return Number of jobs the operation failed for
+	 */
+	virtual long controlJobs(const JobInfo& filter_,
+			const JobOperation operation_,
+			JobOperationCallback *callback_ = NULL) const;
+
+	/**
+	 * @brief Creates an empty wait set
+	 *
+	 * @param[in] terminated_ - Wait for termination instead of start
+	 *
+	 * @return JobWaitSet, deleted by the caller
+	 */
+	virtual JobWaitSet& createWaitSet(const bool terminated_) const;
+
 	/**
 	 * @brief In a list of specified job ids waits until
 	 * 			any of the job is started
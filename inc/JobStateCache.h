@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_JOBSTATECACHE_H
+#define INC_JOBSTATECACHE_H
+
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <drmaa2.hpp>
+
+using namespace std;
+
+#define JOB_CACHE_INTERVAL_ENV "DRMAA2_JOB_CACHE_INTERVAL"
+#define JOB_CACHE_MAX_JOBS 65536 /*!< Jobs kept, the oldest cached go first */
+#define JOB_CACHE_SWEEP_SYNCS 10 /*!< Syncs between two sweeps of the ids */
+
+namespace drmaa2 {
+
+/**
+ *  @brief Opt-in cache of the JobInfo of the jobs of the calling user,
+ *  enabled by the refresh interval in seconds in DRMAA2_JOB_CACHE_INTERVAL.
+ *  One thread selects the jobs modified since the last sync on mtime and
+ *  patches their records, so a refresh costs the changed jobs only. Jobs
+ *  leaving the server never show up in such a delta, every
+ *  JOB_CACHE_SWEEP_SYNCS syncs the ids the server still knows are listed
+ *  and the other records dropped. The queries run without the lock,
+ *  readers wait at most for the patch.
+ */
+class JobStateCache {
+private:
+	static pthread_mutex_t _instMutex;
+	static JobStateCache* _instance;
+	mutable pthread_mutex_t _mutex;
+	const unsigned int _interval;
+	bool _started;
+	time_t _synced; /*!< Latest mtime seen, 0 before the first sync */
+	map<string, JobInfo> _jobs;
+	list<string> _order;
+	/**
+	 * @brief
+	 *      JobStateCache() - copy constructor for JobStateCache
+	 *
+	 */
+	JobStateCache(JobStateCache& cache_) : _interval(0) {
+	}
+	/**
+	 * @brief
+	 *      refresherMain() - thread entry, runs run() forever
+	 *
+	 * @param[in]   arg_ - pointer to the owning JobStateCache
+	 *
+	 * @return	NULL
+	 */
+	static void* refresherMain(void *arg_);
+	/**
+	 * @brief
+	 *      run() - syncs the cache every interval
+	 *
+	 * @return	void
+	 */
+	void run();
+public:
+	/**
+	 * @brief
+	 *      JobStateCache() - constructor for JobStateCache, the process
+	 *      wide cache is the one of getInstance()
+	 *
+	 * @param[in]   interval_ - seconds between syncs, 0 disables syncing
+	 *
+	 */
+	explicit JobStateCache(const unsigned int interval_);
+	/**
+	 * @brief
+	 *      ~JobStateCache() - destructor, only for a cache which never
+	 *      started syncing
+	 *
+	 */
+	~JobStateCache();
+	/**
+	 * @brief
+	 *	getInstance() - returns singleton Instance of JobStateCache
+	 *
+	 * @return    pointer to JobStateCache object
+	 *
+	 */
+	static JobStateCache* getInstance() {
+		pthread_mutex_lock(&_instMutex);
+		if (_instance == 0) {
+			_instance = new JobStateCache(refreshInterval());
+		}
+		pthread_mutex_unlock(&_instMutex);
+		return _instance;
+	}
+	/**
+	 * @brief
+	 *      refreshInterval() - returns the interval set in
+	 *      DRMAA2_JOB_CACHE_INTERVAL
+	 *
+	 * @return	seconds, 0 if unset or invalid
+	 */
+	static unsigned int refreshInterval();
+	/**
+	 * @brief
+	 *      isEnabled() - tells whether DRMAA2_JOB_CACHE_INTERVAL is set
+	 *
+	 * @return	true if enabled
+	 */
+	bool isEnabled() const {
+		return _interval > 0;
+	}
+	/**
+	 * @brief
+	 *      lookup() - copies the cached JobInfo of a job, starting the
+	 *      refresher on first use if enabled
+	 *
+	 * @param[in]   jobId_ - job id
+	 * @param[out]  info_ - receives the record
+	 *
+	 * @return	false if the job is not cached
+	 */
+	bool lookup(const string& jobId_, JobInfo& info_);
+	/**
+	 * @brief
+	 *      update() - patches the records of changed jobs
+	 *
+	 * @param[in]   changed_ - JobInfo of the jobs modified since the last
+	 *              sync
+	 * @param[in]   synced_ - latest modification time of changed_
+	 * @param[in]   known_ - ids the server knew before changed_ was
+	 *              queried, the records of other jobs not in changed_ are
+	 *              dropped. NULL keeps all records
+	 *
+	 * @return	void
+	 */
+	void update(const map<string, JobInfo>& changed_, const time_t synced_,
+			const set<string> *known_ = NULL);
+	/**
+	 * @brief
+	 *      getSynced() - returns the modification time of the last sync
+	 *
+	 * @return	mtime, 0 before the first sync
+	 */
+	time_t getSynced() const;
+};
+}
+#endif
@@ -39,6 +39,8 @@
 #define INC_JOBTEMPLATEATTRHELPER_H
 
 #include <AttrHelper.h>
+#include <EnvironmentEncoder.h>
+#include <JobCategories.h>
 #include <string>
 using namespace std;
 namespace drmaa2 {
@@ -59,17 +61,37 @@ public:
 	string _startTime;
 	string _priority;
 	string _envList;
+	string _categoryQueue;
+	const EnvironmentEncoder *_baseEnvironment;
+	const JobCategories *_categories;
 	/**
 	 * @brief default constructor
 	 *
 	 */
-	JobTemplateAttrHelper() {
+	JobTemplateAttrHelper() : _baseEnvironment(NULL), _categories(NULL) {
 	}
 	/**
 	 * @brief parameterised constructor
 	 *
 	 */
-	JobTemplateAttrHelper(ATTRL* attrList_) : AttrHelper(attrList_) {
+	JobTemplateAttrHelper(ATTRL* attrList_) : AttrHelper(attrList_),
+			_baseEnvironment(NULL), _categories(NULL) {
+	}
+
+	/**
+	 * @brief sets the session base environment merged into every
+	 * 			parsed template, NULL for none
+	 */
+	void setBaseEnvironment(const EnvironmentEncoder *baseEnvironment_) {
+		_baseEnvironment = baseEnvironment_;
+	}
+
+	/**
+	 * @brief sets the categories the job category is looked up in,
+	 * 			NULL for the process wide JobCategories
+	 */
+	void setCategories(const JobCategories *categories_) {
+		_categories = categories_;
 	}
 
 	/**
@@ -0,0 +1,382 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_JOBWAITPOLLER_H
+#define INC_JOBWAITPOLLER_H
+
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <drmaa2.hpp>
+#include <OutOfResourceException.h>
+#include <TimeoutException.h>
+#include <TimingWheel.h>
+
+using namespace std;
+
+#define WAIT_TICK_MS 100 /*!< Resolution of wait timeouts */
+#define WAIT_POLL_MS 1000 /*!< Interval of the shared state query */
+#define WAIT_FRESH_POLL_MS 200 /*!< Earliest query once a new wait arrives */
+#define WAIT_ACCOUNTING_POLL_MS 30000 /*!< Query interval while the
+		accounting log reports the terminations */
+#define WAIT_HINT_POLL_MS 200 /*!< Interval of the checks of hinted jobs */
+#define WAIT_HINT_WINDOW_MS 5000 /*!< How long a hinted job is checked */
+#define WAIT_BY_ID_MAX 16 /*!< Most waited jobs queried by id instead of
+		with the query over the jobs of the user */
+#define POLLER_START_FAILED "Failed to start wait poller thread"
+
+namespace drmaa2 {
+
+/**
+ *  @brief Registration of a wait with the JobWaitPoller. Every field is
+ *  guarded by the poller lock.
+ */
+class JobWaiter : public TimerEntry {
+public:
+	pthread_cond_t _cond;
+	enum { WAITING, SATISFIED, TIMED_OUT } _status;
+	bool _attached;
+	list<JobWaiter*>::iterator _pos;
+	/**
+	 * @brief
+	 *      JobWaiter() - constructor for JobWaiter
+	 *
+	 */
+	JobWaiter() : _status(WAITING), _attached(false) {
+		pthread_cond_init(&_cond, NULL);
+	}
+	/**
+	 * @brief
+	 *      ~JobWaiter() - destructor for JobWaiter
+	 *
+	 */
+	virtual ~JobWaiter() {
+		pthread_cond_destroy(&_cond);
+	}
+	/**
+	 * @brief
+	 *      getJobIds() - appends the jobs whose state is needed
+	 *
+	 * @param[out]  jobIds_ - receives the job ids
+	 *
+	 * @return	void
+	 */
+	virtual void getJobIds(list<string>& jobIds_) const = 0;
+	/**
+	 * @brief
+	 *      check() - takes in the states of one query
+	 *
+	 * @param[in]   states_ - known states
+	 * @param[in]   complete_ - jobs missing from states_ are forgotten by
+	 *              the DRMS, otherwise they are merely unknown
+	 *
+	 * @return	true if the waiting thread has to wake up
+	 */
+	virtual bool check(const map<string, JobState>& states_,
+			const bool complete_) = 0;
+	/**
+	 * @brief
+	 *      waitsForStart() - tells whether the waiter needs to see jobs
+	 *      start, which the accounting log does not report
+	 *
+	 * @return	true for a started wait
+	 */
+	virtual bool waitsForStart() const = 0;
+	/**
+	 * @brief
+	 *      isDone() - tells whether the poller can drop the waiter
+	 *
+	 * @return	true if nothing is left to poll for
+	 */
+	virtual bool isDone() const = 0;
+	/**
+	 * @brief
+	 *      reached() - tells whether a state satisfies a wait
+	 *
+	 * @param[in]   state_ - state of the job, UNDETERMINED if unknown
+	 * @param[in]   gone_ - the DRMS no longer knows the job
+	 * @param[in]   terminated_ - wait for termination instead of start
+	 *
+	 * @return	true if the job started or terminated
+	 */
+	static bool reached(const JobState state_, const bool gone_,
+			const bool terminated_);
+};
+
+/**
+ *  @brief One blocked waitStarted/waitTerminated/waitAny call, lives on the
+ *  stack of the waiting thread and is dropped once satisfied.
+ */
+class JobAnyWaiter : public JobWaiter {
+public:
+	const vector<string> &_jobIds;
+	const bool _terminated;
+	size_t _index;
+	JobState _state;
+	/**
+	 * @brief
+	 *      JobAnyWaiter() - constructor for JobAnyWaiter
+	 *
+	 * @param[in]   jobIds_ - jobs of which any one ends the wait
+	 * @param[in]   terminated_ - wait for termination instead of start
+	 *
+	 */
+	JobAnyWaiter(const vector<string>& jobIds_, const bool terminated_) :
+			_jobIds(jobIds_), _terminated(terminated_), _index(0),
+			_state(UNDETERMINED) {
+	}
+	virtual void getJobIds(list<string>& jobIds_) const;
+	virtual bool check(const map<string, JobState>& states_,
+			const bool complete_);
+	virtual bool waitsForStart() const;
+	virtual bool isDone() const;
+};
+
+/**
+ *  @brief Serves every waitStarted/waitTerminated call of the process from
+ *  one thread. Each tick the states of all waited jobs come from a single
+ *  projected query, timeouts are kept on a TimingWheel and each waiter
+ *  sleeps on its own condition variable, so the DRMS load follows the poll
+ *  frequency instead of the number of waiters.
+ */
+class JobWaitPoller {
+private:
+	static pthread_mutex_t _instMutex;
+	static JobWaitPoller* _instance;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	TimingWheel _wheel;
+	pthread_cond_t _idle;
+	list<JobWaiter*> _waiters;
+	bool _fresh;
+	bool _started;
+	bool _querying;
+	unsigned long long _lastQuery;
+	map<string, unsigned long long> _hinted;
+	bool _hintPending;
+	unsigned long long _lastHint;
+	/**
+	 * @brief
+	 *      JobWaitPoller() - constructor for JobWaitPoller, starts the
+	 *      poller thread
+	 *
+	 */
+	JobWaitPoller();
+	/**
+	 * @brief
+	 *      JobWaitPoller() - copy constructor for JobWaitPoller
+	 *
+	 */
+	JobWaitPoller(JobWaitPoller& poller_) {
+	}
+	/**
+	 * @brief
+	 *      pollerMain() - thread entry, runs poll() forever
+	 *
+	 * @param[in]   arg_ - pointer to the owning JobWaitPoller
+	 *
+	 * @return	NULL
+	 */
+	static void* pollerMain(void *arg_);
+	/**
+	 * @brief
+	 *      poll() - queries and expires waiters tick by tick
+	 *
+	 * @return	void
+	 */
+	void poll();
+	/**
+	 * @brief
+	 *      logStates() - gets the states of the jobs whose end is in the
+	 *      accounting log
+	 *
+	 * @param[in]   jobIds_ - jobs whose state is needed
+	 * @param[out]  states_ - receives the final states found
+	 *
+	 * @return	void
+	 */
+	static void logStates(const list<string>& jobIds_,
+			map<string, JobState>& states_);
+	/**
+	 * @brief
+	 *      queryStates() - gets the states of the jobs with one query,
+	 *      by id for up to WAIT_BY_ID_MAX jobs, else over the jobs of the
+	 *      user, then from the accounting log for the ones the DRMS forgot
+	 *
+	 * @param[in]   jobIds_ - jobs whose state is needed
+	 * @param[out]  states_ - receives the known states, jobs the DRMS
+	 *              forgot are missing
+	 *
+	 * @return	false if the DRMS could not be queried
+	 */
+	static bool queryStates(const list<string>& jobIds_,
+			map<string, JobState>& states_);
+	/**
+	 * @brief
+	 *      hintStates() - gets the states of a few jobs by id
+	 * @param[in]   jobIds_ - jobs whose state is needed
+	 * @param[out]  states_ - receives the states the DRMS knows
+	 * @return	void
+	 */
+	static void hintStates(const list<string>& jobIds_,
+			map<string, JobState>& states_);
+	/**
+	 * @brief
+	 *      hintedJobs() - picks the hinted jobs due for a check, drops the
+	 *      expired hints and the ones nobody waits for, _mutex held
+	 * @param[in]   now_ - current tick
+	 * @param[in]   jobIds_ - jobs of all waiters
+	 * @param[out]  hinted_ - receives the jobs to check
+	 * @return	void
+	 */
+	void hintedJobs(const unsigned long long now_,
+			const list<string>& jobIds_, list<string>& hinted_);
+	/**
+	 * @brief
+	 *      finish() - wakes the waiter and drops it once done, _mutex held
+	 *
+	 * @return	void
+	 */
+	void finish(JobWaiter *waiter_);
+public:
+	/**
+	 * @brief
+	 *	getInstance() - returns singleton Instance of JobWaitPoller
+	 *
+	 * @return    pointer to JobWaitPoller object
+	 *
+	 */
+	static JobWaitPoller* getInstance() {
+		pthread_mutex_lock(&_instMutex);
+		if (_instance == 0) {
+			_instance = new JobWaitPoller;
+		}
+		pthread_mutex_unlock(&_instMutex);
+		return _instance;
+	}
+	/**
+	 * @brief
+	 *      wait() - blocks until one of the jobs started or terminated
+	 *
+	 * @param[in]   jobIds_ - jobs to wait for
+	 * @param[in]   terminated_ - wait for termination instead of start
+	 * @param[in]   timeout_ - seconds, 0 checks once, negative waits forever
+	 * @param[out]  state_ - state of the job which ended the wait
+	 *
+	 * @throw TimeoutException - If no job got there in time
+	 * @throw OutOfResourceException - If the poller thread could not start
+	 *
+	 * @return	index of the job in jobIds_ which ended the wait
+	 */
+	size_t wait(const vector<string>& jobIds_, const bool terminated_,
+			const TimeAmount timeout_, JobState& state_)
+			throw (TimeoutException, OutOfResourceException);
+	/**
+	 * @brief
+	 *      lock() - takes the lock guarding every registered waiter
+	 *
+	 * @return	void
+	 */
+	void lock() {
+		pthread_mutex_lock(&_mutex);
+	}
+	/**
+	 * @brief
+	 *      unlock() - releases the lock taken by lock()
+	 *
+	 * @return	void
+	 */
+	void unlock() {
+		pthread_mutex_unlock(&_mutex);
+	}
+	/**
+	 * @brief
+	 *      attach() - registers a waiter for the next queries, the lock
+	 *      is held
+	 *
+	 * @param[in]   waiter_ - waiter to poll for, nothing if already attached
+	 *
+	 * @throw OutOfResourceException - If the poller thread could not start
+	 *
+	 * @return	void
+	 */
+	void attach(JobWaiter *waiter_) throw (OutOfResourceException);
+	/**
+	 * @brief
+	 *      detach() - unregisters a waiter, the lock is held. Waits for a
+	 *      query in progress so the poller no longer refers to it
+	 *
+	 * @param[in]   waiter_ - waiter to drop, nothing if not attached
+	 *
+	 * @return	void
+	 */
+	void detach(JobWaiter *waiter_);
+	/**
+	 * @brief
+	 *      block() - sleeps until the poller wakes the attached waiter or
+	 *      the timeout expires, the lock is held
+	 *
+	 * @param[in]   waiter_ - attached waiter, _status tells the outcome
+	 * @param[in]   timeout_ - seconds, negative waits forever
+	 *
+	 * @return	void
+	 */
+	void block(JobWaiter *waiter_, const TimeAmount timeout_);
+	/**
+	 * @brief
+	 *      refresh() - runs one query for the waiter in the calling thread,
+	 *      the lock is held and released during the query
+	 *
+	 * @param[in]   waiter_ - waiter to check
+	 *
+	 * @return	true if the waiter would be woken up
+	 */
+	bool refresh(JobWaiter *waiter_);
+	/**
+	 * @brief
+	 *      hint() - tells that the jobs likely just ended, as their output
+	 *      showed up. They are checked by id right away and then every
+	 *      WAIT_HINT_POLL_MS for WAIT_HINT_WINDOW_MS
+	 * @param[in]   jobIds_ - jobs to check
+	 * @return	void
+	 */
+	void hint(const list<string>& jobIds_);
+};
+}
+#endif
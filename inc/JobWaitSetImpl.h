@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_JOBWAITSETIMPL_H_
+#define INC_JOBWAITSETIMPL_H_
+
+#include <list>
+#include <map>
+#include <string>
+
+#include "drmaa2.hpp"
+#include <JobWaitPoller.h>
+
+using namespace std;
+
+namespace drmaa2 {
+/**
+ * @class JobWaitSetImpl
+ * @brief Implementation of JobWaitSet. The set stays attached to the
+ * 			JobWaitPoller while it has pending jobs, so transitions are
+ * 			caught by the shared query also between two waits and kept in
+ * 			the ready queue. Every member is guarded by the poller lock
+ *
+ */
+class JobWaitSetImpl : public JobWaitSet, public JobWaiter {
+	const bool _terminated;
+	map<string, Job*> _pending;
+	JobList _ready;
+	bool _blocked;
+	/**
+	 * @brief Copy constructor
+	 */
+	JobWaitSetImpl(const JobWaitSetImpl &jobWaitSetImpl_) :
+			_terminated(false), _blocked(false) {};
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param[in] terminated_ - Wait for termination instead of start
+	 */
+	JobWaitSetImpl(const bool terminated_) :
+			_terminated(terminated_), _blocked(false) {
+	}
+	/**
+	 * @brief Destructor, detaches the set from the poller
+	 */
+	virtual ~JobWaitSetImpl(void);
+
+	/**
+	 * @brief overridden method from JobWaitSet
+	 */
+	virtual void add(const Job& job_);
+
+	/**
+	 * @brief overridden method from JobWaitSet
+	 */
+	virtual void remove(const Job& job_);
+
+	/**
+	 * @brief overridden method from JobWaitSet
+	 */
+	virtual size_t size(void) const;
+
+	/**
+	 * @brief overridden method from JobWaitSet
+	 */
+	virtual JobList wait(const TimeAmount timeout_);
+
+	/**
+	 * @brief overridden method from JobWaiter
+	 */
+	virtual void getJobIds(list<string>& jobIds_) const;
+
+	/**
+	 * @brief overridden method from JobWaiter, moves the pending jobs
+	 * 			which got there to the ready queue
+	 */
+	virtual bool check(const map<string, JobState>& states_,
+			const bool complete_);
+
+	/**
+	 * @brief overridden method from JobWaiter
+	 */
+	virtual bool waitsForStart() const;
+
+	/**
+	 * @brief overridden method from JobWaiter
+	 */
+	virtual bool isDone() const;
+};
+
+} /* namespace drmaa2 */
+
+#endif /* INC_JOBWAITSETIMPL_H_ */
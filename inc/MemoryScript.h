@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_MEMORYSCRIPT_H_
+#define INC_MEMORYSCRIPT_H_
+
+#include <string>
+#include <ImplementationSpecificException.h>
+
+using namespace std;
+
+#define MEMORY_SCRIPT_NAME "drmaa2script"
+#define MEMORY_SCRIPT_FALLBACK "/dev/shm/drmaa2scriptXXXXXX"
+
+namespace drmaa2 {
+
+/**
+ * @class MemoryScript
+ * @brief Job script held in an anonymous memory file. The script is
+ * 			reachable through getPath() for as long as the object lives
+ * 			and is released automatically on destruction.
+ */
+class MemoryScript {
+	int _fd;
+	string _path;
+	/**
+	 * @brief Copy constructor
+	 */
+	MemoryScript(const MemoryScript &memoryScript_) {};
+public:
+	/**
+	 * @brief Constructor, creates the memory file holding content_
+	 *
+	 * @param[in] content_ - script body
+	 *
+	 * @throw ImplementationSpecificException - If no memory file can
+	 * 			be created or written
+	 */
+	MemoryScript(const string& content_)
+			throw (ImplementationSpecificException);
+
+	/**
+	 * @brief Destructor, releases the memory file
+	 */
+	~MemoryScript();
+
+	/**
+	 * @brief Returns a path under which the script can be opened
+	 *
+	 * @return path of the script
+	 */
+	const string& getPath(void) const;
+};
+
+} /* namespace drmaa2 */
+
+#endif /* INC_MEMORYSCRIPT_H_ */
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_OUTPUTREADER_H
+#define INC_OUTPUTREADER_H
+
+#include <string>
+#include <drmaa2.hpp>
+
+using namespace std;
+
+#define OUTPUT_READ_POLL_MS 1000 /*!< Longest sleep between checks while
+		waiting, for file systems inotify does not see written */
+
+namespace drmaa2 {
+
+/**
+ *  @brief Incremental reader of one output stream of a job. Each call
+ *  opens the file, compares its identity and size with the OutputCursor
+ *  and preads only the bytes past the cursor. Waiting for more data sleeps
+ *  on an inotify watch of the directory, which also sees the file being
+ *  created or replaced.
+ */
+class OutputReader {
+private:
+	string _directory;
+	string _name;
+	const string _jobId;
+	const char _kind;
+	/**
+	 * @brief
+	 *      locate() - finds the file, among the PBS default names when
+	 *      the path is a directory
+	 *
+	 * @return	path of the file, empty if it does not exist yet
+	 */
+	string locate() const;
+	/**
+	 * @brief
+	 *      readNew() - reads the bytes past the cursor
+	 *
+	 * @param[in,out] cursor_ - position, reset if the file changed
+	 * @param[in]   maxBytes_ - most bytes to read
+	 * @param[out]  data_ - receives the bytes
+	 *
+	 * @return	true if bytes were read
+	 */
+	bool readNew(OutputCursor& cursor_, const size_t maxBytes_,
+			string& data_) const;
+public:
+	/**
+	 * @brief
+	 *      OutputReader() - constructor for OutputReader
+	 *
+	 * @param[in]   path_ - outputPath or errorPath of the JobTemplate
+	 * @param[in]   jobId_ - job writing the stream
+	 * @param[in]   kind_ - 'o' or 'e', the PBS default name of the stream
+	 *
+	 * @throw InvalidArgumentException - If path_ names no file
+	 */
+	OutputReader(const string& path_, const string& jobId_,
+			const char kind_);
+	/**
+	 * @brief
+	 *      read() - returns the bytes past the cursor, see Job::readOutput
+	 *
+	 * @param[in,out] cursor_ - position reached by the previous call
+	 * @param[in]   maxBytes_ - most bytes to return
+	 * @param[in]   timeout_ - seconds to wait, negative waits forever
+	 *
+	 * @return	new bytes, empty if none arrived in time
+	 */
+	string read(OutputCursor& cursor_, const size_t maxBytes_,
+			const TimeAmount timeout_) const;
+};
+}
+#endif
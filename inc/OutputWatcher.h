@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_OUTPUTWATCHER_H
+#define INC_OUTPUTWATCHER_H
+
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <drmaa2.hpp>
+
+using namespace std;
+
+#define OUTPUT_WATCH_ENV "DRMAA2_WATCH_OUTPUT"
+#define OUTPUT_WATCH_MAX_JOBS 65536 /*!< Jobs watched at the same time */
+#define OUTPUT_WATCH_BUFFER 16384 /*!< Bytes read from inotify at once */
+
+namespace drmaa2 {
+
+/**
+ *  @brief One output file of a job as watched in its directory.
+ */
+struct OutputWatch {
+	int wd; /*!< inotify watch of the directory */
+	string name; /*!< File name, empty for the PBS default names */
+};
+
+/**
+ *  @brief Files watched for one job and its place in the eviction order.
+ */
+struct WatchedJob {
+	vector<OutputWatch> watches;
+	list<string>::iterator pos;
+};
+
+/**
+ *  @brief Optional watcher of the output and error files named in the
+ *  JobTemplate, enabled by DRMAA2_WATCH_OUTPUT. PBS delivers these files
+ *  when the job ends, so an inotify close-write or move in their directory
+ *  is a hint to the JobWaitPoller to check the job right away instead of
+ *  at its next poll. Jobs whose files never show up here, as on file
+ *  systems not shared with this host, are left to the normal polling.
+ */
+class OutputWatcher {
+private:
+	static pthread_mutex_t _instMutex;
+	static OutputWatcher* _instance;
+	pthread_mutex_t _mutex;
+	int _fd;
+	bool _started;
+	map<string, WatchedJob> _jobs;
+	multimap<pair<int, string>, string> _byFile;
+	map<int, size_t> _refs;
+	list<string> _order;
+	/**
+	 * @brief
+	 *      OutputWatcher() - constructor for OutputWatcher, starts the
+	 *      watcher thread if enabled
+	 *
+	 * @param[in]   enabled_ - whether to watch at all
+	 *
+	 */
+	OutputWatcher(const bool enabled_);
+	/**
+	 * @brief
+	 *      OutputWatcher() - copy constructor for OutputWatcher
+	 *
+	 */
+	OutputWatcher(OutputWatcher& watcher_) {
+	}
+	/**
+	 * @brief
+	 *      watcherMain() - thread entry, runs run() forever
+	 *
+	 * @param[in]   arg_ - pointer to the owning OutputWatcher
+	 *
+	 * @return	NULL
+	 */
+	static void* watcherMain(void *arg_);
+	/**
+	 * @brief
+	 *      run() - reads the inotify events and hints the jobs
+	 *
+	 * @return	void
+	 */
+	void run();
+	/**
+	 * @brief
+	 *      add() - watches one output path of a job, _mutex held
+	 *
+	 * @param[in]   jobId_ - job writing the file
+	 * @param[in]   path_ - outputPath or errorPath of the template
+	 *
+	 * @return	void
+	 */
+	void add(const string& jobId_, const string& path_);
+	/**
+	 * @brief
+	 *      remove() - stops watching the files of a job, _mutex held
+	 *
+	 * @param[in]   jobId_ - job to forget
+	 *
+	 * @return	void
+	 */
+	void remove(const string& jobId_);
+public:
+	/**
+	 * @brief
+	 *      resolve() - turns an outputPath or errorPath into the directory
+	 *      and name of the file PBS delivers
+	 *
+	 * @param[in]   path_ - [hostname:]path, relative to the current
+	 *              directory unless absolute
+	 * @param[out]  directory_ - directory receiving the file
+	 * @param[out]  name_ - file name, empty if path_ is a directory in
+	 *              which PBS picks the default names
+	 *
+	 * @return	false if path_ names no file
+	 */
+	static bool resolve(const string& path_, string& directory_,
+			string& name_);
+	/**
+	 * @brief
+	 *      matches() - tells whether a file carries one of the PBS default
+	 *      output names, <name>.o<sequence> or <name>.e<sequence>
+	 *
+	 * @param[in]   jobId_ - job id, its sequence number is compared
+	 * @param[in]   name_ - name of the file written
+	 * @param[in]   kinds_ - stream letters accepted, o and e
+	 *
+	 * @return	true if the file belongs to the job
+	 */
+	static bool matches(const string& jobId_, const string& name_,
+			const string& kinds_ = "oe");
+	/**
+	 * @brief
+	 *	getInstance() - returns singleton Instance of OutputWatcher
+	 *
+	 * @return    pointer to OutputWatcher object
+	 *
+	 */
+	static OutputWatcher* getInstance();
+	/**
+	 * @brief
+	 *      watch() - watches the output and error files of a submitted job
+	 *
+	 * @param[in]   jobId_ - id of the submitted job
+	 * @param[in]   jobTemplate_ - template naming the files
+	 *
+	 * @return	void
+	 */
+	void watch(const string& jobId_, const JobTemplate& jobTemplate_);
+};
+}
+#endif
@@ -65,6 +65,11 @@ extern "C" {
 #define STATE "state"
 #define FREE "free"
 
+/* Values of ATTR_resv_state, as kept by the server */
+#define RESV_STATE_UNCONFIRMED 1
+#define RESV_STATE_FINISHED 6
+#define RESV_STATE_DELETING_JOBS 9
+
 #define ATTRL struct attrl
 #define OPERATION enum batch_op
 #define ADD_NODE(head_, node_) {\
@@ -40,9 +40,25 @@
 
 #include <drmaa2.hpp>
 #include <DRMSystem.h>
+#include <JobTemplateAttrHelper.h>
 #include <pthread.h>
 #include <string>
 
+#define SWEEP_MAX_ARRAY 10000
+#define STAT_BATCH_SIZE 256
+#define DEPEND_AFTEROK "afterok"
+#define DEPEND_AFTERANY "afterany"
+#define SUBMIT_KEY_VARIABLE "DRMAA2_SUBMIT_KEY"
+#define SUBMIT_KEY_RETRIES 3
+#define SUBMIT_KEY_CLOCK_SKEW 300 /*!< Seconds the server clock may lag
+		behind when looking a keyed job up by queue time */
+
+#ifdef ATTR_max_run_subjobs
+#define MAX_RUN_SUBJOBS ATTR_max_run_subjobs
+#else
+#define MAX_RUN_SUBJOBS "max_run_subjobs"
+#endif
+
 namespace drmaa2 {
 
 /**
@@ -64,6 +80,15 @@ class PBSProSystem: public DRMSystem {
 	friend Singleton<DRMSystem, PBSProSystem> ;
 private:
 	static pthread_mutex_t _posixMutex;
+	/**
+	 * @brief Whether the server accepts MAX_RUN_SUBJOBS, -1 until the
+	 * 			first capped array submission found out
+	 */
+	int _maxRunSubjobs;
+	/**
+	 * @brief Guards _maxRunSubjobs, sessions submit arrays concurrently
+	 */
+	static pthread_mutex_t _probeMutex;
 
 	/**
 	 * @brief Default Constructor
@@ -94,6 +119,75 @@ private:
 	 */
 	void checkForPBS_ErrorException() throw (InvalidStateException,
 			ImplementationSpecificException, DeniedByDrmsException);
+	/**
+	 * @brief - Throws the exception matching the PBS error errorCode_
+	 *
+	 * @param[in] errorCode_ - PBS error, as found in pbs_errno
+	 *
+	 * @throw - InvalidStateException
+	 * @throw - ImplementationSpecificException
+	 *
+	 * @return - None
+	 */
+	void checkForPBS_ErrorException(const int errorCode_) throw (
+			InvalidStateException, ImplementationSpecificException,
+			DeniedByDrmsException);
+	/**
+	 * @brief - Submits a job with the attributes of jobTemplate_
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] attrParse_ - helper holding any extra attributes
+	 * @param[in] jobTemplate_ - JobTemplate
+	 * @param[in] script_ - path of the job script
+	 *
+	 * @throw - ImplementationSpecificException
+	 *
+	 * @return - Job object
+	 */
+	Job* submitJob(const Connection & connection_,
+			JobTemplateAttrHelper& attrParse_, const JobTemplate& jobTemplate_,
+			const string& script_) throw (ImplementationSpecificException);
+	/**
+	 * @brief - Submits a job array with the attributes of jobTemplate_
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] attrParse_ - helper holding any extra attributes
+	 * @param[in] jobTemplate_ - JobTemplate
+	 * @param[in] script_ - path of the job script
+	 * @param[in] jobIndices_ - PBS array range, empty for a plain job
+	 *
+	 * @throw - ImplementationSpecificException
+	 *
+	 * @return - JobArray object
+	 */
+	JobArray* submitJobArray(const Connection & connection_,
+			JobTemplateAttrHelper& attrParse_, const JobTemplate& jobTemplate_,
+			const string& script_, const string& jobIndices_)
+			throw (ImplementationSpecificException);
+	/**
+	 * @brief - Submits a job array as a chain of arrays of at most
+	 * 			maxParallel_ subjobs, each window waits for the previous
+	 * 			one to finish. A window of a single index is submitted as
+	 * 			a plain job with PBS_ARRAY_INDEX in its environment. Used
+	 * 			when the server lacks MAX_RUN_SUBJOBS
+	 *
+	 * @param[in] connection_ - connection object
+	 * @param[in] jobTemplate_ - JobTemplate
+	 * @param[in] beginIndex_ - start index of the array
+	 * @param[in] endIndex_ - end index of the array
+	 * @param[in] step_ - index increment
+	 * @param[in] maxParallel_ - subjobs per window
+	 * @param[in] environment_ - session base environment, NULL for none
+	 *
+	 * @throw - ImplementationSpecificException
+	 *
+	 * @return - JobArray of the first window, carrying the others
+	 */
+	JobArray* submitJobArrayWindows(const Connection & connection_,
+			const JobTemplate& jobTemplate_, const long beginIndex_,
+			const long endIndex_, const long step_, const long maxParallel_,
+			const EnvironmentEncoder *environment_)
+			throw (ImplementationSpecificException);
 public:
 	/**
 	 * @brief Default Destructor
@@ -113,8 +207,65 @@ public:
 	 * @brief overridden method from DRMSystem
 	 */
 	virtual Job* runJob(const Connection & connection_,
-			const JobTemplate& jobTemplate_)
+			const JobTemplate& jobTemplate_,
+			const EnvironmentEncoder *environment_ = NULL)
+					throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual Job* runJob(const Connection & connection_,
+			const JobTemplate& jobTemplate_, const list<string>& afterOk_,
+			const EnvironmentEncoder *environment_ = NULL)
+					throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual Job* runKeyedJob(const Connection & connection_,
+			const JobTemplate& jobTemplate_, const string& submitKey_,
+			const EnvironmentEncoder *environment_ = NULL)
 					throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual string findKeyedJob(const Connection & connection_,
+			const string& submitKey_, const string& jobName_,
+			const time_t queuedAfter_ = 0)
+					throw (ImplementationSpecificException);
+	/**
+	 * @brief Tells whether submitKey_ can be stored in Variable_List
+	 *
+	 * @param[in] submitKey_ - client idempotency key
+	 *
+	 * @return - true if the key is not empty and holds neither white
+	 * 			space, ',' nor a backslash
+	 */
+	static bool isValidSubmitKey(const string& submitKey_);
+	/**
+	 * @brief Parses a PBS duration, as resources_used.walltime
+	 *
+	 * @param[in] value_ - [[HH:]MM:]SS
+	 *
+	 * @return - seconds
+	 */
+	static long parseDuration(const char *value_);
+	/**
+	 * @brief Parses a PBS size, as resources_used.mem
+	 *
+	 * @param[in] value_ - number with an optional b, kb, mb, gb, tb or pb
+	 * 			suffix, w instead of b counts words
+	 *
+	 * @return - kilobytes
+	 */
+	static long long parseSize(const char *value_);
+	/**
+	 * @brief Fills the JobInfo fields reported in a pbs_statjob response
+	 *
+	 * @param[in] attribs_ - attributes of one job
+	 * @param[in,out] jobInfo_ - fields without an attribute are kept
+	 *
+	 * @return - None
+	 */
+	static void toJobInfo(struct attrl *attribs_, JobInfo& jobInfo_);
 
 	/**
 	 * @brief overridden method from DRMSystem
@@ -149,6 +300,30 @@ public:
 	/**
 	 * @brief overridden method from DRMSystem
 	 */
+	virtual void control(const Connection & connection_,
+			const JobOperation operation_, JobOperationResult *results_,
+			const size_t count_) throw ();
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual void alter(const Connection & connection_, const Job& job_,
+			const JobAlteration& alteration_) throw (InvalidArgumentException,
+			InvalidStateException, DeniedByDrmsException,
+			ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual void alter(const Connection & connection_,
+			JobAlterationAttrHelper& attributes_, JobOperationResult *results_,
+			const size_t count_) throw ();
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual char **selectJobs(const Connection & connection_,
+			const JobInfo& filter_);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
 	virtual void reap(const Connection & connection_, const Job& job_) throw ();
 	/**
 	 * @brief overridden method from DRMSystem
@@ -158,6 +333,41 @@ public:
 	/**
 	 * @brief overridden method from DRMSystem
 	 */
+	virtual map<string, JobState> getUserJobStates(
+			const Connection & connection_, const list<string>& jobIds_)
+			throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual void getUserJobSnapshots(const Connection & connection_,
+			map<string, JobSnapshot>& snapshot_)
+			throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual map<string, JobState> getJobStates(const Connection & connection_,
+			const list<string>& jobIds_)
+			throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual map<string, JobUsage> getJobUsage(const Connection & connection_,
+			const list<string>& jobIds_)
+			throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual time_t getChangedJobs(const Connection & connection_,
+			const time_t since_, map<string, JobInfo>& changed_)
+			throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual void getUserJobIds(const Connection & connection_,
+			set<string>& jobIds_) throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
 	virtual Job* getJob(const Connection & connection_,
 			const string& jobId_) throw ();
 	/**
@@ -166,7 +376,17 @@ public:
 	virtual JobArray* runJobArray(const Connection & connection_,
 			const JobTemplate& jobTemplate_, const long beginIndex_,
 			const long endIndex_, const long step_,
-			const long maxParallel_) throw ();
+			const long maxParallel_,
+			const EnvironmentEncoder *environment_ = NULL)
+			throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
+	virtual JobList runJobSweep(const Connection & connection_,
+			const JobTemplate& jobTemplate_, const SweepTable& points_,
+			const EnvironmentEncoder *environment_ = NULL)
+			throw (ImplementationSpecificException,
+			InvalidArgumentException);
 
 	/**
 	 * @brief overridden method from DRMSystem
@@ -209,12 +429,14 @@ public:
 	 * @brief overridden method from DRMSystem
 	 */
 	virtual Reservation* submit(const Connection & connection_,
-			const ReservationTemplate& reservationTemplate_) throw ();
+			const ReservationTemplate& reservationTemplate_)
+			throw (ImplementationSpecificException);
 	/**
 	 * @brief overridden method from DRMSystem
 	 */
 	virtual void remove(const Connection & connection_,
-			const Reservation& reservation_) throw ();
+			const Reservation& reservation_)
+			throw (ImplementationSpecificException);
 	/**
 	 * @brief overridden method from DRMSystem
 	 */
@@ -223,6 +445,12 @@ public:
 	/**
 	 * @brief overridden method from DRMSystem
 	 */
+	virtual void checkReservations(const Connection & connection_,
+			set<string>& pending_, set<string>& confirmed_)
+			throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
 	virtual Reservation* getReservation(const Connection & connection_,
 			const string& reservationId_) throw ();
 	/**
@@ -238,6 +466,12 @@ public:
 	/**
 	 * @brief overridden method from DRMSystem
 	 */
+	virtual JobList getJobs(const Connection & connection_,
+			const JobInfo& filter_, const list<string>& jobIds_,
+			list<string>& gone_) throw (ImplementationSpecificException);
+	/**
+	 * @brief overridden method from DRMSystem
+	 */
 	virtual MachineInfoList getAllMachines(const Connection & connection_,
 			list<string> machines_) throw (ImplementationSpecificException);
 	/**
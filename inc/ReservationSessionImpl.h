@@ -46,6 +46,9 @@
 #include <ConnectionPool.h>
 #include <ReservationImpl.h>
 
+#define RESV_POLL_MIN_MS 250 /*!< First interval of waitConfirmed */
+#define RESV_POLL_MAX_MS 5000 /*!< Interval cap while nothing changes */
+
 using namespace std;
 
 namespace drmaa2 {
@@ -98,6 +101,24 @@ public:
 	virtual const Reservation& requestReservation(
 			const ReservationTemplate& reservationTemplate_) const;
 
+	/**
+	 * @brief overridden method from ReservationSession
+	 */
+	virtual ReservationList requestReservations(
+			const list<ReservationTemplate>& reservationTemplates_) const;
+
+	/**
+	 * @brief overridden method from ReservationSession
+	 */
+	virtual ReservationList waitConfirmed(const ReservationList& reservations_,
+			const TimeAmount timeout_) const;
+
+	/**
+	 * @brief overridden method from ReservationSession
+	 */
+	virtual ReservationList terminateReservations(
+			const ReservationList& reservations_) const;
+
 	/**
 	 * @brief Returns associated list of reservations
 	 *
@@ -161,6 +161,11 @@ public:
 	 */
 	virtual void registerEventNotification(const DrmaaCallback& callback);
 
+	/**
+	 * @brief overridden method from SessionManager
+	 */
+	virtual void unregisterEventNotification(void);
+
 	/**
 	 * @brief overridden method from SessionManager
 	 *
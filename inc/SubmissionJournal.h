@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_SUBMISSIONJOURNAL_H
+#define INC_SUBMISSIONJOURNAL_H
+
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <string>
+#include <drmaa2.hpp>
+#include <EnvironmentEncoder.h>
+#include <ImplementationSpecificException.h>
+#include <InvalidArgumentException.h>
+
+using namespace std;
+
+#define JOURNAL_QUEUED 'Q'
+#define JOURNAL_SUBMITTING 'S'
+#define JOURNAL_RETRY 'A'
+#define JOURNAL_DONE 'D'
+#define JOURNAL_FAILED 'F'
+#define JOURNAL_COMPACT_RECORDS 10000
+#define JOURNAL_KEEP_FINISHED 10000
+#define JOURNAL_INITIAL_WINDOW 4
+#define JOURNAL_BACKOFF_MAX 32
+#define JOURNAL_UNCERTAIN -1
+#define JOURNAL_MAX_UNCERTAIN 5
+
+namespace drmaa2 {
+
+/**
+ *  @brief Write-ahead journal of job submissions. Requests are appended
+ *  to a local file, made durable with one fdatasync per group of
+ *  concurrent appends and submitted by a background drainer.
+ *
+ *  Every record is "<type> <key> <length> <checksum>\n<payload>\n".
+ *  A request goes through Q (queued, payload is the JobTemplate),
+ *  S (about to be submitted), A (submission failed, queued again),
+ *  D (payload is the job id) or F (payload is the PBS error). S is
+ *  durable before pbs_submit is called and the job carries the request
+ *  key as its submit key, so a request found in S on replay is looked
+ *  up on the server before it is submitted again. Compaction keeps the
+ *  D and F records of the last JOURNAL_KEEP_FINISHED requests, so a key
+ *  enqueued again after a restart is still recognized.
+ */
+class SubmissionJournal {
+	/**
+	 *  @brief In memory state of one request
+	 */
+	struct Entry {
+		char state;
+		JobTemplate jobTemplate;
+		string jobId;
+		long errorCode;
+		bool submitted;
+		int uncertain;
+	};
+	string _path;
+	int _fd;
+	const EnvironmentEncoder *_environment;
+	map<string, Entry> _entries;
+	list<string> _ready;
+	list<string> _finished;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _syncCond;
+	pthread_cond_t _readyCond;
+	string _buffer;
+	unsigned long _appended;
+	unsigned long _durable;
+	bool _syncing;
+	long _records;
+	long _window;
+	bool _stop;
+	pthread_t _drainer;
+	unsigned long _sequence;
+
+	/**
+	 * @brief
+	 *      SubmissionJournal() - copy constructor, not available
+	 *
+	 */
+	SubmissionJournal(const SubmissionJournal& journal_);
+	/**
+	 * @brief
+	 *      append() - buffers one record, caller holds _mutex
+	 *
+	 * @param[in]   type_ - record type
+	 * @param[in]   key_ - request key
+	 * @param[in]   payload_ - record payload
+	 *
+	 * @return	sequence number to pass to sync()
+	 */
+	unsigned long append(const char type_, const string& key_,
+			const string& payload_);
+	/**
+	 * @brief
+	 *      sync() - returns once every record up to seq_ is on disk. The
+	 *      first waiting thread writes the records of all others.
+	 *      Caller holds _mutex.
+	 *
+	 * @param[in]   seq_ - sequence number returned by append()
+	 *
+	 * @return	false if the write failed, the records are kept for the
+	 * 			next attempt
+	 */
+	bool sync(const unsigned long seq_);
+	/**
+	 * @brief
+	 *      finish() - remembers key_ as finished and forgets the oldest
+	 *      finished request beyond JOURNAL_KEEP_FINISHED. Caller holds
+	 *      _mutex.
+	 *
+	 * @param[in]   key_ - request key
+	 *
+	 * @return	void
+	 */
+	void finish(const string& key_);
+	/**
+	 * @brief
+	 *      replay() - rebuilds the request states from the file and cuts
+	 *      a torn last record
+	 *
+	 * @throw ImplementationSpecificException - If the file can not be read
+	 *
+	 * @return	void
+	 */
+	void replay() throw (ImplementationSpecificException);
+	/**
+	 * @brief
+	 *      compact() - rewrites the file with the pending requests and
+	 *      the outcome of the recently finished ones. Caller holds _mutex.
+	 *
+	 * @return	false if the file could not be rewritten, the old file
+	 * 			stays in use
+	 */
+	bool compact();
+	/**
+	 * @brief
+	 *      drain() - drainer loop, submits ready requests in batches
+	 *
+	 * @return	void
+	 */
+	void drain();
+	/**
+	 * @brief
+	 *      drainerMain() - drainer thread entry
+	 *
+	 * @param[in]   arg_ - pointer to the owning SubmissionJournal
+	 *
+	 * @return	NULL
+	 */
+	static void* drainerMain(void *arg_);
+public:
+	/**
+	 * @brief
+	 *      SubmissionJournal() - opens or creates the journal at path_,
+	 *      replays it and starts the drainer
+	 *
+	 * @param[in]   path_ - journal file
+	 * @param[in]   environment_ - session base environment, NULL for none
+	 *
+	 * @throw ImplementationSpecificException - If the file can not be used
+	 *
+	 */
+	SubmissionJournal(const string& path_,
+			const EnvironmentEncoder *environment_)
+			throw (ImplementationSpecificException);
+	/**
+	 * @brief
+	 *      ~SubmissionJournal() - stops the drainer once the batch in
+	 *      flight finished, pending requests stay in the file
+	 *
+	 */
+	~SubmissionJournal();
+	/**
+	 * @brief
+	 *      enqueue() - durably records the request and hands it to the
+	 *      drainer
+	 *
+	 * @param[in]   jobTemplate_ - job to submit
+	 * @param[in]   key_ - caller chosen request key, generated if empty.
+	 *      A key already in the journal is not queued again.
+	 *
+	 * @throw InvalidArgumentException - If key_ holds white space,
+	 * 			',' or a backslash
+	 * @throw ImplementationSpecificException - If the write fails. The
+	 * 			request may still be submitted, retry with the same key
+	 *
+	 * @return	request key
+	 */
+	string enqueue(const JobTemplate& jobTemplate_, const string& key_)
+			throw (InvalidArgumentException, ImplementationSpecificException);
+	/**
+	 * @brief
+	 *      getJobId() - returns the job submitted for key_
+	 *
+	 * @param[in]   key_ - request key
+	 *
+	 * @throw InvalidArgumentException - If key_ is unknown or finished
+	 * 			more than JOURNAL_KEEP_FINISHED requests ago
+	 * @throw ImplementationSpecificException - If the submission failed,
+	 * 			the error code is JOURNAL_UNCERTAIN if the outcome was still
+	 * 			unknown after JOURNAL_MAX_UNCERTAIN attempts
+	 *
+	 * @return	job id, empty while the request is pending
+	 */
+	string getJobId(const string& key_)
+			throw (InvalidArgumentException, ImplementationSpecificException);
+	/**
+	 * @brief
+	 *      serialize() - encodes jobTemplate_ as journal payload
+	 *
+	 * @param[in]   jobTemplate_ - template to encode
+	 *
+	 * @return	payload
+	 */
+	static string serialize(const JobTemplate& jobTemplate_);
+	/**
+	 * @brief
+	 *      deserialize() - decodes a payload written by serialize()
+	 *
+	 * @param[in]   payload_ - payload
+	 * @param[out]  jobTemplate_ - decoded template
+	 *
+	 * @return	void
+	 */
+	static void deserialize(const string& payload_, JobTemplate& jobTemplate_);
+};
+}
+#endif
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_TIMINGWHEEL_H
+#define INC_TIMINGWHEEL_H
+
+#include <cstddef>
+#include <list>
+
+using namespace std;
+
+#define WHEEL_ROOT_BITS 8 /*!< Root level covers 256 ticks */
+#define WHEEL_LEVEL_BITS 6 /*!< Every outer level covers 64 times more */
+#define WHEEL_LEVELS 4 /*!< Levels including the root, 2^26 ticks in all */
+
+namespace drmaa2 {
+
+class TimingWheel;
+
+/**
+ *  @brief Element scheduled on a TimingWheel, embedded in the object
+ *  which waits for the timeout.
+ */
+class TimerEntry {
+	friend class TimingWheel;
+	unsigned long long _expires;
+	list<TimerEntry*> *_slot;
+	list<TimerEntry*>::iterator _pos;
+public:
+	/**
+	 * @brief
+	 *      TimerEntry() - constructor for an unscheduled TimerEntry
+	 *
+	 */
+	TimerEntry() : _expires(0), _slot(NULL) {
+	}
+	/**
+	 * @brief
+	 *      ~TimerEntry() - destructor for TimerEntry
+	 *
+	 */
+	virtual ~TimerEntry() {
+	}
+	/**
+	 * @brief
+	 *      isScheduled() - tells whether the entry sits on a wheel
+	 *
+	 * @return	true if scheduled
+	 */
+	bool isScheduled() const {
+		return _slot != NULL;
+	}
+};
+
+/**
+ *  @brief Hierarchical timing wheel. Scheduling and cancelling are O(1),
+ *  entries of the outer levels move inwards once per lap of the level
+ *  below, so the cost of a tick does not depend on the number of timers.
+ */
+class TimingWheel {
+private:
+	unsigned long long _now;
+	size_t _size;
+	list<TimerEntry*> _root[1 << WHEEL_ROOT_BITS];
+	list<TimerEntry*> _levels[WHEEL_LEVELS - 1][1 << WHEEL_LEVEL_BITS];
+	/**
+	 * @brief
+	 *      place() - links the entry into the slot matching its expiry
+	 *
+	 * @param[in]   entry_ - entry with _expires set
+	 *
+	 * @return	void
+	 */
+	void place(TimerEntry *entry_);
+	/**
+	 * @brief
+	 *      cascade() - moves the entries of one outer slot inwards
+	 *
+	 * @param[in]   level_ - outer level, 0 is the first one after the root
+	 * @param[in]   index_ - slot of that level
+	 *
+	 * @return	void
+	 */
+	void cascade(const size_t level_, const size_t index_);
+public:
+	/**
+	 * @brief
+	 *      TimingWheel() - constructor for TimingWheel
+	 *
+	 * @param[in]   now_ - current tick
+	 *
+	 */
+	TimingWheel(const unsigned long long now_ = 0);
+	/**
+	 * @brief
+	 *      getNow() - returns the tick the wheel advanced to
+	 *
+	 * @return	current tick
+	 */
+	unsigned long long getNow() const {
+		return _now;
+	}
+	/**
+	 * @brief
+	 *      size() - returns the number of scheduled entries
+	 *
+	 * @return	number of entries
+	 */
+	size_t size() const {
+		return _size;
+	}
+	/**
+	 * @brief
+	 *      schedule() - schedules the entry, rescheduling it if needed
+	 *
+	 * @param[in]   entry_ - entry owned by the caller
+	 * @param[in]   expires_ - tick to expire at, past ticks expire on the
+	 *              next advance
+	 *
+	 * @return	void
+	 */
+	void schedule(TimerEntry *entry_, const unsigned long long expires_);
+	/**
+	 * @brief
+	 *      cancel() - removes the entry, nothing happens if not scheduled
+	 *
+	 * @param[in]   entry_ - entry owned by the caller
+	 *
+	 * @return	void
+	 */
+	void cancel(TimerEntry *entry_);
+	/**
+	 * @brief
+	 *      advance() - moves the wheel to now_ and collects the entries
+	 *      which expired on the way, they are no longer scheduled
+	 *
+	 * @param[in]   now_ - current tick
+	 * @param[out]  expired_ - receives the expired entries
+	 *
+	 * @return	void
+	 */
+	void advance(const unsigned long long now_, list<TimerEntry*>& expired_);
+};
+}
+#endif
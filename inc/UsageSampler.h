@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_USAGESAMPLER_H
+#define INC_USAGESAMPLER_H
+
+#include <pthread.h>
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <drmaa2.hpp>
+#include <OutOfResourceException.h>
+
+using namespace std;
+
+#define USAGE_INTERVAL_ENV "DRMAA2_USAGE_INTERVAL"
+#define USAGE_SAMPLE_INTERVAL 30 /*!< Default seconds between samples */
+#define USAGE_MAX_SAMPLES 1024 /*!< Samples kept per job */
+#define USAGE_MAX_JOBS 4096 /*!< Jobs kept, the oldest tracked go first */
+#define SAMPLER_START_FAILED "Failed to start usage sampler thread"
+
+namespace drmaa2 {
+
+/**
+ *  @brief Bounded series of UsageSample of one job. The oldest sample is
+ *  kept whole, every later one as the zigzag varint deltas of its fields
+ *  to the sample before, so a steady job costs a few bytes per sample.
+ *  Beyond the capacity the oldest delta is folded into the first sample.
+ */
+class UsageRing {
+private:
+	UsageSample _first;
+	UsageSample _last;
+	size_t _count;
+	size_t _capacity;
+	deque<unsigned char> _deltas;
+	/**
+	 * @brief
+	 *      putDelta() - appends a delta as a zigzag varint
+	 *
+	 * @param[in]   delta_ - difference to the previous value
+	 *
+	 * @return	void
+	 */
+	void putDelta(const long long delta_);
+	/**
+	 * @brief
+	 *      getDelta() - decodes a delta written by putDelta
+	 *
+	 * @param[in,out] it_ - first byte of the delta, left past it
+	 *
+	 * @return	difference to the previous value
+	 */
+	static long long getDelta(deque<unsigned char>::const_iterator& it_);
+	/**
+	 * @brief
+	 *      apply() - adds the next four deltas to a sample
+	 *
+	 * @param[in,out] it_ - first byte of the deltas, left past them
+	 * @param[in,out] sample_ - previous sample, becomes the next one
+	 *
+	 * @return	void
+	 */
+	static void apply(deque<unsigned char>::const_iterator& it_,
+			UsageSample& sample_);
+public:
+	bool active; /*!< Still sampled, cleared once the job ended */
+	/**
+	 * @brief
+	 *      UsageRing() - constructor for UsageRing
+	 *
+	 * @param[in]   capacity_ - samples kept, at least one
+	 *
+	 */
+	UsageRing(const size_t capacity_ = USAGE_MAX_SAMPLES);
+	/**
+	 * @brief
+	 *      push() - appends a sample, dropping the oldest beyond capacity
+	 *
+	 * @param[in]   sample_ - sample to keep
+	 *
+	 * @return	void
+	 */
+	void push(const UsageSample& sample_);
+	/**
+	 * @brief
+	 *      samples() - decodes the samples kept
+	 *
+	 * @return	samples, oldest first
+	 */
+	UsageSampleList samples() const;
+	/**
+	 * @brief
+	 *      size() - returns the number of samples kept
+	 *
+	 * @return	number of samples
+	 */
+	size_t size() const {
+		return _count;
+	}
+	/**
+	 * @brief
+	 *      bytes() - returns the size of the encoded deltas
+	 *
+	 * @return	bytes
+	 */
+	size_t bytes() const {
+		return _deltas.size();
+	}
+};
+
+/**
+ *  @brief Opt-in sampler of the resources used by tracked jobs. One thread
+ *  queries all tracked jobs which may still run with one projected
+ *  statjob per batch of ids each interval, set in seconds by
+ *  DRMAA2_USAGE_INTERVAL. Running jobs get a sample, ended ones stop
+ *  being sampled but keep their series until evicted.
+ */
+class UsageSampler {
+private:
+	static pthread_mutex_t _instMutex;
+	static UsageSampler* _instance;
+	mutable pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	const unsigned int _interval;
+	bool _started;
+	map<string, UsageRing> _rings;
+	list<string> _order;
+	/**
+	 * @brief
+	 *      UsageSampler() - constructor for UsageSampler
+	 *
+	 */
+	UsageSampler();
+	/**
+	 * @brief
+	 *      UsageSampler() - copy constructor for UsageSampler
+	 *
+	 */
+	UsageSampler(UsageSampler& sampler_) : _interval(0) {
+	}
+	/**
+	 * @brief
+	 *      samplerMain() - thread entry, runs run() forever
+	 *
+	 * @param[in]   arg_ - pointer to the owning UsageSampler
+	 *
+	 * @return	NULL
+	 */
+	static void* samplerMain(void *arg_);
+	/**
+	 * @brief
+	 *      run() - samples the active jobs every interval
+	 *
+	 * @return	void
+	 */
+	void run();
+public:
+	/**
+	 * @brief
+	 *	getInstance() - returns singleton Instance of UsageSampler
+	 *
+	 * @return    pointer to UsageSampler object
+	 *
+	 */
+	static UsageSampler* getInstance() {
+		pthread_mutex_lock(&_instMutex);
+		if (_instance == 0) {
+			_instance = new UsageSampler;
+		}
+		pthread_mutex_unlock(&_instMutex);
+		return _instance;
+	}
+	/**
+	 * @brief
+	 *      track() - starts sampling a job, starting the thread on first
+	 *      use. Nothing if the job is tracked already
+	 *
+	 * @param[in]   jobId_ - job to sample
+	 *
+	 * @throw OutOfResourceException - If the sampler thread could not start
+	 *
+	 * @return	void
+	 */
+	void track(const string& jobId_) throw (OutOfResourceException);
+	/**
+	 * @brief
+	 *      samples() - returns the samples of a job
+	 *
+	 * @param[in]   jobId_ - tracked job
+	 *
+	 * @return	samples, oldest first, empty if not tracked
+	 */
+	UsageSampleList samples(const string& jobId_) const;
+};
+}
+#endif
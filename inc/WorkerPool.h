@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef INC_WORKERPOOL_H
+#define INC_WORKERPOOL_H
+
+#include <pthread.h>
+#include <list>
+#include <ConnectionPool.h>
+#include <OutOfResourceException.h>
+
+using namespace std;
+
+#define MAX_WORKERS (MAX_CONNS / 2)
+#define WORKER_START_FAILED "Failed to start worker thread"
+
+namespace drmaa2 {
+
+/**
+ *  @brief Unit of work executed by a WorkerPool thread.
+ */
+class WorkerTask {
+public:
+	/**
+	 * @brief
+	 *      ~WorkerTask() - destructor for WorkerTask
+	 *
+	 */
+	virtual ~WorkerTask() {
+	}
+	/**
+	 * @brief
+	 *      run() - performs the task. Invoked on a worker thread, the task
+	 *      is deleted by the pool once run() returns.
+	 *
+	 * @return	void
+	 */
+	virtual void run() = 0;
+};
+
+/**
+ *  @brief Countdown latch used to wait for a group of submitted tasks.
+ */
+class TaskGroup {
+private:
+	pthread_mutex_t _groupMutex;
+	pthread_cond_t _groupCond;
+	long _pending;
+	/**
+	 * @brief
+	 *      TaskGroup() - copy constructor for TaskGroup
+	 *
+	 */
+	TaskGroup(TaskGroup& group_) {
+	}
+public:
+	/**
+	 * @brief
+	 *      TaskGroup() - constructor for TaskGroup
+	 *
+	 */
+	TaskGroup();
+	/**
+	 * @brief
+	 *      ~TaskGroup() - destructor for TaskGroup
+	 *
+	 */
+	~TaskGroup();
+	/**
+	 * @brief
+	 *      add() - registers a task which will call done()
+	 *
+	 * @return	void
+	 */
+	void add();
+	/**
+	 * @brief
+	 *      done() - marks one registered task as finished
+	 *
+	 * @return	void
+	 */
+	void done();
+	/**
+	 * @brief
+	 *      wait() - blocks until every registered task called done()
+	 *
+	 * @return	void
+	 */
+	void wait();
+};
+
+/**
+ *  @brief Class that maintains a fixed set of threads executing WorkerTask
+ *  objects in submission order.
+ */
+class WorkerPool {
+private:
+	static pthread_mutex_t _instMutex;
+	static WorkerPool* _instance;
+	pthread_mutex_t _taskMutex;
+	pthread_cond_t _taskCond;
+	list<WorkerTask*> _tasks;
+	size_t _workers;
+	/**
+	 * @brief
+	 *      WorkerPool() - constructor for WorkerPool, starts the workers
+	 *
+	 */
+	WorkerPool();
+	/**
+	 * @brief
+	 *      WorkerPool() - copy constructor for WorkerPool
+	 *
+	 */
+	WorkerPool(WorkerPool& pool_) {
+	}
+	/**
+	 * @brief
+	 *      workerMain() - thread entry, runs queued tasks forever
+	 *
+	 * @param[in]   arg_ - pointer to the owning WorkerPool
+	 *
+	 * @return	NULL
+	 */
+	static void* workerMain(void *arg_);
+public:
+	/**
+	 * @brief
+	 *	getInstance() - returns singleton Instance of WorkerPool
+	 *
+	 * @return    pointer to WorkerPool object
+	 *
+	 */
+	static WorkerPool* getInstance() {
+		pthread_mutex_lock(&_instMutex);
+		if (_instance == 0) {
+			_instance = new WorkerPool;
+		}
+		pthread_mutex_unlock(&_instMutex);
+		return _instance;
+	}
+	/**
+	 * @brief
+	 *      submit() - queues the task for execution, pool takes ownership.
+	 *
+	 * @param[in]   task_ - task allocated with new
+	 *
+	 * @throw OutOfResourceException - If no worker thread could be started
+	 *
+	 * @return	void
+	 */
+	void submit(WorkerTask *task_) throw (OutOfResourceException);
+};
+}
+#endif
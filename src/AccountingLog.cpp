@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <AccountingLog.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+
+namespace drmaa2 {
+
+AccountingLog* AccountingLog::_instance = 0;
+pthread_mutex_t AccountingLog::_instMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief - Tells whether the key of a key=value token is name_
+ *
+ * @param[in] key_ - first byte of the token
+ * @param[in] keyEnd_ - the '=' of the token
+ * @param[in] name_ - key to compare with
+ *
+ * @return - true if equal
+ */
+static bool isKey(const char *key_, const char *keyEnd_, const char *name_) {
+	size_t length_ = strlen(name_);
+	return (size_t) (keyEnd_ - key_) == length_
+			&& memcmp(key_, name_, length_) == 0;
+}
+
+/**
+ * @brief - Parses a decimal number without running past end_
+ *
+ * @return - value, digits after the first other character are ignored
+ */
+static long parseNumber(const char *value_, const char *end_) {
+	bool negative_ = value_ < end_ && *value_ == '-';
+	long number_ = 0;
+	for (const char *c = negative_ ? value_ + 1 : value_;
+			c < end_ && *c >= '0' && *c <= '9'; c++)
+		number_ = number_ * 10 + (*c - '0');
+	return negative_ ? -number_ : number_;
+}
+
+/**
+ * @brief - Parses a duration written as [[HH:]MM:]SS
+ *
+ * @return - seconds
+ */
+static long parseDuration(const char *value_, const char *end_) {
+	long seconds_ = 0, field_ = 0;
+	for (const char *c = value_; c < end_; c++) {
+		if (*c == ':') {
+			seconds_ = (seconds_ + field_) * 60;
+			field_ = 0;
+		} else if (*c >= '0' && *c <= '9') {
+			field_ = field_ * 10 + (*c - '0');
+		} else {
+			break;
+		}
+	}
+	return seconds_ + field_;
+}
+
+/**
+ * @brief - Parses the MM/DD/YYYY HH:MM:SS local time starting a record
+ *
+ * @return - seconds since the epoch, 0 if malformed
+ */
+static time_t parseTimestamp(const char *value_) {
+	struct tm tm_;
+	memset(&tm_, 0, sizeof(tm_));
+	if (sscanf(value_, "%2d/%2d/%4d %2d:%2d:%2d", &tm_.tm_mon, &tm_.tm_mday,
+			&tm_.tm_year, &tm_.tm_hour, &tm_.tm_min, &tm_.tm_sec) != 6)
+		return 0;
+	tm_.tm_mon -= 1;
+	tm_.tm_year -= 1900;
+	tm_.tm_isdst = -1;
+	return mktime(&tm_);
+}
+
+/**
+ * @brief - Tells whether name_ looks like a daily accounting file
+ *
+ * @return - true for eight digits
+ */
+static bool isDailyFile(const char *name_) {
+	size_t i = 0;
+	for (; name_[i] >= '0' && name_[i] <= '9'; i++)
+		;
+	return i == 8 && name_[i] == '\0';
+}
+
+AccountingLog::AccountingLog(const string& directory_,
+		const size_t maxRecords_) : _directory(directory_),
+		_maxRecords(maxRecords_), _inode(0), _offset(0), _available(false) {
+	pthread_mutex_init(&_mutex, NULL);
+}
+
+AccountingLog::~AccountingLog() {
+	pthread_mutex_destroy(&_mutex);
+}
+
+AccountingLog* AccountingLog::getInstance() {
+	pthread_mutex_lock(&_instMutex);
+	if (_instance == 0) {
+		const char *dir_ = getenv(ACCOUNTING_DIR_ENV);
+		string directory_(dir_ && *dir_ ? dir_ : "");
+		if (directory_.empty()) {
+			const char *home_ = getenv("PBS_HOME");
+			string pbsHome_(home_ && *home_ ? home_ : "");
+			if (pbsHome_.empty()) {
+				const char *conf_ = getenv(PBS_CONF_FILE_ENV);
+				ifstream in_(conf_ && *conf_ ? conf_ : PBS_CONF_FILE_DEFAULT);
+				string line_;
+				while (getline(in_, line_))
+					if (line_.compare(0, 9, "PBS_HOME=") == 0)
+						pbsHome_ = line_.substr(9);
+			}
+			directory_ = (pbsHome_.empty() ? string(PBS_HOME_DEFAULT) :
+					pbsHome_) + ACCOUNTING_SUBDIR;
+		}
+		_instance = new AccountingLog(directory_);
+	}
+	pthread_mutex_unlock(&_instMutex);
+	return _instance;
+}
+
+string AccountingLog::latestFile() {
+	string latest_;
+	DIR *dir_ = opendir(_directory.c_str());
+	_available = dir_ != NULL;
+	if (dir_ == NULL)
+		return latest_;
+	struct dirent *entry_;
+	while ((entry_ = readdir(dir_)) != NULL)
+		if (isDailyFile(entry_->d_name) && latest_ < entry_->d_name)
+			latest_ = entry_->d_name;
+	closedir(dir_);
+	return latest_;
+}
+
+size_t AccountingLog::readFile(bool& grown_) {
+	grown_ = false;
+	string path_(_directory + "/" + _file);
+	int fd_ = open(path_.c_str(), O_RDONLY);
+	if (fd_ < 0)
+		return 0;
+	struct stat st_;
+	if (fstat(fd_, &st_) != 0) {
+		close(fd_);
+		return 0;
+	}
+	if ((_inode != 0 && st_.st_ino != _inode) || st_.st_size < _offset)
+		_offset = 0; // Replaced or truncated, start over
+	_inode = st_.st_ino;
+	if (st_.st_size == _offset) {
+		close(fd_);
+		return 0;
+	}
+	off_t base_ = _offset - _offset % sysconf(_SC_PAGESIZE);
+	size_t length_ = st_.st_size - base_;
+	void *map_ = mmap(NULL, length_, PROT_READ, MAP_PRIVATE, fd_, base_);
+	close(fd_);
+	if (map_ == MAP_FAILED)
+		return 0;
+	const char *begin_ = static_cast<const char*>(map_) + (_offset - base_);
+	const char *end_ = static_cast<const char*>(map_) + length_;
+	// A line still being written is read on the next call
+	while (end_ > begin_ && end_[-1] != '\n')
+		end_--;
+	size_t records_ = parse(begin_, end_);
+	grown_ = end_ > begin_;
+	_offset += end_ - begin_;
+	munmap(map_, length_);
+	return records_;
+}
+
+size_t AccountingLog::parse(const char *begin_, const char *end_) {
+	size_t records_ = 0;
+	const char *line_ = begin_;
+	while (line_ < end_) {
+		const char *eol_ = static_cast<const char*>(memchr(line_, '\n',
+				end_ - line_));
+		// date time;type;id;message
+		const char *fields_[3];
+		const char *c = line_;
+		for (size_t i = 0; i < 3 && c < eol_; i++) {
+			c = static_cast<const char*>(memchr(c, ';', eol_ - c));
+			if (c == NULL) {
+				c = eol_;
+				break;
+			}
+			fields_[i] = ++c;
+		}
+		char type_ = c < eol_ && fields_[1] - fields_[0] == 2 ?
+				fields_[0][0] : '\0';
+		if (type_ == 'E' || type_ == 'D' || type_ == 'A') {
+			AccountingRecord record_;
+			// A queued job that is deleted or aborted never gets an E
+			// record, a running one still does and it replaces this one
+			if (type_ != 'E') {
+				record_.ended = false;
+				record_.finishTime = parseTimestamp(line_);
+			}
+			const char *token_ = fields_[2];
+			while (token_ < eol_) {
+				const char *tokenEnd_ = token_;
+				while (tokenEnd_ < eol_ && *tokenEnd_ != ' ')
+					tokenEnd_++;
+				const char *equal_ = static_cast<const char*>(memchr(token_,
+						'=', tokenEnd_ - token_));
+				if (equal_ != NULL) {
+					if (isKey(token_, equal_, "Exit_status"))
+						record_.exitStatus = parseNumber(equal_ + 1, tokenEnd_);
+					else if (isKey(token_, equal_, "end"))
+						record_.finishTime = parseNumber(equal_ + 1, tokenEnd_);
+					else if (isKey(token_, equal_, "resources_used.cput"))
+						record_.cpuTime = parseDuration(equal_ + 1, tokenEnd_);
+					else if (isKey(token_, equal_, "resources_used.walltime"))
+						record_.wallclockTime = parseDuration(equal_ + 1,
+								tokenEnd_);
+				}
+				token_ = tokenEnd_ + 1;
+			}
+			string jobId_(fields_[1], fields_[2] - 1);
+			map<string, AccountingRecord>::iterator known_ =
+					_records.find(jobId_);
+			if (known_ == _records.end()) {
+				_order.push_back(jobId_);
+				if (_order.size() > _maxRecords) {
+					_records.erase(_order.front());
+					_order.pop_front();
+				}
+				_records[jobId_] = record_;
+				records_++;
+			} else if (record_.ended || !known_->second.ended) {
+				known_->second = record_;
+				records_++;
+			}
+		}
+		line_ = eol_ + 1;
+	}
+	return records_;
+}
+
+size_t AccountingLog::refresh() {
+	pthread_mutex_lock(&_mutex);
+	size_t records_ = 0;
+	if (_file.empty())
+		_file = latestFile();
+	while (!_file.empty()) {
+		bool grown_;
+		records_ += readFile(grown_);
+		if (grown_)
+			break;
+		// Nothing new, the server may have moved on to the next day
+		string latest_(latestFile());
+		if (latest_ <= _file)
+			break;
+		_file = latest_;
+		_inode = 0;
+		_offset = 0;
+	}
+	pthread_mutex_unlock(&_mutex);
+	return records_;
+}
+
+bool AccountingLog::isAvailable() const {
+	pthread_mutex_lock(&_mutex);
+	bool available_ = _available;
+	pthread_mutex_unlock(&_mutex);
+	return available_;
+}
+
+bool AccountingLog::lookup(const string& jobId_,
+		AccountingRecord& record_) const {
+	pthread_mutex_lock(&_mutex);
+	map<string, AccountingRecord>::const_iterator it = _records.find(jobId_);
+	bool found_ = it != _records.end();
+	if (found_)
+		record_ = it->second;
+	pthread_mutex_unlock(&_mutex);
+	return found_;
+}
+}
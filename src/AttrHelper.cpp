@@ -109,6 +109,32 @@ char* AttrHelper::getAttribute(char* attrName_, char* attrVal_) {
 	return NULL;
 }
 
+void AttrHelper::mergeAttributes(const ATTRL* chain_) {
+	ATTRL *attr_, *attrTmp_;
+
+	for (; chain_ != NULL; chain_ = chain_->next) {
+		for (attrTmp_ = _attrList; attrTmp_; attrTmp_ = attrTmp_->next) {
+			if (strcmp(chain_->name, attrTmp_->name) == 0
+					&& (chain_->resource == NULL ? attrTmp_->resource == NULL
+							: attrTmp_->resource != NULL
+							&& strcmp(chain_->resource, attrTmp_->resource) == 0))
+				break;
+		}
+		if (attrTmp_ != NULL)
+			continue;
+		attr_ = createAttribute();
+		attr_->name = chain_->name;
+		attr_->resource = chain_->resource;
+		attr_->value = chain_->value;
+		attr_->op = chain_->op;
+		if (_attrList == NULL) {
+			_attrList = attr_;
+		} else {
+			ADD_NODE(_attrList,attr_);
+		}
+	}
+}
+
 void AttrHelper::setResource(char* resName_, char* resVal_) {
 	ATTRL *attr_;
 
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <CompletionQueue.h>
+#include <Message.h>
+#include <SourceInfo.h>
+#include <sys/eventfd.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <stdint.h>
+
+namespace drmaa2 {
+
+CompletionQueue::CompletionQueue() throw (OutOfResourceException) :
+		_outstanding(0) {
+	_eventFd = eventfd(0, EFD_NONBLOCK | EFD_SEMAPHORE | EFD_CLOEXEC);
+	if (_eventFd < 0)
+		throw OutOfResourceException(DRMAA2_SOURCEINFO(), Message(
+				OUT_OF_RESOURCE_SHORT, EVENTFD_FAILED));
+	pthread_mutex_init(&_queueMutex, NULL);
+	pthread_cond_init(&_queueCond, NULL);
+}
+
+CompletionQueue::~CompletionQueue() {
+	close(_eventFd);
+	pthread_cond_destroy(&_queueCond);
+	pthread_mutex_destroy(&_queueMutex);
+}
+
+int CompletionQueue::getFd() const {
+	return _eventFd;
+}
+
+void CompletionQueue::expect() {
+	pthread_mutex_lock(&_queueMutex);
+	_outstanding++;
+	pthread_mutex_unlock(&_queueMutex);
+}
+
+void CompletionQueue::push(void *entry_) {
+	uint64_t one_ = 1;
+	pthread_mutex_lock(&_queueMutex);
+	_entries.push_back(entry_);
+	_outstanding--;
+	if (write(_eventFd, &one_, sizeof(one_)) != sizeof(one_)) {
+		// Counter can only overflow after 2^64 entries, ignore
+	}
+	pthread_cond_broadcast(&_queueCond);
+	pthread_mutex_unlock(&_queueMutex);
+}
+
+void CompletionQueue::cancel() {
+	pthread_mutex_lock(&_queueMutex);
+	_outstanding--;
+	pthread_cond_broadcast(&_queueCond);
+	pthread_mutex_unlock(&_queueMutex);
+}
+
+void* CompletionQueue::popEntry() {
+	uint64_t count_ = 0;
+	if (_entries.empty())
+		return NULL;
+	void *entry_ = _entries.front();
+	_entries.pop_front();
+	if (read(_eventFd, &count_, sizeof(count_)) != sizeof(count_)) {
+		// Semaphore mode, each queued entry owns exactly one count
+	}
+	return entry_;
+}
+
+void* CompletionQueue::poll() {
+	pthread_mutex_lock(&_queueMutex);
+	void *entry_ = popEntry();
+	pthread_mutex_unlock(&_queueMutex);
+	return entry_;
+}
+
+void* CompletionQueue::wait(const TimeAmount timeout_) {
+	struct timeval now_;
+	struct timespec until_;
+	gettimeofday(&now_, NULL);
+	until_.tv_sec = now_.tv_sec + timeout_;
+	until_.tv_nsec = now_.tv_usec * 1000;
+	pthread_mutex_lock(&_queueMutex);
+	while (_entries.empty()) {
+		if (timeout_ < 0) {
+			pthread_cond_wait(&_queueCond, &_queueMutex);
+		} else if (pthread_cond_timedwait(&_queueCond, &_queueMutex, &until_)
+				!= 0) {
+			break;
+		}
+	}
+	void *entry_ = popEntry();
+	pthread_mutex_unlock(&_queueMutex);
+	return entry_;
+}
+
+void CompletionQueue::drain() {
+	pthread_mutex_lock(&_queueMutex);
+	while (_outstanding > 0)
+		pthread_cond_wait(&_queueCond, &_queueMutex);
+	pthread_mutex_unlock(&_queueMutex);
+}
+}
@@ -44,6 +44,7 @@ namespace drmaa2 {
 ConnectionPool* ConnectionPool::_instance = 0;
 pthread_mutex_t ConnectionPool::_instMutex = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t ConnectionPool::_connMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t ConnectionPool::_connCond = PTHREAD_COND_INITIALIZER;
 
 
 const Connection& ConnectionPool::getConnection() throw (InternalException) {
@@ -60,6 +61,22 @@ const Connection& ConnectionPool::getConnection() throw (InternalException) {
 			CON_NOT_AVAILABLE));
 }
 
+const Connection& ConnectionPool::waitConnection() throw (InternalException) {
+	pthread_mutex_lock(&ConnectionPool::_connMutex);
+	while(_freeConnections.size() == 0 && _usedConnections.size() > 0)
+		pthread_cond_wait(&ConnectionPool::_connCond, &ConnectionPool::_connMutex);
+	if(_freeConnections.size() > 0) {
+		Connection *cnHold_ = _freeConnections.front();
+		_usedConnections.push_back(cnHold_);
+		_freeConnections.pop_front();
+		pthread_mutex_unlock(&ConnectionPool::_connMutex);
+		return *cnHold_;
+	}
+	pthread_mutex_unlock(&ConnectionPool::_connMutex);
+	throw InternalException(DRMAA2_SOURCEINFO(), Message(INTERNAL_SHORT,
+			CON_NOT_AVAILABLE));
+}
+
 void ConnectionPool::addConnection(const Connection& object)
 		throw (ImplementationSpecificException, InternalException) {
 	pthread_mutex_lock(&ConnectionPool::_connMutex);
@@ -74,6 +91,7 @@ void ConnectionPool::addConnection(const Connection& object)
 			throw ;
 		}
 		_freeConnections.push_back(addObj_);
+		pthread_cond_signal(&ConnectionPool::_connCond);
 		pthread_mutex_unlock(&ConnectionPool::_connMutex);
 		return;
 	}
@@ -89,6 +107,7 @@ void ConnectionPool::returnConnection(const Connection& object) {
 			if(&object == *it) {
 				_freeConnections.push_back(*it);
 				_usedConnections.erase(it);
+				pthread_cond_signal(&ConnectionPool::_connCond);
 				break;
 			}
 		}
@@ -99,6 +118,12 @@ void ConnectionPool::returnConnection(const Connection& object) {
 void ConnectionPool::reconnectConnection(const Connection& object)
 		throw (ImplementationSpecificException, InternalException) {
 	pthread_mutex_lock(&ConnectionPool::_connMutex);
+	try {
+		// Release the broken descriptor, it may already be closed
+		const_cast<Connection&> (object).disconnect();
+	} catch (const Drmaa2Exception &ex) {
+		// Nothing to release
+	}
 	try {
 		// Since connect() is pure virtual function const object cannot work
 		// cast the object
@@ -137,6 +162,7 @@ void ConnectionPool::clearConnectionPool() {
 			_usedConnections.erase(it++);
 		}
 	}
+	pthread_cond_broadcast(&ConnectionPool::_connCond);
 	pthread_mutex_unlock(&ConnectionPool::_connMutex);
 }
 }
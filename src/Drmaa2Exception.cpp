@@ -36,6 +36,17 @@
  */
 
 #include <Drmaa2Exception.h>
+#include <DeniedByDrmsException.h>
+#include <DrmCommunicationException.h>
+#include <InternalException.h>
+#include <InvalidArgumentException.h>
+#include <InvalidSessionException.h>
+#include <InvalidStateException.h>
+#include <OutOfResourceException.h>
+#include <TimeoutException.h>
+#include <TryLaterException.h>
+#include <UnsupportedAttributeException.h>
+#include <UnsupportedOperationException.h>
 #include <sstream>
 
 namespace drmaa2 {
@@ -78,4 +89,30 @@ const char* Drmaa2Exception::what() const throw () {
 	return _whatInfo.c_str();
 }
 
+ErrorCode toErrorCode(const Drmaa2Exception &ex_) {
+	if (dynamic_cast<const DeniedByDrmsException*>(&ex_))
+		return ERROR_DENIED_BY_DRMS;
+	if (dynamic_cast<const DrmCommunicationException*>(&ex_))
+		return ERROR_DRM_COMMUNICATION;
+	if (dynamic_cast<const TryLaterException*>(&ex_))
+		return ERROR_TRY_LATER;
+	if (dynamic_cast<const TimeoutException*>(&ex_))
+		return ERROR_TIMEOUT;
+	if (dynamic_cast<const InternalException*>(&ex_))
+		return ERROR_INTERNAL;
+	if (dynamic_cast<const InvalidArgumentException*>(&ex_))
+		return ERROR_INVALID_ARGUMENT;
+	if (dynamic_cast<const InvalidSessionException*>(&ex_))
+		return ERROR_INVALID_SESSION;
+	if (dynamic_cast<const InvalidStateException*>(&ex_))
+		return ERROR_INVALID_STATE;
+	if (dynamic_cast<const OutOfResourceException*>(&ex_))
+		return ERROR_OUT_OF_RESOURCE;
+	if (dynamic_cast<const UnsupportedAttributeException*>(&ex_))
+		return ERROR_UNSUPPORTED_ATTRIBUTE;
+	if (dynamic_cast<const UnsupportedOperationException*>(&ex_))
+		return ERROR_UNSUPPORTED_OPERATION;
+	return ERROR_IMPLEMENTATION_SPECIFIC;
+}
+
 } /* namespace drmaa2 */
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <EnvironmentEncoder.h>
+
+namespace drmaa2 {
+
+EnvironmentEncoder::EnvironmentEncoder(const map<string, string>& base_) {
+	setBase(base_);
+}
+
+void EnvironmentEncoder::setBase(const map<string, string>& base_) {
+	_base = base_;
+	_encoded.clear();
+	encodeAll(_base, _encoded);
+}
+
+void EnvironmentEncoder::encode(const map<string, string>& environment_,
+		string& out_) const {
+	out_.assign(_encoded);
+	map<string, string>::const_iterator it = environment_.begin();
+	for (; it != environment_.end(); ++it) {
+		map<string, string>::const_iterator base_ = _base.find(it->first);
+		if (base_ == _base.end())
+			appendEntry(out_, it->first, it->second);
+		else if (base_->second != it->second)
+			break;
+	}
+	if (it == environment_.end())
+		return;
+
+	// A job overrides a base value, merge both sorted maps in one walk
+	out_.clear();
+	map<string, string>::const_iterator base_ = _base.begin();
+	it = environment_.begin();
+	while (base_ != _base.end() || it != environment_.end()) {
+		if (it == environment_.end()
+				|| (base_ != _base.end() && base_->first < it->first)) {
+			appendEntry(out_, base_->first, base_->second);
+			++base_;
+		} else {
+			if (base_ != _base.end() && base_->first == it->first)
+				++base_;
+			appendEntry(out_, it->first, it->second);
+			++it;
+		}
+	}
+}
+
+void EnvironmentEncoder::encodeAll(const map<string, string>& environment_,
+		string& out_) {
+	for (map<string, string>::const_iterator it = environment_.begin();
+			it != environment_.end(); ++it)
+		appendEntry(out_, it->first, it->second);
+}
+
+void EnvironmentEncoder::appendEntry(string& out_, const string& name_,
+		const string& value_) {
+	if (!out_.empty())
+		out_.push_back(',');
+	out_.append(name_);
+	out_.push_back('=');
+	size_t start_ = 0;
+	for (size_t i = 0; i < value_.size(); i++) {
+		if (value_[i] == ',' || value_[i] == '\\') {
+			out_.append(value_, start_, i - start_);
+			out_.push_back('\\');
+			start_ = i;
+		}
+	}
+	out_.append(value_, start_, string::npos);
+}
+}
@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <EventEngine.h>
+#include <ConnectionPool.h>
+#include <PBSProSystem.h>
+#include <Message.h>
+#include <SourceInfo.h>
+#include <sys/time.h>
+
+namespace drmaa2 {
+
+DrmaaCallback::~DrmaaCallback() {
+}
+
+EventQueue::EventQueue(const size_t depth_) : _depth(depth_) {
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_notEmpty, NULL);
+	pthread_cond_init(&_notFull, NULL);
+}
+
+EventQueue::~EventQueue() {
+	pthread_cond_destroy(&_notFull);
+	pthread_cond_destroy(&_notEmpty);
+	pthread_mutex_destroy(&_mutex);
+}
+
+void EventQueue::push(const DrmaaNotification& notification_) {
+	pair<string, int> key_(notification_.jobId, notification_.event);
+	pthread_mutex_lock(&_mutex);
+	map<pair<string, int>, list<DrmaaNotification>::iterator>::iterator it =
+			_index.find(key_);
+	if (it != _index.end()) {
+		// Not delivered yet, only the latest state is of interest
+		*it->second = notification_;
+		pthread_mutex_unlock(&_mutex);
+		return;
+	}
+	while (_events.size() >= _depth)
+		pthread_cond_wait(&_notFull, &_mutex);
+	_index[key_] = _events.insert(_events.end(), notification_);
+	pthread_cond_signal(&_notEmpty);
+	pthread_mutex_unlock(&_mutex);
+}
+
+DrmaaNotification EventQueue::pop() {
+	pthread_mutex_lock(&_mutex);
+	while (_events.empty())
+		pthread_cond_wait(&_notEmpty, &_mutex);
+	DrmaaNotification notification_ = _events.front();
+	_index.erase(pair<string, int>(notification_.jobId, notification_.event));
+	_events.pop_front();
+	pthread_cond_signal(&_notFull);
+	pthread_mutex_unlock(&_mutex);
+	return notification_;
+}
+
+EventEngine* EventEngine::_instance = 0;
+pthread_mutex_t EventEngine::_instMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t EventEngine::_sessionMutex = PTHREAD_MUTEX_INITIALIZER;
+map<string, string> EventEngine::_sessions;
+list<string> EventEngine::_sessionOrder;
+
+EventEngine::EventEngine() : _callback(NULL), _baseline(false),
+		_started(false) {
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_cond, NULL);
+	pthread_cond_init(&_delivered, NULL);
+	pthread_t thread_;
+	for (size_t i = 0; i < EVENT_CALLBACK_THREADS; i++) {
+		EventQueue *queue_ = new EventQueue(EVENT_QUEUE_DEPTH);
+		if (pthread_create(&thread_, NULL, &EventEngine::deliveryMain,
+				queue_) != 0) {
+			delete queue_;
+			break;
+		}
+		pthread_detach(thread_);
+		_queues.push_back(queue_);
+	}
+	if (!_queues.empty() && pthread_create(&thread_, NULL,
+			&EventEngine::pollerMain, this) == 0) {
+		pthread_detach(thread_);
+		_started = true;
+	}
+}
+
+void* EventEngine::pollerMain(void *arg_) {
+	static_cast<EventEngine*>(arg_)->poll();
+	return NULL;
+}
+
+void* EventEngine::deliveryMain(void *arg_) {
+	EventQueue *queue_ = static_cast<EventQueue*>(arg_);
+	for (;;) {
+		DrmaaNotification notification_ = queue_->pop();
+		EventEngine::getInstance()->deliver(notification_);
+	}
+	return NULL;
+}
+
+void EventEngine::deliver(const DrmaaNotification& notification_) {
+	pthread_mutex_lock(&_mutex);
+	DrmaaCallback *callback_ = _callback;
+	if (callback_ == NULL) {
+		pthread_mutex_unlock(&_mutex);
+		return;
+	}
+	list<pair<pthread_t, DrmaaCallback*> >::iterator self_ = _delivering.insert(
+			_delivering.end(), make_pair(pthread_self(), callback_));
+	pthread_mutex_unlock(&_mutex);
+	try {
+		callback_->notify(notification_);
+	} catch (...) {
+		// Callbacks report their own failures, never let one kill delivery
+	}
+	pthread_mutex_lock(&_mutex);
+	_delivering.erase(self_);
+	pthread_cond_broadcast(&_delivered);
+	pthread_mutex_unlock(&_mutex);
+}
+
+void EventEngine::emit(const DrmaaEvent event_, const string& jobId_,
+		const JobState state_) {
+	DrmaaNotification notification_;
+	notification_.event = event_;
+	notification_.jobId = jobId_;
+	notification_.jobState = state_;
+	pthread_mutex_lock(&_sessionMutex);
+	map<string, string>::iterator session_ = _sessions.find(jobId_);
+	if (session_ != _sessions.end())
+		notification_.sessionName = session_->second;
+	pthread_mutex_unlock(&_sessionMutex);
+	unsigned long hash_ = 0;
+	for (size_t i = 0; i < jobId_.size(); i++)
+		hash_ = hash_ * 31 + (unsigned char) jobId_[i];
+	_queues[hash_ % _queues.size()]->push(notification_);
+}
+
+void EventEngine::diff(const map<string, JobSnapshot>& snapshot_) {
+	// Both snapshots are ordered by job id, walk them side by side
+	map<string, JobSnapshot>::const_iterator old_ = _snapshot.begin();
+	map<string, JobSnapshot>::const_iterator new_ = snapshot_.begin();
+	while (old_ != _snapshot.end() || new_ != snapshot_.end()) {
+		if (new_ == snapshot_.end() || (old_ != _snapshot.end()
+				&& old_->first < new_->first)) {
+			// Purged by the DRMS, unknown how it ended unless seen before
+			if (old_->second.state != DONE && old_->second.state != FAILED)
+				emit(NEW_STATE, old_->first, UNDETERMINED);
+			++old_;
+		} else if (old_ == _snapshot.end() || new_->first < old_->first) {
+			emit(NEW_STATE, new_->first, new_->second.state);
+			++new_;
+		} else {
+			if (old_->second.state != new_->second.state)
+				emit(NEW_STATE, new_->first, new_->second.state);
+			if (old_->second.digest != new_->second.digest)
+				emit(ATTRIBUTE_CHANGE, new_->first, new_->second.state);
+			++old_;
+			++new_;
+		}
+	}
+}
+
+void EventEngine::poll() {
+	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	pthread_mutex_lock(&_mutex);
+	for (;;) {
+		while (_callback == NULL) {
+			_baseline = false;
+			_snapshot.clear();
+			pthread_cond_wait(&_cond, &_mutex);
+		}
+		pthread_mutex_unlock(&_mutex);
+		map<string, JobSnapshot> snapshot_;
+		bool taken_ = true;
+		try {
+			const Connection &conn_ =
+					ConnectionPool::getInstance()->waitConnection();
+			try {
+				drms->getUserJobSnapshots(conn_, snapshot_);
+			} catch (const Drmaa2Exception &ex) {
+				ConnectionPool::getInstance()->returnConnection(conn_);
+				throw ;
+			}
+			ConnectionPool::getInstance()->returnConnection(conn_);
+		} catch (const Drmaa2Exception &ex) {
+			// Keep the previous snapshot, the next one catches up
+			taken_ = false;
+		}
+		// Only this thread touches the snapshots, emit() may block on a
+		// full queue without holding _mutex
+		if (taken_ && _baseline)
+			diff(snapshot_);
+		if (taken_) {
+			_snapshot.swap(snapshot_);
+			_baseline = true;
+		}
+		pthread_mutex_lock(&_mutex);
+		if (_callback == NULL)
+			continue;
+		struct timeval now_;
+		struct timespec until_;
+		gettimeofday(&now_, NULL);
+		long usec_ = now_.tv_usec + (EVENT_POLL_MS % 1000) * 1000;
+		until_.tv_sec = now_.tv_sec + EVENT_POLL_MS / 1000 + usec_ / 1000000;
+		until_.tv_nsec = (usec_ % 1000000) * 1000;
+		pthread_cond_timedwait(&_cond, &_mutex, &until_);
+	}
+}
+
+void EventEngine::setCallback(DrmaaCallback *callback_)
+		throw (OutOfResourceException) {
+	pthread_mutex_lock(&_mutex);
+	if (!_started && callback_ != NULL) {
+		pthread_mutex_unlock(&_mutex);
+		throw OutOfResourceException(DRMAA2_SOURCEINFO(), Message(
+				OUT_OF_RESOURCE_SHORT, EVENT_ENGINE_START_FAILED));
+	}
+	DrmaaCallback *previous_ = _callback;
+	bool idle_ = _callback == NULL;
+	_callback = callback_;
+	if (idle_ && _callback != NULL)
+		pthread_cond_signal(&_cond);
+	// A notify of the previous callback calling here must not wait for
+	// itself
+	for (;;) {
+		bool running_ = false;
+		for (list<pair<pthread_t, DrmaaCallback*> >::iterator it =
+				_delivering.begin(); it != _delivering.end(); ++it)
+			if (it->second == previous_ && it->second != callback_
+					&& !pthread_equal(it->first, pthread_self()))
+				running_ = true;
+		if (!running_)
+			break;
+		pthread_cond_wait(&_delivered, &_mutex);
+	}
+	pthread_mutex_unlock(&_mutex);
+}
+
+void EventEngine::recordSession(const string& jobId_,
+		const string& sessionName_) {
+	pthread_mutex_lock(&_sessionMutex);
+	if (_sessions.insert(make_pair(jobId_, sessionName_)).second) {
+		_sessionOrder.push_back(jobId_);
+		while (_sessionOrder.size() > EVENT_MAX_SESSION_JOBS) {
+			_sessions.erase(_sessionOrder.front());
+			_sessionOrder.pop_front();
+		}
+	}
+	pthread_mutex_unlock(&_sessionMutex);
+}
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+#include <JobAlterationAttrHelper.h>
+#include <sstream>
+
+namespace drmaa2 {
+
+ATTRL* JobAlterationAttrHelper::parseTemplate(void* template_) {
+	if(template_ == NULL)
+		return _attrList;
+	JobAlteration &alteration_ = *static_cast<JobAlteration *>(template_);
+	if(!alteration_.jobName.empty()) {
+		setAttribute((char *) ATTR_N, (char *) alteration_.jobName.c_str());
+	}
+	if(alteration_.alterPriority) {
+		stringstream stream_;
+		stream_ << alteration_.priority;
+		_priority.assign(stream_.str());
+		setAttribute((char *) ATTR_p, (char *) _priority.c_str());
+	}
+	if(!alteration_.holdTypes.empty()) {
+		setAttribute((char *) ATTR_h, (char *) alteration_.holdTypes.c_str());
+	}
+	for(map<string, string>::iterator it = alteration_.resourceLimits.begin();
+			it != alteration_.resourceLimits.end(); ++it) {
+		// DRMAA2 limit names are translated, anything else is a PBS resource
+		if(it->first == DRMAA2_WALLCLOCK_TIME)
+			setResource((char *) WALLTIME, (char *) it->second.c_str());
+		else if(it->first == DRMAA2_CPU_TIME)
+			setResource((char *) CPUTIME, (char *) it->second.c_str());
+		else if(it->first == DRMAA2_VIRTUAL_MEMORY)
+			setResource((char *) VMEM, (char *) it->second.c_str());
+		else
+			setResource((char *) it->first.c_str(), (char *) it->second.c_str());
+	}
+	return _attrList;
+}
+
+}
@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <JobArchive.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace drmaa2 {
+
+JobArchive* JobArchive::_instance = 0;
+pthread_mutex_t JobArchive::_instMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief - Appends value_ escaping backslash, tab and newline
+ */
+static void archiveEscape(string& out_, const string& value_) {
+	for (size_t i = 0; i < value_.size(); i++) {
+		switch (value_[i]) {
+		case '\\':
+			out_.append("\\\\");
+			break;
+		case '\t':
+			out_.append("\\t");
+			break;
+		case '\n':
+			out_.append("\\n");
+			break;
+		default:
+			out_.push_back(value_[i]);
+		}
+	}
+}
+
+/**
+ * @brief - Splits a record line at the tabs and reverts archiveEscape
+ *
+ * @param[in] begin_ - first byte of the line
+ * @param[in] end_ - the newline ending the line
+ *
+ * @return - fields of the record
+ */
+static vector<string> archiveSplit(const char *begin_, const char *end_) {
+	vector<string> fields_(1);
+	for (const char *c = begin_; c < end_; c++) {
+		if (*c == '\t') {
+			fields_.push_back(string());
+		} else if (*c == '\\' && c + 1 < end_) {
+			c++;
+			fields_.back().push_back(*c == 't' ? '\t' :
+					(*c == 'n' ? '\n' : *c));
+		} else {
+			fields_.back().push_back(*c);
+		}
+	}
+	return fields_;
+}
+
+/**
+ * @brief - Appends a field and its separating tab
+ */
+static void archiveField(string& out_, const string& value_) {
+	archiveEscape(out_, value_);
+	out_.push_back('\t');
+}
+
+/**
+ * @brief - Appends a numeric field and its separating tab
+ */
+static void archiveField(string& out_, const long long value_) {
+	stringstream strm_;
+	strm_ << value_;
+	archiveField(out_, strm_.str());
+}
+
+/**
+ * @brief - Columns of a record line, in order
+ */
+enum ArchiveColumn {
+	COL_JOB_ID, COL_STATE, COL_EXIT_STATUS, COL_OWNER, COL_QUEUE,
+	COL_SUBMISSION_TIME, COL_DISPATCH_TIME, COL_FINISH_TIME,
+	COL_WALLCLOCK_TIME, COL_CPU_TIME, COL_SLOTS, COL_SUB_STATE, COL_SIGNAL,
+	COL_ANNOTATION, COL_SUBMISSION_MACHINE, COL_MACHINES, COL_COUNT
+};
+
+/**
+ * @brief - Encodes info_ as one record line
+ */
+static string archiveEncode(const JobInfo& info_) {
+	string line_, machines_;
+	for (size_t i = 0; i < info_.allocatedMachines.size(); i++) {
+		if (i > 0)
+			machines_.push_back('+');
+		machines_.append(info_.allocatedMachines[i]);
+	}
+	archiveField(line_, info_.jobId);
+	archiveField(line_, (long long) info_.jobState);
+	archiveField(line_, (long long) info_.exitStatus);
+	archiveField(line_, info_.jobOwner);
+	archiveField(line_, info_.queueName);
+	archiveField(line_, (long long) info_.submissionTime);
+	archiveField(line_, (long long) info_.dispatchTime);
+	archiveField(line_, (long long) info_.finishTime);
+	archiveField(line_, (long long) info_.wallclockTime);
+	archiveField(line_, (long long) info_.cpuTime);
+	archiveField(line_, (long long) info_.slots);
+	archiveField(line_, info_.jobSubState);
+	archiveField(line_, info_.terminatingSignal);
+	archiveField(line_, info_.annotation);
+	archiveField(line_, info_.submissionMachine);
+	archiveEscape(line_, machines_);
+	line_.push_back('\n');
+	return line_;
+}
+
+/**
+ * @brief - Decodes a record line split by archiveSplit
+ *
+ * @return - false if the line is not a complete record
+ */
+static bool archiveDecode(const vector<string>& fields_, JobInfo& info_) {
+	if (fields_.size() != COL_COUNT || fields_[COL_JOB_ID].empty())
+		return false;
+	info_.jobId = fields_[COL_JOB_ID];
+	info_.jobState = (JobState) atol(fields_[COL_STATE].c_str());
+	info_.exitStatus = atol(fields_[COL_EXIT_STATUS].c_str());
+	info_.jobOwner = fields_[COL_OWNER];
+	info_.queueName = fields_[COL_QUEUE];
+	info_.submissionTime = (time_t) atoll(fields_[COL_SUBMISSION_TIME].c_str());
+	info_.dispatchTime = (time_t) atoll(fields_[COL_DISPATCH_TIME].c_str());
+	info_.finishTime = (time_t) atoll(fields_[COL_FINISH_TIME].c_str());
+	info_.wallclockTime = (time_t) atoll(fields_[COL_WALLCLOCK_TIME].c_str());
+	info_.cpuTime = atol(fields_[COL_CPU_TIME].c_str());
+	info_.slots = atol(fields_[COL_SLOTS].c_str());
+	info_.jobSubState = fields_[COL_SUB_STATE];
+	info_.terminatingSignal = fields_[COL_SIGNAL];
+	info_.annotation = fields_[COL_ANNOTATION];
+	info_.submissionMachine = fields_[COL_SUBMISSION_MACHINE];
+	info_.allocatedMachines.clear();
+	const string &machines_ = fields_[COL_MACHINES];
+	size_t start_ = 0;
+	while (start_ < machines_.size()) {
+		size_t plus_ = machines_.find('+', start_);
+		if (plus_ == string::npos)
+			plus_ = machines_.size();
+		info_.allocatedMachines.push_back(machines_.substr(start_,
+				plus_ - start_));
+		start_ = plus_ + 1;
+	}
+	return true;
+}
+
+JobArchive::JobArchive(const string& directory_) : _directory(directory_),
+		_segmentRecords(0) {
+	pthread_mutex_init(&_mutex, NULL);
+	if (!_directory.empty())
+		load();
+}
+
+JobArchive::~JobArchive() {
+	for (size_t i = 0; i < _segments.size(); i++)
+		if (_segments[i] >= 0)
+			close(_segments[i]);
+	pthread_mutex_destroy(&_mutex);
+}
+
+JobArchive* JobArchive::getInstance() {
+	pthread_mutex_lock(&_instMutex);
+	if (_instance == 0) {
+		const char *dir_ = getenv(JOB_ARCHIVE_ENV);
+		_instance = new JobArchive(dir_ ? dir_ : "");
+	}
+	pthread_mutex_unlock(&_instMutex);
+	return _instance;
+}
+
+size_t JobArchive::intern(const string& name_) {
+	map<string, size_t>::iterator it = _nameIndex.find(name_);
+	if (it != _nameIndex.end())
+		return it->second;
+	_names.push_back(name_);
+	_nameIndex[name_] = _names.size() - 1;
+	return _names.size() - 1;
+}
+
+void JobArchive::index(const JobInfo& info_, const size_t segment_,
+		const off_t offset_, const size_t length_) {
+	ArchiveEntry entry_;
+	entry_.owner = intern(info_.jobOwner);
+	entry_.queue = intern(info_.queueName);
+	entry_.state = info_.jobState;
+	entry_.finishTime = info_.finishTime;
+	entry_.segment = segment_;
+	entry_.offset = offset_;
+	entry_.length = length_;
+	size_t position_ = _entries.size();
+	_entries.push_back(entry_);
+	_byId[info_.jobId] = position_;
+	_byOwner[entry_.owner].push_back(position_);
+	_byQueue[entry_.queue].push_back(position_);
+	_byFinish.insert(pair<time_t, size_t>(entry_.finishTime, position_));
+}
+
+int JobArchive::openSegment(const size_t segment_) const {
+	char name_[32];
+	snprintf(name_, sizeof(name_), ARCHIVE_SEGMENT_PREFIX "%06lu",
+			(unsigned long) segment_);
+	return open((_directory + "/" + name_).c_str(),
+			O_RDWR | O_APPEND | O_CREAT, 0600);
+}
+
+void JobArchive::load() {
+	struct stat st_;
+	if (stat(_directory.c_str(), &st_) != 0 || !S_ISDIR(st_.st_mode))
+		return;
+	for (size_t segment_ = 0;; segment_++) {
+		char name_[32];
+		snprintf(name_, sizeof(name_), ARCHIVE_SEGMENT_PREFIX "%06lu",
+				(unsigned long) segment_);
+		string path_(_directory + "/" + name_);
+		if (stat(path_.c_str(), &st_) != 0)
+			break;
+		int fd_ = openSegment(segment_);
+		if (fd_ < 0)
+			break;
+		_segments.push_back(fd_);
+		string data_((size_t) st_.st_size, '\0');
+		ssize_t read_ = pread(fd_, &data_[0], data_.size(), 0);
+		if (read_ < 0)
+			read_ = 0;
+		_segmentRecords = 0;
+		const char *begin_ = data_.data(), *end_ = begin_ + read_;
+		const char *line_ = begin_;
+		while (line_ < end_) {
+			const char *eol_ = static_cast<const char*>(memchr(line_, '\n',
+					end_ - line_));
+			if (eol_ == NULL) {
+				// Torn by a crash, new records go to a fresh segment
+				_segmentRecords = ARCHIVE_SEGMENT_RECORDS;
+				break;
+			}
+			JobInfo info_;
+			if (archiveDecode(archiveSplit(line_, eol_), info_)
+					&& _byId.find(info_.jobId) == _byId.end())
+				index(info_, segment_, line_ - begin_, eol_ + 1 - line_);
+			_segmentRecords++;
+			line_ = eol_ + 1;
+		}
+	}
+	if (_segments.empty()) {
+		// Probe that the directory takes new segments
+		int fd_ = openSegment(0);
+		if (fd_ >= 0)
+			_segments.push_back(fd_);
+	}
+}
+
+bool JobArchive::read(const ArchiveEntry& entry_, JobInfo& info_) const {
+	string line_(entry_.length, '\0');
+	ssize_t read_ = pread(_segments[entry_.segment], &line_[0], entry_.length,
+			entry_.offset);
+	if (read_ != (ssize_t) entry_.length || line_[entry_.length - 1] != '\n')
+		return false;
+	const char *begin_ = line_.data();
+	return archiveDecode(archiveSplit(begin_, begin_ + entry_.length - 1),
+			info_);
+}
+
+bool JobArchive::isEnabled() const {
+	pthread_mutex_lock(&_mutex);
+	bool enabled_ = !_segments.empty();
+	pthread_mutex_unlock(&_mutex);
+	return enabled_;
+}
+
+bool JobArchive::isArchived(const string& jobId_) const {
+	pthread_mutex_lock(&_mutex);
+	bool archived_ = _byId.find(jobId_) != _byId.end();
+	pthread_mutex_unlock(&_mutex);
+	return archived_;
+}
+
+void JobArchive::add(const JobInfo& info_) {
+	if ((info_.jobState != DONE && info_.jobState != FAILED)
+			|| info_.jobId.empty())
+		return;
+	string line_(archiveEncode(info_));
+	pthread_mutex_lock(&_mutex);
+	if (_segments.empty() || _byId.find(info_.jobId) != _byId.end()) {
+		pthread_mutex_unlock(&_mutex);
+		return;
+	}
+	if (_segmentRecords >= ARCHIVE_SEGMENT_RECORDS) {
+		int fd_ = openSegment(_segments.size());
+		if (fd_ < 0) {
+			pthread_mutex_unlock(&_mutex);
+			return;
+		}
+		_segments.push_back(fd_);
+		_segmentRecords = 0;
+	}
+	int fd_ = _segments.back();
+	off_t offset_ = lseek(fd_, 0, SEEK_END);
+	size_t done_ = 0;
+	while (offset_ >= 0 && done_ < line_.size()) {
+		ssize_t written_ = write(fd_, line_.data() + done_,
+				line_.size() - done_);
+		if (written_ < 0 && errno == EINTR)
+			continue;
+		if (written_ < 0)
+			break;
+		done_ += written_;
+	}
+	if (offset_ >= 0 && done_ == line_.size()) {
+		index(info_, _segments.size() - 1, offset_, line_.size());
+		_segmentRecords++;
+	} else {
+		// A partial line would glue onto the next one
+		_segmentRecords = ARCHIVE_SEGMENT_RECORDS;
+	}
+	pthread_mutex_unlock(&_mutex);
+}
+
+bool JobArchive::lookup(const string& jobId_, JobInfo& info_) const {
+	pthread_mutex_lock(&_mutex);
+	map<string, size_t>::const_iterator it = _byId.find(jobId_);
+	bool found_ = it != _byId.end() && read(_entries[it->second], info_);
+	pthread_mutex_unlock(&_mutex);
+	return found_;
+}
+
+JobInfoList JobArchive::find(const JobInfo& filter_,
+		const time_t finishedAfter_) const {
+	JobInfoList found_;
+	pthread_mutex_lock(&_mutex);
+	vector<size_t> candidates_;
+	const vector<size_t> *posting_ = NULL;
+	if (!filter_.jobId.empty()) {
+		map<string, size_t>::const_iterator it = _byId.find(filter_.jobId);
+		if (it != _byId.end())
+			candidates_.push_back(it->second);
+	} else if (!filter_.jobOwner.empty() || !filter_.queueName.empty()) {
+		// Walk the shorter posting list, the other column is checked
+		static const vector<size_t> none_;
+		const vector<size_t> *owner_ = NULL, *queue_ = NULL;
+		map<string, size_t>::const_iterator name_;
+		if (!filter_.jobOwner.empty()) {
+			// Owners and queues share the name table, a known name may
+			// have no posting list of this kind
+			name_ = _nameIndex.find(filter_.jobOwner);
+			map<size_t, vector<size_t> >::const_iterator it = name_
+					== _nameIndex.end() ? _byOwner.end() :
+					_byOwner.find(name_->second);
+			owner_ = it == _byOwner.end() ? &none_ : &it->second;
+		}
+		if (!filter_.queueName.empty()) {
+			name_ = _nameIndex.find(filter_.queueName);
+			map<size_t, vector<size_t> >::const_iterator it = name_
+					== _nameIndex.end() ? _byQueue.end() :
+					_byQueue.find(name_->second);
+			queue_ = it == _byQueue.end() ? &none_ : &it->second;
+		}
+		posting_ = owner_ == NULL || (queue_ != NULL
+				&& queue_->size() < owner_->size()) ? queue_ : owner_;
+	} else {
+		multimap<time_t, size_t>::const_iterator it =
+				_byFinish.lower_bound(finishedAfter_);
+		multimap<time_t, size_t>::const_iterator end_ = filter_.finishTime
+				== 0 ? _byFinish.end() : _byFinish.upper_bound(
+				filter_.finishTime);
+		for (; it != end_; ++it)
+			candidates_.push_back(it->second);
+	}
+	if (posting_ != NULL)
+		candidates_ = *posting_;
+	vector<pair<time_t, size_t> > matches_;
+	for (size_t i = 0; i < candidates_.size(); i++) {
+		const ArchiveEntry &entry_ = _entries[candidates_[i]];
+		if (entry_.state != filter_.jobState
+				|| (!filter_.jobOwner.empty()
+						&& _names[entry_.owner] != filter_.jobOwner)
+				|| (!filter_.queueName.empty()
+						&& _names[entry_.queue] != filter_.queueName)
+				|| (filter_.finishTime != 0
+						&& entry_.finishTime > filter_.finishTime)
+				|| entry_.finishTime < finishedAfter_)
+			continue;
+		matches_.push_back(pair<time_t, size_t>(entry_.finishTime,
+				candidates_[i]));
+	}
+	if (posting_ != NULL)
+		stable_sort(matches_.begin(), matches_.end());
+	for (size_t i = 0; i < matches_.size(); i++) {
+		JobInfo info_;
+		if (!read(_entries[matches_[i].second], info_))
+			continue;
+		if (!filter_.annotation.empty()
+				&& info_.annotation != filter_.annotation)
+			continue;
+		found_.push_back(info_);
+	}
+	pthread_mutex_unlock(&_mutex);
+	return found_;
+}
+
+bool JobArchive::matchesFinished(const JobInfo& filter_) {
+	return filter_.jobState == DONE || filter_.jobState == FAILED;
+}
+}
@@ -41,7 +41,10 @@
 #include <JobTemplateAttrHelper.h>
 #include <Drmaa2Exception.h>
 #include <JobImpl.h>
+#include <JobSessionImpl.h>
+#include <UnsupportedOperationException.h>
 #include <stdlib.h>
+#include <sstream>
 #include <pbs_ifl.h>
 
 namespace drmaa2 {
@@ -49,6 +52,15 @@ namespace drmaa2 {
 JobArrayImpl::~JobArrayImpl() {
 	// TODO Auto-generated destructor stub
 }
+void JobArrayImpl::addWindow(const string& jobArrayId_, const long firstIndex_) {
+	_windows.push_back(jobArrayId_);
+	_windowStarts.push_back(firstIndex_);
+}
+
+const list<string>& JobArrayImpl::getWindows(void) const {
+	return _windows;
+}
+
 const string& JobArrayImpl::getJobArrayId(void) const {
 	return _jobId;
 }
@@ -69,6 +81,11 @@ const JobTemplate& JobArrayImpl::getJobTemplate(void) const {
 void JobArrayImpl::suspend(void) const {
 	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->getConnection();
 	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	for (list<string>::const_reverse_iterator it = _windows.rbegin();
+			it != _windows.rend(); ++it) {
+		JobArrayImpl window_(*it);
+		drms->suspend(pbsConnPoolObj_, window_);
+	}
 	drms->suspend(pbsConnPoolObj_, *this);
 	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
 }
@@ -76,6 +93,11 @@ void JobArrayImpl::suspend(void) const {
 void JobArrayImpl::resume(void) const {
 	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->getConnection();
 	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	for (list<string>::const_reverse_iterator it = _windows.rbegin();
+			it != _windows.rend(); ++it) {
+		JobArrayImpl window_(*it);
+		drms->resume(pbsConnPoolObj_, window_);
+	}
 	drms->resume(pbsConnPoolObj_, *this);
 	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
 }
@@ -83,6 +105,11 @@ void JobArrayImpl::resume(void) const {
 void JobArrayImpl::hold(void) const {
 	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->getConnection();
 	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	for (list<string>::const_reverse_iterator it = _windows.rbegin();
+			it != _windows.rend(); ++it) {
+		JobArrayImpl window_(*it);
+		drms->hold(pbsConnPoolObj_, window_);
+	}
 	drms->hold(pbsConnPoolObj_, *this);
 	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
 }
@@ -90,6 +117,11 @@ void JobArrayImpl::hold(void) const {
 void JobArrayImpl::release(void) const {
 	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->getConnection();
 	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	for (list<string>::const_reverse_iterator it = _windows.rbegin();
+			it != _windows.rend(); ++it) {
+		JobArrayImpl window_(*it);
+		drms->release(pbsConnPoolObj_, window_);
+	}
 	drms->release(pbsConnPoolObj_, *this);
 	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
 }
@@ -97,10 +129,92 @@ void JobArrayImpl::release(void) const {
 void JobArrayImpl::terminate(void) const {
 	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->getConnection();
 	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	// Later windows first, so a terminated window never starts the next
+	for (list<string>::const_reverse_iterator it = _windows.rbegin();
+			it != _windows.rend(); ++it) {
+		JobArrayImpl window_(*it);
+		drms->terminate(pbsConnPoolObj_, window_);
+	}
 	drms->terminate(pbsConnPoolObj_, *this);
 	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
 }
 
+void JobArrayImpl::compressIndices(set<long>::const_iterator first_,
+		set<long>::const_iterator last_, list<string>& ranges_) {
+	vector<long> indices_(first_, last_);
+	size_t count_ = indices_.size();
+	for (size_t i = 0; i < count_;) {
+		size_t end_ = i + 1;
+		long step_ = 0;
+		if (end_ < count_) {
+			step_ = indices_[end_] - indices_[i];
+			while (end_ + 1 < count_ && indices_[end_ + 1] - indices_[end_] == step_)
+				end_++;
+			// Two indices only form a range when they are consecutive
+			if (end_ - i < 2 && step_ != 1)
+				end_ = i;
+		} else {
+			end_ = i;
+		}
+		stringstream range_;
+		range_ << indices_[i];
+		if (end_ > i) {
+			range_ << "-" << indices_[end_];
+			if (step_ != 1)
+				range_ << ":" << step_;
+		}
+		ranges_.push_back(range_.str());
+		i = end_ + 1;
+	}
+}
+
+/**
+ * @brief - Returns the id of the sub jobs range_ of the array jobArrayId_
+ *
+ * @param[in] jobArrayId_ - array id, "123[].server"
+ * @param[in] range_ - range expression
+ *
+ * @return - sub jobs id, "123[range_].server"
+ */
+static string subJobsId(const string& jobArrayId_, const string& range_) {
+	string jobId_(jobArrayId_);
+	size_t open_ = jobId_.find('[');
+	if (open_ == string::npos)
+		return jobId_;
+	size_t close_ = jobId_.find(']', open_);
+	jobId_.replace(open_ + 1, close_ == string::npos ? 0 : close_ - open_ - 1,
+			range_);
+	return jobId_;
+}
+
+vector<JobOperationResult> JobArrayImpl::controlIndices(
+		const set<long>& indices_, const JobOperation operation_) const {
+	if (operation_ == HOLD_JOB || operation_ == RELEASE_JOB)
+		throw UnsupportedOperationException(DRMAA2_SOURCEINFO());
+	// Windows cover ascending index ranges, the array itself the lowest one
+	list<string> arrayIds_(1, _jobId);
+	arrayIds_.insert(arrayIds_.end(), _windows.begin(), _windows.end());
+	list<long>::const_iterator start_ = _windowStarts.begin();
+	set<long>::const_iterator first_ = indices_.begin();
+	vector<JobOperationResult> results_;
+	for (list<string>::const_iterator it = arrayIds_.begin();
+			it != arrayIds_.end(); ++it) {
+		set<long>::const_iterator last_ = indices_.end();
+		if (start_ != _windowStarts.end())
+			last_ = indices_.lower_bound(*start_++);
+		list<string> ranges_;
+		compressIndices(first_, last_, ranges_);
+		for (list<string>::iterator range_ = ranges_.begin();
+				range_ != ranges_.end(); ++range_) {
+			results_.push_back(JobOperationResult());
+			results_.back().jobId = subJobsId(*it, *range_);
+		}
+		first_ = last_;
+	}
+	controlJobIds(operation_, results_);
+	return results_;
+}
+
 void JobArrayImpl::reap(void) const {
 
 }
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <JobCategories.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace drmaa2 {
+
+JobCategories* JobCategories::_instance = 0;
+pthread_mutex_t JobCategories::_instMutex = PTHREAD_MUTEX_INITIALIZER;
+
+void JobCategory::add(const string& name_, const string& resource_,
+		const string& value_) {
+	_text.push_back(value_);
+	char *value = const_cast<char*>(_text.back().c_str());
+	for (list<ATTRL>::iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
+		if (name_ == it->name && (it->resource ? resource_ == it->resource
+				: resource_.empty())) {
+			it->value = value;
+			return;
+		}
+	}
+	ATTRL node_;
+	node_.next = NULL;
+	_text.push_back(name_);
+	node_.name = const_cast<char*>(_text.back().c_str());
+	node_.resource = NULL;
+	if (!resource_.empty()) {
+		_text.push_back(resource_);
+		node_.resource = const_cast<char*>(_text.back().c_str());
+	}
+	node_.value = value;
+	node_.op = SET;
+	_nodes.push_back(node_);
+	if (_nodes.size() > 1)
+		(++_nodes.rbegin())->next = &_nodes.back();
+}
+
+/**
+ * @brief - Strips leading and trailing white space
+ *
+ * @param[in] text_ - text to trim
+ *
+ * @return - trimmed text
+ */
+static string trimCategoryText(const string& text_) {
+	size_t begin_ = text_.find_first_not_of(" \t\r");
+	if (begin_ == string::npos)
+		return string();
+	size_t end_ = text_.find_last_not_of(" \t\r");
+	return text_.substr(begin_, end_ - begin_ + 1);
+}
+
+JobCategories::JobCategories(const string& path_) {
+	ifstream in_(path_.c_str());
+	if (in_)
+		parse(in_);
+}
+
+JobCategories::~JobCategories() {
+	for (map<string, JobCategory*>::iterator it = _categories.begin();
+			it != _categories.end(); ++it)
+		delete it->second;
+}
+
+void JobCategories::parse(istream& in_) {
+	JobCategory *current_ = NULL;
+	string line_;
+	while (getline(in_, line_)) {
+		line_ = trimCategoryText(line_);
+		if (line_.empty() || line_[0] == '#')
+			continue;
+		if (line_[0] == '[' && line_[line_.size() - 1] == ']') {
+			string name_ = trimCategoryText(line_.substr(1, line_.size() - 2));
+			if (name_.empty()) {
+				current_ = NULL;
+				continue;
+			}
+			JobCategory *&category_ = _categories[name_];
+			if (category_ == NULL)
+				category_ = new JobCategory();
+			current_ = category_;
+			continue;
+		}
+		size_t equal_ = line_.find('=');
+		if (current_ == NULL || equal_ == string::npos)
+			continue;
+		string key_ = trimCategoryText(line_.substr(0, equal_));
+		string value_ = trimCategoryText(line_.substr(equal_ + 1));
+		if (key_.empty())
+			continue;
+		if (key_ == JOB_CATEGORY_QUEUE) {
+			current_->setQueue(value_);
+			continue;
+		}
+		size_t dot_ = key_.find('.');
+		if (dot_ == string::npos)
+			current_->add(key_, string(), value_);
+		else if (dot_ > 0 && dot_ + 1 < key_.size())
+			current_->add(key_.substr(0, dot_), key_.substr(dot_ + 1), value_);
+	}
+}
+
+JobCategories* JobCategories::getInstance() {
+	pthread_mutex_lock(&_instMutex);
+	if (_instance == 0) {
+		const char *path_ = getenv(JOB_CATEGORIES_ENV);
+		_instance = new JobCategories(path_ && *path_ ? path_ :
+				JOB_CATEGORIES_FILE);
+	}
+	pthread_mutex_unlock(&_instMutex);
+	return _instance;
+}
+
+StringList JobCategories::getNames() const {
+	StringList names_;
+	for (map<string, JobCategory*>::const_iterator it = _categories.begin();
+			it != _categories.end(); ++it)
+		names_.push_back(it->first);
+	return names_;
+}
+
+const JobCategory* JobCategories::find(const string& name_) const {
+	map<string, JobCategory*>::const_iterator it = _categories.find(name_);
+	return it == _categories.end() ? NULL : it->second;
+}
+}
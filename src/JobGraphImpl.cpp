@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <JobGraphImpl.h>
+#include <ConnectionPool.h>
+#include <PBSProSystem.h>
+#include <Drmaa2Exception.h>
+
+namespace drmaa2 {
+
+JobGraphImpl::~JobGraphImpl() {
+	for (JobList::iterator it = _jobList.begin(); it != _jobList.end(); ++it)
+		delete *it;
+}
+
+const JobList& JobGraphImpl::getJobs(void) const {
+	return _jobList;
+}
+
+map<JobState, long> JobGraphImpl::getStateSummary(void) const {
+	map<JobState, long> summary_;
+	map<string, JobState> states_;
+	list<string> jobIds_;
+	for (JobList::const_iterator it = _jobList.begin(); it != _jobList.end(); ++it)
+		jobIds_.push_back((*it)->getJobId());
+	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->waitConnection();
+	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	try {
+		states_ = drms->getJobStates(pbsConnPoolObj_, jobIds_);
+	} catch (const Drmaa2Exception &ex) {
+		ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+		throw ;
+	}
+	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+	for (map<string, JobState>::iterator it = states_.begin(); it != states_.end(); ++it)
+		summary_[it->second]++;
+	return summary_;
+}
+
+JobState JobGraphImpl::getState(void) const {
+	map<JobState, long> summary_ = getStateSummary();
+	if (summary_[FAILED] > 0)
+		return FAILED;
+	if (summary_[DONE] == (long)_jobList.size())
+		return DONE;
+	if (summary_[RUNNING] > 0 || summary_[SUSPENDED] > 0)
+		return RUNNING;
+	if (summary_[QUEUED] > 0 || summary_[QUEUED_HELD] > 0
+			|| summary_[REQUEUED] > 0 || summary_[REQUEUED_HELD] > 0)
+		return QUEUED;
+	return UNDETERMINED;
+}
+
+void JobGraphImpl::terminate(void) const {
+	for (JobList::const_iterator it = _jobList.begin(); it != _jobList.end(); ++it)
+		(*it)->terminate();
+}
+
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <JobIdIndex.h>
+#include <algorithm>
+#include <cstdio>
+
+namespace drmaa2 {
+
+bool JobIdIndex::toKey(const string& jobId_, unsigned long long& key_,
+		const bool intern_) {
+	unsigned long long sequence_ = 0;
+	size_t pos_ = 0;
+	while (pos_ < jobId_.size() && jobId_[pos_] >= '0' && jobId_[pos_] <= '9'
+			&& sequence_ < (1ULL << JOBID_SEQUENCE_BITS))
+		sequence_ = sequence_ * 10 + (jobId_[pos_++] - '0');
+	if (pos_ == 0 || sequence_ >= (1ULL << JOBID_SEQUENCE_BITS)
+			|| pos_ == jobId_.size())
+		return false;
+	bool array_ = false;
+	if (jobId_[pos_] == '[') {
+		// An array or one of its subjobs, both stand for the array
+		size_t close_ = jobId_.find(']', pos_);
+		if (close_ == string::npos)
+			return false;
+		array_ = true;
+		pos_ = close_ + 1;
+	}
+	if (pos_ + 1 >= jobId_.size() || jobId_[pos_] != '.')
+		return false;
+	string server_(jobId_.substr(pos_ + 1));
+	map<string, size_t>::iterator it = _serverIndex.find(server_);
+	size_t index_ = 0;
+	if (it != _serverIndex.end()) {
+		index_ = it->second;
+	} else if (intern_) {
+		index_ = _servers.size();
+		_servers.push_back(server_);
+		_serverIndex[server_] = index_;
+	} else {
+		return false;
+	}
+	key_ = ((unsigned long long) index_ << (JOBID_SEQUENCE_BITS + 1))
+			| (sequence_ << 1) | (array_ ? 1 : 0);
+	return true;
+}
+
+void JobIdIndex::sort() const {
+	if (_sorted)
+		return;
+	std::sort(_keys.begin(), _keys.end());
+	_keys.erase(unique(_keys.begin(), _keys.end()), _keys.end());
+	_sorted = true;
+}
+
+void JobIdIndex::add(const string& jobId_) {
+	unsigned long long key_;
+	if (!toKey(jobId_, key_, true)) {
+		if (find(_others.begin(), _others.end(), jobId_) == _others.end())
+			_others.push_back(jobId_);
+		return;
+	}
+	// Ids of one server grow, appending mostly keeps the keys sorted
+	if (!_keys.empty() && key_ <= _keys.back())
+		_sorted = false;
+	_keys.push_back(key_);
+}
+
+void JobIdIndex::remove(const list<string>& jobIds_) {
+	vector<unsigned long long> removed_;
+	for (list<string>::const_iterator it = jobIds_.begin();
+			it != jobIds_.end(); ++it) {
+		unsigned long long key_;
+		if (toKey(*it, key_, false))
+			removed_.push_back(key_);
+		else
+			_others.remove(*it);
+	}
+	if (removed_.empty())
+		return;
+	sort();
+	std::sort(removed_.begin(), removed_.end());
+	vector<unsigned long long> kept_;
+	kept_.reserve(_keys.size());
+	set_difference(_keys.begin(), _keys.end(), removed_.begin(),
+			removed_.end(), back_inserter(kept_));
+	_keys.swap(kept_);
+}
+
+list<string> JobIdIndex::ids() const {
+	sort();
+	list<string> ids_;
+	char sequence_[32];
+	for (size_t i = 0; i < _keys.size(); i++) {
+		unsigned long long key_ = _keys[i];
+		snprintf(sequence_, sizeof(sequence_), "%llu%s",
+				(key_ >> 1) & ((1ULL << JOBID_SEQUENCE_BITS) - 1),
+				(key_ & 1) ? "[]" : "");
+		ids_.push_back(string(sequence_) + "."
+				+ _servers[key_ >> (JOBID_SEQUENCE_BITS + 1)]);
+	}
+	ids_.insert(ids_.end(), _others.begin(), _others.end());
+	return ids_;
+}
+
+size_t JobIdIndex::size() const {
+	sort();
+	return _keys.size() + _others.size();
+}
+}
@@ -35,13 +35,19 @@
  *
  */
 
+#include <AccountingLog.h>
 #include <ConnectionPool.h>
 #include <Drmaa2Exception.h>
+#include <JobArchive.h>
 #include <JobTemplateAttrHelper.h>
 #include <PBSConnection.h>
 #include <PBSIFLExtend.h>
 #include <JobImpl.h>
+#include <JobStateCache.h>
+#include <JobWaitPoller.h>
+#include <OutputReader.h>
 #include <PBSProSystem.h>
+#include <UsageSampler.h>
 #include <stddef.h>
 #include <cstdlib>
 #include <ctime>
@@ -58,12 +64,16 @@ const string& JobImpl::getJobId(void) const {
 }
 
 const JobInfo& JobImpl::getJobInfo(void) const {
-	populateJobInfo();
+	if (_archived)
+		return _jobInfo;
+	if (JobStateCache::getInstance()->lookup(_jobId, _jobInfo))
+		JobArchive::getInstance()->add(_jobInfo);
+	else
+		populateJobInfo();
 	return _jobInfo;
 }
 
 const void JobImpl::populateJobInfo(void) const {
-	char *attrVal_;
 	_jobInfo.jobId = _jobId;
 	PBSConnection pbsconn_(pbs_default(), 0, 0);
 	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->getConnection();
@@ -71,100 +81,32 @@ const void JobImpl::populateJobInfo(void) const {
 	struct batch_status *batchResponse_ = NULL;
 	batchResponse_ = pbs_statjob(pbsCnHolder_->getFd(), (char *)_jobId.c_str(), NULL, (char *)"x");
 	if(batchResponse_) {
-		if(batchResponse_->attribs) {
-			JobTemplateAttrHelper attrObj(batchResponse_->attribs);
-			attrVal_ = attrObj.getAttribute((char *)ATTR_comment, NULL);
-			if(attrVal_) {
-				_jobInfo.annotation = string(attrVal_);
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_exit_status, NULL);
-			if(attrVal_) {
-				_jobInfo.exitStatus = atol(attrVal_);
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_state, NULL);
-			if(attrVal_) {
-				switch(attrVal_[0]) {
-					case 'R':
-						_jobInfo.jobState = RUNNING;
-						break;
-					case 'Q':
-						_jobInfo.jobState = QUEUED;
-						break;
-					case 'S':
-						_jobInfo.jobState = SUSPENDED;
-						break;
-					case 'H':
-						_jobInfo.jobState = QUEUED_HELD;
-						break;
-					case 'F':
-						_jobInfo.jobState = DONE;
-						break;
-					default:
-						_jobInfo.jobState = UNDETERMINED;
-						break;
-				}
-				if(_jobInfo.jobState == QUEUED || _jobInfo.jobState == QUEUED_HELD) {
-					attrVal_ = attrObj.getAttribute((char *)ATTR_runcount, NULL);
-					if(attrVal_) {
-						if(atol(attrVal_) > 0) {
-							if(_jobInfo.jobState == QUEUED)
-								_jobInfo.jobState = REQUEUED;
-							else if(_jobInfo.jobState == QUEUED_HELD)
-								_jobInfo.jobState = REQUEUED_HELD;
-						}
-					}
-				}
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_owner, NULL);
-			if(attrVal_) {
-				_jobInfo.jobOwner = string(attrVal_);
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_queue, NULL);
-			if(attrVal_) {
-				_jobInfo.queueName = string(attrVal_);
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_qtime, NULL);
-			if(attrVal_) {
-				_jobInfo.submissionTime = (time_t)atol(attrVal_);
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_substate, NULL);
-			if(attrVal_) {
-				_jobInfo.jobSubState = string(attrVal_);
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_stime, NULL);
-			if(attrVal_) {
-				_jobInfo.dispatchTime = (time_t)atol(attrVal_);
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_etime, NULL);
-			if(attrVal_) {
-				_jobInfo.finishTime = (time_t)atol(attrVal_);
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_execvnode, NULL);
-			if(attrVal_) {
-				string str_(attrVal_), token_;
-				size_t pos_ = 0;
-				while ((pos_ = str_.find('+')) != std::string::npos) {
-					token_ = str_.substr(0, pos_);
-					_jobInfo.allocatedMachines.push_back(token_);
-					str_.erase(0, pos_ + 1);
-				}
-				_jobInfo.slots = _jobInfo.allocatedMachines.size();
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_used, (char *)WALLTIME);
-			if(attrVal_) {
-				_jobInfo.wallclockTime = atol(attrVal_);
-			}
-			attrVal_ = attrObj.getAttribute((char *)ATTR_used, (char *)CPUTIME);
-			if(attrVal_) {
-				_jobInfo.wallclockTime = atol(attrVal_);
-			}
-		}
+		PBSProSystem::toJobInfo(batchResponse_->attribs, _jobInfo);
 		pbs_statfree(batchResponse_);
 	}
 	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+	AccountingRecord record_;
+	AccountingLog::getInstance()->refresh();
+	if (AccountingLog::getInstance()->lookup(_jobId, record_)) {
+		// The end record holds the final figures, also once purged
+		if (batchResponse_ == NULL)
+			_jobInfo.jobState = record_.getState();
+		_jobInfo.finishTime = record_.finishTime;
+		if (record_.ended) {
+			_jobInfo.exitStatus = record_.exitStatus;
+			_jobInfo.cpuTime = record_.cpuTime;
+			_jobInfo.wallclockTime = record_.wallclockTime;
+		}
+	}
+	JobArchive::getInstance()->add(_jobInfo);
 }
 
 const JobState& JobImpl::getState(string& subState) {
+	if (JobStateCache::getInstance()->lookup(_jobId, _jobInfo)) {
+		subState = _jobInfo.jobSubState;
+		_jobState = _jobInfo.jobState;
+		return _jobState;
+	}
 	try {
 		const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->getConnection();
 		_jobState = Singleton<DRMSystem, PBSProSystem>::getInstance()->state(
@@ -247,14 +189,54 @@ void JobImpl::terminate(void) const throw () {
 	}
 }
 
+void JobImpl::alter(const JobAlteration& alteration_) const {
+	const Connection &conn_ = ConnectionPool::getInstance()->getConnection();
+	try {
+		Singleton<DRMSystem, PBSProSystem>::getInstance()->alter(conn_,
+				*this, alteration_);
+	} catch (const Drmaa2Exception &ex) {
+		ConnectionPool::getInstance()->returnConnection(conn_);
+		throw ;
+	}
+	ConnectionPool::getInstance()->returnConnection(conn_);
+}
+
 void JobImpl::reap(void) const throw (){
 	return;
 }
 
-void JobImpl::waitStarted(const TimeAmount& timeout_) throw (){
+void JobImpl::waitStarted(const TimeAmount& timeout_) {
+	vector<string> jobIds_(1, getJobId());
+	JobWaitPoller::getInstance()->wait(jobIds_, false, timeout_, _jobState);
+}
+
+void JobImpl::waitTerminated(TimeAmount& timeout_) {
+	vector<string> jobIds_(1, getJobId());
+	JobWaitPoller::getInstance()->wait(jobIds_, true, timeout_, _jobState);
+	// Archive while the server and the accounting log still know the job
+	if ((_jobState == DONE || _jobState == FAILED) && !_archived
+			&& JobArchive::getInstance()->isEnabled()
+			&& !JobArchive::getInstance()->isArchived(_jobId))
+		populateJobInfo();
+}
+
+string JobImpl::readOutput(const OutputStream stream_, OutputCursor& cursor_,
+		const size_t maxBytes_, const TimeAmount timeout_) const {
+	// Joined files all go to the output path
+	bool error_ = stream_ == ERROR_STREAM && !_jt.joinFiles;
+	const string &path_ = error_ ? _jt.errorPath : _jt.outputPath;
+	if (path_.empty())
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+	return OutputReader(path_, _jobId, error_ ? 'e' : 'o').read(cursor_,
+			maxBytes_, timeout_);
+}
+
+void JobImpl::trackUsage(void) const {
+	UsageSampler::getInstance()->track(_jobId);
 }
 
-void JobImpl::waitTerminated(TimeAmount& timeout_) throw (){
+UsageSampleList JobImpl::getUsage(void) const {
+	return UsageSampler::getInstance()->samples(_jobId);
 }
 
 } /* namespace drmaa2 */
@@ -39,18 +39,309 @@
 #include <ConnectionPool.h>
 #include <PBSProSystem.h>
 #include <PBSConnection.h>
+#include <JobCategories.h>
 #include <JobArrayImpl.h>
+#include <JobGraphImpl.h>
+#include <JobAlterationAttrHelper.h>
+#include <WorkerPool.h>
+#include <EventEngine.h>
+#include <JobWaitPoller.h>
+#include <JobWaitSetImpl.h>
+#include <InvalidArgumentException.h>
+#include <InvalidStateException.h>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
 
 namespace drmaa2 {
 
+/**
+ * @brief Submits or releases one node of a job graph on the WorkerPool
+ */
+class JobGraphTask : public WorkerTask {
+	TaskGroup &_group;
+	const JobTemplate *_jobTemplate;
+	const EnvironmentEncoder *_environment;
+	list<string> _afterOk;
+	Job **_job;
+	long *_errorCode;
+public:
+	/**
+	 * @brief Constructor, registers the task with group_
+	 *
+	 * @param[in] group_ - group to signal once done
+	 * @param[in] jobTemplate_ - template to submit, NULL releases *job_
+	 * @param[in] environment_ - session base environment
+	 * @param[in] afterOk_ - ids of jobs the node depends on
+	 * @param[in,out] job_ - receives the submitted job or holds the
+	 * 			job to release
+	 * @param[out] errorCode_ - receives the DRMS error on failure
+	 */
+	JobGraphTask(TaskGroup &group_, const JobTemplate *jobTemplate_,
+			const EnvironmentEncoder *environment_,
+			const list<string>& afterOk_, Job **job_, long *errorCode_) :
+			_group(group_), _jobTemplate(jobTemplate_),
+			_environment(environment_), _afterOk(afterOk_),
+			_job(job_), _errorCode(errorCode_) {
+		_group.add();
+	}
+
+	virtual ~JobGraphTask() {
+		_group.done();
+	}
+
+	virtual void run() {
+		DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+		try {
+			const Connection &conn_ = ConnectionPool::getInstance()->waitConnection();
+			try {
+				if (_jobTemplate)
+					*_job = drms->runJob(conn_, *_jobTemplate, _afterOk,
+							_environment);
+				else
+					drms->release(conn_, **_job);
+			} catch (const Drmaa2Exception &ex) {
+				ConnectionPool::getInstance()->returnConnection(conn_);
+				throw ;
+			}
+			ConnectionPool::getInstance()->returnConnection(conn_);
+		} catch (const ImplementationSpecificException &ex) {
+			*_errorCode = ex.getErrorCode(0);
+		} catch (const Drmaa2Exception &ex) {
+			*_errorCode = PBSE_INTERNAL;
+		}
+	}
+};
+
+/**
+ * @brief What the batches of a bulk request apply to their jobs
+ */
+class BatchAction {
+public:
+	virtual ~BatchAction() {
+	}
+	/**
+	 * @brief Applies the action to one batch of jobs
+	 *
+	 * @param[in] connection_ - pooled connection
+	 * @param[in,out] results_ - first result of the batch, jobId set
+	 * @param[in] count_ - number of results in the batch
+	 */
+	virtual void apply(const Connection& connection_,
+			JobOperationResult *results_, const size_t count_) const = 0;
+};
+
+/**
+ * @brief Applies a JobOperation
+ */
+class OperationAction : public BatchAction {
+	JobOperation _operation;
+public:
+	explicit OperationAction(const JobOperation operation_) :
+			_operation(operation_) {
+	}
+	virtual void apply(const Connection& connection_,
+			JobOperationResult *results_, const size_t count_) const {
+		Singleton<DRMSystem, PBSProSystem>::getInstance()->control(connection_,
+				_operation, results_, count_);
+	}
+};
+
+/**
+ * @brief Applies the attribute list of a JobAlteration, parsed once for
+ * 			all batches
+ */
+class AlterationAction : public BatchAction {
+	JobAlterationAttrHelper &_attributes;
+public:
+	explicit AlterationAction(JobAlterationAttrHelper& attributes_) :
+			_attributes(attributes_) {
+	}
+	virtual void apply(const Connection& connection_,
+			JobOperationResult *results_, const size_t count_) const {
+		Singleton<DRMSystem, PBSProSystem>::getInstance()->alter(connection_,
+				_attributes, results_, count_);
+	}
+};
+
+/**
+ * @brief - Applies action_ to one batch of jobs over a pooled connection
+ *
+ * @param[in] action_ - operation or alteration to apply
+ * @param[in,out] results_ - first result of the batch, jobId set
+ * @param[in] count_ - number of results in the batch
+ */
+static void controlBatch(const BatchAction& action_,
+		JobOperationResult *results_, const size_t count_) {
+	try {
+		const Connection &conn_ = ConnectionPool::getInstance()->waitConnection();
+		action_.apply(conn_, results_, count_);
+		ConnectionPool::getInstance()->returnConnection(conn_);
+	} catch (const Drmaa2Exception &ex) {
+		for (size_t i = 0; i < count_; i++) {
+			results_[i].error = toErrorCode(ex);
+			results_[i].message = ex.getMessage().getDetailMsg();
+		}
+	}
+}
+
+/**
+ * @brief Progress shared by the batches of a filter driven JobOperation
+ */
+class JobFilterProgress {
+	pthread_mutex_t _mutex;
+	JobOperationCallback *_callback;
+	long _done;
+	long _failed;
+	long _total;
+public:
+	JobFilterProgress(JobOperationCallback *callback_, const long total_) :
+			_callback(callback_), _done(0), _failed(0), _total(total_) {
+		pthread_mutex_init(&_mutex, NULL);
+	}
+
+	~JobFilterProgress() {
+		pthread_mutex_destroy(&_mutex);
+	}
+
+	long getFailed() const {
+		return _failed;
+	}
+
+	/**
+	 * @brief Counts a processed batch and hands it to the callback
+	 *
+	 * @param[in] results_ - first result of the batch
+	 * @param[in] count_ - number of results in the batch
+	 */
+	void report(const JobOperationResult *results_, const size_t count_) {
+		pthread_mutex_lock(&_mutex);
+		_done += count_;
+		for (size_t i = 0; i < count_; i++) {
+			if (results_[i].error == ERROR_NONE)
+				continue;
+			_failed++;
+			if (_callback)
+				_callback->failed(results_[i]);
+		}
+		if (_callback)
+			_callback->progress(_done, _failed, _total);
+		pthread_mutex_unlock(&_mutex);
+	}
+};
+
+/**
+ * @brief Applies a JobOperation to one batch of jobs on the WorkerPool
+ */
+class JobControlTask : public WorkerTask {
+	TaskGroup &_group;
+	const BatchAction &_action;
+	JobOperationResult *_results;
+	char **_jobIds;
+	size_t _count;
+	JobFilterProgress *_progress;
+public:
+	/**
+	 * @brief Constructor, registers the task with group_
+	 *
+	 * @param[in] group_ - group to signal once done
+	 * @param[in] action_ - operation or alteration to apply, outlives
+	 * 			the task
+	 * @param[in,out] results_ - first result of the batch, NULL to build
+	 * 			the results of the batch from jobIds_
+	 * @param[in] jobIds_ - first job id of the batch if results_ is NULL
+	 * @param[in] count_ - number of jobs in the batch
+	 * @param[in] progress_ - receives the results built from jobIds_
+	 */
+	JobControlTask(TaskGroup &group_, const BatchAction& action_,
+			JobOperationResult *results_, char **jobIds_, const size_t count_,
+			JobFilterProgress *progress_) :
+			_group(group_), _action(action_), _results(results_),
+			_jobIds(jobIds_), _count(count_), _progress(progress_) {
+		_group.add();
+	}
+
+	virtual ~JobControlTask() {
+		_group.done();
+	}
+
+	virtual void run() {
+		if (_results) {
+			controlBatch(_action, _results, _count);
+			return;
+		}
+		// Results only live as long as the batch, whatever the filter matched
+		vector<JobOperationResult> results_(_count);
+		for (size_t i = 0; i < _count; i++)
+			results_[i].jobId.assign(_jobIds[i]);
+		controlBatch(_action, &results_[0], _count);
+		_progress->report(&results_[0], _count);
+	}
+};
+
+/**
+ * @brief - Returns the number of jobs per batch of a JobOperation
+ *
+ * @param[in] count_ - number of jobs
+ *
+ * @return - batch size, spreads the jobs over every worker but keeps single
+ * 			requests short
+ */
+static size_t controlBatchSize(const size_t count_) {
+	size_t batch_ = (count_ + MAX_WORKERS - 1) / MAX_WORKERS;
+	return max((size_t)1, min(batch_, (size_t)CONTROL_BATCH_SIZE));
+}
+
+/**
+ * @brief - Rejects a template naming a job category which is not configured
+ *
+ * @param[in] jobTemplate_ - template to check
+ *
+ * @throw InvalidArgumentException - If the category is unknown
+ */
+static void checkJobCategory(const JobTemplate& jobTemplate_) {
+	if (!jobTemplate_.jobCategory.empty() && JobCategories::getInstance()->find(
+			jobTemplate_.jobCategory) == NULL)
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+}
+
+void JobSessionImpl::recordJob(const string& jobId_) const {
+	pthread_mutex_lock(&_sessionMutex);
+	_sessionJobs.add(jobId_);
+	pthread_mutex_unlock(&_sessionMutex);
+	EventEngine::recordSession(jobId_, getSessionName());
+}
+
 const JobList& JobSessionImpl::getJobs(const JobInfo& filter_) {
+	pthread_mutex_lock(&_sessionMutex);
+	list<string> jobIds_ = _sessionJobs.ids();
+	pthread_mutex_unlock(&_sessionMutex);
+	list<string> gone_;
 	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->getConnection();
 	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
-	_jobList = drms->getJobs(pbsConnPoolObj_, filter_);
+	try {
+		_jobList = drms->getJobs(pbsConnPoolObj_, filter_, jobIds_, gone_);
+	} catch (const Drmaa2Exception &ex) {
+		ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+		throw ;
+	}
 	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+	// Jobs purged from the server history are not reported again
+	pthread_mutex_lock(&_sessionMutex);
+	_sessionJobs.remove(gone_);
+	pthread_mutex_unlock(&_sessionMutex);
 	return _jobList;
 }
 
+void JobSessionImpl::setBaseEnvironment(
+		const map<string, string>& environment_) {
+	_baseEnvironment.setBase(environment_);
+}
+
+const map<string, string>& JobSessionImpl::getBaseEnvironment(void) const {
+	return _baseEnvironment.getBase();
+}
+
 const JobArray& JobSessionImpl::getJobArray(const string& jobArrayId_) {
 	JobArrayImpl *jobArrayImpl_ = new JobArrayImpl(jobArrayId_);
 	JobArray& jobArray_ = static_cast<JobArray&>(*jobArrayImpl_);
@@ -59,10 +350,38 @@ const JobArray& JobSessionImpl::getJobArray(const string& jobArrayId_) {
 
 Job& JobSessionImpl::runJob(const JobTemplate& jobTemplate_) const {
 	Job *job_;
-	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->getConnection();
+	checkJobCategory(jobTemplate_);
+	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->waitConnection();
 	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
-	job_ = (Job *)drms->runJob(pbsConnPoolObj_, jobTemplate_);
+	try {
+		job_ = (Job *)drms->runJob(pbsConnPoolObj_, jobTemplate_,
+				&_baseEnvironment);
+	} catch (const Drmaa2Exception &ex) {
+		ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+		throw ;
+	}
 	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+	recordJob(job_->getJobId());
+	return *job_;
+}
+
+Job& JobSessionImpl::runJob(const JobTemplate& jobTemplate_,
+		const string& submitKey_) const {
+	Job *job_;
+	if (!PBSProSystem::isValidSubmitKey(submitKey_))
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+	checkJobCategory(jobTemplate_);
+	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->waitConnection();
+	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	try {
+		job_ = (Job *)drms->runKeyedJob(pbsConnPoolObj_, jobTemplate_,
+				submitKey_, &_baseEnvironment);
+	} catch (const Drmaa2Exception &ex) {
+		ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+		throw ;
+	}
+	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+	recordJob(job_->getJobId());
 	return *job_;
 }
 
@@ -70,21 +389,333 @@ JobArray& JobSessionImpl::runBulkJobs(const JobTemplate& jobTemplate_,
 		const long beginIndex_, const long endIndex_, const long step_,
 		const long maxParallel_) const {
 	JobArray *jobArray_;
+	checkJobCategory(jobTemplate_);
 	PBSConnection pbsconn_(pbs_default(), 0, 0);
 	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->getConnection();
 	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
-	jobArray_ = (JobArray *)drms->runJobArray(pbsConnPoolObj_, jobTemplate_,
-			beginIndex_, endIndex_, step_, maxParallel_);
+	try {
+		jobArray_ = (JobArray *)drms->runJobArray(pbsConnPoolObj_, jobTemplate_,
+				beginIndex_, endIndex_, step_, maxParallel_, &_baseEnvironment);
+	} catch (const Drmaa2Exception &ex) {
+		ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+		throw ;
+	}
 	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+	recordJob(jobArray_->getJobArrayId());
+	// Windows chained by the fallback are separate arrays on the server
+	JobArrayImpl *windowed_ = dynamic_cast<JobArrayImpl*>(jobArray_);
+	if (windowed_ != NULL) {
+		const list<string> &windows_ = windowed_->getWindows();
+		for (list<string>::const_iterator it = windows_.begin();
+				it != windows_.end(); ++it)
+			recordJob(*it);
+	}
 	return *jobArray_;
 }
 
+JobList JobSessionImpl::runJobSweep(const JobTemplate& jobTemplate_,
+		const SweepTable& points_) const {
+	JobList jobs_;
+	checkJobCategory(jobTemplate_);
+	const Connection &pbsConnPoolObj_ = ConnectionPool::getInstance()->waitConnection();
+	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	try {
+		jobs_ = drms->runJobSweep(pbsConnPoolObj_, jobTemplate_, points_,
+				&_baseEnvironment);
+	} catch (const Drmaa2Exception &ex) {
+		ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+		throw ;
+	}
+	ConnectionPool::getInstance()->returnConnection(pbsConnPoolObj_);
+	// Sweep points are subjobs of one array, recorded once as the array
+	for (JobList::iterator it = jobs_.begin(); it != jobs_.end(); ++it)
+		recordJob((*it)->getJobId());
+	return jobs_;
+}
+
+void JobSessionImpl::openJournal(const string& path_) {
+	if (_journal != NULL)
+		throw InvalidStateException(DRMAA2_SOURCEINFO());
+	_journal = new SubmissionJournal(path_, &_baseEnvironment);
+}
+
+void JobSessionImpl::closeJournal(void) {
+	delete _journal;
+	_journal = NULL;
+}
+
+string JobSessionImpl::enqueueJob(const JobTemplate& jobTemplate_,
+		const string& requestKey_) {
+	if (_journal == NULL)
+		throw InvalidStateException(DRMAA2_SOURCEINFO());
+	checkJobCategory(jobTemplate_);
+	return _journal->enqueue(jobTemplate_, requestKey_);
+}
+
+string JobSessionImpl::getEnqueuedJobId(const string& requestKey_) {
+	if (_journal == NULL)
+		throw InvalidStateException(DRMAA2_SOURCEINFO());
+	string jobId_ = _journal->getJobId(requestKey_);
+	if (!jobId_.empty())
+		recordJob(jobId_);
+	return jobId_;
+}
+
+JobGraph& JobSessionImpl::runJobGraph(const JobGraphTemplate& graph_) const {
+	size_t count_ = graph_.size();
+	vector<long> indegree_(count_, 0), wave_(count_, 0);
+	vector<list<size_t> > children_(count_);
+	vector<vector<size_t> > waves_;
+	list<size_t> ready_;
+	for (size_t i = 0; i < count_; i++) {
+		checkJobCategory(graph_[i].jobTemplate);
+		for (list<long>::const_iterator it = graph_[i].dependsOn.begin();
+				it != graph_[i].dependsOn.end(); ++it) {
+			if (*it < 0 || *it >= (long)count_ || *it == (long)i)
+				throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+			children_[*it].push_back(i);
+			indegree_[i]++;
+		}
+	}
+	for (size_t i = 0; i < count_; i++)
+		if (indegree_[i] == 0)
+			ready_.push_back(i);
+	size_t visited_ = 0;
+	while (!ready_.empty()) {
+		size_t node_ = ready_.front();
+		ready_.pop_front();
+		visited_++;
+		if (waves_.size() <= (size_t)wave_[node_])
+			waves_.resize(wave_[node_] + 1);
+		waves_[wave_[node_]].push_back(node_);
+		for (list<size_t>::iterator it = children_[node_].begin();
+				it != children_[node_].end(); ++it) {
+			wave_[*it] = max(wave_[*it], wave_[node_] + 1);
+			if (--indegree_[*it] == 0)
+				ready_.push_back(*it);
+		}
+	}
+	if (visited_ != count_)
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+
+	// Roots are held until every node is known to the DRMS, so no job can
+	// finish before its dependents were able to register on it.
+	bool holdRoots_ = waves_.size() > 1;
+	vector<JobTemplate> templates_(count_);
+	vector<Job*> jobs_(count_, (Job*)NULL);
+	vector<long> errors_(count_, PBSE_NONE);
+	long errorCode_ = PBSE_NONE;
+	for (size_t w = 0; w < waves_.size() && errorCode_ == PBSE_NONE; w++) {
+		TaskGroup group_;
+		for (size_t i = 0; i < waves_[w].size(); i++) {
+			size_t node_ = waves_[w][i];
+			list<string> afterOk_;
+			templates_[node_] = graph_[node_].jobTemplate;
+			if (w == 0 && holdRoots_)
+				templates_[node_].submitAsHold = true;
+			for (list<long>::const_iterator it = graph_[node_].dependsOn.begin();
+					it != graph_[node_].dependsOn.end(); ++it)
+				afterOk_.push_back(jobs_[*it]->getJobId());
+			try {
+				WorkerPool::getInstance()->submit(new JobGraphTask(group_,
+						&templates_[node_], &_baseEnvironment, afterOk_, &jobs_[node_],
+						&errors_[node_]));
+			} catch (const OutOfResourceException &ex) {
+				errorCode_ = PBSE_SYSTEM;
+				break;
+			}
+		}
+		group_.wait();
+		for (size_t i = 0; i < waves_[w].size(); i++)
+			if (errors_[waves_[w][i]] != PBSE_NONE)
+				errorCode_ = errors_[waves_[w][i]];
+	}
+	if (errorCode_ == PBSE_NONE && holdRoots_) {
+		TaskGroup group_;
+		for (size_t i = 0; i < waves_[0].size(); i++) {
+			size_t node_ = waves_[0][i];
+			if (graph_[node_].jobTemplate.submitAsHold)
+				continue;
+			try {
+				WorkerPool::getInstance()->submit(new JobGraphTask(group_, NULL,
+						NULL, list<string>(), &jobs_[node_], &errors_[node_]));
+			} catch (const OutOfResourceException &ex) {
+				errorCode_ = PBSE_SYSTEM;
+				break;
+			}
+		}
+		group_.wait();
+		for (size_t i = 0; i < waves_[0].size(); i++)
+			if (errors_[waves_[0][i]] != PBSE_NONE)
+				errorCode_ = errors_[waves_[0][i]];
+	}
+	if (errorCode_ != PBSE_NONE) {
+		for (vector<Job*>::iterator it = jobs_.begin(); it != jobs_.end(); ++it) {
+			if (*it) {
+				(*it)->terminate();
+				delete *it;
+			}
+		}
+		throw ImplementationSpecificException(errorCode_, DRMAA2_SOURCEINFO());
+	}
+	for (vector<Job*>::iterator it = jobs_.begin(); it != jobs_.end(); ++it)
+		recordJob((*it)->getJobId());
+	return *new JobGraphImpl(JobList(jobs_.begin(), jobs_.end()));
+}
+
+/**
+ * @brief - Runs the batches of controlJobIds or alterJobs on the WorkerPool
+ *
+ * @param[in] action_ - operation or alteration to apply
+ * @param[in,out] results_ - jobId set by the caller
+ */
+static void runControlBatches(const BatchAction& action_,
+		vector<JobOperationResult>& results_) {
+	size_t count_ = results_.size();
+	size_t batch_ = controlBatchSize(count_);
+	TaskGroup group_;
+	for (size_t first_ = 0; first_ < count_; first_ += batch_) {
+		try {
+			WorkerPool::getInstance()->submit(new JobControlTask(group_,
+					action_, &results_[first_], NULL,
+					min(batch_, count_ - first_), NULL));
+		} catch (const OutOfResourceException &ex) {
+			for (size_t i = first_; i < count_; i++) {
+				results_[i].error = toErrorCode(ex);
+				results_[i].message = ex.getMessage().getDetailMsg();
+			}
+			break;
+		}
+	}
+	group_.wait();
+}
+
+void controlJobIds(const JobOperation operation_,
+		vector<JobOperationResult>& results_) {
+	OperationAction action_(operation_);
+	runControlBatches(action_, results_);
+}
+
+/**
+ * @brief - Builds one result per job of jobs_
+ *
+ * @param[in] jobs_ - List of Jobs
+ * @param[out] results_ - receives job and jobId of every job
+ *
+ * @throw InvalidArgumentException - If jobs_ holds NULL
+ */
+static void initResults(const JobList& jobs_,
+		vector<JobOperationResult>& results_) {
+	results_.resize(jobs_.size());
+	size_t count_ = 0;
+	for (JobList::const_iterator it = jobs_.begin(); it != jobs_.end(); ++it) {
+		if (*it == NULL)
+			throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+		results_[count_].job = *it;
+		results_[count_++].jobId = (*it)->getJobId();
+	}
+}
+
+vector<JobOperationResult> JobSessionImpl::controlJobs(const JobList& jobs_,
+		const JobOperation operation_) const {
+	vector<JobOperationResult> results_;
+	initResults(jobs_, results_);
+	controlJobIds(operation_, results_);
+	return results_;
+}
+
+vector<JobOperationResult> JobSessionImpl::alterJobs(const JobList& jobs_,
+		const JobAlteration& alteration_) const {
+	JobAlterationAttrHelper attributes_;
+	if (attributes_.parseTemplate((void *) &alteration_) == NULL)
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+	vector<JobOperationResult> results_;
+	initResults(jobs_, results_);
+	AlterationAction action_(attributes_);
+	runControlBatches(action_, results_);
+	return results_;
+}
+
+long JobSessionImpl::controlJobs(const JobInfo& filter_,
+		const JobOperation operation_, JobOperationCallback *callback_) const {
+	const Connection &conn_ = ConnectionPool::getInstance()->waitConnection();
+	char **jobIds_ = NULL;
+	try {
+		jobIds_ = Singleton<DRMSystem, PBSProSystem>::getInstance()->selectJobs(
+				conn_, filter_);
+	} catch (const Drmaa2Exception &ex) {
+		ConnectionPool::getInstance()->returnConnection(conn_);
+		throw ;
+	}
+	ConnectionPool::getInstance()->returnConnection(conn_);
+	size_t count_ = 0;
+	while (jobIds_ && jobIds_[count_])
+		count_++;
+	JobFilterProgress progress_(callback_, count_);
+	OperationAction action_(operation_);
+	size_t batch_ = controlBatchSize(count_);
+	TaskGroup group_;
+	for (size_t first_ = 0; first_ < count_; first_ += batch_) {
+		size_t size_ = min(batch_, count_ - first_);
+		try {
+			WorkerPool::getInstance()->submit(new JobControlTask(group_,
+					action_, NULL, &jobIds_[first_], size_, &progress_));
+		} catch (const OutOfResourceException &ex) {
+			vector<JobOperationResult> results_(count_ - first_);
+			for (size_t i = 0; i < results_.size(); i++) {
+				results_[i].jobId.assign(jobIds_[first_ + i]);
+				results_[i].error = toErrorCode(ex);
+				results_[i].message = ex.getMessage().getDetailMsg();
+			}
+			progress_.report(&results_[0], results_.size());
+			break;
+		}
+	}
+	group_.wait();
+	free(jobIds_);
+	return progress_.getFailed();
+}
+
+JobWaitSet& JobSessionImpl::createWaitSet(const bool terminated_) const {
+	return *new JobWaitSetImpl(terminated_);
+}
+
+/**
+ * @brief - Waits until any job of jobs_ started or terminated
+ *
+ * @param[in] jobs_ - List of Jobs
+ * @param[in] terminated_ - wait for termination instead of start
+ * @param[in] timeout_ - seconds, negative waits forever
+ *
+ * @throw InvalidArgumentException - If jobs_ is empty or holds NULL
+ * @throw TimeoutException - If no job got there in time
+ *
+ * @return - the job which ended the wait
+ */
+static const Job& waitAny(const JobList& jobs_, const bool terminated_,
+		const TimeAmount timeout_) {
+	vector<Job*> jobList_(jobs_.begin(), jobs_.end());
+	vector<string> jobIds_;
+	for (size_t i = 0; i < jobList_.size(); i++) {
+		if (jobList_[i] == NULL)
+			throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+		jobIds_.push_back(jobList_[i]->getJobId());
+	}
+	if (jobIds_.empty())
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+	JobState state_;
+	return *jobList_[JobWaitPoller::getInstance()->wait(jobIds_, terminated_,
+			timeout_, state_)];
+}
+
 const Job& JobSessionImpl::waitAnyStarted(const JobList& jobs_,
 		const TimeAmount timeout_) {
+	return waitAny(jobs_, false, timeout_);
 }
 
 const Job& JobSessionImpl::waitAnyTerminated(const JobList& jobs_,
 		const TimeAmount timeout_) {
+	return waitAny(jobs_, true, timeout_);
 }
 
 }
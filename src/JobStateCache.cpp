@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <JobStateCache.h>
+#include <ConnectionPool.h>
+#include <PBSProSystem.h>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace drmaa2 {
+
+JobStateCache* JobStateCache::_instance = 0;
+pthread_mutex_t JobStateCache::_instMutex = PTHREAD_MUTEX_INITIALIZER;
+
+unsigned int JobStateCache::refreshInterval() {
+	const char *value_ = getenv(JOB_CACHE_INTERVAL_ENV);
+	long interval_ = value_ ? atol(value_) : 0;
+	return interval_ > 0 ? (unsigned int) interval_ : 0;
+}
+
+JobStateCache::JobStateCache(const unsigned int interval_) :
+		_interval(interval_), _started(false), _synced(0) {
+	pthread_mutex_init(&_mutex, NULL);
+}
+
+JobStateCache::~JobStateCache() {
+	pthread_mutex_destroy(&_mutex);
+}
+
+void* JobStateCache::refresherMain(void *arg_) {
+	static_cast<JobStateCache*>(arg_)->run();
+	return NULL;
+}
+
+bool JobStateCache::lookup(const string& jobId_, JobInfo& info_) {
+	pthread_mutex_lock(&_mutex);
+	if (!_started && _interval > 0) {
+		pthread_t thread_;
+		// Without the thread the cache stays empty and callers query the
+		// server as before
+		if (pthread_create(&thread_, NULL, &JobStateCache::refresherMain,
+				this) == 0) {
+			pthread_detach(thread_);
+			_started = true;
+		}
+	}
+	map<string, JobInfo>::const_iterator it = _jobs.find(jobId_);
+	bool found_ = it != _jobs.end();
+	if (found_)
+		info_ = it->second;
+	pthread_mutex_unlock(&_mutex);
+	return found_;
+}
+
+void JobStateCache::update(const map<string, JobInfo>& changed_,
+		const time_t synced_, const set<string> *known_) {
+	pthread_mutex_lock(&_mutex);
+	for (map<string, JobInfo>::const_iterator it = changed_.begin();
+			it != changed_.end(); ++it) {
+		map<string, JobInfo>::iterator job_ = _jobs.find(it->first);
+		if (job_ != _jobs.end()) {
+			job_->second = it->second;
+			continue;
+		}
+		_jobs.insert(*it);
+		_order.push_back(it->first);
+	}
+	if (known_ != NULL) {
+		// Gone from the server, readers fall back to their own query
+		list<string>::iterator it = _order.begin();
+		while (it != _order.end()) {
+			if (known_->find(*it) == known_->end()
+					&& changed_.find(*it) == changed_.end()) {
+				_jobs.erase(*it);
+				it = _order.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+	while (_order.size() > JOB_CACHE_MAX_JOBS) {
+		_jobs.erase(_order.front());
+		_order.pop_front();
+	}
+	if (synced_ > _synced)
+		_synced = synced_;
+	pthread_mutex_unlock(&_mutex);
+}
+
+time_t JobStateCache::getSynced() const {
+	pthread_mutex_lock(&_mutex);
+	time_t synced_ = _synced;
+	pthread_mutex_unlock(&_mutex);
+	return synced_;
+}
+
+void JobStateCache::run() {
+	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	for (unsigned long syncs_ = 0;; syncs_++) {
+		map<string, JobInfo> changed_;
+		set<string> known_;
+		bool sweep_ = syncs_ % JOB_CACHE_SWEEP_SYNCS == JOB_CACHE_SWEEP_SYNCS - 1;
+		time_t since_ = getSynced();
+		try {
+			const Connection &conn_ =
+					ConnectionPool::getInstance()->waitConnection();
+			try {
+				// The ids are listed first, a job submitted meanwhile is
+				// in the delta and kept
+				if (sweep_)
+					drms->getUserJobIds(conn_, known_);
+				time_t synced_ = drms->getChangedJobs(conn_, since_, changed_);
+				update(changed_, synced_, sweep_ ? &known_ : NULL);
+			} catch (const Drmaa2Exception &ex) {
+				// Synced again next interval from the same point
+			}
+			ConnectionPool::getInstance()->returnConnection(conn_);
+		} catch (const Drmaa2Exception &ex) {
+		}
+		sleep(_interval);
+	}
+}
+}
@@ -114,14 +114,12 @@ ATTRL* JobTemplateAttrHelper::parseTemplate(void* template_) {
 		stream_.clear();
 		setAttribute((char *)ATTR_p, (char *)_priority.c_str());
 	}
-	if(jobTemplate_.jobEnvironment.size() > 0) {
-		for(map<string,string>::iterator it = jobTemplate_.jobEnvironment.begin(); it != jobTemplate_.jobEnvironment.end(); ++it) {
-			_envList.append(it->first);
-			_envList.append("=");
-			_envList.append(it->second);
-			_envList.append(",");
-		}
-		_envList.erase(_envList.size() - 1, _envList.size());
+	if(_baseEnvironment != NULL) {
+		_baseEnvironment->encode(jobTemplate_.jobEnvironment, _envList);
+	} else {
+		EnvironmentEncoder::encodeAll(jobTemplate_.jobEnvironment, _envList);
+	}
+	if(!_envList.empty()) {
 		setAttribute((char*) ATTR_v, (char*)_envList.c_str());
 	}
 	if (jobTemplate_.minPhysMemory) {
@@ -176,7 +174,7 @@ ATTRL* JobTemplateAttrHelper::parseTemplate(void* template_) {
 		_stageoutFiles.erase(_stageoutFiles.size() - 1, _stageoutFiles.size());
 		setAttribute((char*) ATTR_stagein, (char*)_stageoutFiles.c_str());
 	}
-	if (!jobTemplate_.remoteCommand.empty()) {
+	if (!jobTemplate_.remoteCommand.empty() && jobTemplate_.scriptBody.empty()) {
 		setAttribute((char *) ATTR_executable, (char*) jobTemplate_.remoteCommand.c_str());
 
 		copy(jobTemplate_.args.begin(), jobTemplate_.args.end(), ostream_iterator<string>(stream_,(char *)" "));
@@ -191,6 +189,17 @@ ATTRL* JobTemplateAttrHelper::parseTemplate(void* template_) {
 			setAttribute((char *) ATTR_Arglist, (char*) _submitArguments.c_str());
 		}
 	}
+	if (!jobTemplate_.jobCategory.empty()) {
+		const JobCategories *categories_ = _categories != NULL ?
+				_categories : JobCategories::getInstance();
+		const JobCategory *category_ = categories_->find(
+				jobTemplate_.jobCategory);
+		if (category_ != NULL) {
+			// Template settings win over the category defaults
+			mergeAttributes(category_->getAttributes());
+			_categoryQueue.assign(category_->getQueue());
+		}
+	}
 
 	return _attrList;
 }
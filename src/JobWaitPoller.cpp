@@ -0,0 +1,402 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <JobWaitPoller.h>
+#include <AccountingLog.h>
+#include <ConnectionPool.h>
+#include <PBSProSystem.h>
+#include <Message.h>
+#include <SourceInfo.h>
+#include <set>
+#include <sys/time.h>
+
+namespace drmaa2 {
+
+JobWaitPoller* JobWaitPoller::_instance = 0;
+pthread_mutex_t JobWaitPoller::_instMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief - Returns the current time in WAIT_TICK_MS ticks
+ *
+ * @return - tick
+ */
+static unsigned long long currentTick() {
+	struct timeval now_;
+	gettimeofday(&now_, NULL);
+	return ((unsigned long long) now_.tv_sec * 1000 + now_.tv_usec / 1000)
+			/ WAIT_TICK_MS;
+}
+
+JobWaitPoller::JobWaitPoller() : _wheel(currentTick()), _fresh(false),
+		_started(false), _querying(false), _lastQuery(0),
+		_hintPending(false), _lastHint(0) {
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_cond, NULL);
+	pthread_cond_init(&_idle, NULL);
+	pthread_t thread_;
+	if (pthread_create(&thread_, NULL, &JobWaitPoller::pollerMain, this) == 0) {
+		pthread_detach(thread_);
+		_started = true;
+	}
+}
+
+void* JobWaitPoller::pollerMain(void *arg_) {
+	static_cast<JobWaitPoller*>(arg_)->poll();
+	return NULL;
+}
+
+void JobWaitPoller::logStates(const list<string>& jobIds_,
+		map<string, JobState>& states_) {
+	AccountingLog *log_ = AccountingLog::getInstance();
+	AccountingRecord record_;
+	for (list<string>::const_iterator it = jobIds_.begin();
+			it != jobIds_.end(); ++it)
+		if (states_.find(*it) == states_.end() && log_->lookup(*it, record_))
+			states_[*it] = record_.getState();
+}
+
+bool JobWaitPoller::queryStates(const list<string>& jobIds_,
+		map<string, JobState>& states_) {
+	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	try {
+		const Connection &conn_ = ConnectionPool::getInstance()->waitConnection();
+		try {
+			// A few waited jobs fit one query by id, otherwise one query
+			// over the jobs of the user serves every waiter
+			states_.clear();
+			list<string> missing_;
+			if (jobIds_.size() > WAIT_BY_ID_MAX) {
+				states_ = drms->getUserJobStates(conn_, jobIds_);
+				logStates(jobIds_, states_);
+				for (list<string>::const_iterator it = jobIds_.begin();
+						it != jobIds_.end(); ++it)
+					if (states_.find(*it) == states_.end())
+						missing_.push_back(*it);
+			} else {
+				missing_ = jobIds_;
+			}
+			// Jobs of other users or ones the server no longer keeps
+			if (!missing_.empty() && missing_.size() <= WAIT_BY_ID_MAX) {
+				map<string, JobState> byId_ = drms->getJobStates(conn_,
+						missing_);
+				for (map<string, JobState>::iterator it = byId_.begin();
+						it != byId_.end(); ++it)
+					if (it->second != UNDETERMINED)
+						states_.insert(*it);
+				logStates(missing_, states_);
+			}
+		} catch (const Drmaa2Exception &ex) {
+			ConnectionPool::getInstance()->returnConnection(conn_);
+			throw ;
+		}
+		ConnectionPool::getInstance()->returnConnection(conn_);
+	} catch (const Drmaa2Exception &ex) {
+		return false;
+	}
+	return true;
+}
+
+void JobWaitPoller::hintStates(const list<string>& jobIds_,
+		map<string, JobState>& states_) {
+	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	try {
+		const Connection &conn_ = ConnectionPool::getInstance()->waitConnection();
+		map<string, JobState> byId_;
+		try {
+			byId_ = drms->getJobStates(conn_, jobIds_);
+		} catch (const Drmaa2Exception &ex) {
+			ConnectionPool::getInstance()->returnConnection(conn_);
+			throw ;
+		}
+		ConnectionPool::getInstance()->returnConnection(conn_);
+		for (map<string, JobState>::iterator it = byId_.begin();
+				it != byId_.end(); ++it)
+			if (it->second != UNDETERMINED)
+				states_.insert(*it);
+	} catch (const Drmaa2Exception &ex) {
+		// The next regular query finds the jobs anyway
+	}
+}
+
+void JobWaitPoller::hintedJobs(const unsigned long long now_,
+		const list<string>& jobIds_, list<string>& hinted_) {
+	set<string> waited_(jobIds_.begin(), jobIds_.end());
+	for (map<string, unsigned long long>::iterator it = _hinted.begin();
+			it != _hinted.end();) {
+		if (now_ > it->second || waited_.find(it->first) == waited_.end()) {
+			_hinted.erase(it++);
+		} else {
+			hinted_.push_back(it->first);
+			++it;
+		}
+	}
+}
+
+bool JobWaiter::reached(const JobState state_, const bool gone_,
+		const bool terminated_) {
+	switch (state_) {
+	case RUNNING:
+	case SUSPENDED:
+		return !terminated_;
+	case DONE:
+	case FAILED:
+		return true;
+	case UNDETERMINED:
+		// Gone from the DRMS, it will neither start nor end anymore
+		return gone_;
+	default:
+		return false;
+	}
+}
+
+void JobAnyWaiter::getJobIds(list<string>& jobIds_) const {
+	jobIds_.insert(jobIds_.end(), _jobIds.begin(), _jobIds.end());
+}
+
+bool JobAnyWaiter::check(const map<string, JobState>& states_,
+		const bool complete_) {
+	if (_status != WAITING)
+		return false;
+	for (size_t i = 0; i < _jobIds.size(); i++) {
+		map<string, JobState>::const_iterator it = states_.find(_jobIds[i]);
+		JobState state_ = it == states_.end() ? UNDETERMINED : it->second;
+		if (reached(state_, complete_ && it == states_.end(), _terminated)) {
+			_index = i;
+			_state = state_;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool JobAnyWaiter::waitsForStart() const {
+	return !_terminated;
+}
+
+bool JobAnyWaiter::isDone() const {
+	return _status != WAITING;
+}
+
+void JobWaitPoller::finish(JobWaiter *waiter_) {
+	_wheel.cancel(waiter_);
+	if (waiter_->_attached && waiter_->isDone()) {
+		_waiters.erase(waiter_->_pos);
+		waiter_->_attached = false;
+	}
+	pthread_cond_broadcast(&waiter_->_cond);
+}
+
+void JobWaitPoller::poll() {
+	pthread_mutex_lock(&_mutex);
+	for (;;) {
+		while (_waiters.empty())
+			pthread_cond_wait(&_cond, &_mutex);
+		// The accounting log is read every tick, it costs no DRMS query
+		pthread_mutex_unlock(&_mutex);
+		AccountingLog *log_ = AccountingLog::getInstance();
+		bool ended_ = log_->refresh() > 0;
+		bool logged_ = log_->isAvailable();
+		pthread_mutex_lock(&_mutex);
+		bool startWaits_ = !logged_;
+		for (list<JobWaiter*>::iterator it = _waiters.begin();
+				!startWaits_ && it != _waiters.end(); ++it)
+			startWaits_ = (*it)->waitsForStart();
+		// While the log reports the terminations the DRMS is only asked
+		// for new waits and as a safety net
+		unsigned long long interval_ = (startWaits_ ? WAIT_POLL_MS :
+				WAIT_ACCOUNTING_POLL_MS) / WAIT_TICK_MS;
+		unsigned long long now_ = currentTick();
+		bool query_ = now_ >= _lastQuery + interval_ || (_fresh
+				&& now_ >= _lastQuery + WAIT_FRESH_POLL_MS / WAIT_TICK_MS);
+		// Jobs whose output just showed up are checked by id in between
+		bool hintDue_ = !_hinted.empty() && (_hintPending
+				|| now_ >= _lastHint + WAIT_HINT_POLL_MS / WAIT_TICK_MS);
+		if (query_ || ended_ || hintDue_) {
+			if (query_) {
+				_fresh = false;
+				_lastQuery = now_;
+			}
+			// detach() waits for _querying to drop, the snapshot stays
+			// valid while the query runs unlocked
+			vector<JobWaiter*> queried_(_waiters.begin(), _waiters.end());
+			list<string> jobIds_;
+			for (size_t i = 0; i < queried_.size(); i++)
+				queried_[i]->getJobIds(jobIds_);
+			list<string> hinted_;
+			if (!_hinted.empty()) {
+				hintedJobs(now_, jobIds_, hinted_);
+				if (hintDue_) {
+					_hintPending = false;
+					_lastHint = now_;
+				}
+				if (query_ || !hintDue_)
+					hinted_.clear();
+			}
+			_querying = true;
+			pthread_mutex_unlock(&_mutex);
+			map<string, JobState> states_;
+			bool complete_ = query_ && queryStates(jobIds_, states_);
+			if (!complete_) {
+				if (!hinted_.empty())
+					hintStates(hinted_, states_);
+				logStates(jobIds_, states_);
+			}
+			pthread_mutex_lock(&_mutex);
+			_querying = false;
+			pthread_cond_broadcast(&_idle);
+			for (size_t i = 0; i < queried_.size(); i++) {
+				if (queried_[i]->check(states_, complete_)
+						|| queried_[i]->isDone()) {
+					queried_[i]->_status = JobWaiter::SATISFIED;
+					finish(queried_[i]);
+				}
+			}
+			for (map<string, JobState>::iterator it = states_.begin();
+					it != states_.end(); ++it)
+				if (it->second == DONE || it->second == FAILED)
+					_hinted.erase(it->first);
+		}
+		list<TimerEntry*> expired_;
+		_wheel.advance(currentTick(), expired_);
+		for (list<TimerEntry*>::iterator it = expired_.begin();
+				it != expired_.end(); ++it) {
+			JobWaiter *waiter_ = static_cast<JobWaiter*>(*it);
+			waiter_->_status = JobWaiter::TIMED_OUT;
+			finish(waiter_);
+		}
+		if (_waiters.empty())
+			continue;
+		struct timeval now;
+		struct timespec until_;
+		gettimeofday(&now, NULL);
+		long usec_ = now.tv_usec + WAIT_TICK_MS * 1000;
+		until_.tv_sec = now.tv_sec + usec_ / 1000000;
+		until_.tv_nsec = (usec_ % 1000000) * 1000;
+		pthread_cond_timedwait(&_cond, &_mutex, &until_);
+	}
+}
+
+size_t JobWaitPoller::wait(const vector<string>& jobIds_,
+		const bool terminated_, const TimeAmount timeout_, JobState& state_)
+		throw (TimeoutException, OutOfResourceException) {
+	JobAnyWaiter waiter_(jobIds_, terminated_);
+	if (timeout_ == 0) {
+		list<string> ids_(jobIds_.begin(), jobIds_.end());
+		map<string, JobState> states_;
+		if (!queryStates(ids_, states_) || !waiter_.check(states_, true))
+			throw TimeoutException(DRMAA2_SOURCEINFO());
+		state_ = waiter_._state;
+		return waiter_._index;
+	}
+	pthread_mutex_lock(&_mutex);
+	try {
+		attach(&waiter_);
+	} catch (const OutOfResourceException &ex) {
+		pthread_mutex_unlock(&_mutex);
+		throw ;
+	}
+	block(&waiter_, timeout_);
+	pthread_mutex_unlock(&_mutex);
+	if (waiter_._status == JobWaiter::TIMED_OUT)
+		throw TimeoutException(DRMAA2_SOURCEINFO());
+	state_ = waiter_._state;
+	return waiter_._index;
+}
+
+void JobWaitPoller::attach(JobWaiter *waiter_) throw (OutOfResourceException) {
+	if (!_started)
+		throw OutOfResourceException(DRMAA2_SOURCEINFO(), Message(
+				OUT_OF_RESOURCE_SHORT, POLLER_START_FAILED));
+	if (waiter_->_attached)
+		return;
+	waiter_->_pos = _waiters.insert(_waiters.end(), waiter_);
+	waiter_->_attached = true;
+	_fresh = true;
+	pthread_cond_signal(&_cond);
+}
+
+void JobWaitPoller::detach(JobWaiter *waiter_) {
+	while (_querying)
+		pthread_cond_wait(&_idle, &_mutex);
+	_wheel.cancel(waiter_);
+	if (!waiter_->_attached)
+		return;
+	_waiters.erase(waiter_->_pos);
+	waiter_->_attached = false;
+}
+
+void JobWaitPoller::block(JobWaiter *waiter_, const TimeAmount timeout_) {
+	waiter_->_status = JobWaiter::WAITING;
+	if (timeout_ > 0) {
+		unsigned long long now_ = currentTick();
+		if (_wheel.size() == 0) {
+			list<TimerEntry*> none_;
+			_wheel.advance(now_, none_);
+		}
+		_wheel.schedule(waiter_, now_ + (unsigned long long) timeout_
+				* 1000 / WAIT_TICK_MS);
+	}
+	while (waiter_->_status == JobWaiter::WAITING)
+		pthread_cond_wait(&waiter_->_cond, &_mutex);
+}
+
+bool JobWaitPoller::refresh(JobWaiter *waiter_) {
+	list<string> jobIds_;
+	waiter_->getJobIds(jobIds_);
+	pthread_mutex_unlock(&_mutex);
+	map<string, JobState> states_;
+	bool complete_ = queryStates(jobIds_, states_);
+	if (!complete_)
+		logStates(jobIds_, states_);
+	pthread_mutex_lock(&_mutex);
+	return waiter_->check(states_, complete_);
+}
+
+void JobWaitPoller::hint(const list<string>& jobIds_) {
+	pthread_mutex_lock(&_mutex);
+	if (!_waiters.empty()) {
+		unsigned long long until_ = currentTick()
+				+ WAIT_HINT_WINDOW_MS / WAIT_TICK_MS;
+		for (list<string>::const_iterator it = jobIds_.begin();
+				it != jobIds_.end(); ++it)
+			_hinted[*it] = until_;
+		_hintPending = true;
+		pthread_cond_signal(&_cond);
+	}
+	pthread_mutex_unlock(&_mutex);
+}
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <JobWaitSetImpl.h>
+#include <InvalidStateException.h>
+#include <SourceInfo.h>
+
+namespace drmaa2 {
+
+JobWaitSetImpl::~JobWaitSetImpl() {
+	JobWaitPoller *poller_ = JobWaitPoller::getInstance();
+	poller_->lock();
+	poller_->detach(this);
+	poller_->unlock();
+}
+
+void JobWaitSetImpl::add(const Job& job_) {
+	JobWaitPoller *poller_ = JobWaitPoller::getInstance();
+	poller_->lock();
+	Job *j_ = const_cast<Job*>(&job_);
+	bool ready_ = false;
+	for (JobList::iterator it = _ready.begin(); it != _ready.end(); ++it)
+		if (*it == j_)
+			ready_ = true;
+	if (!ready_)
+		_pending[job_.getJobId()] = j_;
+	try {
+		poller_->attach(this);
+	} catch (const OutOfResourceException &ex) {
+		// Reported by the next wait
+	}
+	poller_->unlock();
+}
+
+void JobWaitSetImpl::remove(const Job& job_) {
+	JobWaitPoller *poller_ = JobWaitPoller::getInstance();
+	poller_->lock();
+	_pending.erase(job_.getJobId());
+	_ready.remove(const_cast<Job*>(&job_));
+	poller_->unlock();
+}
+
+size_t JobWaitSetImpl::size(void) const {
+	JobWaitPoller *poller_ = JobWaitPoller::getInstance();
+	poller_->lock();
+	size_t size_ = _pending.size() + _ready.size();
+	poller_->unlock();
+	return size_;
+}
+
+JobList JobWaitSetImpl::wait(const TimeAmount timeout_) {
+	JobWaitPoller *poller_ = JobWaitPoller::getInstance();
+	poller_->lock();
+	if (_blocked || (_ready.empty() && _pending.empty())) {
+		poller_->unlock();
+		throw InvalidStateException(DRMAA2_SOURCEINFO());
+	}
+	_blocked = true;
+	// A timeout of an earlier wait must not end this one
+	_status = JobWaiter::WAITING;
+	if (_ready.empty() && timeout_ == 0) {
+		poller_->refresh(this);
+	} else if (_ready.empty()) {
+		try {
+			poller_->attach(this);
+		} catch (const OutOfResourceException &ex) {
+			_blocked = false;
+			poller_->unlock();
+			throw ;
+		}
+		while (_ready.empty() && !_pending.empty()
+				&& _status != JobWaiter::TIMED_OUT)
+			poller_->block(this, timeout_);
+	}
+	_blocked = false;
+	JobList ready_;
+	ready_.swap(_ready);
+	poller_->unlock();
+	if (ready_.empty())
+		throw TimeoutException(DRMAA2_SOURCEINFO());
+	return ready_;
+}
+
+void JobWaitSetImpl::getJobIds(list<string>& jobIds_) const {
+	for (map<string, Job*>::const_iterator it = _pending.begin();
+			it != _pending.end(); ++it)
+		jobIds_.push_back(it->first);
+}
+
+bool JobWaitSetImpl::check(const map<string, JobState>& states_,
+		const bool complete_) {
+	map<string, Job*>::iterator it = _pending.begin();
+	while (it != _pending.end()) {
+		map<string, JobState>::const_iterator state_ = states_.find(it->first);
+		if (reached(state_ == states_.end() ? UNDETERMINED : state_->second,
+				complete_ && state_ == states_.end(), _terminated)) {
+			_ready.push_back(it->second);
+			_pending.erase(it++);
+		} else {
+			++it;
+		}
+	}
+	return !_ready.empty();
+}
+
+bool JobWaitSetImpl::waitsForStart() const {
+	return !_terminated;
+}
+
+bool JobWaitSetImpl::isDone() const {
+	return _pending.empty();
+}
+
+} /* namespace drmaa2 */
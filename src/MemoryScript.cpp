@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <MemoryScript.h>
+#include <PBSIFLExtend.h>
+#include <SourceInfo.h>
+#include <sstream>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+namespace drmaa2 {
+
+MemoryScript::MemoryScript(const string& content_)
+		throw (ImplementationSpecificException) : _fd(-1) {
+	stringstream path_;
+#ifdef SYS_memfd_create
+	_fd = syscall(SYS_memfd_create, MEMORY_SCRIPT_NAME, MFD_CLOEXEC);
+#endif
+	if (_fd < 0) {
+		// Kernel without memfd, use tmpfs and drop the name right away
+		char name_[] = MEMORY_SCRIPT_FALLBACK;
+		_fd = mkstemp(name_);
+		if (_fd < 0)
+			throw ImplementationSpecificException(PBSE_SYSTEM,
+					DRMAA2_SOURCEINFO());
+		unlink(name_);
+	}
+	size_t written_ = 0;
+	while (written_ < content_.size()) {
+		ssize_t ret_ = write(_fd, content_.data() + written_,
+				content_.size() - written_);
+		if (ret_ <= 0) {
+			close(_fd);
+			throw ImplementationSpecificException(PBSE_SYSTEM,
+					DRMAA2_SOURCEINFO());
+		}
+		written_ += ret_;
+	}
+	path_ << "/proc/self/fd/" << _fd;
+	_path = path_.str();
+}
+
+MemoryScript::~MemoryScript() {
+	close(_fd);
+}
+
+const string& MemoryScript::getPath(void) const {
+	return _path;
+}
+
+} /* namespace drmaa2 */
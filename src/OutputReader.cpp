@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <OutputReader.h>
+#include <OutputWatcher.h>
+#include <InvalidArgumentException.h>
+#include <SourceInfo.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace drmaa2 {
+
+/**
+ * @brief - Returns the current time in milliseconds
+ *
+ * @return - milliseconds since the epoch
+ */
+static long long currentMs() {
+	struct timeval now_;
+	gettimeofday(&now_, NULL);
+	return (long long) now_.tv_sec * 1000 + now_.tv_usec / 1000;
+}
+
+OutputReader::OutputReader(const string& path_, const string& jobId_,
+		const char kind_) : _jobId(jobId_), _kind(kind_) {
+	if (!OutputWatcher::resolve(path_, _directory, _name))
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+}
+
+string OutputReader::locate() const {
+	if (!_name.empty())
+		return _directory + "/" + _name;
+	DIR *dir_ = opendir(_directory.c_str());
+	if (dir_ == NULL)
+		return string();
+	string found_;
+	struct dirent *entry_;
+	while ((entry_ = readdir(dir_)) != NULL) {
+		if (OutputWatcher::matches(_jobId, entry_->d_name,
+				string(1, _kind))) {
+			found_ = _directory + "/" + entry_->d_name;
+			break;
+		}
+	}
+	closedir(dir_);
+	return found_;
+}
+
+bool OutputReader::readNew(OutputCursor& cursor_, const size_t maxBytes_,
+		string& data_) const {
+	string file_(locate());
+	if (file_.empty())
+		return false;
+	int fd_ = open(file_.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd_ < 0)
+		return false;
+	struct stat st_;
+	if (fstat(fd_, &st_) != 0) {
+		close(fd_);
+		return false;
+	}
+	unsigned long long identity_ = ((unsigned long long) st_.st_dev << 32)
+			^ (unsigned long long) st_.st_ino;
+	if (cursor_.file != identity_) {
+		// Replaced, as by a rotation, the new file is read from its start
+		cursor_.file = identity_;
+		cursor_.offset = 0;
+	} else if ((unsigned long long) st_.st_size < cursor_.offset) {
+		cursor_.offset = 0;
+	}
+	unsigned long long available_ = st_.st_size - cursor_.offset;
+	size_t want_ = available_ < maxBytes_ ? (size_t) available_ : maxBytes_;
+	data_.resize(want_);
+	size_t done_ = 0;
+	while (done_ < want_) {
+		ssize_t read_ = pread(fd_, &data_[done_], want_ - done_,
+				cursor_.offset + done_);
+		if (read_ < 0 && errno == EINTR)
+			continue;
+		if (read_ <= 0)
+			break;
+		done_ += read_;
+	}
+	close(fd_);
+	data_.resize(done_);
+	cursor_.offset += done_;
+	return done_ > 0;
+}
+
+string OutputReader::read(OutputCursor& cursor_, const size_t maxBytes_,
+		const TimeAmount timeout_) const {
+	string data_;
+	if (readNew(cursor_, maxBytes_, data_) || timeout_ == 0 || maxBytes_ == 0)
+		return data_;
+	long long deadline_ = currentMs() + timeout_ * 1000;
+	// Watching the directory also reports the file showing up or being
+	// replaced, the watch is set before the next check so no write is lost
+	int fd_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+	if (fd_ >= 0 && inotify_add_watch(fd_, _directory.c_str(), IN_MODIFY
+			| IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO) < 0) {
+		close(fd_);
+		fd_ = -1;
+	}
+	while (!readNew(cursor_, maxBytes_, data_)) {
+		long long wait_ = OUTPUT_READ_POLL_MS;
+		if (timeout_ > 0) {
+			long long left_ = deadline_ - currentMs();
+			if (left_ <= 0)
+				break;
+			if (left_ < wait_)
+				wait_ = left_;
+		}
+		if (fd_ < 0) {
+			usleep(wait_ * 1000);
+			continue;
+		}
+		struct pollfd ready_;
+		ready_.fd = fd_;
+		ready_.events = POLLIN;
+		if (poll(&ready_, 1, (int) wait_) > 0) {
+			char events_[4096];
+			while (::read(fd_, events_, sizeof(events_)) > 0)
+				;
+		}
+	}
+	if (fd_ >= 0)
+		close(fd_);
+	return data_;
+}
+}
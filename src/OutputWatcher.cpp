@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <OutputWatcher.h>
+#include <JobWaitPoller.h>
+#include <cstdlib>
+#include <errno.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace drmaa2 {
+
+OutputWatcher* OutputWatcher::_instance = 0;
+pthread_mutex_t OutputWatcher::_instMutex = PTHREAD_MUTEX_INITIALIZER;
+
+OutputWatcher::OutputWatcher(const bool enabled_) : _fd(-1), _started(false) {
+	pthread_mutex_init(&_mutex, NULL);
+	if (!enabled_)
+		return;
+	_fd = inotify_init1(IN_CLOEXEC);
+	if (_fd < 0)
+		return;
+	pthread_t thread_;
+	if (pthread_create(&thread_, NULL, &OutputWatcher::watcherMain, this)
+			== 0) {
+		pthread_detach(thread_);
+		_started = true;
+	} else {
+		close(_fd);
+		_fd = -1;
+	}
+}
+
+OutputWatcher* OutputWatcher::getInstance() {
+	pthread_mutex_lock(&_instMutex);
+	if (_instance == 0) {
+		const char *watch_ = getenv(OUTPUT_WATCH_ENV);
+		_instance = new OutputWatcher(watch_ != NULL && *watch_ != '\0'
+				&& string(watch_) != "0");
+	}
+	pthread_mutex_unlock(&_instMutex);
+	return _instance;
+}
+
+void* OutputWatcher::watcherMain(void *arg_) {
+	static_cast<OutputWatcher*>(arg_)->run();
+	return NULL;
+}
+
+bool OutputWatcher::matches(const string& jobId_, const string& name_,
+		const string& kinds_) {
+	string sequence_(jobId_.substr(0, jobId_.find('.')));
+	if (name_.size() < sequence_.size() + 2)
+		return false;
+	size_t suffix_ = name_.size() - sequence_.size() - 2;
+	return name_[suffix_] == '.'
+			&& kinds_.find(name_[suffix_ + 1]) != string::npos
+			&& name_.compare(suffix_ + 2, string::npos, sequence_) == 0;
+}
+
+bool OutputWatcher::resolve(const string& path_, string& directory_,
+		string& name_) {
+	string file_(path_);
+	// PBS takes [hostname:]path, the host part is of no use here
+	size_t colon_ = file_.find(':');
+	if (colon_ != string::npos && colon_ < file_.find('/'))
+		file_.erase(0, colon_ + 1);
+	if (file_.empty())
+		return false;
+	if (file_[0] != '/') {
+		char *cwd_ = getcwd(NULL, 0);
+		if (cwd_ == NULL)
+			return false;
+		file_ = string(cwd_) + "/" + file_;
+		free(cwd_);
+	}
+	struct stat st_;
+	if (stat(file_.c_str(), &st_) == 0 && S_ISDIR(st_.st_mode)) {
+		// PBS names the files itself inside a directory
+		directory_ = file_;
+		name_.clear();
+	} else {
+		size_t slash_ = file_.rfind('/');
+		directory_ = slash_ == 0 ? "/" : file_.substr(0, slash_);
+		name_ = file_.substr(slash_ + 1);
+	}
+	return true;
+}
+
+void OutputWatcher::add(const string& jobId_, const string& path_) {
+	OutputWatch watch_;
+	string directory_;
+	if (!resolve(path_, directory_, watch_.name))
+		return;
+	watch_.wd = inotify_add_watch(_fd, directory_.c_str(),
+			IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (watch_.wd < 0)
+		return;
+	_jobs[jobId_].watches.push_back(watch_);
+	_byFile.insert(make_pair(make_pair(watch_.wd, watch_.name), jobId_));
+	_refs[watch_.wd]++;
+}
+
+void OutputWatcher::remove(const string& jobId_) {
+	map<string, WatchedJob>::iterator job_ = _jobs.find(jobId_);
+	if (job_ == _jobs.end())
+		return;
+	for (size_t i = 0; i < job_->second.watches.size(); i++) {
+		const OutputWatch &watch_ = job_->second.watches[i];
+		pair<multimap<pair<int, string>, string>::iterator,
+				multimap<pair<int, string>, string>::iterator> range_ =
+				_byFile.equal_range(make_pair(watch_.wd, watch_.name));
+		for (multimap<pair<int, string>, string>::iterator it =
+				range_.first; it != range_.second; ++it) {
+			if (it->second == jobId_) {
+				_byFile.erase(it);
+				break;
+			}
+		}
+		map<int, size_t>::iterator refs_ = _refs.find(watch_.wd);
+		if (refs_ != _refs.end() && --refs_->second == 0) {
+			inotify_rm_watch(_fd, watch_.wd);
+			_refs.erase(refs_);
+		}
+	}
+	_order.erase(job_->second.pos);
+	_jobs.erase(job_);
+}
+
+void OutputWatcher::watch(const string& jobId_,
+		const JobTemplate& jobTemplate_) {
+	if (!_started
+			|| (jobTemplate_.outputPath.empty()
+					&& jobTemplate_.errorPath.empty()))
+		return;
+	pthread_mutex_lock(&_mutex);
+	if (_jobs.find(jobId_) == _jobs.end()) {
+		add(jobId_, jobTemplate_.outputPath);
+		if (!jobTemplate_.joinFiles)
+			add(jobId_, jobTemplate_.errorPath);
+		map<string, WatchedJob>::iterator job_ = _jobs.find(jobId_);
+		if (job_ != _jobs.end()) {
+			job_->second.pos = _order.insert(_order.end(), jobId_);
+			// Oldest first, their files are likely delivered elsewhere
+			while (_order.size() > OUTPUT_WATCH_MAX_JOBS)
+				remove(string(_order.front()));
+		}
+	}
+	pthread_mutex_unlock(&_mutex);
+}
+
+void OutputWatcher::run() {
+	char buffer_[OUTPUT_WATCH_BUFFER]
+			__attribute__ ((aligned(__alignof__(struct inotify_event))));
+	for (;;) {
+		ssize_t read_ = read(_fd, buffer_, sizeof(buffer_));
+		if (read_ <= 0) {
+			if (read_ < 0 && errno == EINTR)
+				continue;
+			break;
+		}
+		list<string> jobIds_;
+		pthread_mutex_lock(&_mutex);
+		for (char *it = buffer_; it < buffer_ + read_;) {
+			struct inotify_event *event_ =
+					reinterpret_cast<struct inotify_event*>(it);
+			it += sizeof(struct inotify_event) + event_->len;
+			if (event_->len == 0)
+				continue;
+			string name_(event_->name);
+			pair<multimap<pair<int, string>, string>::iterator,
+					multimap<pair<int, string>, string>::iterator> range_ =
+					_byFile.equal_range(make_pair(event_->wd, name_));
+			for (; range_.first != range_.second; ++range_.first)
+				jobIds_.push_back(range_.first->second);
+			range_ = _byFile.equal_range(make_pair(event_->wd, string()));
+			for (; range_.first != range_.second; ++range_.first)
+				if (matches(range_.first->second, name_))
+					jobIds_.push_back(range_.first->second);
+		}
+		// One hint per job, the poller keeps checking it for a while
+		jobIds_.sort();
+		jobIds_.unique();
+		for (list<string>::iterator it = jobIds_.begin(); it != jobIds_.end();
+				++it)
+			remove(*it);
+		pthread_mutex_unlock(&_mutex);
+		if (!jobIds_.empty())
+			JobWaitPoller::getInstance()->hint(jobIds_);
+	}
+}
+}
@@ -36,15 +36,19 @@
  */
 
 #include <Message.h>
+#include <ConnectionPool.h>
 #include <PBSConnection.h>
 #include <PBSIFLExtend.h>
+#include <JobArchive.h>
 #include <JobImpl.h>
 #include <PBSProSystem.h>
 #include <cstdlib>
 #include <ctime>
 #include <exception>
 #include <list>
+#include <set>
 #include <JobTemplateAttrHelper.h>
+#include <JobAlterationAttrHelper.h>
 #include <ReservationTemplateAttrHelper.h>
 #include <drmaa2.hpp>
 #include <Drmaa2Exception.h>
@@ -53,6 +57,7 @@
 #include <InvalidArgumentException.h>
 #include <InvalidStateException.h>
 #include <ImplementationSpecificException.h>
+#include <UnsupportedAttributeException.h>
 #include <SourceInfo.h>
 #include <JobArrayImpl.h>
 #include <ReservationImpl.h>
@@ -61,13 +66,17 @@
 #include <string.h>
 #include <sstream>
 #include <algorithm>
+#include <MemoryScript.h>
+#include <OutputWatcher.h>
+#include <ctype.h>
+#include <pwd.h>
+#include <unistd.h>
 
 namespace drmaa2 {
 pthread_mutex_t PBSProSystem::_posixMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t PBSProSystem::_probeMutex = PTHREAD_MUTEX_INITIALIZER;
 
-PBSProSystem::PBSProSystem() {
-	// TODO Auto-generated constructor stub
-
+PBSProSystem::PBSProSystem() : _maxRunSubjobs(-1) {
 }
 
 PBSProSystem::~PBSProSystem() {
@@ -96,36 +105,224 @@ void PBSProSystem::disconnect(const Connection & connection_)
 }
 
 Job* PBSProSystem::runJob(const Connection& connection_,
-		const JobTemplate& jobTemplate_) throw (ImplementationSpecificException) {
+		const JobTemplate& jobTemplate_, const EnvironmentEncoder *environment_)
+		throw (ImplementationSpecificException) {
+	JobTemplateAttrHelper _attrParse;
+	_attrParse.setBaseEnvironment(environment_);
+	return submitJob(connection_, _attrParse, jobTemplate_,
+			jobTemplate_.remoteCommand);
+}
+
+Job* PBSProSystem::runJob(const Connection& connection_,
+		const JobTemplate& jobTemplate_, const list<string>& afterOk_,
+		const EnvironmentEncoder *environment_)
+		throw (ImplementationSpecificException) {
+	string depend_;
+	JobTemplateAttrHelper _attrParse;
+	_attrParse.setBaseEnvironment(environment_);
+	if (!afterOk_.empty()) {
+		depend_.assign(DEPEND_AFTEROK);
+		for (list<string>::const_iterator it = afterOk_.begin();
+				it != afterOk_.end(); ++it) {
+			depend_.append(":");
+			depend_.append(*it);
+		}
+		_attrParse.setAttribute((char *) ATTR_depend, (char *) depend_.c_str());
+	}
+	return submitJob(connection_, _attrParse, jobTemplate_,
+			jobTemplate_.remoteCommand);
+}
+
+Job* PBSProSystem::submitJob(const Connection& connection_,
+		JobTemplateAttrHelper& attrParse_, const JobTemplate& jobTemplate_,
+		const string& script_) throw (ImplementationSpecificException) {
 	string destination_;
 	char *jobIdFromDRMS_;
 	const PBSConnection *pbsCnHolder_ =
 			dynamic_cast<const PBSConnection*>(&connection_);
-	JobTemplateAttrHelper _attrParse;
 
 	if (!jobTemplate_.reservationId.empty())
 		destination_.append(jobTemplate_.queueName);
 	else if (!jobTemplate_.queueName.empty())
 		destination_.append(jobTemplate_.queueName);
 
-	ATTRL *attributeList = _attrParse.parseTemplate((void*) &jobTemplate_);
-	jobIdFromDRMS_ = pbs_submit(pbsCnHolder_->getFd(),
-			(struct attropl *) attributeList,
-			(char*) jobTemplate_.remoteCommand.c_str(),
-			(char*) destination_.c_str(), NULL);
+	ATTRL *attributeList = attrParse_.parseTemplate((void*) &jobTemplate_);
+	if (destination_.empty() && jobTemplate_.reservationId.empty())
+		destination_.assign(attrParse_._categoryQueue);
+	if (!jobTemplate_.scriptBody.empty()) {
+		MemoryScript memoryScript_(jobTemplate_.scriptBody);
+		jobIdFromDRMS_ = pbs_submit(pbsCnHolder_->getFd(),
+				(struct attropl *) attributeList,
+				(char*) memoryScript_.getPath().c_str(),
+				(char*) destination_.c_str(), NULL);
+	} else {
+		jobIdFromDRMS_ = pbs_submit(pbsCnHolder_->getFd(),
+				(struct attropl *) attributeList,
+				(char*) script_.c_str(),
+				(char*) destination_.c_str(), NULL);
+	}
 	if (jobIdFromDRMS_) {
 		string jobId_(jobIdFromDRMS_);
 		free(jobIdFromDRMS_);
+		OutputWatcher::getInstance()->watch(jobId_, jobTemplate_);
 		return new JobImpl(jobId_, jobTemplate_);
 	} else {
 		throw ImplementationSpecificException(pbs_errno,
 		DRMAA2_SOURCEINFO());
 	}
 }
+
+bool PBSProSystem::isValidSubmitKey(const string& submitKey_) {
+	if (submitKey_.empty())
+		return false;
+	for (string::const_iterator it = submitKey_.begin();
+			it != submitKey_.end(); ++it) {
+		if (isspace((unsigned char) *it) || *it == ',' || *it == '\\')
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief - Tells whether the server may have created the job although
+ * 			pbs_submit failed, as with a reply lost to a timeout
+ *
+ * @param[in] errorCode_ - PBS error of the failed submission
+ *
+ * @return - true if the outcome is unknown
+ */
+static bool submitOutcomeUnknown(const long errorCode_) {
+	return errorCode_ == PBSE_PROTOCOL || errorCode_ == PBSE_SYSTEM;
+}
+
+/**
+ * @brief - Tells whether a Variable_List value holds entry_, honoring the
+ * 			backslash escapes of the encoding
+ *
+ * @param[in] variables_ - Variable_List value
+ * @param[in] entry_ - NAME=value entry looked for
+ *
+ * @return - true if one of the entries equals entry_
+ */
+static bool hasVariable(const char *variables_, const string& entry_) {
+	string current_;
+	for (const char *it = variables_; ; it++) {
+		if (*it == '\0' || *it == ',') {
+			if (current_ == entry_)
+				return true;
+			if (*it == '\0')
+				return false;
+			current_.clear();
+		} else if (*it == '\\' && it[1] != '\0') {
+			current_ += *++it;
+		} else {
+			current_ += *it;
+		}
+	}
+}
+
+Job* PBSProSystem::runKeyedJob(const Connection& connection_,
+		const JobTemplate& jobTemplate_, const string& submitKey_,
+		const EnvironmentEncoder *environment_)
+		throw (ImplementationSpecificException) {
+	JobTemplate keyedTemplate_(jobTemplate_);
+	keyedTemplate_.jobEnvironment[SUBMIT_KEY_VARIABLE] = submitKey_;
+	// Only jobs queued since the first attempt can carry the key
+	time_t queuedAfter_ = time(NULL) - SUBMIT_KEY_CLOCK_SKEW;
+	for (int attempt_ = 1; ; attempt_++) {
+		try {
+			return runJob(connection_, keyedTemplate_, environment_);
+		} catch (const ImplementationSpecificException &ex) {
+			if (attempt_ >= SUBMIT_KEY_RETRIES
+					|| !submitOutcomeUnknown(ex.getErrorCode(0)))
+				throw ;
+		}
+		// The reply is lost and the connection with it, ask the server
+		// whether the job exists before submitting it again
+		string jobId_;
+		for (;;) {
+			try {
+				ConnectionPool::getInstance()->reconnectConnection(connection_);
+				// History included, a short job may already have ended
+				jobId_ = findKeyedJob(connection_, submitKey_,
+						jobTemplate_.jobName, queuedAfter_);
+				break;
+			} catch (const ImplementationSpecificException &ex) {
+				// Submitting without an answer could run the job twice
+				if (++attempt_ > SUBMIT_KEY_RETRIES)
+					throw ;
+			}
+		}
+		if (!jobId_.empty())
+			return new JobImpl(jobId_, keyedTemplate_);
+	}
+}
+
+/**
+ * @brief - Returns the name of the user running the process
+ *
+ * @return - user name, empty if it can not be looked up
+ */
+static string currentUser() {
+	struct passwd pwd_, *result_ = NULL;
+	char buffer_[1024];
+	if (getpwuid_r(geteuid(), &pwd_, buffer_, sizeof(buffer_), &result_) == 0
+			&& result_ != NULL)
+		return string(result_->pw_name);
+	return string();
+}
+
+string PBSProSystem::findKeyedJob(const Connection& connection_,
+		const string& submitKey_, const string& jobName_,
+		const time_t queuedAfter_) throw (ImplementationSpecificException) {
+	JobTemplateAttrHelper criteria_, projection_;
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	string owner_(currentUser()), jobId_;
+	string entry_(SUBMIT_KEY_VARIABLE "=");
+	entry_.append(submitKey_);
+	char queued_[32];
+
+	if (!owner_.empty())
+		criteria_.setAttribute((char *) ATTR_u, (char *) owner_.c_str(), EQ);
+	if (!jobName_.empty())
+		criteria_.setAttribute((char *) ATTR_N, (char *) jobName_.c_str(),
+				EQ);
+	if (queuedAfter_ > 0) {
+		// Bounds the Variable_List transferred to the recent jobs
+		snprintf(queued_, sizeof(queued_), "%ld", (long) queuedAfter_);
+		criteria_.setAttribute((char *) ATTR_qtime, queued_, GE);
+	}
+	projection_.setAttribute((char *) ATTR_v, (char *) "");
+
+	pbs_errno = PBSE_NONE;
+	struct batch_status *batchResponse_ = pbs_selstat(pbsCnHolder_->getFd(),
+			(struct attropl *) criteria_.getAttributeList(),
+			projection_.getAttributeList(), (char *) "x");
+	if (batchResponse_ == NULL && pbs_errno != PBSE_NONE)
+		throw ImplementationSpecificException(pbs_errno, DRMAA2_SOURCEINFO());
+	for (struct batch_status *it = batchResponse_; it && jobId_.empty();
+			it = it->next) {
+		JobTemplateAttrHelper attribs_(it->attribs);
+		const char *variables_ = attribs_.getAttribute((char *) ATTR_v, NULL);
+		if (variables_ && hasVariable(variables_, entry_))
+			jobId_.assign(it->name);
+	}
+	if (batchResponse_)
+		pbs_statfree(batchResponse_);
+	return jobId_;
+}
+
 void PBSProSystem::checkForPBS_ErrorException() throw (InvalidStateException,
 		ImplementationSpecificException, DeniedByDrmsException) {
+	checkForPBS_ErrorException(pbs_errno);
+}
+
+void PBSProSystem::checkForPBS_ErrorException(const int errorCode_) throw (
+		InvalidStateException, ImplementationSpecificException,
+		DeniedByDrmsException) {
 
-	switch (pbs_errno) {
+	switch (errorCode_) {
 		case PBSE_BADSTATE:
 		case PBSE_MODATRRUN:
 		case PBSE_ALRDYEXIT:
@@ -142,10 +339,11 @@ void PBSProSystem::checkForPBS_ErrorException() throw (InvalidStateException,
 			throw DeniedByDrmsException(DRMAA2_SOURCEINFO());
 		case PBSE_NOATTR:
 		default:
-			throw ImplementationSpecificException(pbs_errno,
+			throw ImplementationSpecificException(errorCode_,
 				DRMAA2_SOURCEINFO());
 	}
 }
+
 void PBSProSystem::hold(const Connection& connection_, const Job& job_)
 		throw (InvalidStateException, DeniedByDrmsException,
 		ImplementationSpecificException) {
@@ -211,16 +409,300 @@ void PBSProSystem::terminate(const Connection& connection_, const Job& job_)
 	}
 }
 
+/**
+ * @brief - Stores the outcome of a failed job operation in result_
+ *
+ * @param[out] result_ - result of the job
+ * @param[in] ex_ - exception raised for the job
+ * @param[in] serverMsg_ - text the server sent with the error, may be NULL
+ */
+static void setOperationError(JobOperationResult &result_,
+		const Drmaa2Exception &ex_, const char *serverMsg_) {
+	result_.error = toErrorCode(ex_);
+	if (serverMsg_ && *serverMsg_)
+		result_.message.assign(serverMsg_);
+	else
+		result_.message = ex_.getMessage().getDetailMsg();
+}
+
+/**
+ * @brief - Sends operation_ for one job
+ *
+ * @param[in] fd_ - connection to the server
+ * @param[in] operation_ - operation to apply
+ * @param[in] jobId_ - job id
+ *
+ * @return - 0 on success, non zero with pbs_errno set otherwise
+ */
+static int sendOperation(const int fd_, const JobOperation operation_,
+		char *jobId_) {
+	switch (operation_) {
+	case SUSPEND_JOB:
+		return pbs_sigjob(fd_, jobId_, (char *) CMD_SUSPEND, NULL);
+	case RESUME_JOB:
+		return pbs_sigjob(fd_, jobId_, (char *) CMD_RESUME, NULL);
+	case HOLD_JOB:
+		return pbs_holdjob(fd_, jobId_, NULL, NULL);
+	case RELEASE_JOB:
+		return pbs_rlsjob(fd_, jobId_, NULL, NULL);
+	case TERMINATE_JOB:
+		return pbs_deljob(fd_, jobId_, NULL);
+	}
+	return 0;
+}
+
+#ifdef HAVE_PBS_DELJOBLIST
+/**
+ * @brief - Returns the form of a job id pbs_deljoblist failures are
+ * 			matched by, the sequence number with any array index and the
+ * 			first label of the server name, so that short and fully
+ * 			qualified server names match
+ *
+ * @param[in] jobId_ - job id
+ *
+ * @return - matching key, "#" prefixed to differ from any job id
+ */
+static string deljobKey(const string& jobId_) {
+	size_t end_ = jobId_.find(']');
+	size_t dot_ = jobId_.find('.', end_ == string::npos ? 0 : end_);
+	if (dot_ == string::npos)
+		return "#" + jobId_;
+	size_t server_ = jobId_.find('.', dot_ + 1);
+	return "#" + jobId_.substr(0, server_);
+}
+#endif
+
+void PBSProSystem::control(const Connection& connection_,
+		const JobOperation operation_, JobOperationResult *results_,
+		const size_t count_) throw () {
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+#ifdef HAVE_PBS_DELJOBLIST
+	// Servers with pbs_deljoblist delete the whole batch in one request and
+	// only report the jobs which could not be deleted.
+	if (operation_ == TERMINATE_JOB) {
+		vector<char*> ids_(count_);
+		map<string, size_t> positions_;
+		for (size_t i = 0; i < count_; i++) {
+			ids_[i] = (char*) results_[i].jobId.c_str();
+			positions_[results_[i].jobId] = i;
+		}
+		for (size_t i = 0; i < count_; i++) {
+			// count_ marks a key shared by several requests
+			string key_(deljobKey(results_[i].jobId));
+			map<string, size_t>::iterator pos_ = positions_.find(key_);
+			if (pos_ == positions_.end())
+				positions_[key_] = i;
+			else if (pos_->second != i)
+				pos_->second = count_;
+		}
+		pbs_errno = PBSE_NONE;
+		struct batch_deljob_status *failed_ = pbs_deljoblist(
+				pbsCnHolder_->getFd(), &ids_[0], (int) count_, NULL);
+		if (failed_ == NULL && pbs_errno != PBSE_NONE) {
+			int errorCode_ = pbs_errno;
+			for (size_t i = 0; i < count_; i++) {
+				try {
+					checkForPBS_ErrorException(errorCode_);
+				} catch (const Drmaa2Exception &ex) {
+					setOperationError(results_[i], ex,
+							pbs_geterrmsg(pbsCnHolder_->getFd()));
+				}
+			}
+			return;
+		}
+		vector<bool> reported_(count_, false);
+		for (struct batch_deljob_status *it = failed_; it; it = it->next) {
+			map<string, size_t>::iterator pos_ = positions_.find(it->name);
+			if (pos_ == positions_.end())
+				pos_ = positions_.find(deljobKey(it->name));
+			try {
+				checkForPBS_ErrorException(it->code);
+			} catch (const Drmaa2Exception &ex) {
+				if (pos_ != positions_.end() && pos_->second != count_) {
+					setOperationError(results_[pos_->second], ex, NULL);
+					reported_[pos_->second] = true;
+					continue;
+				}
+				// Some job failed but which one is unknown, none of the
+				// unreported ones may be taken as deleted
+				string message_("Deleting ");
+				message_.append(it->name).append(" failed, outcome unknown");
+				for (size_t i = 0; i < count_; i++)
+					if (!reported_[i] && results_[i].error == ERROR_NONE)
+						setOperationError(results_[i], ex, message_.c_str());
+			}
+		}
+		pbs_delstatfree(failed_);
+		return;
+	}
+#endif
+	for (size_t i = 0; i < count_; i++) {
+		if (sendOperation(pbsCnHolder_->getFd(), operation_,
+				(char*) results_[i].jobId.c_str()) == 0)
+			continue;
+		try {
+			checkForPBS_ErrorException();
+		} catch (const Drmaa2Exception &ex) {
+			setOperationError(results_[i], ex,
+					pbs_geterrmsg(pbsCnHolder_->getFd()));
+		}
+	}
+}
+
+void PBSProSystem::alter(const Connection& connection_, const Job& job_,
+		const JobAlteration& alteration_) throw (InvalidArgumentException,
+		InvalidStateException, DeniedByDrmsException,
+		ImplementationSpecificException) {
+	JobAlterationAttrHelper attrs_;
+	ATTRL *attrList_ = attrs_.parseTemplate((void *) &alteration_);
+	if (attrList_ == NULL)
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	if (pbs_alterjob(pbsCnHolder_->getFd(), (char*) job_.getJobId().c_str(),
+			attrList_, NULL) != 0)
+		checkForPBS_ErrorException();
+}
+
+void PBSProSystem::alter(const Connection& connection_,
+		JobAlterationAttrHelper& attributes_, JobOperationResult *results_,
+		const size_t count_) throw () {
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	ATTRL *attrList_ = attributes_.getAttributeList();
+	for (size_t i = 0; i < count_; i++) {
+		if (pbs_alterjob(pbsCnHolder_->getFd(),
+				(char*) results_[i].jobId.c_str(), attrList_, NULL) == 0)
+			continue;
+		try {
+			checkForPBS_ErrorException();
+		} catch (const Drmaa2Exception &ex) {
+			setOperationError(results_[i], ex,
+					pbs_geterrmsg(pbsCnHolder_->getFd()));
+		}
+	}
+}
+
+char **PBSProSystem::selectJobs(const Connection& connection_,
+		const JobInfo& filter_) {
+	JobInfo defaults_;
+	if (filter_.exitStatus != defaults_.exitStatus
+			|| !filter_.terminatingSignal.empty()
+			|| !filter_.annotation.empty() || !filter_.jobSubState.empty()
+			|| !filter_.allocatedMachines.empty()
+			|| !filter_.submissionMachine.empty()
+			|| filter_.slots != defaults_.slots
+			|| filter_.wallclockTime != defaults_.wallclockTime
+			|| filter_.cpuTime != defaults_.cpuTime
+			|| filter_.submissionTime != defaults_.submissionTime
+			|| filter_.dispatchTime != defaults_.dispatchTime
+			|| filter_.finishTime != defaults_.finishTime)
+		throw UnsupportedAttributeException(DRMAA2_SOURCEINFO());
+	const char *states_ = NULL;
+	switch (filter_.jobState) {
+	case UNDETERMINED:
+		break;
+	case QUEUED:
+		states_ = "QW";
+		break;
+	case QUEUED_HELD:
+		states_ = "H";
+		break;
+	case RUNNING:
+		states_ = "REB";
+		break;
+	case SUSPENDED:
+		states_ = "S";
+		break;
+	default:
+		throw UnsupportedAttributeException(DRMAA2_SOURCEINFO());
+	}
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	JobTemplateAttrHelper criteria_;
+	if (!filter_.jobOwner.empty())
+		criteria_.setAttribute((char *) ATTR_u,
+				(char *) filter_.jobOwner.c_str(), EQ);
+	if (!filter_.queueName.empty())
+		criteria_.setAttribute((char *) ATTR_q,
+				(char *) filter_.queueName.c_str(), EQ);
+	if (states_)
+		criteria_.setAttribute((char *) ATTR_state, (char *) states_, EQ);
+	pbs_errno = PBSE_NONE;
+	char **jobIds_ = pbs_selectjob(pbsCnHolder_->getFd(),
+			(struct attropl *) criteria_.getAttributeList(), NULL);
+	if (jobIds_ == NULL && pbs_errno != PBSE_NONE)
+		throw ImplementationSpecificException(pbs_errno, DRMAA2_SOURCEINFO());
+	if (jobIds_ != NULL && !filter_.jobId.empty()) {
+		// The ids share the block of the array, so it is compacted in place
+		size_t kept_ = 0;
+		for (size_t i = 0; jobIds_[i] != NULL; i++)
+			if (filter_.jobId == jobIds_[i])
+				jobIds_[kept_++] = jobIds_[i];
+		jobIds_[kept_] = NULL;
+	}
+	return jobIds_;
+}
+
 void PBSProSystem::reap(const Connection& connection_, const Job& job_) throw () {
 	//TODO Add Code here
 	throw std::exception();
 }
 
+/**
+ * @brief - Maps PBS job_state, run_count and Exit_status to JobState
+ *
+ * @param[in] state_ - job_state value
+ * @param[in] runCount_ - run_count value or NULL
+ * @param[in] exitStatus_ - Exit_status value or NULL
+ *
+ * @return - JobState
+ */
+static JobState toJobState(const char *state_, const char *runCount_,
+		const char *exitStatus_) {
+	JobState jobState_;
+	if (state_ == NULL)
+		return UNDETERMINED;
+	switch (state_[0]) {
+	case 'R':
+	case 'E':
+	case 'B':
+		jobState_ = RUNNING;
+		break;
+	case 'Q':
+	case 'W':
+		jobState_ = QUEUED;
+		break;
+	case 'S':
+		jobState_ = SUSPENDED;
+		break;
+	case 'H':
+		jobState_ = QUEUED_HELD;
+		break;
+	case 'F':
+	case 'X':
+		jobState_ = DONE;
+		if (exitStatus_ && atol(exitStatus_) != 0)
+			jobState_ = FAILED;
+		break;
+	default:
+		jobState_ = UNDETERMINED;
+		break;
+	}
+	if (runCount_ && atol(runCount_) > 0) {
+		if (jobState_ == QUEUED)
+			jobState_ = REQUEUED;
+		else if (jobState_ == QUEUED_HELD)
+			jobState_ = REQUEUED_HELD;
+	}
+	return jobState_;
+}
+
 JobState PBSProSystem::state(const Connection& connection_,
 		const Job& job_) throw () {
-	char *runCount_;
 	JobTemplateAttrHelper attrParse_;
-	JobState jobState_;
+	JobState jobState_ = UNDETERMINED;
 	struct batch_status *batchResponse_ = NULL;
 	const PBSConnection *pbsCnHolder_ =
 			dynamic_cast<const PBSConnection*>(&connection_);
@@ -230,42 +712,499 @@ JobState PBSProSystem::state(const Connection& connection_,
 	batchResponse_ = pbs_statjob(pbsCnHolder_->getFd(),
 			(char *) job_.getJobId().c_str(), attributeList_, (char *) "x");
 	if (batchResponse_) {
-		switch (batchResponse_->attribs->value[0]) {
-		case 'R':
-			jobState_ = RUNNING;
-			break;
-		case 'Q':
-			jobState_ = QUEUED;
-			break;
-		case 'S':
-			jobState_ = SUSPENDED;
-			break;
-		case 'H':
-			jobState_ = QUEUED_HELD;
-			break;
-		case 'F':
-			jobState_ = DONE;
-			break;
-		default:
-			jobState_ = UNDETERMINED;
-			break;
+		JobTemplateAttrHelper result_(batchResponse_->attribs);
+		jobState_ = toJobState(
+				result_.getAttribute((char *) ATTR_state, NULL),
+				result_.getAttribute((char *) ATTR_runcount, NULL), NULL);
+		pbs_statfree(batchResponse_);
+	}
+	return jobState_;
+}
+
+/**
+ * @brief - Returns the sequence number of a job id with any array index,
+ * 			the part the server reports unchanged whatever form of the
+ * 			server name was requested
+ *
+ * @param[in] jobId_ - job id
+ *
+ * @return - sequence part of jobId_
+ */
+static string jobSequence(const string& jobId_) {
+	size_t end_ = jobId_.find(']');
+	return jobId_.substr(0,
+			jobId_.find('.', end_ == string::npos ? 0 : end_));
+}
+
+/**
+ * @brief - Maps the sequence part of each requested job id back to the id.
+ * 			Sequences requested under several ids map to an empty string
+ *
+ * @param[in] jobIds_ - requested job ids
+ *
+ * @return - map of sequence to requested id
+ */
+static map<string, string> requestedIds(const list<string>& jobIds_) {
+	map<string, string> requested_;
+	for (list<string>::const_iterator it = jobIds_.begin();
+			it != jobIds_.end(); ++it) {
+		string sequence_(jobSequence(*it));
+		if (requested_.count(sequence_))
+			requested_[sequence_].clear();
+		else
+			requested_[sequence_] = *it;
+	}
+	return requested_;
+}
+
+/**
+ * @brief - Returns the requested id a job reported by the server stands for
+ *
+ * @param[in] requested_ - map built by requestedIds
+ * @param[in] reported_ - job id as reported by the server
+ *
+ * @return - requested id, or reported_ when the sequence is ambiguous or
+ * 			was not requested
+ */
+static string requestedId(const map<string, string>& requested_,
+		const string& reported_) {
+	map<string, string>::const_iterator id_ =
+			requested_.find(jobSequence(reported_));
+	if (id_ != requested_.end() && !id_->second.empty())
+		return id_->second;
+	return reported_;
+}
+
+map<string, JobState> PBSProSystem::getUserJobStates(
+		const Connection& connection_, const list<string>& jobIds_)
+		throw (ImplementationSpecificException) {
+	map<string, JobState> states_;
+	JobTemplateAttrHelper criteria_, projection_;
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	string owner_(currentUser());
+	if (!owner_.empty())
+		criteria_.setAttribute((char *) ATTR_u, (char *) owner_.c_str(), EQ);
+	projection_.setAttribute((char *) ATTR_state, (char *) "");
+	projection_.setAttribute((char *) ATTR_runcount, (char *) "");
+	projection_.setAttribute((char *) ATTR_exit_status, (char *) "");
+	pbs_errno = PBSE_NONE;
+	struct batch_status *batchResponse_ = pbs_selstat(pbsCnHolder_->getFd(),
+			(struct attropl *) criteria_.getAttributeList(),
+			projection_.getAttributeList(), (char *) "x");
+	if (batchResponse_ == NULL && pbs_errno != PBSE_NONE)
+		throw ImplementationSpecificException(pbs_errno, DRMAA2_SOURCEINFO());
+	// The server reports its own form of the ids, match them to the
+	// waited ones by sequence and drop the rest
+	map<string, string> requested_(requestedIds(jobIds_));
+	set<string> waited_(jobIds_.begin(), jobIds_.end());
+	for (struct batch_status *it = batchResponse_; it; it = it->next) {
+		string jobId_(requestedId(requested_, it->name));
+		if (waited_.find(jobId_) == waited_.end())
+			continue;
+		JobTemplateAttrHelper result_(it->attribs);
+		states_[jobId_] = toJobState(
+				result_.getAttribute((char *) ATTR_state, NULL),
+				result_.getAttribute((char *) ATTR_runcount, NULL),
+				result_.getAttribute((char *) ATTR_exit_status, NULL));
+	}
+	if (batchResponse_)
+		pbs_statfree(batchResponse_);
+	return states_;
+}
+
+void PBSProSystem::getUserJobSnapshots(const Connection& connection_,
+		map<string, JobSnapshot>& snapshot_)
+		throw (ImplementationSpecificException) {
+	JobTemplateAttrHelper criteria_, projection_;
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	string owner_(currentUser());
+	if (!owner_.empty())
+		criteria_.setAttribute((char *) ATTR_u, (char *) owner_.c_str(), EQ);
+	projection_.setAttribute((char *) ATTR_state, (char *) "");
+	projection_.setAttribute((char *) ATTR_runcount, (char *) "");
+	projection_.setAttribute((char *) ATTR_exit_status, (char *) "");
+	projection_.setAttribute((char *) ATTR_substate, (char *) "");
+	projection_.setAttribute((char *) ATTR_queue, (char *) "");
+	projection_.setAttribute((char *) ATTR_N, (char *) "");
+	projection_.setAttribute((char *) ATTR_p, (char *) "");
+	projection_.setAttribute((char *) ATTR_h, (char *) "");
+	projection_.setAttribute((char *) ATTR_l, (char *) "");
+	projection_.setAttribute((char *) ATTR_exechost, (char *) "");
+	pbs_errno = PBSE_NONE;
+	struct batch_status *batchResponse_ = pbs_selstat(pbsCnHolder_->getFd(),
+			(struct attropl *) criteria_.getAttributeList(),
+			projection_.getAttributeList(), (char *) "x");
+	if (batchResponse_ == NULL && pbs_errno != PBSE_NONE)
+		throw ImplementationSpecificException(pbs_errno, DRMAA2_SOURCEINFO());
+	for (struct batch_status *it = batchResponse_; it; it = it->next) {
+		const char *state_ = NULL, *runcount_ = NULL, *exit_ = NULL;
+		// FNV-1a over name, resource and value of the other attributes
+		unsigned long digest_ = 2166136261UL;
+		for (struct attrl *attr_ = it->attribs; attr_; attr_ = attr_->next) {
+			if (strcmp(attr_->name, ATTR_state) == 0) {
+				state_ = attr_->value;
+				continue;
+			} else if (strcmp(attr_->name, ATTR_runcount) == 0) {
+				runcount_ = attr_->value;
+				continue;
+			} else if (strcmp(attr_->name, ATTR_exit_status) == 0) {
+				exit_ = attr_->value;
+				continue;
+			}
+			const char *parts_[] = { attr_->name, attr_->resource,
+					attr_->value };
+			for (size_t i = 0; i < 3; i++) {
+				for (const char *c = parts_[i]; c && *c; c++)
+					digest_ = (digest_ ^ (unsigned char) *c) * 16777619UL;
+				digest_ = (digest_ ^ '\n') * 16777619UL;
+			}
 		}
-		if (jobState_ == QUEUED || jobState_ == QUEUED_HELD) {
-			if (batchResponse_->attribs->next) {
-				runCount_ = batchResponse_->attribs->next->value;
-				if (runCount_) {
-					if (atol(runCount_) > 0) {
-						if (jobState_ == QUEUED)
-							jobState_ = REQUEUED;
-						else if (jobState_ == QUEUED_HELD)
-							jobState_ = REQUEUED_HELD;
-					}
+		JobSnapshot &job_ = snapshot_[string(it->name)];
+		job_.state = toJobState(state_, runcount_, exit_);
+		job_.digest = digest_;
+	}
+	if (batchResponse_)
+		pbs_statfree(batchResponse_);
+}
+
+/**
+ * @brief - Runs projected pbs_statjob calls over jobIds_, STAT_BATCH_SIZE
+ * 			ids at a time, and hands the attributes of every job reported
+ * 			to visit_(jobId, attribs) under the id it was requested with.
+ * 			Jobs the server no longer knows (PBSE_UNKJOBID,
+ * 			PBSE_HISTJOBID) are skipped
+ *
+ * @param[in] fd_ - connection to the server
+ * @param[in] jobIds_ - ids of jobs to query
+ * @param[in] attributeList_ - attributes to project
+ * @param[in] visit_ - called once per job reported
+ *
+ * @throw ImplementationSpecificException - If the server fails otherwise
+ */
+template<class Visitor>
+static void statJobList(const int fd_, const list<string>& jobIds_,
+		ATTRL *attributeList_, Visitor& visit_) {
+	list<string>::const_iterator next_ = jobIds_.begin();
+	while (next_ != jobIds_.end()) {
+		list<string> batch_;
+		string idList_;
+		for (; next_ != jobIds_.end() && batch_.size() < STAT_BATCH_SIZE;
+				++next_) {
+			batch_.push_back(*next_);
+			if (!idList_.empty())
+				idList_.append(",");
+			idList_.append(*next_);
+		}
+		pbs_errno = PBSE_NONE;
+		struct batch_status *batchResponse_ = pbs_statjob(fd_,
+				(char *) idList_.c_str(), attributeList_, (char *) "x");
+		if (batchResponse_ == NULL && pbs_errno != PBSE_NONE
+				&& batch_.size() == 1) {
+			if (pbs_errno != PBSE_UNKJOBID && pbs_errno != PBSE_HISTJOBID)
+				throw ImplementationSpecificException(pbs_errno,
+						DRMAA2_SOURCEINFO());
+			continue;
+		}
+		if (batchResponse_ == NULL && pbs_errno != PBSE_NONE) {
+			// Server refused the id list, typically because one of the
+			// jobs is gone. Fall back to one query per job.
+			for (list<string>::iterator it = batch_.begin();
+					it != batch_.end(); ++it) {
+				pbs_errno = PBSE_NONE;
+				struct batch_status *single_ = pbs_statjob(fd_,
+						(char *) it->c_str(), attributeList_, (char *) "x");
+				if (single_ == NULL) {
+					if (pbs_errno != PBSE_NONE && pbs_errno != PBSE_UNKJOBID
+							&& pbs_errno != PBSE_HISTJOBID)
+						throw ImplementationSpecificException(pbs_errno,
+								DRMAA2_SOURCEINFO());
+					continue;
 				}
+				visit_(*it, single_->attribs);
+				pbs_statfree(single_);
 			}
+			continue;
 		}
+		// The server answers with its own form of the ids, "1.srv" may
+		// come back as "1.srv.example.com"
+		map<string, string> requested_(requestedIds(batch_));
+		for (struct batch_status *it = batchResponse_; it; it = it->next)
+			visit_(requestedId(requested_, it->name), it->attribs);
+		if (batchResponse_)
+			pbs_statfree(batchResponse_);
+	}
+}
+
+/**
+ * @brief - Collects the JobState of the jobs walked by statJobList
+ */
+struct JobStateVisitor {
+	map<string, JobState> &states_;
+	JobStateVisitor(map<string, JobState>& states) : states_(states) {
+	}
+	void operator()(const string& jobId_, struct attrl *attribs_) {
+		JobTemplateAttrHelper result_(attribs_);
+		states_[jobId_] = toJobState(
+				result_.getAttribute((char *) ATTR_state, NULL),
+				result_.getAttribute((char *) ATTR_runcount, NULL),
+				result_.getAttribute((char *) ATTR_exit_status, NULL));
+	}
+};
+
+/**
+ * @brief - Collects the JobUsage of the jobs walked by statJobList
+ */
+struct JobUsageVisitor {
+	map<string, JobUsage> &usage_;
+	JobUsageVisitor(map<string, JobUsage>& usage) : usage_(usage) {
+	}
+	void operator()(const string& jobId_, struct attrl *attribs_) {
+		JobTemplateAttrHelper result_(attribs_);
+		JobUsage &usage = usage_[jobId_];
+		usage.state = toJobState(
+				result_.getAttribute((char *) ATTR_state, NULL),
+				result_.getAttribute((char *) ATTR_runcount, NULL),
+				result_.getAttribute((char *) ATTR_exit_status, NULL));
+		char *value_ = result_.getAttribute((char *) ATTR_used,
+				(char *) CPUTIME);
+		if (value_) {
+			usage.sampled = true;
+			usage.usage.cpuTime = PBSProSystem::parseDuration(value_);
+		}
+		value_ = result_.getAttribute((char *) ATTR_used, (char *) MEM);
+		if (value_) {
+			usage.sampled = true;
+			usage.usage.memory = PBSProSystem::parseSize(value_);
+		}
+		value_ = result_.getAttribute((char *) ATTR_used, (char *) WALLTIME);
+		if (value_) {
+			usage.sampled = true;
+			usage.usage.wallclockTime = PBSProSystem::parseDuration(value_);
+		}
+	}
+};
+
+map<string, JobState> PBSProSystem::getJobStates(const Connection& connection_,
+		const list<string>& jobIds_) throw (ImplementationSpecificException) {
+	map<string, JobState> states_;
+	JobTemplateAttrHelper attrParse_;
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	attrParse_.setAttribute((char *) ATTR_state, (char *) "");
+	attrParse_.setAttribute((char *) ATTR_runcount, (char *) "");
+	attrParse_.setAttribute((char *) ATTR_exit_status, (char *) "");
+	for (list<string>::const_iterator it = jobIds_.begin();
+			it != jobIds_.end(); ++it)
+		states_[*it] = UNDETERMINED;
+	JobStateVisitor visitor_(states_);
+	statJobList(pbsCnHolder_->getFd(), jobIds_,
+			attrParse_.getAttributeList(), visitor_);
+	return states_;
+}
+
+map<string, JobUsage> PBSProSystem::getJobUsage(const Connection& connection_,
+		const list<string>& jobIds_) throw (ImplementationSpecificException) {
+	map<string, JobUsage> usage_;
+	JobTemplateAttrHelper attrParse_;
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	attrParse_.setAttribute((char *) ATTR_state, (char *) "");
+	attrParse_.setAttribute((char *) ATTR_runcount, (char *) "");
+	attrParse_.setAttribute((char *) ATTR_exit_status, (char *) "");
+	attrParse_.setAttribute((char *) ATTR_used, (char *) "");
+	JobUsageVisitor visitor_(usage_);
+	statJobList(pbsCnHolder_->getFd(), jobIds_,
+			attrParse_.getAttributeList(), visitor_);
+	return usage_;
+}
+
+time_t PBSProSystem::getChangedJobs(const Connection& connection_,
+		const time_t since_, map<string, JobInfo>& changed_)
+		throw (ImplementationSpecificException) {
+	JobTemplateAttrHelper criteria_, projection_;
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	string owner_(currentUser());
+	char modified_[32];
+	if (!owner_.empty())
+		criteria_.setAttribute((char *) ATTR_u, (char *) owner_.c_str(), EQ);
+	if (since_ > 0) {
+		// GE as mtime has a resolution of seconds, a job modified within
+		// the second of the last sync is fetched again
+		snprintf(modified_, sizeof(modified_), "%ld", (long) since_);
+		criteria_.setAttribute((char *) ATTR_mtime, modified_, GE);
+	}
+	// Only what toJobInfo reads, plus mtime to advance the sync point
+	const char *projected_[] = { ATTR_mtime, ATTR_comment, ATTR_exit_status,
+			ATTR_state, ATTR_runcount, ATTR_owner, ATTR_queue, ATTR_qtime,
+			ATTR_substate, ATTR_stime, ATTR_etime, ATTR_execvnode, ATTR_used };
+	for (size_t i = 0; i < sizeof(projected_) / sizeof(projected_[0]); i++)
+		projection_.setAttribute((char *) projected_[i], (char *) "");
+	pbs_errno = PBSE_NONE;
+	struct batch_status *batchResponse_ = pbs_selstat(pbsCnHolder_->getFd(),
+			(struct attropl *) criteria_.getAttributeList(),
+			projection_.getAttributeList(), (char *) "x");
+	if (batchResponse_ == NULL && pbs_errno != PBSE_NONE)
+		throw ImplementationSpecificException(pbs_errno, DRMAA2_SOURCEINFO());
+	time_t latest_ = since_;
+	for (struct batch_status *it = batchResponse_; it; it = it->next) {
+		JobInfo &info_ = changed_[string(it->name)];
+		info_.jobId = it->name;
+		toJobInfo(it->attribs, info_);
+		JobTemplateAttrHelper result_(it->attribs);
+		char *mtime_ = result_.getAttribute((char *) ATTR_mtime, NULL);
+		if (mtime_ && (time_t) atol(mtime_) > latest_)
+			latest_ = (time_t) atol(mtime_);
+	}
+	if (batchResponse_)
 		pbs_statfree(batchResponse_);
+	return latest_;
+}
+
+void PBSProSystem::getUserJobIds(const Connection& connection_,
+		set<string>& jobIds_) throw (ImplementationSpecificException) {
+	JobTemplateAttrHelper criteria_;
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	string owner_(currentUser());
+	if (!owner_.empty())
+		criteria_.setAttribute((char *) ATTR_u, (char *) owner_.c_str(), EQ);
+	pbs_errno = PBSE_NONE;
+	char **selected_ = pbs_selectjob(pbsCnHolder_->getFd(),
+			(struct attropl *) criteria_.getAttributeList(), (char *) "x");
+	if (selected_ == NULL && pbs_errno != PBSE_NONE)
+		throw ImplementationSpecificException(pbs_errno, DRMAA2_SOURCEINFO());
+	for (size_t i = 0; selected_ && selected_[i] != NULL; i++)
+		jobIds_.insert(string(selected_[i]));
+	free(selected_);
+}
+
+long PBSProSystem::parseDuration(const char *value_) {
+	long seconds_ = 0, field_ = 0;
+	for (const char *c = value_; *c != '\0'; c++) {
+		if (*c == ':') {
+			seconds_ = (seconds_ + field_) * 60;
+			field_ = 0;
+		} else if (*c >= '0' && *c <= '9') {
+			field_ = field_ * 10 + (*c - '0');
+		} else {
+			break;
+		}
+	}
+	return seconds_ + field_;
+}
+
+long long PBSProSystem::parseSize(const char *value_) {
+	static const char scales_[] = "kmgtp";
+	char *unit_;
+	long long size_ = strtoll(value_, &unit_, 10);
+	int shift_ = 0;
+	const char *scale_ = *unit_ == '\0' ? NULL : strchr(scales_,
+			tolower((unsigned char) *unit_));
+	if (scale_ != NULL) {
+		shift_ = 10 * (scale_ - scales_ + 1);
+		unit_++;
+	}
+	// b counts bytes, w words of the server host
+	if (tolower((unsigned char) *unit_) == 'w')
+		size_ *= sizeof(void*);
+	if (shift_ >= 10)
+		return size_ << (shift_ - 10);
+	return (size_ + 1023) >> 10;
+}
+
+void PBSProSystem::toJobInfo(struct attrl *attribs_, JobInfo& jobInfo_) {
+	char *attrVal_;
+	if(attribs_ == NULL)
+		return;
+	JobTemplateAttrHelper attrObj(attribs_);
+	attrVal_ = attrObj.getAttribute((char *)ATTR_comment, NULL);
+	if(attrVal_) {
+		jobInfo_.annotation = string(attrVal_);
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_exit_status, NULL);
+	if(attrVal_) {
+		jobInfo_.exitStatus = atol(attrVal_);
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_state, NULL);
+	if(attrVal_) {
+		switch(attrVal_[0]) {
+			case 'R':
+				jobInfo_.jobState = RUNNING;
+				break;
+			case 'Q':
+				jobInfo_.jobState = QUEUED;
+				break;
+			case 'S':
+				jobInfo_.jobState = SUSPENDED;
+				break;
+			case 'H':
+				jobInfo_.jobState = QUEUED_HELD;
+				break;
+			case 'F':
+				jobInfo_.jobState = jobInfo_.exitStatus != 0 ? FAILED : DONE;
+				break;
+			default:
+				jobInfo_.jobState = UNDETERMINED;
+				break;
+		}
+		if(jobInfo_.jobState == QUEUED || jobInfo_.jobState == QUEUED_HELD) {
+			attrVal_ = attrObj.getAttribute((char *)ATTR_runcount, NULL);
+			if(attrVal_) {
+				if(atol(attrVal_) > 0) {
+					if(jobInfo_.jobState == QUEUED)
+						jobInfo_.jobState = REQUEUED;
+					else if(jobInfo_.jobState == QUEUED_HELD)
+						jobInfo_.jobState = REQUEUED_HELD;
+				}
+			}
+		}
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_owner, NULL);
+	if(attrVal_) {
+		jobInfo_.jobOwner = string(attrVal_);
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_queue, NULL);
+	if(attrVal_) {
+		jobInfo_.queueName = string(attrVal_);
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_qtime, NULL);
+	if(attrVal_) {
+		jobInfo_.submissionTime = (time_t)atol(attrVal_);
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_substate, NULL);
+	if(attrVal_) {
+		jobInfo_.jobSubState = string(attrVal_);
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_stime, NULL);
+	if(attrVal_) {
+		jobInfo_.dispatchTime = (time_t)atol(attrVal_);
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_etime, NULL);
+	if(attrVal_) {
+		jobInfo_.finishTime = (time_t)atol(attrVal_);
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_execvnode, NULL);
+	if(attrVal_) {
+		string str_(attrVal_), token_;
+		size_t pos_ = 0;
+		while ((pos_ = str_.find('+')) != std::string::npos) {
+			token_ = str_.substr(0, pos_);
+			jobInfo_.allocatedMachines.push_back(token_);
+			str_.erase(0, pos_ + 1);
+		}
+		jobInfo_.slots = jobInfo_.allocatedMachines.size();
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_used, (char *)WALLTIME);
+	if(attrVal_) {
+		jobInfo_.wallclockTime = PBSProSystem::parseDuration(attrVal_);
+	}
+	attrVal_ = attrObj.getAttribute((char *)ATTR_used, (char *)CPUTIME);
+	if(attrVal_) {
+		jobInfo_.cpuTime = PBSProSystem::parseDuration(attrVal_);
 	}
-	return jobState_;
 }
 
 Job* PBSProSystem::getJob(const Connection& connection_,
@@ -277,14 +1216,12 @@ Job* PBSProSystem::getJob(const Connection& connection_,
 JobArray* PBSProSystem::runJobArray(const Connection& connection_,
 		const JobTemplate& jobTemplate_, const long beginIndex_,
 		const long endIndex_, const long step_,
-		const long maxParallel_) throw () {
-	string destination_;
+		const long maxParallel_, const EnvironmentEncoder *environment_)
+		throw (ImplementationSpecificException) {
 	string jobIndices_;
 	stringstream strm_;
-	char *jobIdFromDRMS_;
-	const PBSConnection *pbsCnHolder_ =
-			static_cast<const PBSConnection*>(&connection_);
 	JobTemplateAttrHelper _attrParse;
+	_attrParse.setBaseEnvironment(environment_);
 	strm_ << beginIndex_;
 	strm_ << "-";
 	strm_ << endIndex_;
@@ -293,15 +1230,129 @@ JobArray* PBSProSystem::runJobArray(const Connection& connection_,
 		strm_ << step_;
 	}
 	jobIndices_.assign(strm_.str());
+	long count_ = (endIndex_ - beginIndex_) / (step_ > 0 ? step_ : 1) + 1;
+	if (maxParallel_ <= 0 || maxParallel_ >= count_)
+		return submitJobArray(connection_, _attrParse, jobTemplate_,
+				jobTemplate_.remoteCommand, jobIndices_);
+
+	pthread_mutex_lock(&_probeMutex);
+	int maxRunSubjobs_ = _maxRunSubjobs;
+	pthread_mutex_unlock(&_probeMutex);
+	if (maxRunSubjobs_ != 0) {
+		strm_.str("");
+		strm_.clear();
+		strm_ << maxParallel_;
+		string maxRun_(strm_.str());
+		_attrParse.setAttribute((char *) MAX_RUN_SUBJOBS, (char *) maxRun_.c_str());
+		try {
+			JobArray *jobArray_ = submitJobArray(connection_, _attrParse,
+					jobTemplate_, jobTemplate_.remoteCommand, jobIndices_);
+			pthread_mutex_lock(&_probeMutex);
+			_maxRunSubjobs = 1;
+			pthread_mutex_unlock(&_probeMutex);
+			return jobArray_;
+		} catch (const ImplementationSpecificException &ex) {
+			// Only a server that never took the attribute falls back
+			pthread_mutex_lock(&_probeMutex);
+			bool fallback_ = _maxRunSubjobs != 1
+					&& ex.getErrorCode(0) == PBSE_NOATTR;
+			if (fallback_)
+				_maxRunSubjobs = 0;
+			pthread_mutex_unlock(&_probeMutex);
+			if (!fallback_)
+				throw ;
+		}
+	}
+	return submitJobArrayWindows(connection_, jobTemplate_, beginIndex_,
+			endIndex_, step_, maxParallel_, environment_);
+}
+
+JobArray* PBSProSystem::submitJobArrayWindows(const Connection& connection_,
+		const JobTemplate& jobTemplate_, const long beginIndex_,
+		const long endIndex_, const long step_, const long maxParallel_,
+		const EnvironmentEncoder *environment_)
+		throw (ImplementationSpecificException) {
+	long stride_ = step_ > 0 ? step_ : 1;
+	long count_ = (endIndex_ - beginIndex_) / stride_ + 1;
+	JobArrayImpl *first_ = NULL;
+	string previous_;
+	for (long done_ = 0; done_ < count_;) {
+		long size_ = std::min(maxParallel_, count_ - done_);
+		// Keep the last window from becoming a single index
+		if (count_ - done_ - size_ == 1 && size_ > 2)
+			size_--;
+		long start_ = beginIndex_ + done_ * stride_;
+		JobTemplate windowTemplate_(jobTemplate_);
+		stringstream range_;
+		if (size_ > 1) {
+			range_ << start_ << "-" << start_ + (size_ - 1) * stride_;
+			if (step_)
+				range_ << ":" << step_;
+		} else {
+			// PBS does not take a single index array, run it as a plain
+			// job that still sees its index
+			stringstream index_;
+			index_ << start_;
+			windowTemplate_.jobEnvironment["PBS_ARRAY_INDEX"] = index_.str();
+		}
+		JobTemplateAttrHelper attrParse_;
+		attrParse_.setBaseEnvironment(environment_);
+		string depend_;
+		if (!previous_.empty()) {
+			depend_.assign(DEPEND_AFTERANY);
+			depend_.append(":");
+			depend_.append(previous_);
+			attrParse_.setAttribute((char *) ATTR_depend, (char *) depend_.c_str());
+		}
+		JobArray *window_;
+		try {
+			window_ = submitJobArray(connection_, attrParse_, windowTemplate_,
+					windowTemplate_.remoteCommand, range_.str());
+		} catch (const ImplementationSpecificException &ex) {
+			if (first_ != NULL) {
+				first_->terminate();
+				delete first_;
+			}
+			throw ;
+		}
+		previous_ = window_->getJobArrayId();
+		if (first_ == NULL) {
+			first_ = static_cast<JobArrayImpl*>(window_);
+		} else {
+			first_->addWindow(previous_, start_);
+			delete window_;
+		}
+		done_ += size_;
+	}
+	return first_;
+}
+
+JobArray* PBSProSystem::submitJobArray(const Connection& connection_,
+		JobTemplateAttrHelper& attrParse_, const JobTemplate& jobTemplate_,
+		const string& script_, const string& jobIndices_)
+		throw (ImplementationSpecificException) {
+	string destination_;
+	char *jobIdFromDRMS_;
+	const PBSConnection *pbsCnHolder_ =
+			static_cast<const PBSConnection*>(&connection_);
 	if (!jobTemplate_.reservationId.empty())
 		destination_.append(jobTemplate_.queueName);
 	else if (!jobTemplate_.queueName.empty())
 		destination_.append(jobTemplate_.queueName);
 
-	_attrParse.setAttribute((char *)ATTR_J, (char *)jobIndices_.c_str());
-	ATTRL *attributeList = _attrParse.parseTemplate((void*)&jobTemplate_);
-	jobIdFromDRMS_ = pbs_submit(pbsCnHolder_->getFd(), (struct attropl *) attributeList,
-			(char*) jobTemplate_.remoteCommand.c_str(), (char*) destination_.c_str(), NULL);
+	if (!jobIndices_.empty())
+		attrParse_.setAttribute((char *)ATTR_J, (char *)jobIndices_.c_str());
+	ATTRL *attributeList = attrParse_.parseTemplate((void*)&jobTemplate_);
+	if (destination_.empty() && jobTemplate_.reservationId.empty())
+		destination_.assign(attrParse_._categoryQueue);
+	if (!jobTemplate_.scriptBody.empty()) {
+		MemoryScript memoryScript_(jobTemplate_.scriptBody);
+		jobIdFromDRMS_ = pbs_submit(pbsCnHolder_->getFd(), (struct attropl *) attributeList,
+				(char*) memoryScript_.getPath().c_str(), (char*) destination_.c_str(), NULL);
+	} else {
+		jobIdFromDRMS_ = pbs_submit(pbsCnHolder_->getFd(), (struct attropl *) attributeList,
+				(char*) script_.c_str(), (char*) destination_.c_str(), NULL);
+	}
 	if(jobIdFromDRMS_) {
 		string jobArrayId_(jobIdFromDRMS_);
 		free(jobIdFromDRMS_);
@@ -311,6 +1362,273 @@ JobArray* PBSProSystem::runJobArray(const Connection& connection_,
 	}
 }
 
+/**
+ * @brief - Quotes value_ for the POSIX shell
+ *
+ * @param[in] value_ - raw value
+ *
+ * @return - single quoted value
+ */
+static string sweepQuote(const string& value_) {
+	string quoted_("'");
+	for (string::const_iterator it = value_.begin(); it != value_.end(); ++it) {
+		if (*it == '\'')
+			quoted_.append("'\\''");
+		else
+			quoted_.push_back(*it);
+	}
+	quoted_.push_back('\'');
+	return quoted_;
+}
+
+/**
+ * @brief - Returns the JobTemplate a sweep point effectively runs with
+ *
+ * @param[in] jobTemplate_ - base JobTemplate
+ * @param[in] point_ - sweep point
+ *
+ * @return - merged JobTemplate
+ */
+static JobTemplate sweepPointTemplate(const JobTemplate& jobTemplate_,
+		const SweepPoint& point_) {
+	JobTemplate pointTemplate_(jobTemplate_);
+	if (!point_.args.empty())
+		pointTemplate_.args = point_.args;
+	for (map<string, string>::const_iterator it = point_.jobEnvironment.begin();
+			it != point_.jobEnvironment.end(); ++it)
+		pointTemplate_.jobEnvironment[it->first] = it->second;
+	for (map<string, string>::const_iterator it = point_.resourceLimits.begin();
+			it != point_.resourceLimits.end(); ++it)
+		pointTemplate_.resourceLimits[it->first] = it->second;
+	return pointTemplate_;
+}
+
+/**
+ * @brief - Tells whether name_ is a valid shell variable name
+ *
+ * @param[in] name_ - environment variable name
+ *
+ * @return - true if name_ matches [A-Za-z_][A-Za-z0-9_]*
+ */
+static bool isShellName(const string& name_) {
+	if (name_.empty() || isdigit((unsigned char) name_[0]))
+		return false;
+	for (size_t i = 0; i < name_.size(); i++)
+		if (!isalnum((unsigned char) name_[i]) && name_[i] != '_')
+			return false;
+	return true;
+}
+
+/**
+ * @brief - Splits the header off a sweep scriptBody: the shebang line and
+ * 			the comment lines, #PBS directives among them, before the first
+ * 			command. The generated preamble goes after them.
+ *
+ * @param[in] body_ - scriptBody of the template
+ * @param[out] shell_ - shell named by the shebang, /bin/sh without one
+ * @param[out] header_ - header lines without the shebang
+ * @param[out] rest_ - rest of the script
+ *
+ * @return - false if the shebang names anything but the absolute path of
+ * 			a POSIX shell, the preamble could not run
+ */
+static bool sweepScriptHeader(const string& body_, string& shell_,
+		string& header_, string& rest_) {
+	static const char *shells_[] = { "sh", "bash", "dash", "ksh", "zsh" };
+	size_t pos_ = 0;
+	shell_ = "/bin/sh";
+	header_.clear();
+	if (body_.compare(0, 2, "#!") == 0) {
+		size_t eol_ = body_.find('\n');
+		string line_(body_.substr(2, eol_ == string::npos ? string::npos :
+				eol_ - 2));
+		size_t begin_ = line_.find_first_not_of(" \t");
+		size_t end_ = line_.find_first_of(" \t\r", begin_);
+		string path_(begin_ == string::npos ? string() :
+				line_.substr(begin_, end_ == string::npos ? string::npos :
+						end_ - begin_));
+		string name_(path_.substr(path_.rfind('/') + 1));
+		bool known_ = false;
+		for (size_t i = 0; i < sizeof(shells_) / sizeof(shells_[0]); i++)
+			known_ = known_ || name_ == shells_[i];
+		if (path_.empty() || path_[0] != '/' || !known_)
+			return false;
+		shell_ = path_;
+		pos_ = eol_ == string::npos ? body_.size() : eol_ + 1;
+	}
+	while (pos_ < body_.size()) {
+		size_t eol_ = body_.find('\n', pos_);
+		size_t next_ = eol_ == string::npos ? body_.size() : eol_ + 1;
+		size_t first_ = body_.find_first_not_of(" \t\r", pos_);
+		if (first_ < next_ - (eol_ == string::npos ? 0 : 1)
+				&& body_[first_] != '#')
+			break;
+		header_.append(body_, pos_, next_ - pos_);
+		if (eol_ == string::npos)
+			header_.push_back('\n');
+		pos_ = next_;
+	}
+	rest_ = body_.substr(pos_);
+	return true;
+}
+
+/**
+ * @brief - Builds the job script of one sweep array. The script selects
+ * 			the arguments and environment of its point by PBS_ARRAY_INDEX
+ * 			and execs the remote command, or runs the scriptBody whose
+ * 			shebang and directives are kept ahead of the selection.
+ *
+ * @param[in] jobTemplate_ - base JobTemplate
+ * @param[in] points_ - sweep table
+ * @param[in] indices_ - points of the array, array index i runs indices_[i]
+ *
+ * @return - script text
+ */
+static string sweepScript(const JobTemplate& jobTemplate_,
+		const SweepTable& points_, const vector<size_t>& indices_) {
+	stringstream script_;
+	string shell_, header_, body_;
+	sweepScriptHeader(jobTemplate_.scriptBody, shell_, header_, body_);
+	script_ << "#!" << shell_ << "\n" << header_ << "set --";
+	for (vector<string>::const_iterator it = jobTemplate_.args.begin();
+			it != jobTemplate_.args.end(); ++it)
+		script_ << " " << sweepQuote(*it);
+	script_ << "\ncase \"$PBS_ARRAY_INDEX\" in\n";
+	for (size_t i = 0; i < indices_.size(); i++) {
+		const SweepPoint &point_ = points_[indices_[i]];
+		if (point_.args.empty() && point_.jobEnvironment.empty())
+			continue;
+		script_ << i << ")";
+		if (!point_.args.empty()) {
+			script_ << " set --";
+			for (vector<string>::const_iterator it = point_.args.begin();
+					it != point_.args.end(); ++it)
+				script_ << " " << sweepQuote(*it);
+			script_ << ";";
+		}
+		for (map<string, string>::const_iterator it =
+				point_.jobEnvironment.begin();
+				it != point_.jobEnvironment.end(); ++it)
+			script_ << " export " << it->first << "=" << sweepQuote(it->second)
+					<< ";";
+		script_ << ";\n";
+	}
+	script_ << "esac\n";
+	if (!jobTemplate_.scriptBody.empty())
+		script_ << body_ << "\n";
+	else
+		script_ << "exec " << sweepQuote(jobTemplate_.remoteCommand)
+				<< " \"$@\"\n";
+	return script_.str();
+}
+
+/**
+ * @brief - Returns the id of subjob index_ of array jobArrayId_
+ *
+ * @param[in] jobArrayId_ - array id as returned by pbs_submit
+ * @param[in] index_ - subjob index
+ *
+ * @return - subjob id
+ */
+static string sweepSubJobId(const string& jobArrayId_, const size_t index_) {
+	stringstream strm_;
+	size_t pos_ = jobArrayId_.find("[]");
+	if (pos_ == string::npos)
+		return jobArrayId_;
+	strm_ << jobArrayId_.substr(0, pos_ + 1) << index_
+			<< jobArrayId_.substr(pos_ + 1);
+	return strm_.str();
+}
+
+JobList PBSProSystem::runJobSweep(const Connection& connection_,
+		const JobTemplate& jobTemplate_, const SweepTable& points_,
+		const EnvironmentEncoder *environment_)
+		throw (ImplementationSpecificException, InvalidArgumentException) {
+	map<string, vector<size_t> > groups_;
+	vector<Job*> jobs_(points_.size(), (Job*) NULL);
+	list<string> submitted_;
+	string shell_, header_, body_;
+	// The generated preamble is shell code and has to follow the
+	// directives of the scriptBody
+	if (!sweepScriptHeader(jobTemplate_.scriptBody, shell_, header_, body_))
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+	for (size_t i = 0; i < points_.size(); i++) {
+		// The names are written unquoted into the sweep script
+		for (map<string, string>::const_iterator it =
+				points_[i].jobEnvironment.begin();
+				it != points_[i].jobEnvironment.end(); ++it)
+			if (!isShellName(it->first))
+				throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+	}
+	for (size_t i = 0; i < points_.size(); i++) {
+		stringstream key_;
+		for (map<string, string>::const_iterator it =
+				points_[i].resourceLimits.begin();
+				it != points_[i].resourceLimits.end(); ++it)
+			key_ << it->first << "=" << it->second << "\n";
+		groups_[key_.str()].push_back(i);
+	}
+	try {
+		for (map<string, vector<size_t> >::iterator group_ = groups_.begin();
+				group_ != groups_.end(); ++group_) {
+			const vector<size_t> &members_ = group_->second;
+			SweepPoint limits_;
+			limits_.resourceLimits = points_[members_[0]].resourceLimits;
+			JobTemplate groupTemplate_ = sweepPointTemplate(jobTemplate_,
+					limits_);
+			for (size_t start_ = 0; start_ < members_.size();
+					start_ += SWEEP_MAX_ARRAY) {
+				size_t end_ = std::min(members_.size(),
+						start_ + (size_t) SWEEP_MAX_ARRAY);
+				if (end_ - start_ == 1) {
+					jobs_[members_[start_]] = runJob(connection_,
+							sweepPointTemplate(jobTemplate_,
+									points_[members_[start_]]), environment_);
+					submitted_.push_back(jobs_[members_[start_]]->getJobId());
+					continue;
+				}
+				vector<size_t> indices_(members_.begin() + start_,
+						members_.begin() + end_);
+				stringstream range_;
+				range_ << 0 << "-" << indices_.size() - 1;
+				JobTemplate arrayTemplate_(groupTemplate_);
+				arrayTemplate_.scriptBody = sweepScript(groupTemplate_,
+						points_, indices_);
+				arrayTemplate_.remoteCommand.clear();
+				arrayTemplate_.args.clear();
+				JobTemplateAttrHelper attrParse_;
+				attrParse_.setBaseEnvironment(environment_);
+				attrParse_.setAttribute((char *) ATTR_S,
+						(char *) shell_.c_str());
+				JobArray *jobArray_ = submitJobArray(connection_, attrParse_,
+						arrayTemplate_, arrayTemplate_.remoteCommand,
+						range_.str());
+				string jobArrayId_ = jobArray_->getJobArrayId();
+				delete jobArray_;
+				submitted_.push_back(jobArrayId_);
+				for (size_t i = 0; i < indices_.size(); i++) {
+					jobs_[indices_[i]] = new JobImpl(
+							sweepSubJobId(jobArrayId_, i),
+							sweepPointTemplate(jobTemplate_,
+									points_[indices_[i]]));
+				}
+			}
+		}
+	} catch (const ImplementationSpecificException &ex) {
+		// The caller gets no handle to the groups already submitted,
+		// do not leave them queued
+		const PBSConnection *pbsCnHolder_ =
+				dynamic_cast<const PBSConnection*>(&connection_);
+		for (list<string>::iterator it = submitted_.begin();
+				it != submitted_.end(); ++it)
+			pbs_deljob(pbsCnHolder_->getFd(), (char *) it->c_str(), NULL);
+		for (vector<Job*>::iterator it = jobs_.begin(); it != jobs_.end(); ++it)
+			delete *it;
+		throw ;
+	}
+	return JobList(jobs_.begin(), jobs_.end());
+}
+
 void PBSProSystem::hold(const Connection& connection_,
 		const JobArray& jobArray_) throw () {
 	int ret_;
@@ -378,7 +1696,8 @@ JobArray* PBSProSystem::getJobArray(const Connection& connection_,
 }
 
 Reservation* PBSProSystem::submit(const Connection& connection_,
-		const ReservationTemplate& reservationTemplate_) throw () {
+		const ReservationTemplate& reservationTemplate_)
+		throw (ImplementationSpecificException) {
 	char *reservationIdFromDRMS_;
 	ReservationTemplateAttrHelper rAttrParse_;
 	const PBSConnection *pbsCnHolder_ =
@@ -395,7 +1714,8 @@ Reservation* PBSProSystem::submit(const Connection& connection_,
 }
 
 void PBSProSystem::remove(const Connection& connection_,
-		const Reservation& reservation_) throw () {
+		const Reservation& reservation_)
+		throw (ImplementationSpecificException) {
 	int ret;
 	const PBSConnection *pbsCnHolder_ =
 					static_cast<const PBSConnection*>(&connection_);
@@ -431,14 +1751,198 @@ ReservationList PBSProSystem::getAllReservations(
 	return _rList;
 }
 
+/**
+ * @brief - Gets the resv_state of the reservations of idList_
+ *
+ * @param[in] fd_ - connection to the server
+ * @param[in] idList_ - comma separated reservation ids
+ * @param[in] projection_ - attributes to project
+ * @param[out] states_ - receives reservation id to state
+ *
+ * @return - false if the server refused the request, pbs_errno tells why
+ */
+static bool statReservations(const int fd_, const string& idList_,
+		ATTRL *projection_, map<string, int>& states_) {
+	pbs_errno = PBSE_NONE;
+	struct batch_status *batchResponse_ = pbs_statresv(fd_,
+			(char *) idList_.c_str(), projection_, NULL);
+	if (batchResponse_ == NULL && pbs_errno != PBSE_NONE)
+		return false;
+	for (struct batch_status *tmp_ = batchResponse_; tmp_; tmp_ = tmp_->next) {
+		if (tmp_->name == NULL)
+			continue;
+		int state_ = 0;
+		for (struct attrl *attr_ = tmp_->attribs; attr_; attr_ = attr_->next)
+			if (strcmp(attr_->name, ATTR_resv_state) == 0 && attr_->value)
+				state_ = atoi(attr_->value);
+		states_[tmp_->name] = state_;
+	}
+	if (batchResponse_)
+		pbs_statfree(batchResponse_);
+	return true;
+}
+
+void PBSProSystem::checkReservations(const Connection& connection_,
+		set<string>& pending_, set<string>& confirmed_)
+		throw (ImplementationSpecificException) {
+	JobTemplateAttrHelper projection_;
+	const PBSConnection *pbsCnHolder_ =
+			static_cast<const PBSConnection*>(&connection_);
+	projection_.setAttribute((char *) ATTR_resv_state, (char *) "");
+	list<string> ids_(pending_.begin(), pending_.end());
+	map<string, int> states_;
+	list<string>::iterator next_ = ids_.begin();
+	while (next_ != ids_.end()) {
+		list<string> batch_;
+		string idList_;
+		for (; next_ != ids_.end() && batch_.size() < STAT_BATCH_SIZE;
+				++next_) {
+			batch_.push_back(*next_);
+			if (!idList_.empty())
+				idList_.append(",");
+			idList_.append(*next_);
+		}
+		if (statReservations(pbsCnHolder_->getFd(), idList_,
+				projection_.getAttributeList(), states_))
+			continue;
+		if (batch_.size() > 1) {
+			// Typically one of them is gone, ask for each on its own
+			for (list<string>::iterator it = batch_.begin();
+					it != batch_.end(); ++it) {
+				if (!statReservations(pbsCnHolder_->getFd(), *it,
+						projection_.getAttributeList(), states_)
+						&& pbs_errno != PBSE_UNKRESVID)
+					throw ImplementationSpecificException(pbs_errno,
+							DRMAA2_SOURCEINFO());
+			}
+		} else if (pbs_errno != PBSE_UNKRESVID) {
+			throw ImplementationSpecificException(pbs_errno,
+					DRMAA2_SOURCEINFO());
+		}
+	}
+	for (list<string>::iterator it = ids_.begin(); it != ids_.end(); ++it) {
+		map<string, int>::iterator state_ = states_.find(*it);
+		// Denied or removed reservations no longer show up at all
+		if (state_ == states_.end()) {
+			pending_.erase(*it);
+			continue;
+		}
+		if (state_->second == RESV_STATE_UNCONFIRMED || state_->second == 0)
+			continue;
+		pending_.erase(*it);
+		if (state_->second < RESV_STATE_FINISHED
+				|| state_->second > RESV_STATE_DELETING_JOBS)
+			confirmed_.insert(*it);
+	}
+}
+
+/**
+ * @brief - Applies the exact match criteria of getJobs to one job
+ *
+ * @param[in] _jInfo - JobInfo of the job
+ * @param[in] filter_ - JobInfo filter
+ *
+ * @return - true if the job is to be reported
+ */
+static bool matchesFilter(const JobInfo& _jInfo, const JobInfo& filter_) {
+	if (!filter_.jobId.empty() && _jInfo.jobId != filter_.jobId)
+		return false;
+	if (!filter_.annotation.empty()
+			&& _jInfo.annotation != filter_.annotation)
+		return false;
+	if (_jInfo.exitStatus != filter_.exitStatus)
+		return false;
+	if (_jInfo.jobState != filter_.jobState)
+		return false;
+	if (!filter_.annotation.empty()
+			&& _jInfo.submissionMachine != filter_.submissionMachine)
+		return false;
+	if (_jInfo.cpuTime != filter_.cpuTime)
+		return false;
+	if (difftime(_jInfo.wallclockTime, filter_.wallclockTime) > 0)
+		return false;
+	if (difftime(_jInfo.submissionTime, filter_.submissionTime) > 0)
+		return false;
+	if (difftime(_jInfo.dispatchTime, filter_.dispatchTime) > 0)
+		return false;
+	if (difftime(_jInfo.finishTime, filter_.finishTime) > 0)
+		return false;
+	return true;
+}
+
+/**
+ * @brief - Collects the JobInfo of the jobs walked by statJobList
+ */
+struct JobInfoVisitor {
+	map<string, JobInfo> &infos_;
+	JobInfoVisitor(map<string, JobInfo>& infos) : infos_(infos) {
+	}
+	void operator()(const string& jobId_, struct attrl *attribs_) {
+		JobInfo &info = infos_[jobId_];
+		info.jobId = jobId_;
+		PBSProSystem::toJobInfo(attribs_, info);
+	}
+};
+
 JobList PBSProSystem::getJobs(const Connection& connection_,
 		const JobInfo& filter_) throw (ImplementationSpecificException) {
 	JobList _jList;
+	JobArchive *archive_ = JobArchive::getInstance();
+	bool archived_ = archive_->isEnabled();
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	if (JobArchive::matchesFinished(filter_)) {
+		// Archived jobs may already be purged from the server history
+		set<string> seen_;
+		if (archived_) {
+			JobInfoList finished_ = archive_->find(filter_);
+			for (JobInfoList::iterator it = finished_.begin();
+					it != finished_.end(); ++it) {
+				_jList.push_back(new JobImpl(it->jobId, *it));
+				seen_.insert(it->jobId);
+			}
+		}
+		// The rest comes from one projected query over the finished jobs
+		JobTemplateAttrHelper criteria_, projection_;
+		criteria_.setAttribute((char *) ATTR_state, (char *) "F", EQ);
+		if (!filter_.jobOwner.empty())
+			criteria_.setAttribute((char *) ATTR_owner,
+					(char *) filter_.jobOwner.c_str(), EQ);
+		if (!filter_.queueName.empty())
+			criteria_.setAttribute((char *) ATTR_queue,
+					(char *) filter_.queueName.c_str(), EQ);
+		const char *projected_[] = { ATTR_comment, ATTR_exit_status,
+				ATTR_state, ATTR_owner, ATTR_queue, ATTR_qtime, ATTR_substate,
+				ATTR_stime, ATTR_etime, ATTR_execvnode, ATTR_used };
+		for (size_t i = 0; i < sizeof(projected_) / sizeof(projected_[0]); i++)
+			projection_.setAttribute((char *) projected_[i], (char *) "");
+		pbs_errno = PBSE_NONE;
+		struct batch_status *finished_ = pbs_selstat(pbsCnHolder_->getFd(),
+				(struct attropl *) criteria_.getAttributeList(),
+				projection_.getAttributeList(), (char *) "x");
+		if (finished_ == NULL && pbs_errno != PBSE_NONE) {
+			for (JobList::iterator it = _jList.begin(); it != _jList.end();
+					++it)
+				delete *it;
+			throw ImplementationSpecificException(pbs_errno,
+					DRMAA2_SOURCEINFO());
+		}
+		for (struct batch_status *it = finished_; it; it = it->next) {
+			if (it->name == NULL || seen_.count(it->name))
+				continue;
+			JobInfo info_;
+			info_.jobId = it->name;
+			toJobInfo(it->attribs, info_);
+			if (matchesFilter(info_, filter_))
+				_jList.push_back(new JobImpl(info_.jobId));
+		}
+		if (finished_)
+			pbs_statfree(finished_);
+		return _jList;
+	}
 	list<string> _allJobs;
 	struct batch_status *batchRsp_ = (struct batch_status *) 0, *tmpBatchRsp_ =
 			(struct batch_status *) 0;
-	const PBSConnection *pbsCnHolder_ =
-			dynamic_cast<const PBSConnection*>(&connection_);
 	batchRsp_ = pbs_statjob(pbsCnHolder_->getFd(), NULL, NULL, (char *) "x");
 	if(batchRsp_ == NULL)
 		throw ImplementationSpecificException(pbs_errno,SourceInfo(__func__,__LINE__));
@@ -451,47 +1955,15 @@ JobList PBSProSystem::getJobs(const Connection& connection_,
 	}
 	for (list<string>::iterator iterator = _allJobs.begin();
 			iterator != _allJobs.end(); ++iterator) {
-		JobImpl *_job = new JobImpl(*iterator);
-		JobInfo _jInfo = _job->getJobInfo();
-		if (!filter_.jobId.empty() && _jInfo.jobId != filter_.jobId) {
-			delete _job;
-			continue;
-		}
-		if (!filter_.annotation.empty()
-				&& _jInfo.annotation != filter_.annotation) {
-			delete _job;
-			continue;
-		}
-		if (_jInfo.exitStatus != filter_.exitStatus) {
-			delete _job;
-			continue;
-		}
-		if (_jInfo.jobState != filter_.jobState) {
-			delete _job;
+		// Archived records are final, no need to stat the job again
+		JobInfo info_;
+		if (archived_ && archive_->lookup(*iterator, info_)) {
+			if (matchesFilter(info_, filter_))
+				_jList.push_back(new JobImpl(*iterator, info_));
 			continue;
 		}
-		if (!filter_.annotation.empty()
-				&& _jInfo.submissionMachine != filter_.submissionMachine) {
-			delete _job;
-			continue;
-		}
-		if (_jInfo.cpuTime != filter_.cpuTime) {
-			delete _job;
-			continue;
-		}
-		if (difftime(_jInfo.wallclockTime, filter_.wallclockTime) > 0) {
-			delete _job;
-			continue;
-		}
-		if (difftime(_jInfo.submissionTime, filter_.submissionTime) > 0) {
-			delete _job;
-			continue;
-		}
-		if (difftime(_jInfo.dispatchTime, filter_.dispatchTime) > 0) {
-			delete _job;
-			continue;
-		}
-		if (difftime(_jInfo.finishTime, filter_.finishTime) > 0) {
+		JobImpl *_job = new JobImpl(*iterator);
+		if (!matchesFilter(_job->getJobInfo(), filter_)) {
 			delete _job;
 			continue;
 		}
@@ -502,6 +1974,39 @@ JobList PBSProSystem::getJobs(const Connection& connection_,
 	return _jList;
 }
 
+JobList PBSProSystem::getJobs(const Connection& connection_,
+		const JobInfo& filter_, const list<string>& jobIds_,
+		list<string>& gone_) throw (ImplementationSpecificException) {
+	JobList _jList;
+	list<string> live_;
+	JobArchive *archive_ = JobArchive::getInstance();
+	bool archived_ = archive_->isEnabled();
+	for (list<string>::const_iterator it = jobIds_.begin();
+			it != jobIds_.end(); ++it) {
+		// Finished jobs are final once archived, the server is not asked
+		JobInfo info_;
+		if (!archived_ || !archive_->lookup(*it, info_))
+			live_.push_back(*it);
+		else if (matchesFilter(info_, filter_))
+			_jList.push_back(new JobImpl(*it, info_));
+	}
+	if (live_.empty())
+		return _jList;
+	map<string, JobInfo> infos_;
+	const PBSConnection *pbsCnHolder_ =
+			dynamic_cast<const PBSConnection*>(&connection_);
+	JobInfoVisitor visitor_(infos_);
+	statJobList(pbsCnHolder_->getFd(), live_, NULL, visitor_);
+	for (list<string>::iterator it = live_.begin(); it != live_.end(); ++it) {
+		map<string, JobInfo>::iterator info_ = infos_.find(*it);
+		if (info_ == infos_.end())
+			gone_.push_back(*it);
+		else if (matchesFilter(info_->second, filter_))
+			_jList.push_back(new JobImpl(*it));
+	}
+	return _jList;
+}
+
 MachineInfoList PBSProSystem::getAllMachines(const Connection& connection_,
 	list<string> machines_) throw (ImplementationSpecificException) {
 	MachineInfoList _mList;
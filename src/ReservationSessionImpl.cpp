@@ -38,9 +38,117 @@
 #include <ReservationSessionImpl.h>
 #include <ReservationImpl.h>
 #include <PBSProSystem.h>
+#include <WorkerPool.h>
+#include <InternalException.h>
+#include <TimeoutException.h>
+#include <algorithm>
+#include <ctime>
+#include <unistd.h>
+#include <vector>
 
 namespace drmaa2 {
 
+/**
+ * @brief Outcome of one ReservationTask
+ */
+struct ReservationOutcome {
+	long errorCode; /*!< DRMS error of an ImplementationSpecificException */
+	bool internal; /*!< failed with another exception, see message */
+	Message message; /*!< message of that exception */
+	ReservationOutcome() : errorCode(PBSE_NONE), internal(false) {
+	}
+	bool failed() const {
+		return internal || errorCode != PBSE_NONE;
+	}
+	/**
+	 * @brief Raises the failure again for the caller
+	 */
+	void raise() const {
+		if (internal)
+			throw InternalException(DRMAA2_SOURCEINFO(), message);
+		throw ImplementationSpecificException(errorCode, DRMAA2_SOURCEINFO());
+	}
+};
+
+/**
+ * @brief Requests or removes one reservation on a worker thread
+ */
+class ReservationTask : public WorkerTask {
+	TaskGroup &_group;
+	const ReservationTemplate *_reservationTemplate;
+	Reservation **_reservation;
+	ReservationOutcome *_outcome;
+public:
+	/**
+	 * @brief Constructor, registers the task with group_
+	 *
+	 * @param[in] group_ - group to signal once done
+	 * @param[in] reservationTemplate_ - template to request, NULL removes
+	 * 			*reservation_
+	 * @param[in,out] reservation_ - receives the new reservation or holds
+	 * 			the reservation to remove
+	 * @param[out] outcome_ - receives the failure, if any
+	 */
+	ReservationTask(TaskGroup &group_,
+			const ReservationTemplate *reservationTemplate_,
+			Reservation **reservation_, ReservationOutcome *outcome_) :
+			_group(group_), _reservationTemplate(reservationTemplate_),
+			_reservation(reservation_), _outcome(outcome_) {
+		_group.add();
+	}
+
+	virtual ~ReservationTask() {
+		_group.done();
+	}
+
+	virtual void run() {
+		DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+		try {
+			const Connection &conn_ = ConnectionPool::getInstance()->waitConnection();
+			try {
+				if (_reservationTemplate)
+					*_reservation = drms->submit(conn_, *_reservationTemplate);
+				else
+					drms->remove(conn_, **_reservation);
+			} catch (const Drmaa2Exception &ex) {
+				ConnectionPool::getInstance()->returnConnection(conn_);
+				throw ;
+			}
+			ConnectionPool::getInstance()->returnConnection(conn_);
+		} catch (const ImplementationSpecificException &ex) {
+			_outcome->errorCode = ex.getErrorCode(0);
+		} catch (const Drmaa2Exception &ex) {
+			_outcome->internal = true;
+			_outcome->message = ex.getMessage();
+		}
+	}
+};
+
+/**
+ * @brief - Runs one ReservationTask per entry and waits for all of them
+ *
+ * @param[in] templates_ - templates to request, NULL removes reservations_
+ * @param[in,out] reservations_ - requested or to be removed reservations
+ * @param[out] outcomes_ - outcome of every entry
+ */
+static void runReservationTasks(const vector<ReservationTemplate> *templates_,
+		vector<Reservation*>& reservations_,
+		vector<ReservationOutcome>& outcomes_) {
+	TaskGroup group_;
+	for (size_t i = 0; i < reservations_.size(); i++) {
+		try {
+			WorkerPool::getInstance()->submit(new ReservationTask(group_,
+					templates_ ? &(*templates_)[i] : NULL, &reservations_[i],
+					&outcomes_[i]));
+		} catch (const OutOfResourceException &ex) {
+			for (; i < reservations_.size(); i++)
+				outcomes_[i].errorCode = PBSE_SYSTEM;
+			break;
+		}
+	}
+	group_.wait();
+}
+
 const Reservation& ReservationSessionImpl::getReservation(const string& reservationId_) {
 	Reservation *reservation_ = new ReservationImpl(reservationId_);
 	return *reservation_;
@@ -56,6 +164,87 @@ const Reservation& ReservationSessionImpl::requestReservation(const ReservationT
 	return *reservation_;
 }
 
+ReservationList ReservationSessionImpl::requestReservations(
+		const list<ReservationTemplate>& reservationTemplates_) const {
+	vector<ReservationTemplate> templates_(reservationTemplates_.begin(),
+			reservationTemplates_.end());
+	vector<Reservation*> reservations_(templates_.size(), (Reservation*) NULL);
+	vector<ReservationOutcome> outcomes_(templates_.size());
+	runReservationTasks(&templates_, reservations_, outcomes_);
+	const ReservationOutcome *failure_ = NULL;
+	vector<Reservation*> accepted_;
+	for (size_t i = 0; i < reservations_.size(); i++) {
+		if (outcomes_[i].failed())
+			failure_ = &outcomes_[i];
+		else
+			accepted_.push_back(reservations_[i]);
+	}
+	if (failure_ != NULL) {
+		vector<ReservationOutcome> removeOutcomes_(accepted_.size());
+		runReservationTasks(NULL, accepted_, removeOutcomes_);
+		for (size_t i = 0; i < accepted_.size(); i++)
+			delete dynamic_cast<ReservationImpl*>(accepted_[i]);
+		failure_->raise();
+	}
+	_reservationList.insert(_reservationList.end(), reservations_.begin(),
+			reservations_.end());
+	return ReservationList(reservations_.begin(), reservations_.end());
+}
+
+ReservationList ReservationSessionImpl::waitConfirmed(
+		const ReservationList& reservations_, const TimeAmount timeout_) const {
+	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	set<string> pending_, confirmed_;
+	for (ReservationList::const_iterator it = reservations_.begin();
+			it != reservations_.end(); ++it)
+		pending_.insert((*it)->getReservationId());
+	time_t deadline_ = time(NULL) + timeout_;
+	long interval_ = RESV_POLL_MIN_MS;
+	while (!pending_.empty()) {
+		size_t before_ = pending_.size();
+		const Connection &conn_ = ConnectionPool::getInstance()->waitConnection();
+		try {
+			drms->checkReservations(conn_, pending_, confirmed_);
+		} catch (const Drmaa2Exception &ex) {
+			ConnectionPool::getInstance()->returnConnection(conn_);
+			throw ;
+		}
+		ConnectionPool::getInstance()->returnConnection(conn_);
+		if (pending_.empty())
+			break;
+		// Poll quickly while decisions arrive, back off while nothing moves
+		if (pending_.size() < before_)
+			interval_ = RESV_POLL_MIN_MS;
+		long sleep_ = interval_;
+		if (timeout_ >= 0) {
+			time_t now_ = time(NULL);
+			if (now_ >= deadline_)
+				throw TimeoutException(DRMAA2_SOURCEINFO());
+			sleep_ = min(sleep_, (long) (deadline_ - now_) * 1000);
+		}
+		usleep(sleep_ * 1000);
+		interval_ = min(interval_ * 2, (long) RESV_POLL_MAX_MS);
+	}
+	ReservationList confirmedList_;
+	for (ReservationList::const_iterator it = reservations_.begin();
+			it != reservations_.end(); ++it)
+		if (confirmed_.find((*it)->getReservationId()) != confirmed_.end())
+			confirmedList_.push_back(*it);
+	return confirmedList_;
+}
+
+ReservationList ReservationSessionImpl::terminateReservations(
+		const ReservationList& reservations_) const {
+	vector<Reservation*> targets_(reservations_.begin(), reservations_.end());
+	vector<ReservationOutcome> outcomes_(targets_.size());
+	runReservationTasks(NULL, targets_, outcomes_);
+	ReservationList failed_;
+	for (size_t i = 0; i < targets_.size(); i++)
+		if (outcomes_[i].failed())
+			failed_.push_back(targets_[i]);
+	return failed_;
+}
+
 const ReservationList& ReservationSessionImpl::getReservations(void) {
 	return _reservationList;
 }
@@ -35,7 +35,9 @@
  *
  */
 
+#include <EventEngine.h>
 #include <ConnectionPool.h>
+#include <JobCategories.h>
 #include <InternalException.h>
 #include <Message.h>
 #include <pbs_ifl.h>
@@ -57,8 +59,15 @@ SessionManagerImpl::~SessionManagerImpl() {
 }
 
 bool SessionManagerImpl::supports(const DrmaaCapability& capability_) {
-	//TODO Add Code here
-	return true;
+	switch (capability_) {
+	case BULK_JOBS_MAXPARALLEL:
+		// Enforced by the server through max_run_subjobs, or by chained
+		// array windows where the server lacks it
+		return true;
+	default:
+		//TODO Add Code here
+		return true;
+	}
 }
 
 const JobSession& SessionManagerImpl::createJobSession(
@@ -69,7 +78,7 @@ const JobSession& SessionManagerImpl::createJobSession(
 	}
 
 	if (_jobSessionMap.find(sessionName_) == _jobSessionMap.end()) {
-		StringList jobCategories_;
+		StringList jobCategories_(JobCategories::getInstance()->getNames());
 		string jobSessionContact_;
 		if (contact_.empty()) {
 			char *tmp = NULL;
@@ -95,6 +104,7 @@ const JobSession& SessionManagerImpl::openJobSession(
 }
 
 void SessionManagerImpl::closeJobSession(JobSession& session_) {
+	session_.closeJournal();
 }
 
 void SessionManagerImpl::destroyJobSession(const string& sessionName_) {
@@ -166,7 +176,12 @@ const StringList& SessionManagerImpl::getJobSessionNames(void) {
 
 void SessionManagerImpl::registerEventNotification(
 		const DrmaaCallback& callback) {
-	//TODO Add Code here
+	EventEngine::getInstance()->setCallback(
+			const_cast<DrmaaCallback*>(&callback));
+}
+
+void SessionManagerImpl::unregisterEventNotification(void) {
+	EventEngine::getInstance()->setCallback(NULL);
 }
 
 void SessionManagerImpl::initialize() {
@@ -0,0 +1,775 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <SubmissionJournal.h>
+#include <ConnectionPool.h>
+#include <JobImpl.h>
+#include <PBSProSystem.h>
+#include <WorkerPool.h>
+#include <SourceInfo.h>
+#include <pbs_error.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace drmaa2 {
+
+/**
+ * @brief Submits one journaled request on the WorkerPool
+ */
+class JournalSubmitTask : public WorkerTask {
+	TaskGroup &_group;
+	const JobTemplate *_jobTemplate;
+	string _key;
+	bool _lookup;
+	const EnvironmentEncoder *_environment;
+	Job **_job;
+	long *_errorCode;
+public:
+	/**
+	 * @brief Constructor, registers the task with group_
+	 *
+	 * @param[in] group_ - group to signal once done
+	 * @param[in] jobTemplate_ - template to submit
+	 * @param[in] key_ - request key, submitted as idempotency key
+	 * @param[in] lookup_ - look for a job carrying key_ before submitting
+	 * @param[in] environment_ - session base environment
+	 * @param[out] job_ - receives the submitted job
+	 * @param[out] errorCode_ - receives the DRMS error on failure
+	 */
+	JournalSubmitTask(TaskGroup &group_, const JobTemplate *jobTemplate_,
+			const string& key_, const bool lookup_,
+			const EnvironmentEncoder *environment_, Job **job_,
+			long *errorCode_) :
+			_group(group_), _jobTemplate(jobTemplate_), _key(key_),
+			_lookup(lookup_), _environment(environment_), _job(job_),
+			_errorCode(errorCode_) {
+		_group.add();
+	}
+
+	virtual ~JournalSubmitTask() {
+		_group.done();
+	}
+
+	virtual void run() {
+		DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+		try {
+			const Connection &conn_ = ConnectionPool::getInstance()->waitConnection();
+			try {
+				if (_lookup) {
+					string jobId_ = drms->findKeyedJob(conn_, _key,
+							_jobTemplate->jobName);
+					if (!jobId_.empty())
+						*_job = new JobImpl(jobId_, *_jobTemplate);
+				}
+				if (*_job == NULL)
+					*_job = drms->runKeyedJob(conn_, *_jobTemplate, _key,
+							_environment);
+			} catch (const Drmaa2Exception &ex) {
+				ConnectionPool::getInstance()->returnConnection(conn_);
+				throw ;
+			}
+			ConnectionPool::getInstance()->returnConnection(conn_);
+		} catch (const ImplementationSpecificException &ex) {
+			*_errorCode = ex.getErrorCode(0);
+		} catch (const Drmaa2Exception &ex) {
+			// No connection, the request never reached the server
+			*_errorCode = PBSE_NOCONNECTS;
+		}
+	}
+};
+
+/**
+ * @brief - Tells whether the server certainly did not accept the job, so
+ * 			the request can be submitted again
+ *
+ * @param[in] errorCode_ - PBS error of the failed submission
+ *
+ * @return - true if the submission can be retried
+ */
+static bool journalRetryable(const long errorCode_) {
+	switch (errorCode_) {
+	case PBSE_NOCONNECTS:
+	case PBSE_NOSERVER:
+	case PBSE_MAXQUED:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief - Tells whether the server may have accepted the job although
+ * 			the submission reported an error
+ *
+ * @param[in] errorCode_ - PBS error of the failed submission
+ *
+ * @return - true if the outcome is unknown
+ */
+static bool journalUncertain(const long errorCode_) {
+	return errorCode_ == PBSE_PROTOCOL || errorCode_ == PBSE_SYSTEM;
+}
+
+/**
+ * @brief - FNV-1a checksum of a record payload
+ */
+static unsigned long journalChecksum(const string& payload_) {
+	unsigned long hash_ = 2166136261UL;
+	for (size_t i = 0; i < payload_.size(); i++) {
+		hash_ ^= (unsigned char) payload_[i];
+		hash_ = (hash_ * 16777619UL) & 0xffffffffUL;
+	}
+	return hash_;
+}
+
+/**
+ * @brief - Writes data_ completely to fd_
+ *
+ * @return - true on success
+ */
+static bool journalWrite(const int fd_, const string& data_) {
+	size_t done_ = 0;
+	while (done_ < data_.size()) {
+		ssize_t written_ = write(fd_, data_.data() + done_,
+				data_.size() - done_);
+		if (written_ < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		done_ += written_;
+	}
+	return true;
+}
+
+/**
+ * @brief - Appends value_ escaping backslash, tab and newline
+ */
+static void journalEscape(string& out_, const string& value_) {
+	for (size_t i = 0; i < value_.size(); i++) {
+		switch (value_[i]) {
+		case '\\':
+			out_.append("\\\\");
+			break;
+		case '\t':
+			out_.append("\\t");
+			break;
+		case '\n':
+			out_.append("\\n");
+			break;
+		default:
+			out_.push_back(value_[i]);
+		}
+	}
+}
+
+/**
+ * @brief - Reverts journalEscape
+ */
+static string journalUnescape(const string& value_) {
+	string out_;
+	for (size_t i = 0; i < value_.size(); i++) {
+		if (value_[i] == '\\' && i + 1 < value_.size()) {
+			i++;
+			out_.push_back(value_[i] == 't' ? '\t' :
+					(value_[i] == 'n' ? '\n' : value_[i]));
+		} else {
+			out_.push_back(value_[i]);
+		}
+	}
+	return out_;
+}
+
+/**
+ * @brief - Appends a "name<TAB>value" line, empty values are left out
+ */
+static void journalField(string& out_, const char *name_,
+		const string& value_) {
+	if (value_.empty())
+		return;
+	out_.append(name_);
+	out_.push_back('\t');
+	journalEscape(out_, value_);
+	out_.push_back('\n');
+}
+
+/**
+ * @brief - Appends a numeric "name<TAB>value" line
+ */
+static void journalField(string& out_, const char *name_, const long value_) {
+	stringstream strm_;
+	strm_ << value_;
+	journalField(out_, name_, strm_.str());
+}
+
+/**
+ * @brief - Appends a "name<TAB>key<TAB>value" line per map entry
+ */
+static void journalFields(string& out_, const char *name_,
+		const map<string, string>& values_) {
+	for (map<string, string>::const_iterator it = values_.begin();
+			it != values_.end(); ++it) {
+		out_.append(name_);
+		out_.push_back('\t');
+		journalEscape(out_, it->first);
+		out_.push_back('\t');
+		journalEscape(out_, it->second);
+		out_.push_back('\n');
+	}
+}
+
+/**
+ * @brief - Appends a "name<TAB>value" line per list element
+ */
+template<typename Container>
+static void journalFields(string& out_, const char *name_,
+		const Container& values_) {
+	for (typename Container::const_iterator it = values_.begin();
+			it != values_.end(); ++it) {
+		out_.append(name_);
+		out_.push_back('\t');
+		journalEscape(out_, *it);
+		out_.push_back('\n');
+	}
+}
+
+string SubmissionJournal::serialize(const JobTemplate& jobTemplate_) {
+	string out_;
+	journalField(out_, "cmd", jobTemplate_.remoteCommand);
+	journalFields(out_, "arg", jobTemplate_.args);
+	journalField(out_, "hold", (long) jobTemplate_.submitAsHold);
+	journalField(out_, "rerun", (long) jobTemplate_.rerunnable);
+	journalFields(out_, "env", jobTemplate_.jobEnvironment);
+	journalField(out_, "wd", jobTemplate_.workingDirectory);
+	journalField(out_, "category", jobTemplate_.jobCategory);
+	journalFields(out_, "mail", jobTemplate_.email);
+	journalField(out_, "mailb", (long) jobTemplate_.emailOnStarted);
+	journalField(out_, "maile", (long) jobTemplate_.emailOnTerminated);
+	journalField(out_, "name", jobTemplate_.jobName);
+	journalField(out_, "in", jobTemplate_.inputPath);
+	journalField(out_, "out", jobTemplate_.outputPath);
+	journalField(out_, "err", jobTemplate_.errorPath);
+	journalField(out_, "join", (long) jobTemplate_.joinFiles);
+	journalField(out_, "rsv", jobTemplate_.reservationId);
+	journalField(out_, "queue", jobTemplate_.queueName);
+	journalField(out_, "minslots", jobTemplate_.minSlots);
+	journalField(out_, "maxslots", jobTemplate_.maxSlots);
+	journalField(out_, "prio", jobTemplate_.priority);
+	journalFields(out_, "host", jobTemplate_.candidateMachines);
+	journalField(out_, "mem", jobTemplate_.minPhysMemory);
+	journalField(out_, "os", (long) jobTemplate_.machineOS);
+	journalField(out_, "arch", (long) jobTemplate_.machineArch);
+	journalField(out_, "start", (long) jobTemplate_.startTime);
+	journalField(out_, "deadline", (long) jobTemplate_.deadlineTime);
+	journalFields(out_, "stagein", jobTemplate_.stageInFiles);
+	journalFields(out_, "stageout", jobTemplate_.stageOutFiles);
+	journalFields(out_, "limit", jobTemplate_.resourceLimits);
+	journalField(out_, "account", jobTemplate_.accountingId);
+	journalField(out_, "script", jobTemplate_.scriptBody);
+	return out_;
+}
+
+void SubmissionJournal::deserialize(const string& payload_,
+		JobTemplate& jobTemplate_) {
+	size_t start_ = 0;
+	while (start_ < payload_.size()) {
+		size_t end_ = payload_.find('\n', start_);
+		if (end_ == string::npos)
+			end_ = payload_.size();
+		string line_(payload_, start_, end_ - start_);
+		start_ = end_ + 1;
+		size_t tab_ = line_.find('\t');
+		if (tab_ == string::npos)
+			continue;
+		string name_(line_, 0, tab_);
+		string value_(line_, tab_ + 1);
+		size_t pair_ = value_.find('\t');
+		string key_, second_;
+		if (pair_ != string::npos) {
+			key_ = journalUnescape(value_.substr(0, pair_));
+			second_ = journalUnescape(value_.substr(pair_ + 1));
+		}
+		value_ = journalUnescape(value_);
+		long number_ = atol(value_.c_str());
+		if (name_ == "cmd")
+			jobTemplate_.remoteCommand = value_;
+		else if (name_ == "arg")
+			jobTemplate_.args.push_back(value_);
+		else if (name_ == "hold")
+			jobTemplate_.submitAsHold = number_ != 0;
+		else if (name_ == "rerun")
+			jobTemplate_.rerunnable = number_ != 0;
+		else if (name_ == "env")
+			jobTemplate_.jobEnvironment[key_] = second_;
+		else if (name_ == "wd")
+			jobTemplate_.workingDirectory = value_;
+		else if (name_ == "category")
+			jobTemplate_.jobCategory = value_;
+		else if (name_ == "mail")
+			jobTemplate_.email.push_back(value_);
+		else if (name_ == "mailb")
+			jobTemplate_.emailOnStarted = number_ != 0;
+		else if (name_ == "maile")
+			jobTemplate_.emailOnTerminated = number_ != 0;
+		else if (name_ == "name")
+			jobTemplate_.jobName = value_;
+		else if (name_ == "in")
+			jobTemplate_.inputPath = value_;
+		else if (name_ == "out")
+			jobTemplate_.outputPath = value_;
+		else if (name_ == "err")
+			jobTemplate_.errorPath = value_;
+		else if (name_ == "join")
+			jobTemplate_.joinFiles = number_ != 0;
+		else if (name_ == "rsv")
+			jobTemplate_.reservationId = value_;
+		else if (name_ == "queue")
+			jobTemplate_.queueName = value_;
+		else if (name_ == "minslots")
+			jobTemplate_.minSlots = number_;
+		else if (name_ == "maxslots")
+			jobTemplate_.maxSlots = number_;
+		else if (name_ == "prio")
+			jobTemplate_.priority = number_;
+		else if (name_ == "host")
+			jobTemplate_.candidateMachines.push_back(value_);
+		else if (name_ == "mem")
+			jobTemplate_.minPhysMemory = number_;
+		else if (name_ == "os")
+			jobTemplate_.machineOS = (OperatingSystem) number_;
+		else if (name_ == "arch")
+			jobTemplate_.machineArch = (CpuArchitecture) number_;
+		else if (name_ == "start")
+			jobTemplate_.startTime = (time_t) number_;
+		else if (name_ == "deadline")
+			jobTemplate_.deadlineTime = (time_t) number_;
+		else if (name_ == "stagein")
+			jobTemplate_.stageInFiles[key_] = second_;
+		else if (name_ == "stageout")
+			jobTemplate_.stageOutFiles[key_] = second_;
+		else if (name_ == "limit")
+			jobTemplate_.resourceLimits[key_] = second_;
+		else if (name_ == "account")
+			jobTemplate_.accountingId = value_;
+		else if (name_ == "script")
+			jobTemplate_.scriptBody = value_;
+	}
+}
+
+SubmissionJournal::SubmissionJournal(const string& path_,
+		const EnvironmentEncoder *environment_)
+		throw (ImplementationSpecificException) :
+		_path(path_), _fd(-1), _environment(environment_), _appended(0),
+		_durable(0), _syncing(false), _records(0),
+		_window(JOURNAL_INITIAL_WINDOW), _stop(false), _sequence(0) {
+	_fd = open(_path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+	if (_fd < 0)
+		throw ImplementationSpecificException(PBSE_SYSTEM, DRMAA2_SOURCEINFO());
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_syncCond, NULL);
+	pthread_cond_init(&_readyCond, NULL);
+	try {
+		replay();
+	} catch (const ImplementationSpecificException &ex) {
+		close(_fd);
+		throw ;
+	}
+	pthread_mutex_lock(&_mutex);
+	bool synced_ = _records > (long) (_ready.size() + _finished.size()) ?
+			compact() : sync(_appended);
+	pthread_mutex_unlock(&_mutex);
+	if (!synced_ || pthread_create(&_drainer, NULL,
+			&SubmissionJournal::drainerMain, this) != 0) {
+		close(_fd);
+		throw ImplementationSpecificException(PBSE_SYSTEM, DRMAA2_SOURCEINFO());
+	}
+}
+
+SubmissionJournal::~SubmissionJournal() {
+	pthread_mutex_lock(&_mutex);
+	_stop = true;
+	pthread_cond_broadcast(&_readyCond);
+	pthread_mutex_unlock(&_mutex);
+	pthread_join(_drainer, NULL);
+	pthread_mutex_lock(&_mutex);
+	sync(_appended);
+	pthread_mutex_unlock(&_mutex);
+	close(_fd);
+	pthread_cond_destroy(&_readyCond);
+	pthread_cond_destroy(&_syncCond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+unsigned long SubmissionJournal::append(const char type_, const string& key_,
+		const string& payload_) {
+	stringstream header_;
+	header_ << type_ << " " << key_ << " " << payload_.size() << " "
+			<< std::hex << journalChecksum(payload_) << "\n";
+	_buffer.append(header_.str());
+	_buffer.append(payload_);
+	_buffer.push_back('\n');
+	_records++;
+	return ++_appended;
+}
+
+bool SubmissionJournal::sync(const unsigned long seq_) {
+	while (_durable < seq_) {
+		if (_syncing) {
+			pthread_cond_wait(&_syncCond, &_mutex);
+			continue;
+		}
+		_syncing = true;
+		string data_;
+		data_.swap(_buffer);
+		unsigned long upTo_ = _appended;
+		pthread_mutex_unlock(&_mutex);
+		bool written_ = journalWrite(_fd, data_) && fdatasync(_fd) == 0;
+		pthread_mutex_lock(&_mutex);
+		_syncing = false;
+		if (written_)
+			_durable = upTo_;
+		else
+			_buffer.insert(0, data_);
+		pthread_cond_broadcast(&_syncCond);
+		if (!written_)
+			return false;
+	}
+	return true;
+}
+
+void SubmissionJournal::replay() throw (ImplementationSpecificException) {
+	string data_;
+	int fd_ = open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd_ < 0)
+		throw ImplementationSpecificException(PBSE_SYSTEM, DRMAA2_SOURCEINFO());
+	char chunk_[65536];
+	ssize_t read_;
+	while ((read_ = read(fd_, chunk_, sizeof(chunk_))) != 0) {
+		if (read_ < 0) {
+			if (errno == EINTR)
+				continue;
+			close(fd_);
+			throw ImplementationSpecificException(PBSE_SYSTEM, DRMAA2_SOURCEINFO());
+		}
+		data_.append(chunk_, read_);
+	}
+	close(fd_);
+
+	list<string> order_;
+	size_t pos_ = 0;
+	while (pos_ < data_.size()) {
+		size_t eol_ = data_.find('\n', pos_);
+		if (eol_ == string::npos)
+			break;
+		stringstream header_(data_.substr(pos_, eol_ - pos_));
+		char type_ = 0;
+		string key_;
+		size_t length_ = 0;
+		unsigned long checksum_ = 0;
+		header_ >> type_ >> key_ >> length_ >> std::hex >> checksum_;
+		if (header_.fail() || eol_ + 1 + length_ >= data_.size()
+				|| data_[eol_ + 1 + length_] != '\n')
+			break;
+		string payload_(data_, eol_ + 1, length_);
+		if (journalChecksum(payload_) != checksum_)
+			break;
+		pos_ = eol_ + 1 + length_ + 1;
+		_records++;
+		map<string, Entry>::iterator it = _entries.find(key_);
+		if (type_ == JOURNAL_QUEUED) {
+			if (it != _entries.end())
+				continue;
+			Entry &entry_ = _entries[key_];
+			entry_.state = JOURNAL_QUEUED;
+			entry_.errorCode = 0;
+			entry_.submitted = false;
+			entry_.uncertain = 0;
+			deserialize(payload_, entry_.jobTemplate);
+			order_.push_back(key_);
+			continue;
+		}
+		if (type_ == JOURNAL_DONE || type_ == JOURNAL_FAILED) {
+			// Compaction keeps the outcome of recent requests without Q
+			Entry &entry_ = _entries[key_];
+			entry_.state = type_;
+			entry_.jobId = type_ == JOURNAL_DONE ? payload_ : string();
+			entry_.errorCode = type_ == JOURNAL_FAILED ?
+					atol(payload_.c_str()) : 0;
+			finish(key_);
+		} else if (it != _entries.end()) {
+			it->second.state = type_;
+			if (type_ == JOURNAL_SUBMITTING)
+				it->second.submitted = true;
+		}
+	}
+	// Cut a record torn by a crash, later appends must start clean
+	if (pos_ < data_.size() && ftruncate(_fd, pos_) != 0)
+		throw ImplementationSpecificException(PBSE_SYSTEM, DRMAA2_SOURCEINFO());
+
+	for (list<string>::iterator it = order_.begin(); it != order_.end(); ++it) {
+		Entry &entry_ = _entries[*it];
+		// A request in S may have reached the server before the crash,
+		// the drainer looks its key up before submitting it again
+		if (entry_.state == JOURNAL_QUEUED || entry_.state == JOURNAL_RETRY
+				|| entry_.state == JOURNAL_SUBMITTING)
+			_ready.push_back(*it);
+	}
+}
+
+void SubmissionJournal::finish(const string& key_) {
+	_finished.push_back(key_);
+	while (_finished.size() > JOURNAL_KEEP_FINISHED) {
+		_entries.erase(_finished.front());
+		_finished.pop_front();
+	}
+}
+
+bool SubmissionJournal::compact() {
+	while (_syncing)
+		pthread_cond_wait(&_syncCond, &_mutex);
+	string data_, tmpPath_(_path + ".tmp");
+	unsigned long appended_ = _appended;
+	long records_ = _records;
+	_buffer.swap(data_);
+	_records = 0;
+	for (list<string>::iterator it = _finished.begin(); it != _finished.end();
+			++it) {
+		Entry &entry_ = _entries[*it];
+		stringstream code_;
+		code_ << entry_.errorCode;
+		append(entry_.state, *it, entry_.state == JOURNAL_DONE ?
+				entry_.jobId : code_.str());
+	}
+	for (list<string>::iterator it = _ready.begin(); it != _ready.end(); ++it) {
+		Entry &entry_ = _entries[*it];
+		append(JOURNAL_QUEUED, *it, serialize(entry_.jobTemplate));
+		if (entry_.submitted)
+			append(JOURNAL_SUBMITTING, *it, string());
+	}
+	_buffer.swap(data_);
+	_appended = appended_;
+
+	int fd_ = open(tmpPath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+			0600);
+	bool written_ = fd_ >= 0 && journalWrite(fd_, data_) && fdatasync(fd_) == 0;
+	if (fd_ >= 0)
+		close(fd_);
+	if (written_)
+		written_ = rename(tmpPath_.c_str(), _path.c_str()) == 0;
+	if (!written_) {
+		unlink(tmpPath_.c_str());
+		_records = records_;
+		return false;
+	}
+	size_t slash_ = _path.rfind('/');
+	string dir_(slash_ == string::npos ? string(".") :
+			(slash_ == 0 ? string("/") : _path.substr(0, slash_)));
+	int dirFd_ = open(dir_.c_str(), O_RDONLY | O_CLOEXEC);
+	if (dirFd_ >= 0) {
+		fsync(dirFd_);
+		close(dirFd_);
+	}
+	close(_fd);
+	_fd = open(_path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+	// Records still buffered are covered by the rewritten file
+	_buffer.clear();
+	_durable = _appended;
+	pthread_cond_broadcast(&_syncCond);
+	return _fd >= 0;
+}
+
+string SubmissionJournal::enqueue(const JobTemplate& jobTemplate_,
+		const string& key_)
+		throw (InvalidArgumentException, ImplementationSpecificException) {
+	if (!key_.empty() && !PBSProSystem::isValidSubmitKey(key_))
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+	pthread_mutex_lock(&_mutex);
+	string requestKey_(key_);
+	if (requestKey_.empty()) {
+		stringstream strm_;
+		strm_ << time(NULL) << "." << getpid() << "." << ++_sequence;
+		requestKey_.assign(strm_.str());
+	}
+	if (_entries.find(requestKey_) != _entries.end()) {
+		pthread_mutex_unlock(&_mutex);
+		return requestKey_;
+	}
+	Entry &entry_ = _entries[requestKey_];
+	entry_.state = JOURNAL_QUEUED;
+	entry_.jobTemplate = jobTemplate_;
+	entry_.errorCode = 0;
+	entry_.submitted = false;
+	entry_.uncertain = 0;
+	unsigned long seq_ = append(JOURNAL_QUEUED, requestKey_,
+			serialize(jobTemplate_));
+	// Queued before waiting, so a compaction meanwhile keeps the request
+	_ready.push_back(requestKey_);
+	pthread_cond_signal(&_readyCond);
+	bool synced_ = sync(seq_);
+	pthread_mutex_unlock(&_mutex);
+	if (!synced_)
+		throw ImplementationSpecificException(PBSE_SYSTEM, DRMAA2_SOURCEINFO());
+	return requestKey_;
+}
+
+string SubmissionJournal::getJobId(const string& key_)
+		throw (InvalidArgumentException, ImplementationSpecificException) {
+	pthread_mutex_lock(&_mutex);
+	map<string, Entry>::iterator it = _entries.find(key_);
+	if (it == _entries.end()) {
+		pthread_mutex_unlock(&_mutex);
+		throw InvalidArgumentException(DRMAA2_SOURCEINFO());
+	}
+	string jobId_(it->second.jobId);
+	long errorCode_ = it->second.errorCode;
+	char state_ = it->second.state;
+	pthread_mutex_unlock(&_mutex);
+	if (state_ == JOURNAL_FAILED)
+		throw ImplementationSpecificException(errorCode_, DRMAA2_SOURCEINFO());
+	return jobId_;
+}
+
+void* SubmissionJournal::drainerMain(void *arg_) {
+	static_cast<SubmissionJournal*>(arg_)->drain();
+	return NULL;
+}
+
+void SubmissionJournal::drain() {
+	long backoff_ = 1;
+	pthread_mutex_lock(&_mutex);
+	while (!_stop) {
+		if (_ready.empty()) {
+			pthread_cond_wait(&_readyCond, &_mutex);
+			continue;
+		}
+		vector<string> batch_;
+		vector<Entry*> entries_;
+		while (!_ready.empty() && (long) batch_.size() < _window) {
+			Entry &entry_ = _entries[_ready.front()];
+			entry_.state = JOURNAL_SUBMITTING;
+			append(JOURNAL_SUBMITTING, _ready.front(), string());
+			batch_.push_back(_ready.front());
+			entries_.push_back(&entry_);
+			_ready.pop_front();
+		}
+		// S must be on disk before pbs_submit, see replay()
+		bool synced_ = sync(_appended);
+		pthread_mutex_unlock(&_mutex);
+
+		TaskGroup group_;
+		vector<Job*> jobs_(batch_.size(), (Job*) NULL);
+		vector<long> errors_(batch_.size(), 0);
+		for (size_t i = 0; synced_ && i < batch_.size(); i++) {
+			try {
+				WorkerPool::getInstance()->submit(new JournalSubmitTask(group_,
+						&entries_[i]->jobTemplate, batch_[i],
+						entries_[i]->submitted, _environment, &jobs_[i],
+						&errors_[i]));
+			} catch (const OutOfResourceException &ex) {
+				errors_[i] = PBSE_NOCONNECTS;
+			}
+		}
+		group_.wait();
+
+		pthread_mutex_lock(&_mutex);
+		bool throttled_ = !synced_;
+		list<string> retry_;
+		for (size_t i = 0; i < batch_.size(); i++) {
+			Entry &entry_ = *entries_[i];
+			if (jobs_[i] != NULL) {
+				entry_.state = JOURNAL_DONE;
+				entry_.jobId = jobs_[i]->getJobId();
+				append(JOURNAL_DONE, batch_[i], entry_.jobId);
+				finish(batch_[i]);
+				delete jobs_[i];
+			} else if (!synced_ || journalRetryable(errors_[i])) {
+				entry_.state = JOURNAL_RETRY;
+				append(JOURNAL_RETRY, batch_[i], string());
+				retry_.push_back(batch_[i]);
+				throttled_ = true;
+			} else if (journalUncertain(errors_[i])
+					&& ++entry_.uncertain < JOURNAL_MAX_UNCERTAIN) {
+				// The job may exist, the next attempt looks it up first
+				entry_.state = JOURNAL_RETRY;
+				entry_.submitted = true;
+				append(JOURNAL_RETRY, batch_[i], string());
+				retry_.push_back(batch_[i]);
+				throttled_ = true;
+			} else {
+				entry_.state = JOURNAL_FAILED;
+				entry_.errorCode = journalUncertain(errors_[i]) ?
+						JOURNAL_UNCERTAIN : errors_[i];
+				stringstream code_;
+				code_ << entry_.errorCode;
+				append(JOURNAL_FAILED, batch_[i], code_.str());
+				finish(batch_[i]);
+			}
+		}
+		_ready.splice(_ready.begin(), retry_);
+		sync(_appended);
+
+		if (throttled_) {
+			// Server or local resources are saturated, back off
+			_window = std::max(1L, _window / 2);
+			struct timeval now_;
+			struct timespec until_;
+			gettimeofday(&now_, NULL);
+			until_.tv_sec = now_.tv_sec + backoff_;
+			until_.tv_nsec = now_.tv_usec * 1000;
+			while (!_stop && pthread_cond_timedwait(&_readyCond, &_mutex,
+					&until_) == 0)
+				;
+			backoff_ = std::min(backoff_ * 2, (long) JOURNAL_BACKOFF_MAX);
+		} else {
+			backoff_ = 1;
+			if (_window < (long) MAX_WORKERS)
+				_window++;
+		}
+		if (_records > JOURNAL_COMPACT_RECORDS
+				&& _records > 2 * (long) (_ready.size() + _finished.size()))
+			compact();
+	}
+	pthread_mutex_unlock(&_mutex);
+}
+}
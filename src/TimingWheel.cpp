@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <TimingWheel.h>
+
+#define WHEEL_ROOT_SIZE (1ULL << WHEEL_ROOT_BITS)
+#define WHEEL_LEVEL_MASK ((1ULL << WHEEL_LEVEL_BITS) - 1)
+#define WHEEL_SPAN (1ULL << (WHEEL_ROOT_BITS + \
+		(WHEEL_LEVELS - 1) * WHEEL_LEVEL_BITS))
+
+namespace drmaa2 {
+
+TimingWheel::TimingWheel(const unsigned long long now_) :
+		_now(now_), _size(0) {
+}
+
+void TimingWheel::place(TimerEntry *entry_) {
+	unsigned long long delta_ = entry_->_expires - _now;
+	list<TimerEntry*> *slot_;
+	if (delta_ < WHEEL_ROOT_SIZE) {
+		slot_ = &_root[entry_->_expires & (WHEEL_ROOT_SIZE - 1)];
+	} else {
+		// Timeouts beyond the span park in the farthest slot and are
+		// placed again whenever they come around
+		unsigned long long expires_ = delta_ < WHEEL_SPAN ?
+				entry_->_expires : _now + WHEEL_SPAN - 1;
+		size_t level_ = 0;
+		while ((delta_ >> (WHEEL_ROOT_BITS + (level_ + 1) * WHEEL_LEVEL_BITS))
+				!= 0 && level_ < WHEEL_LEVELS - 2)
+			level_++;
+		slot_ = &_levels[level_][(expires_ >> (WHEEL_ROOT_BITS
+				+ level_ * WHEEL_LEVEL_BITS)) & WHEEL_LEVEL_MASK];
+	}
+	entry_->_slot = slot_;
+	entry_->_pos = slot_->insert(slot_->end(), entry_);
+}
+
+void TimingWheel::cascade(const size_t level_, const size_t index_) {
+	list<TimerEntry*> entries_;
+	entries_.swap(_levels[level_][index_]);
+	for (list<TimerEntry*>::iterator it = entries_.begin();
+			it != entries_.end(); ++it)
+		place(*it);
+}
+
+void TimingWheel::schedule(TimerEntry *entry_,
+		const unsigned long long expires_) {
+	cancel(entry_);
+	entry_->_expires = expires_ > _now ? expires_ : _now + 1;
+	place(entry_);
+	_size++;
+}
+
+void TimingWheel::cancel(TimerEntry *entry_) {
+	if (entry_->_slot == NULL)
+		return;
+	entry_->_slot->erase(entry_->_pos);
+	entry_->_slot = NULL;
+	_size--;
+}
+
+void TimingWheel::advance(const unsigned long long now_,
+		list<TimerEntry*>& expired_) {
+	if (_size == 0 && now_ > _now) {
+		_now = now_;
+		return;
+	}
+	while (_now < now_) {
+		_now++;
+		if ((_now & (WHEEL_ROOT_SIZE - 1)) == 0) {
+			for (size_t level_ = 0; level_ < WHEEL_LEVELS - 1; level_++) {
+				size_t index_ = (_now >> (WHEEL_ROOT_BITS
+						+ level_ * WHEEL_LEVEL_BITS)) & WHEEL_LEVEL_MASK;
+				cascade(level_, index_);
+				if (index_ != 0)
+					break;
+			}
+		}
+		list<TimerEntry*> entries_;
+		entries_.swap(_root[_now & (WHEEL_ROOT_SIZE - 1)]);
+		for (list<TimerEntry*>::iterator it = entries_.begin();
+				it != entries_.end(); ++it) {
+			if ((*it)->_expires > _now) {
+				place(*it);
+				continue;
+			}
+			(*it)->_slot = NULL;
+			_size--;
+			expired_.push_back(*it);
+		}
+		if (_size == 0)
+			_now = now_;
+	}
+}
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <UsageSampler.h>
+#include <ConnectionPool.h>
+#include <PBSProSystem.h>
+#include <Message.h>
+#include <SourceInfo.h>
+#include <cstdlib>
+#include <errno.h>
+#include <sys/time.h>
+
+namespace drmaa2 {
+
+UsageSampler* UsageSampler::_instance = 0;
+pthread_mutex_t UsageSampler::_instMutex = PTHREAD_MUTEX_INITIALIZER;
+
+UsageRing::UsageRing(const size_t capacity_) : _count(0),
+		_capacity(capacity_ > 0 ? capacity_ : 1), active(true) {
+}
+
+void UsageRing::putDelta(const long long delta_) {
+	unsigned long long zigzag_ = ((unsigned long long) delta_ << 1)
+			^ (unsigned long long) (delta_ >> 63);
+	while (zigzag_ >= 0x80) {
+		_deltas.push_back((unsigned char) (zigzag_ | 0x80));
+		zigzag_ >>= 7;
+	}
+	_deltas.push_back((unsigned char) zigzag_);
+}
+
+long long UsageRing::getDelta(deque<unsigned char>::const_iterator& it_) {
+	unsigned long long zigzag_ = 0;
+	int shift_ = 0;
+	for (;;) {
+		unsigned char byte_ = *it_++;
+		zigzag_ |= (unsigned long long) (byte_ & 0x7f) << shift_;
+		if ((byte_ & 0x80) == 0)
+			break;
+		shift_ += 7;
+	}
+	return (long long) (zigzag_ >> 1) ^ -(long long) (zigzag_ & 1);
+}
+
+void UsageRing::apply(deque<unsigned char>::const_iterator& it_,
+		UsageSample& sample_) {
+	sample_.time += getDelta(it_);
+	sample_.cpuTime += getDelta(it_);
+	sample_.memory += getDelta(it_);
+	sample_.wallclockTime += getDelta(it_);
+}
+
+void UsageRing::push(const UsageSample& sample_) {
+	if (_count == 0) {
+		_first = _last = sample_;
+		_count = 1;
+		return;
+	}
+	putDelta((long long) sample_.time - _last.time);
+	putDelta((long long) sample_.cpuTime - _last.cpuTime);
+	putDelta(sample_.memory - _last.memory);
+	putDelta((long long) sample_.wallclockTime - _last.wallclockTime);
+	_last = sample_;
+	if (++_count > _capacity) {
+		deque<unsigned char>::const_iterator begin_ = _deltas.begin();
+		deque<unsigned char>::const_iterator it = begin_;
+		apply(it, _first);
+		_deltas.erase(_deltas.begin(), _deltas.begin() + (it - begin_));
+		_count--;
+	}
+}
+
+UsageSampleList UsageRing::samples() const {
+	UsageSampleList samples_;
+	if (_count == 0)
+		return samples_;
+	samples_.reserve(_count);
+	UsageSample sample_(_first);
+	samples_.push_back(sample_);
+	deque<unsigned char>::const_iterator it = _deltas.begin();
+	while (it != _deltas.end()) {
+		apply(it, sample_);
+		samples_.push_back(sample_);
+	}
+	return samples_;
+}
+
+/**
+ * @brief - Returns the sampling interval from DRMAA2_USAGE_INTERVAL
+ *
+ * @return - seconds, USAGE_SAMPLE_INTERVAL if unset or invalid
+ */
+static unsigned int sampleInterval() {
+	const char *value_ = getenv(USAGE_INTERVAL_ENV);
+	long interval_ = value_ ? atol(value_) : 0;
+	return interval_ > 0 ? (unsigned int) interval_ : USAGE_SAMPLE_INTERVAL;
+}
+
+UsageSampler::UsageSampler() : _interval(sampleInterval()), _started(false) {
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_cond, NULL);
+}
+
+void* UsageSampler::samplerMain(void *arg_) {
+	static_cast<UsageSampler*>(arg_)->run();
+	return NULL;
+}
+
+void UsageSampler::track(const string& jobId_) throw (OutOfResourceException) {
+	pthread_mutex_lock(&_mutex);
+	if (!_started) {
+		pthread_t thread_;
+		if (pthread_create(&thread_, NULL, &UsageSampler::samplerMain, this)
+				!= 0) {
+			pthread_mutex_unlock(&_mutex);
+			throw OutOfResourceException(DRMAA2_SOURCEINFO(), Message(
+					OUT_OF_RESOURCE_SHORT, SAMPLER_START_FAILED));
+		}
+		pthread_detach(thread_);
+		_started = true;
+	}
+	if (_rings.find(jobId_) == _rings.end()) {
+		_rings.insert(make_pair(jobId_, UsageRing()));
+		_order.push_back(jobId_);
+		while (_order.size() > USAGE_MAX_JOBS) {
+			_rings.erase(_order.front());
+			_order.pop_front();
+		}
+		pthread_cond_signal(&_cond);
+	}
+	pthread_mutex_unlock(&_mutex);
+}
+
+UsageSampleList UsageSampler::samples(const string& jobId_) const {
+	UsageSampleList samples_;
+	pthread_mutex_lock(&_mutex);
+	map<string, UsageRing>::const_iterator it = _rings.find(jobId_);
+	if (it != _rings.end())
+		samples_ = it->second.samples();
+	pthread_mutex_unlock(&_mutex);
+	return samples_;
+}
+
+void UsageSampler::run() {
+	DRMSystem *drms = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	pthread_mutex_lock(&_mutex);
+	for (;;) {
+		list<string> jobIds_;
+		for (map<string, UsageRing>::iterator it = _rings.begin();
+				it != _rings.end(); ++it)
+			if (it->second.active)
+				jobIds_.push_back(it->first);
+		if (!jobIds_.empty()) {
+			pthread_mutex_unlock(&_mutex);
+			map<string, JobUsage> usage_;
+			bool queried_ = false;
+			try {
+				const Connection &conn_ =
+						ConnectionPool::getInstance()->waitConnection();
+				try {
+					usage_ = drms->getJobUsage(conn_, jobIds_);
+					queried_ = true;
+				} catch (const Drmaa2Exception &ex) {
+					// Sampled again next interval
+				}
+				ConnectionPool::getInstance()->returnConnection(conn_);
+			} catch (const Drmaa2Exception &ex) {
+			}
+			time_t now_ = time(NULL);
+			pthread_mutex_lock(&_mutex);
+			for (list<string>::iterator id_ = jobIds_.begin();
+					queried_ && id_ != jobIds_.end(); ++id_) {
+				map<string, UsageRing>::iterator ring_ = _rings.find(*id_);
+				if (ring_ == _rings.end())
+					continue;
+				map<string, JobUsage>::iterator it = usage_.find(*id_);
+				if (it == usage_.end() || it->second.state == DONE
+						|| it->second.state == FAILED) {
+					// Ended or forgotten, the series is complete
+					ring_->second.active = false;
+					continue;
+				}
+				if ((it->second.state == RUNNING
+						|| it->second.state == SUSPENDED)
+						&& it->second.sampled) {
+					UsageSample sample_(it->second.usage);
+					sample_.time = now_;
+					ring_->second.push(sample_);
+				}
+			}
+		}
+		struct timeval now_;
+		struct timespec until_;
+		gettimeofday(&now_, NULL);
+		until_.tv_sec = now_.tv_sec + _interval;
+		until_.tv_nsec = now_.tv_usec * 1000;
+		if (jobIds_.empty()) {
+			// Woken up by track() for the first sample of a new job
+			pthread_cond_wait(&_cond, &_mutex);
+		} else {
+			// Jobs tracked meanwhile get their first sample with the rest
+			while (pthread_cond_timedwait(&_cond, &_mutex, &until_)
+					!= ETIMEDOUT)
+				;
+		}
+	}
+}
+}
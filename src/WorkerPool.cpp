@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <WorkerPool.h>
+#include <Message.h>
+#include <SourceInfo.h>
+
+namespace drmaa2 {
+
+WorkerPool* WorkerPool::_instance = 0;
+pthread_mutex_t WorkerPool::_instMutex = PTHREAD_MUTEX_INITIALIZER;
+
+WorkerPool::WorkerPool() : _workers(0) {
+	pthread_mutex_init(&_taskMutex, NULL);
+	pthread_cond_init(&_taskCond, NULL);
+	for (size_t i = 0; i < MAX_WORKERS; i++) {
+		pthread_t thread_;
+		if (pthread_create(&thread_, NULL, &WorkerPool::workerMain, this) != 0)
+			break;
+		pthread_detach(thread_);
+		_workers++;
+	}
+}
+
+void* WorkerPool::workerMain(void *arg_) {
+	WorkerPool *pool_ = static_cast<WorkerPool*>(arg_);
+	for (;;) {
+		pthread_mutex_lock(&pool_->_taskMutex);
+		while (pool_->_tasks.empty())
+			pthread_cond_wait(&pool_->_taskCond, &pool_->_taskMutex);
+		WorkerTask *task_ = pool_->_tasks.front();
+		pool_->_tasks.pop_front();
+		pthread_mutex_unlock(&pool_->_taskMutex);
+		try {
+			task_->run();
+		} catch (...) {
+			// Tasks report their own failures, never let one kill the worker
+		}
+		delete task_;
+	}
+	return NULL;
+}
+
+void WorkerPool::submit(WorkerTask *task_) throw (OutOfResourceException) {
+	if (_workers == 0) {
+		delete task_;
+		throw OutOfResourceException(DRMAA2_SOURCEINFO(), Message(
+				OUT_OF_RESOURCE_SHORT, WORKER_START_FAILED));
+	}
+	pthread_mutex_lock(&_taskMutex);
+	_tasks.push_back(task_);
+	pthread_cond_signal(&_taskCond);
+	pthread_mutex_unlock(&_taskMutex);
+}
+
+TaskGroup::TaskGroup() : _pending(0) {
+	pthread_mutex_init(&_groupMutex, NULL);
+	pthread_cond_init(&_groupCond, NULL);
+}
+
+TaskGroup::~TaskGroup() {
+	pthread_cond_destroy(&_groupCond);
+	pthread_mutex_destroy(&_groupMutex);
+}
+
+void TaskGroup::add() {
+	pthread_mutex_lock(&_groupMutex);
+	_pending++;
+	pthread_mutex_unlock(&_groupMutex);
+}
+
+void TaskGroup::done() {
+	pthread_mutex_lock(&_groupMutex);
+	if (--_pending == 0)
+		pthread_cond_broadcast(&_groupCond);
+	pthread_mutex_unlock(&_groupMutex);
+}
+
+void TaskGroup::wait() {
+	pthread_mutex_lock(&_groupMutex);
+	while (_pending > 0)
+		pthread_cond_wait(&_groupCond, &_groupMutex);
+	pthread_mutex_unlock(&_groupMutex);
+}
+}
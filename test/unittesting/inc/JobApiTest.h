@@ -41,9 +41,13 @@
 class JobApiTest : public CppUnit::TestFixture {
         CPPUNIT_TEST_SUITE(JobApiTest);
         CPPUNIT_TEST(TestJobApi);
+        CPPUNIT_TEST(TestAsyncJobApi);
+        CPPUNIT_TEST(TestWaitJobApi);
         CPPUNIT_TEST_SUITE_END();
 public:
         void TestJobApi();
+        void TestAsyncJobApi();
+        void TestWaitJobApi();
 };
 #endif
 
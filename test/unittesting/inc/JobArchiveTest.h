@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef JOBARCHIVETEST_H_
+#define JOBARCHIVETEST_H_
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <drmaa2.hpp>
+
+class JobArchiveTest: public CppUnit::TestFixture {
+	CPPUNIT_TEST_SUITE(JobArchiveTest);
+	CPPUNIT_TEST(TestAddAndFind);
+	CPPUNIT_TEST(TestFinishRange);
+	CPPUNIT_TEST(TestReload);
+	CPPUNIT_TEST(TestTornRecord);
+	CPPUNIT_TEST(TestDisabled);
+	CPPUNIT_TEST_SUITE_END();
+	std::string _directory;
+	drmaa2::JobInfo finished(const std::string& jobId_,
+			const std::string& owner_, const std::string& queue_,
+			const drmaa2::JobState state_, const time_t finishTime_);
+public:
+	void setUp();
+	void tearDown();
+	void TestAddAndFind();
+	void TestFinishRange();
+	void TestReload();
+	void TestTornRecord();
+	void TestDisabled();
+};
+#endif
@@ -41,9 +41,37 @@
 class JobSessionTest : public CppUnit::TestFixture {
         CPPUNIT_TEST_SUITE(JobSessionTest);
         CPPUNIT_TEST(TestJobSession);
+        CPPUNIT_TEST(TestJobSweep);
+        CPPUNIT_TEST(TestJobGraph);
+        CPPUNIT_TEST(TestScriptBody);
+        CPPUNIT_TEST(TestBaseEnvironment);
+        CPPUNIT_TEST(TestBulkJobsMaxParallel);
+        CPPUNIT_TEST(TestSubmissionJournal);
+        CPPUNIT_TEST(TestSubmitKey);
+        CPPUNIT_TEST(TestJobCategories);
+        CPPUNIT_TEST(TestControlJobs);
+        CPPUNIT_TEST(TestControlJobsFilter);
+        CPPUNIT_TEST(TestArraySlices);
+        CPPUNIT_TEST(TestAlterJobs);
+        CPPUNIT_TEST(TestWaitSet);
+        CPPUNIT_TEST(TestEventNotification);
         CPPUNIT_TEST_SUITE_END();
 public:
         void TestJobSession();
+        void TestJobSweep();
+        void TestJobGraph();
+        void TestScriptBody();
+        void TestBaseEnvironment();
+        void TestBulkJobsMaxParallel();
+        void TestSubmissionJournal();
+        void TestSubmitKey();
+        void TestJobCategories();
+        void TestControlJobs();
+        void TestControlJobsFilter();
+        void TestArraySlices();
+        void TestAlterJobs();
+        void TestWaitSet();
+        void TestEventNotification();
 };
 #endif
 
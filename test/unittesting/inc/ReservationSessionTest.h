@@ -41,9 +41,11 @@
 class ReservationSessionTest : public CppUnit::TestFixture {
         CPPUNIT_TEST_SUITE(ReservationSessionTest);
         CPPUNIT_TEST(TestReservationSession);
+        CPPUNIT_TEST(TestReservationBatch);
         CPPUNIT_TEST_SUITE_END();
 public:
         void TestReservationSession();
+        void TestReservationBatch();
 };
 #endif
 
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include "../inc/AccountingLogTest.h"
+#include "../inc/TempDirectory.h"
+
+#include <cppunit/extensions/AutoRegisterSuite.h>
+#include <cppunit/TestAssert.h>
+#include <AccountingLog.h>
+#include <cstdio>
+#include <fstream>
+
+using namespace drmaa2;
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AccountingLogTest);
+
+#define SAMPLE_QUEUED "04/18/2017 10:15:16;Q;101.server;queue=workq\n"
+#define SAMPLE_STARTED "04/18/2017 10:15:17;S;101.server;user=pbsuser " \
+	"group=pbsuser jobname=STDIN queue=workq start=1492510517\n"
+#define SAMPLE_ENDED "04/18/2017 10:15:27;E;101.server;user=pbsuser " \
+	"group=pbsuser jobname=STDIN queue=workq start=1492510517 " \
+	"end=1492510527 Exit_status=0 resources_used.cpupercent=0 " \
+	"resources_used.cput=00:01:05 resources_used.mem=2kb " \
+	"resources_used.walltime=01:00:10 run_count=1\n"
+#define SAMPLE_FAILED "04/18/2017 10:16:00;E;102.server;user=pbsuser " \
+	"end=1492510560 Exit_status=271 resources_used.cput=00:00:00 " \
+	"resources_used.walltime=00:00:03\n"
+#define SAMPLE_KILLED "04/18/2017 10:15:20;D;101.server;" \
+	"requestor=pbsuser@host\n"
+#define SAMPLE_DELETED "04/18/2017 10:16:02;D;103.server;" \
+	"requestor=pbsuser@host\n"
+#define SAMPLE_ABORTED "04/18/2017 10:16:03;A;104.server;Job deleted as " \
+	"result of dependency on job 102.server\n"
+#define SAMPLE_LICENSE "04/18/2017 10:16:01;L;license;floating license " \
+	"hour:0 day:0 month:0 max:0\n"
+
+void AccountingLogTest::setUp() {
+	_directory = createTempDirectory("drmaa2_acct");
+}
+
+void AccountingLogTest::tearDown() {
+	CPPUNIT_ASSERT(removeTempDirectory(_directory));
+}
+
+void AccountingLogTest::append(const string& file_, const string& text_) {
+	ofstream out_((_directory + "/" + file_).c_str(), ios::app);
+	out_ << text_;
+}
+
+void AccountingLogTest::TestEndRecords() {
+	append("20170418", SAMPLE_QUEUED SAMPLE_STARTED SAMPLE_ENDED
+			SAMPLE_LICENSE SAMPLE_FAILED);
+	AccountingLog log_(_directory);
+	CPPUNIT_ASSERT_EQUAL((size_t) 2, log_.refresh());
+	CPPUNIT_ASSERT(log_.isAvailable());
+	AccountingRecord record_;
+	CPPUNIT_ASSERT(log_.lookup("101.server", record_));
+	CPPUNIT_ASSERT_EQUAL(0L, record_.exitStatus);
+	CPPUNIT_ASSERT_EQUAL((time_t) 1492510527, record_.finishTime);
+	CPPUNIT_ASSERT_EQUAL(65L, record_.cpuTime);
+	CPPUNIT_ASSERT_EQUAL((time_t) 3610, record_.wallclockTime);
+	CPPUNIT_ASSERT_EQUAL(DONE, record_.getState());
+	CPPUNIT_ASSERT(log_.lookup("102.server", record_));
+	CPPUNIT_ASSERT_EQUAL(271L, record_.exitStatus);
+	CPPUNIT_ASSERT_EQUAL(FAILED, record_.getState());
+	CPPUNIT_ASSERT(!log_.lookup("103.server", record_));
+	CPPUNIT_ASSERT_EQUAL((size_t) 0, log_.refresh());
+}
+
+void AccountingLogTest::TestPartialLine() {
+	string ended_(SAMPLE_ENDED);
+	append("20170418", SAMPLE_QUEUED + ended_.substr(0, 40));
+	AccountingLog log_(_directory);
+	AccountingRecord record_;
+	CPPUNIT_ASSERT_EQUAL((size_t) 0, log_.refresh());
+	CPPUNIT_ASSERT(!log_.lookup("101.server", record_));
+	append("20170418", ended_.substr(40));
+	CPPUNIT_ASSERT_EQUAL((size_t) 1, log_.refresh());
+	CPPUNIT_ASSERT(log_.lookup("101.server", record_));
+	CPPUNIT_ASSERT_EQUAL((time_t) 3610, record_.wallclockTime);
+}
+
+void AccountingLogTest::TestRotation() {
+	append("20170417", SAMPLE_QUEUED);
+	append("20170418", SAMPLE_STARTED);
+	AccountingLog log_(_directory);
+	// Reading starts with the newest file, older days are skipped
+	append("20170417", SAMPLE_FAILED);
+	CPPUNIT_ASSERT_EQUAL((size_t) 0, log_.refresh());
+	append("20170418", SAMPLE_ENDED);
+	CPPUNIT_ASSERT_EQUAL((size_t) 1, log_.refresh());
+	// Last lines of the old day, then the server rotates
+	append("20170418", SAMPLE_FAILED);
+	append("20170419", SAMPLE_QUEUED SAMPLE_ENDED);
+	CPPUNIT_ASSERT_EQUAL((size_t) 1, log_.refresh());
+	CPPUNIT_ASSERT_EQUAL((size_t) 1, log_.refresh());
+	AccountingRecord record_;
+	CPPUNIT_ASSERT(log_.lookup("102.server", record_));
+	CPPUNIT_ASSERT_EQUAL((size_t) 0, log_.refresh());
+}
+
+void AccountingLogTest::TestMaxRecords() {
+	append("20170418", SAMPLE_ENDED SAMPLE_FAILED);
+	AccountingLog log_(_directory, 1);
+	CPPUNIT_ASSERT_EQUAL((size_t) 2, log_.refresh());
+	AccountingRecord record_;
+	CPPUNIT_ASSERT(!log_.lookup("101.server", record_));
+	CPPUNIT_ASSERT(log_.lookup("102.server", record_));
+}
+
+void AccountingLogTest::TestDeletedRecords() {
+	append("20170418", SAMPLE_QUEUED SAMPLE_STARTED SAMPLE_KILLED
+			SAMPLE_DELETED SAMPLE_ABORTED);
+	AccountingLog log_(_directory);
+	CPPUNIT_ASSERT_EQUAL((size_t) 3, log_.refresh());
+	AccountingRecord record_;
+	CPPUNIT_ASSERT(log_.lookup("103.server", record_));
+	CPPUNIT_ASSERT(!record_.ended);
+	CPPUNIT_ASSERT(record_.finishTime != 0);
+	CPPUNIT_ASSERT_EQUAL(FAILED, record_.getState());
+	CPPUNIT_ASSERT(log_.lookup("104.server", record_));
+	CPPUNIT_ASSERT_EQUAL(FAILED, record_.getState());
+	// A running job deleted still writes its end record
+	CPPUNIT_ASSERT(log_.lookup("101.server", record_));
+	CPPUNIT_ASSERT_EQUAL(FAILED, record_.getState());
+	append("20170418", SAMPLE_ENDED SAMPLE_KILLED);
+	CPPUNIT_ASSERT_EQUAL((size_t) 1, log_.refresh());
+	CPPUNIT_ASSERT(log_.lookup("101.server", record_));
+	CPPUNIT_ASSERT(record_.ended);
+	CPPUNIT_ASSERT_EQUAL((time_t) 1492510527, record_.finishTime);
+	CPPUNIT_ASSERT_EQUAL(DONE, record_.getState());
+}
+
+void AccountingLogTest::TestMissingDirectory() {
+	AccountingLog log_(_directory + "/missing");
+	CPPUNIT_ASSERT_EQUAL((size_t) 0, log_.refresh());
+	CPPUNIT_ASSERT(!log_.isAvailable());
+}
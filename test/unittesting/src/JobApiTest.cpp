@@ -43,6 +43,7 @@
 #include "drmaa2.hpp"
 #include <string.h>
 #include <unistd.h>
+#include <poll.h>
 
 
 using namespace drmaa2;
@@ -79,3 +80,72 @@ void JobApiTest::TestJobApi() {
 	drmaa2_jinfo_free(&jinfo);
 	drmaa2_jsession_free(&js1);
 }
+
+void JobApiTest::TestAsyncJobApi() {
+	drmaa2_jsession js1 = drmaa2_create_jsession("SessionAsyncApi", "Contact");
+	drmaa2_cq cq = drmaa2_cq_create();
+	CPPUNIT_ASSERT(cq != NULL);
+	CPPUNIT_ASSERT(drmaa2_cq_poll(cq) == NULL);
+	drmaa2_jtemplate jt = drmaa2_jtemplate_create();
+	jt->remoteCommand = strdup("/bin/sleep");
+	jt->jobName = strdup("JobAsyncApiTest");
+	drmaa2_list_add(jt->args, (void*)strdup("100"));
+	int tag = 1;
+	CPPUNIT_ASSERT_EQUAL(DRMAA2_SUCCESS,
+			drmaa2_jsession_run_job_async(js1, jt, cq, &tag));
+	drmaa2_jtemplate_free(&jt);
+	struct pollfd pfd;
+	pfd.fd = drmaa2_cq_get_fd(cq);
+	pfd.events = POLLIN;
+	CPPUNIT_ASSERT_EQUAL(1, poll(&pfd, 1, 30000));
+	drmaa2_completion c = drmaa2_cq_poll(cq);
+	CPPUNIT_ASSERT(c != NULL);
+	CPPUNIT_ASSERT(c->tag == &tag);
+	CPPUNIT_ASSERT_EQUAL(DRMAA2_ASYNC_RUN_JOB, c->op);
+	drmaa2_j j = c->job;
+	drmaa2_completion_free(&c);
+	CPPUNIT_ASSERT(j != NULL);
+	drmaa2_j_get_state_async(j, cq, &tag);
+	drmaa2_j_terminate_async(j, cq, &tag);
+	for (int i = 0; i < 2; i++) {
+		c = drmaa2_cq_wait(cq, DRMAA2_INFINITE_TIME);
+		CPPUNIT_ASSERT(c != NULL);
+		CPPUNIT_ASSERT(c->job == j);
+		drmaa2_completion_free(&c);
+	}
+	CPPUNIT_ASSERT(drmaa2_cq_wait(cq, DRMAA2_ZERO_TIME) == NULL);
+	drmaa2_cq_free(&cq);
+	CPPUNIT_ASSERT(cq == NULL);
+	drmaa2_j_free(&j);
+	drmaa2_jsession_free(&js1);
+}
+
+void JobApiTest::TestWaitJobApi() {
+	drmaa2_jsession js1 = drmaa2_create_jsession("SessionWaitApi", "Contact");
+	drmaa2_jtemplate jt = drmaa2_jtemplate_create();
+	jt->remoteCommand = strdup("/bin/sleep");
+	jt->jobName = strdup("JobWaitApiTest");
+	drmaa2_list_add(jt->args, (void*)strdup("2"));
+	jt->submitAsHold = DRMAA2_TRUE;
+	drmaa2_j held = drmaa2_jsession_run_job(js1, jt);
+	jt->submitAsHold = DRMAA2_FALSE;
+	drmaa2_j j = drmaa2_jsession_run_job(js1, jt);
+	CPPUNIT_ASSERT(held != NULL && j != NULL);
+	// A held job neither starts nor ends, the waits time out
+	CPPUNIT_ASSERT_EQUAL(DRMAA2_TIMEOUT, drmaa2_j_wait_started(held,
+			DRMAA2_ZERO_TIME));
+	CPPUNIT_ASSERT_EQUAL(DRMAA2_TIMEOUT, drmaa2_j_wait_terminated(held, 2));
+	CPPUNIT_ASSERT_EQUAL(DRMAA2_SUCCESS, drmaa2_j_wait_started(j, 60));
+	CPPUNIT_ASSERT_EQUAL(DRMAA2_SUCCESS, drmaa2_j_wait_terminated(j,
+			DRMAA2_INFINITE_TIME));
+	drmaa2_j_list l = drmaa2_list_create(DRMAA2_JOBLIST, NULL);
+	drmaa2_list_add(l, held);
+	drmaa2_list_add(l, j);
+	CPPUNIT_ASSERT(drmaa2_jsession_wait_any_terminated(js1, l, 10) == j);
+	drmaa2_list_free(&l);
+	drmaa2_j_terminate(held);
+	drmaa2_j_free(&held);
+	drmaa2_j_free(&j);
+	drmaa2_jtemplate_free(&jt);
+	drmaa2_jsession_free(&js1);
+}
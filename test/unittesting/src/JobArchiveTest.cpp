@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include "../inc/JobArchiveTest.h"
+#include "../inc/TempDirectory.h"
+
+#include <cppunit/extensions/AutoRegisterSuite.h>
+#include <cppunit/TestAssert.h>
+#include <JobArchive.h>
+#include <fstream>
+
+using namespace drmaa2;
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JobArchiveTest);
+
+void JobArchiveTest::setUp() {
+	_directory = createTempDirectory("drmaa2_archive");
+}
+
+void JobArchiveTest::tearDown() {
+	CPPUNIT_ASSERT(removeTempDirectory(_directory));
+}
+
+JobInfo JobArchiveTest::finished(const string& jobId_, const string& owner_,
+		const string& queue_, const JobState state_, const time_t finishTime_) {
+	JobInfo info_;
+	info_.jobId = jobId_;
+	info_.jobOwner = owner_;
+	info_.queueName = queue_;
+	info_.jobState = state_;
+	info_.exitStatus = state_ == FAILED ? 1 : 0;
+	info_.finishTime = finishTime_;
+	info_.annotation = "tab\there";
+	info_.allocatedMachines.push_back("node1");
+	info_.allocatedMachines.push_back("node2");
+	return info_;
+}
+
+void JobArchiveTest::TestAddAndFind() {
+	JobArchive archive_(_directory);
+	CPPUNIT_ASSERT(archive_.isEnabled());
+	archive_.add(finished("1.server", "alice", "workq", DONE, 100));
+	archive_.add(finished("2.server", "bob", "workq", DONE, 200));
+	archive_.add(finished("3.server", "alice", "fastq", FAILED, 300));
+	archive_.add(finished("1.server", "alice", "workq", DONE, 100));
+	JobInfo running_ = finished("4.server", "alice", "workq", DONE, 0);
+	running_.jobState = RUNNING;
+	archive_.add(running_);
+	CPPUNIT_ASSERT(archive_.isArchived("1.server"));
+	CPPUNIT_ASSERT(!archive_.isArchived("4.server"));
+	JobInfo filter_;
+	filter_.jobState = DONE;
+	filter_.jobOwner = "alice";
+	JobInfoList found_ = archive_.find(filter_);
+	CPPUNIT_ASSERT_EQUAL((size_t) 1, found_.size());
+	CPPUNIT_ASSERT_EQUAL(string("1.server"), found_.front().jobId);
+	CPPUNIT_ASSERT_EQUAL(string("tab\there"), found_.front().annotation);
+	CPPUNIT_ASSERT_EQUAL((size_t) 2, found_.front().allocatedMachines.size());
+	filter_.jobOwner.clear();
+	filter_.queueName = "workq";
+	CPPUNIT_ASSERT_EQUAL((size_t) 2, archive_.find(filter_).size());
+	// Owner and queue names share one table
+	filter_.queueName.clear();
+	filter_.jobOwner = "workq";
+	CPPUNIT_ASSERT(archive_.find(filter_).empty());
+	filter_.jobOwner.clear();
+	filter_.queueName = "alice";
+	CPPUNIT_ASSERT(archive_.find(filter_).empty());
+	filter_.queueName = "workq";
+	filter_.jobState = FAILED;
+	filter_.queueName.clear();
+	filter_.jobId = "3.server";
+	found_ = archive_.find(filter_);
+	CPPUNIT_ASSERT_EQUAL((size_t) 1, found_.size());
+	CPPUNIT_ASSERT_EQUAL(1L, found_.front().exitStatus);
+	filter_.annotation = "other";
+	CPPUNIT_ASSERT(archive_.find(filter_).empty());
+}
+
+void JobArchiveTest::TestFinishRange() {
+	JobArchive archive_(_directory);
+	archive_.add(finished("3.server", "alice", "workq", DONE, 300));
+	archive_.add(finished("1.server", "alice", "workq", DONE, 100));
+	archive_.add(finished("2.server", "bob", "workq", DONE, 200));
+	JobInfo filter_;
+	filter_.jobState = DONE;
+	JobInfoList found_ = archive_.find(filter_, 150);
+	CPPUNIT_ASSERT_EQUAL((size_t) 2, found_.size());
+	CPPUNIT_ASSERT_EQUAL(string("2.server"), found_.front().jobId);
+	filter_.finishTime = 200;
+	found_ = archive_.find(filter_);
+	CPPUNIT_ASSERT_EQUAL((size_t) 2, found_.size());
+	CPPUNIT_ASSERT_EQUAL(string("1.server"), found_.front().jobId);
+	filter_.jobOwner = "alice";
+	CPPUNIT_ASSERT_EQUAL((size_t) 1, archive_.find(filter_).size());
+}
+
+void JobArchiveTest::TestReload() {
+	{
+		JobArchive archive_(_directory);
+		archive_.add(finished("1.server", "alice", "workq", DONE, 100));
+		archive_.add(finished("2.server", "bob", "workq", FAILED, 200));
+	}
+	JobArchive archive_(_directory);
+	CPPUNIT_ASSERT(archive_.isArchived("1.server"));
+	CPPUNIT_ASSERT(archive_.isArchived("2.server"));
+	archive_.add(finished("3.server", "bob", "workq", FAILED, 300));
+	JobInfo filter_;
+	filter_.jobState = FAILED;
+	filter_.jobOwner = "bob";
+	CPPUNIT_ASSERT_EQUAL((size_t) 2, archive_.find(filter_).size());
+}
+
+void JobArchiveTest::TestTornRecord() {
+	{
+		JobArchive archive_(_directory);
+		archive_.add(finished("1.server", "alice", "workq", DONE, 100));
+	}
+	ofstream out_((_directory + "/" ARCHIVE_SEGMENT_PREFIX "000000").c_str(),
+			ios::app);
+	out_ << "2.server\t4\t0\tbob";
+	out_.close();
+	JobArchive archive_(_directory);
+	CPPUNIT_ASSERT(archive_.isArchived("1.server"));
+	CPPUNIT_ASSERT(!archive_.isArchived("2.server"));
+	archive_.add(finished("2.server", "bob", "workq", DONE, 200));
+	JobArchive reloaded_(_directory);
+	CPPUNIT_ASSERT(reloaded_.isArchived("2.server"));
+	JobInfo filter_;
+	filter_.jobState = DONE;
+	CPPUNIT_ASSERT_EQUAL((size_t) 2, reloaded_.find(filter_).size());
+}
+
+void JobArchiveTest::TestDisabled() {
+	JobArchive archive_("");
+	CPPUNIT_ASSERT(!archive_.isEnabled());
+	archive_.add(finished("1.server", "alice", "workq", DONE, 100));
+	CPPUNIT_ASSERT(!archive_.isArchived("1.server"));
+	JobArchive missing_(_directory + "/missing");
+	CPPUNIT_ASSERT(!missing_.isEnabled());
+	JobInfo filter_;
+	filter_.jobState = DONE;
+	CPPUNIT_ASSERT(JobArchive::matchesFinished(filter_));
+	filter_.jobState = RUNNING;
+	CPPUNIT_ASSERT(!JobArchive::matchesFinished(filter_));
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include "../inc/JobIdIndexTest.h"
+
+#include <cppunit/extensions/AutoRegisterSuite.h>
+#include <cppunit/TestAssert.h>
+#include <JobIdIndex.h>
+#include <algorithm>
+#include <cstdio>
+
+using namespace drmaa2;
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JobIdIndexTest);
+
+void JobIdIndexTest::TestRoundTrip() {
+	JobIdIndex index_;
+	CPPUNIT_ASSERT(index_.ids().empty());
+	index_.add("12.pbsserver");
+	index_.add("3.pbsserver");
+	index_.add("7.other.example.com");
+	index_.add("3.pbsserver");
+	// Not of the <sequence>.<server> form, kept as given
+	index_.add("unexpected");
+	list<string> ids_ = index_.ids();
+	CPPUNIT_ASSERT_EQUAL((size_t) 4, index_.size());
+	list<string>::iterator it = ids_.begin();
+	CPPUNIT_ASSERT_EQUAL(string("3.pbsserver"), *it++);
+	CPPUNIT_ASSERT_EQUAL(string("12.pbsserver"), *it++);
+	CPPUNIT_ASSERT_EQUAL(string("7.other.example.com"), *it++);
+	CPPUNIT_ASSERT_EQUAL(string("unexpected"), *it++);
+}
+
+void JobIdIndexTest::TestArrays() {
+	JobIdIndex index_;
+	index_.add("20[].pbsserver");
+	index_.add("20[3].pbsserver");
+	index_.add("20[4].pbsserver");
+	index_.add("20.pbsserver");
+	list<string> ids_ = index_.ids();
+	CPPUNIT_ASSERT_EQUAL((size_t) 2, ids_.size());
+	CPPUNIT_ASSERT_EQUAL(string("20.pbsserver"), ids_.front());
+	CPPUNIT_ASSERT_EQUAL(string("20[].pbsserver"), ids_.back());
+}
+
+void JobIdIndexTest::TestRemove() {
+	JobIdIndex index_;
+	for (int i = 100; i > 0; i--) {
+		char id_[32];
+		snprintf(id_, sizeof(id_), "%d.pbsserver", i);
+		index_.add(id_);
+	}
+	index_.add("odd");
+	list<string> gone_;
+	gone_.push_back("1.pbsserver");
+	gone_.push_back("50.pbsserver");
+	gone_.push_back("5.unknown");
+	gone_.push_back("odd");
+	index_.remove(gone_);
+	list<string> ids_ = index_.ids();
+	CPPUNIT_ASSERT_EQUAL((size_t) 98, ids_.size());
+	CPPUNIT_ASSERT_EQUAL(string("2.pbsserver"), ids_.front());
+	CPPUNIT_ASSERT_EQUAL(string("100.pbsserver"), ids_.back());
+	CPPUNIT_ASSERT(find(ids_.begin(), ids_.end(), "50.pbsserver")
+			== ids_.end());
+}
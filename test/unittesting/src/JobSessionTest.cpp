@@ -41,9 +41,25 @@
 #include <JobSessionTest.h>
 #include <SessionManagerImpl.h>
 #include <PBSProSystem.h>
+#include <ConnectionPool.h>
+#include <EnvironmentEncoder.h>
+#include <JobCategories.h>
+#include <JobTemplateAttrHelper.h>
+#include <JobArrayImpl.h>
+#include <SubmissionJournal.h>
+#include <JobImpl.h>
+#include <InvalidStateException.h>
+#include <TimeoutException.h>
+#include <InvalidArgumentException.h>
+#include <UnsupportedAttributeException.h>
+#include <UnsupportedOperationException.h>
 #include "drmaa2.hpp"
 #include <string>
+#include <sstream>
+#include <iterator>
 #include <unistd.h>
+#include <ctime>
+#include <stdlib.h>
 
 
 using namespace drmaa2;
@@ -91,3 +107,519 @@ void JobSessionTest::TestJobSession() {
 	delete &j1_;
 	delete &ja1_;
 }
+
+void JobSessionTest::TestJobSweep() {
+	string session_("SessionSweep"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	const JobSession &jobSessionObj_ = sessionManagerObj_->createJobSession(session_, contact_);
+	JobTemplate jt_;
+	jt_.jobName.assign("SWEEPJOB");
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("100");
+	SweepTable points_(6);
+	for (size_t i = 0; i < points_.size(); i++) {
+		stringstream value_;
+		value_ << i;
+		points_[i].jobEnvironment["SWEEP_POINT"] = value_.str();
+		points_[i].resourceLimits[DRMAA2_WALLCLOCK_TIME] =
+				(i % 2) ? "00:10:00" : "00:20:00";
+	}
+	points_[5].args.push_back("200");
+	SweepTable injected_(points_);
+	injected_[2].jobEnvironment["X;touch injected;Y"] = "1";
+	CPPUNIT_ASSERT_THROW(jobSessionObj_.runJobSweep(jt_, injected_),
+			InvalidArgumentException);
+	JobList jobs_ = jobSessionObj_.runJobSweep(jt_, points_);
+	CPPUNIT_ASSERT_EQUAL(points_.size(), jobs_.size());
+	JobList::iterator it = jobs_.begin();
+	CPPUNIT_ASSERT((*it)->getJobId().find('[') != string::npos);
+	advance(it, 5);
+	CPPUNIT_ASSERT_EQUAL(string("200"), (*it)->getJobTemplate().args[0]);
+	for (it = jobs_.begin(); it != jobs_.end(); ++it) {
+		(*it)->terminate();
+		delete *it;
+	}
+	sessionManagerObj_->destroyJobSession(session_);
+}
+
+void JobSessionTest::TestJobGraph() {
+	string session_("SessionGraph"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	const JobSession &jobSessionObj_ = sessionManagerObj_->createJobSession(session_, contact_);
+	JobGraphTemplate graph_(4);
+	for (size_t i = 0; i < graph_.size(); i++) {
+		graph_[i].jobTemplate.jobName.assign("GRAPHJOB");
+		graph_[i].jobTemplate.remoteCommand.assign("/bin/sleep");
+		graph_[i].jobTemplate.args.push_back("10");
+	}
+	graph_[1].dependsOn.push_back(0);
+	graph_[2].dependsOn.push_back(0);
+	graph_[3].dependsOn.push_back(1);
+	graph_[3].dependsOn.push_back(2);
+	JobGraph &jobGraph_ = jobSessionObj_.runJobGraph(graph_);
+	CPPUNIT_ASSERT_EQUAL(graph_.size(), jobGraph_.getJobs().size());
+	CPPUNIT_ASSERT(jobGraph_.getState() != FAILED);
+	jobGraph_.terminate();
+	delete &jobGraph_;
+
+	graph_[0].dependsOn.push_back(3);
+	CPPUNIT_ASSERT_THROW(jobSessionObj_.runJobGraph(graph_),
+			InvalidArgumentException);
+	sessionManagerObj_->destroyJobSession(session_);
+}
+
+void JobSessionTest::TestScriptBody() {
+	string session_("SessionScript"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	const JobSession &jobSessionObj_ = sessionManagerObj_->createJobSession(session_, contact_);
+	JobTemplate jt_;
+	jt_.jobName.assign("SCRIPTJOB");
+	jt_.scriptBody.assign("#!/bin/sh\nsleep 100\n");
+	const Job& j1_ = jobSessionObj_.runJob(jt_);
+	CPPUNIT_ASSERT(!j1_.getJobId().empty());
+	const JobArray& ja1_ = jobSessionObj_.runBulkJobs(jt_, 1, 4, 1, 4);
+	CPPUNIT_ASSERT(!ja1_.getJobArrayId().empty());
+	j1_.terminate();
+	ja1_.terminate();
+	sessionManagerObj_->destroyJobSession(session_);
+	delete &j1_;
+	delete &ja1_;
+}
+
+void JobSessionTest::TestBaseEnvironment() {
+	string session_("SessionEnv"), contact_(pbs_default()), encoded_;
+	map<string, string> base_, job_;
+	base_["A"] = "1";
+	base_["B"] = "x,y";
+	base_["C"] = "c:\\d";
+	EnvironmentEncoder encoder_(base_);
+	encoder_.encode(job_, encoded_);
+	CPPUNIT_ASSERT_EQUAL(string("A=1,B=x\\,y,C=c:\\\\d"), encoded_);
+	job_["D"] = "4";
+	job_["A"] = "1";
+	encoder_.encode(job_, encoded_);
+	CPPUNIT_ASSERT_EQUAL(string("A=1,B=x\\,y,C=c:\\\\d,D=4"), encoded_);
+	job_["B"] = "z";
+	encoder_.encode(job_, encoded_);
+	CPPUNIT_ASSERT_EQUAL(string("A=1,B=z,C=c:\\\\d,D=4"), encoded_);
+
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	JobSession &jobSessionObj_ = const_cast<JobSession&>(
+			sessionManagerObj_->createJobSession(session_, contact_));
+	jobSessionObj_.setBaseEnvironment(base_);
+	CPPUNIT_ASSERT(jobSessionObj_.getBaseEnvironment() == base_);
+	JobTemplate jt_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("100");
+	jt_.jobEnvironment["D"] = "4";
+	const Job& j1_ = jobSessionObj_.runJob(jt_);
+	CPPUNIT_ASSERT(!j1_.getJobId().empty());
+	j1_.terminate();
+	sessionManagerObj_->destroyJobSession(session_);
+	delete &j1_;
+}
+
+void JobSessionTest::TestBulkJobsMaxParallel() {
+	string session_("SessionMaxParallel"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	CPPUNIT_ASSERT(sessionManagerObj_->supports(BULK_JOBS_MAXPARALLEL));
+	const JobSession &jobSessionObj_ = sessionManagerObj_->createJobSession(session_, contact_);
+	JobTemplate jt_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("100");
+	const JobArray& ja1_ = jobSessionObj_.runBulkJobs(jt_, 1, 10, 1, 3);
+	CPPUNIT_ASSERT(!ja1_.getJobArrayId().empty());
+	// Either the server caps the array or 10 indices run as 3+3+2+2
+	size_t windows_ = dynamic_cast<const JobArrayImpl&>(ja1_).getWindows().size();
+	CPPUNIT_ASSERT(windows_ == 0 || windows_ == 3);
+	ja1_.terminate();
+	sessionManagerObj_->destroyJobSession(session_);
+	delete &ja1_;
+}
+
+void JobSessionTest::TestSubmissionJournal() {
+	string session_("SessionJournal"), contact_(pbs_default());
+	char path_[] = "/tmp/drmaa2journalXXXXXX";
+	int fd_ = mkstemp(path_);
+	CPPUNIT_ASSERT(fd_ >= 0);
+	close(fd_);
+	JobTemplate jt_, back_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("100");
+	jt_.jobEnvironment["A"] = "tab\there\nnewline";
+	jt_.machineOS = AIX;
+	SubmissionJournal::deserialize(SubmissionJournal::serialize(jt_), back_);
+	CPPUNIT_ASSERT(back_.args == jt_.args);
+	CPPUNIT_ASSERT(back_.jobEnvironment == jt_.jobEnvironment);
+	CPPUNIT_ASSERT_EQUAL(AIX, back_.machineOS);
+
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	JobSession &jobSessionObj_ = const_cast<JobSession&>(
+			sessionManagerObj_->createJobSession(session_, contact_));
+	CPPUNIT_ASSERT_THROW(jobSessionObj_.enqueueJob(jt_), InvalidStateException);
+	jobSessionObj_.openJournal(path_);
+	string key_ = jobSessionObj_.enqueueJob(jt_, "request-1");
+	CPPUNIT_ASSERT_EQUAL(string("request-1"), key_);
+	CPPUNIT_ASSERT_EQUAL(key_, jobSessionObj_.enqueueJob(jt_, key_));
+	CPPUNIT_ASSERT_THROW(jobSessionObj_.enqueueJob(jt_, "bad key"),
+			InvalidArgumentException);
+	string jobId_;
+	for (int i = 0; i < 100 && jobId_.empty(); i++) {
+		usleep(100000);
+		jobId_ = jobSessionObj_.getEnqueuedJobId(key_);
+	}
+	CPPUNIT_ASSERT(!jobId_.empty());
+	jobSessionObj_.closeJournal();
+
+	// Reopening replays the journal, the finished request is remembered
+	jobSessionObj_.openJournal(path_);
+	CPPUNIT_ASSERT_EQUAL(jobId_, jobSessionObj_.getEnqueuedJobId(key_));
+	jobSessionObj_.enqueueJob(jt_, key_);
+	CPPUNIT_ASSERT_EQUAL(jobId_, jobSessionObj_.getEnqueuedJobId(key_));
+	sessionManagerObj_->destroyJobSession(session_);
+	unlink(path_);
+	JobImpl job_(jobId_);
+	job_.terminate();
+}
+
+void JobSessionTest::TestSubmitKey() {
+	string session_("SessionSubmitKey"), contact_(pbs_default());
+	CPPUNIT_ASSERT(PBSProSystem::isValidSubmitKey("run-42.a"));
+	CPPUNIT_ASSERT(!PBSProSystem::isValidSubmitKey(""));
+	CPPUNIT_ASSERT(!PBSProSystem::isValidSubmitKey("a,b"));
+	CPPUNIT_ASSERT(!PBSProSystem::isValidSubmitKey("a b"));
+
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	JobSession &jobSessionObj_ = const_cast<JobSession&>(
+			sessionManagerObj_->createJobSession(session_, contact_));
+	JobTemplate jt_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("100");
+	jt_.jobName.assign("submitkey");
+	CPPUNIT_ASSERT_THROW(jobSessionObj_.runJob(jt_, "bad key"),
+			InvalidArgumentException);
+	stringstream key_;
+	key_ << "submitkey." << getpid() << "." << time(NULL);
+	const Job& j1_ = jobSessionObj_.runJob(jt_, key_.str());
+	CPPUNIT_ASSERT(!j1_.getJobId().empty());
+
+	// The key travels with the job, so the lookup finds it
+	DRMSystem *drms_ = Singleton<DRMSystem, PBSProSystem>::getInstance();
+	const Connection &conn_ = ConnectionPool::getInstance()->waitConnection();
+	CPPUNIT_ASSERT_EQUAL(j1_.getJobId(),
+			drms_->findKeyedJob(conn_, key_.str(), jt_.jobName));
+	CPPUNIT_ASSERT(drms_->findKeyedJob(conn_, key_.str() + "x",
+			jt_.jobName).empty());
+	ConnectionPool::getInstance()->returnConnection(conn_);
+	j1_.terminate();
+	sessionManagerObj_->destroyJobSession(session_);
+}
+
+void JobSessionTest::TestJobCategories() {
+	char path_[] = "/tmp/drmaa2categoriesXXXXXX";
+	int fd_ = mkstemp(path_);
+	CPPUNIT_ASSERT(fd_ >= 0);
+	string config_("# test categories\n"
+			"[bigmem]\n"
+			"queue = workq\n"
+			"Resource_List.ncpus = 8\n"
+			"Resource_List.mem = 64gb\n"
+			"Account_Name = big\n"
+			"Account_Name = bigger\n"
+			"not a setting\n"
+			"[short]\n"
+			"Resource_List.walltime = 00:10:00\n");
+	CPPUNIT_ASSERT_EQUAL((ssize_t) config_.size(),
+			write(fd_, config_.c_str(), config_.size()));
+	close(fd_);
+	JobCategories categories_(path_);
+	unlink(path_);
+	CPPUNIT_ASSERT_EQUAL((size_t) 2, categories_.getNames().size());
+	CPPUNIT_ASSERT(categories_.find("unknown") == NULL);
+	const JobCategory *category_ = categories_.find("bigmem");
+	CPPUNIT_ASSERT(category_ != NULL);
+	CPPUNIT_ASSERT_EQUAL(string("workq"), category_->getQueue());
+
+	// The template's ncpus wins, the rest comes from the category
+	JobTemplate jt_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.jobCategory.assign("bigmem");
+	jt_.minSlots = 2;
+	JobTemplateAttrHelper attrParse_;
+	attrParse_.setCategories(&categories_);
+	attrParse_.parseTemplate((void *) &jt_);
+	CPPUNIT_ASSERT_EQUAL(string("2"),
+			string(attrParse_.getAttribute((char *) ATTR_l, (char *) "ncpus")));
+	CPPUNIT_ASSERT_EQUAL(string("64gb"),
+			string(attrParse_.getAttribute((char *) ATTR_l, (char *) "mem")));
+	CPPUNIT_ASSERT_EQUAL(string("bigger"),
+			string(attrParse_.getAttribute((char *) ATTR_A, NULL)));
+	CPPUNIT_ASSERT_EQUAL(string("workq"), attrParse_._categoryQueue);
+}
+
+void JobSessionTest::TestControlJobs() {
+	string session_("SessionControlJobs"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	JobSession &jobSessionObj_ = const_cast<JobSession&>(
+			sessionManagerObj_->createJobSession(session_, contact_));
+	JobTemplate jt_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("100");
+	jt_.submitAsHold = true;
+	JobList jobs_;
+	for (int i = 0; i < 3; i++)
+		jobs_.push_back(const_cast<Job*>(&jobSessionObj_.runJob(jt_)));
+	JobImpl unknown_("0.unknown");
+	jobs_.push_back(&unknown_);
+
+	// A job the server does not know fails alone, in its own slot
+	vector<JobOperationResult> results_ = jobSessionObj_.controlJobs(jobs_,
+			RELEASE_JOB);
+	CPPUNIT_ASSERT_EQUAL(jobs_.size(), results_.size());
+	for (int i = 0; i < 3; i++)
+		CPPUNIT_ASSERT_EQUAL(ERROR_NONE, results_[i].error);
+	CPPUNIT_ASSERT(results_[3].job == &unknown_);
+	CPPUNIT_ASSERT(results_[3].error != ERROR_NONE);
+	CPPUNIT_ASSERT(!results_[3].message.empty());
+
+	jobs_.pop_back();
+	results_ = jobSessionObj_.controlJobs(jobs_, TERMINATE_JOB);
+	for (size_t i = 0; i < results_.size(); i++)
+		CPPUNIT_ASSERT_EQUAL(ERROR_NONE, results_[i].error);
+	CPPUNIT_ASSERT(jobSessionObj_.controlJobs(JobList(), HOLD_JOB).empty());
+	jobs_.push_back(NULL);
+	CPPUNIT_ASSERT_THROW(jobSessionObj_.controlJobs(jobs_, HOLD_JOB),
+			InvalidArgumentException);
+	sessionManagerObj_->destroyJobSession(session_);
+}
+
+/**
+ * @brief Counts the callbacks of a filter driven controlJobs
+ */
+class CountingOperationCallback : public JobOperationCallback {
+public:
+	long failures, done, total;
+	CountingOperationCallback() : failures(0), done(0), total(0) {
+	}
+	void failed(const JobOperationResult& result_) {
+		failures++;
+	}
+	void progress(const long done_, const long failed_, const long total_) {
+		done = done_;
+		total = total_;
+	}
+};
+
+void JobSessionTest::TestControlJobsFilter() {
+	string session_("SessionControlJobsFilter"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	JobSession &jobSessionObj_ = const_cast<JobSession&>(
+			sessionManagerObj_->createJobSession(session_, contact_));
+	JobTemplate jt_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("100");
+	jt_.submitAsHold = true;
+	const Job& job_ = jobSessionObj_.runJob(jt_);
+
+	JobInfo filter_;
+	filter_.jobId = job_.getJobId();
+	filter_.jobState = QUEUED_HELD;
+	CountingOperationCallback callback_;
+	CPPUNIT_ASSERT_EQUAL(0L, jobSessionObj_.controlJobs(filter_, RELEASE_JOB,
+			&callback_));
+	CPPUNIT_ASSERT_EQUAL(1L, callback_.total);
+	CPPUNIT_ASSERT_EQUAL(1L, callback_.done);
+	CPPUNIT_ASSERT_EQUAL(0L, callback_.failures);
+
+	// Released, so the held filter no longer matches the job
+	CPPUNIT_ASSERT_EQUAL(0L, jobSessionObj_.controlJobs(filter_,
+			TERMINATE_JOB));
+	filter_.jobState = UNDETERMINED;
+	CPPUNIT_ASSERT_EQUAL(0L, jobSessionObj_.controlJobs(filter_,
+			TERMINATE_JOB));
+	filter_.slots = 1;
+	CPPUNIT_ASSERT_THROW(jobSessionObj_.controlJobs(filter_, HOLD_JOB),
+			UnsupportedAttributeException);
+	sessionManagerObj_->destroyJobSession(session_);
+}
+
+void JobSessionTest::TestArraySlices() {
+	long indices_[] = { 1, 3, 5, 7, 50, 51, 99, 250, 260 };
+	set<long> slice_(indices_, indices_ + 9);
+	list<string> ranges_;
+	JobArrayImpl::compressIndices(slice_.begin(), slice_.end(), ranges_);
+	const char *expected_[] = { "1-7:2", "50-51", "99", "250", "260" };
+	CPPUNIT_ASSERT(ranges_ == list<string>(expected_, expected_ + 5));
+
+	string session_("SessionArraySlices"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	const JobSession &jobSessionObj_ = sessionManagerObj_->createJobSession(session_, contact_);
+	JobTemplate jt_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("100");
+	const JobArray& ja_ = jobSessionObj_.runBulkJobs(jt_, 1, 10, 1, 0);
+	slice_.clear();
+	for (long i = 5; i <= 10; i++)
+		slice_.insert(i);
+	CPPUNIT_ASSERT_THROW(ja_.controlIndices(slice_, HOLD_JOB),
+			UnsupportedOperationException);
+	vector<JobOperationResult> results_ = ja_.controlIndices(slice_,
+			TERMINATE_JOB);
+	CPPUNIT_ASSERT_EQUAL((size_t) 1, results_.size());
+	CPPUNIT_ASSERT_EQUAL(ERROR_NONE, results_[0].error);
+	ja_.terminate();
+	sessionManagerObj_->destroyJobSession(session_);
+	delete &ja_;
+}
+
+void JobSessionTest::TestAlterJobs() {
+	string session_("SessionAlterJobs"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	JobSession &jobSessionObj_ = const_cast<JobSession&>(
+			sessionManagerObj_->createJobSession(session_, contact_));
+	JobTemplate jt_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("100");
+	jt_.submitAsHold = true;
+	JobList jobs_;
+	for (int i = 0; i < 3; i++)
+		jobs_.push_back(const_cast<Job*>(&jobSessionObj_.runJob(jt_)));
+	JobImpl unknown_("0.unknown");
+	jobs_.push_back(&unknown_);
+
+	JobAlteration alteration_;
+	alteration_.jobName.assign("altered");
+	alteration_.alterPriority = true;
+	alteration_.priority = 100;
+	alteration_.resourceLimits[DRMAA2_WALLCLOCK_TIME] = "00:10:00";
+	vector<JobOperationResult> results_ = jobSessionObj_.alterJobs(jobs_,
+			alteration_);
+	CPPUNIT_ASSERT_EQUAL(jobs_.size(), results_.size());
+	for (int i = 0; i < 3; i++)
+		CPPUNIT_ASSERT_EQUAL(ERROR_NONE, results_[i].error);
+	CPPUNIT_ASSERT(results_[3].error != ERROR_NONE);
+	CPPUNIT_ASSERT_THROW(jobSessionObj_.alterJobs(jobs_, JobAlteration()),
+			InvalidArgumentException);
+
+	jobs_.pop_back();
+	alteration_ = JobAlteration();
+	alteration_.holdTypes.assign("n");
+	jobs_.front()->alter(alteration_);
+	CPPUNIT_ASSERT_THROW(unknown_.alter(alteration_), Drmaa2Exception);
+	jobSessionObj_.controlJobs(jobs_, TERMINATE_JOB);
+	sessionManagerObj_->destroyJobSession(session_);
+}
+
+void JobSessionTest::TestWaitSet() {
+	string session_("SessionWaitSet"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	JobSession &jobSessionObj_ = const_cast<JobSession&>(
+			sessionManagerObj_->createJobSession(session_, contact_));
+	JobTemplate jt_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("1");
+	JobWaitSet &waitSet_ = jobSessionObj_.createWaitSet(true);
+	CPPUNIT_ASSERT_THROW(waitSet_.wait(1), InvalidStateException);
+	JobList jobs_;
+	for (int i = 0; i < 4; i++) {
+		jobs_.push_back(const_cast<Job*>(&jobSessionObj_.runJob(jt_)));
+		waitSet_.add(*jobs_.back());
+	}
+	waitSet_.add(*jobs_.front());
+	CPPUNIT_ASSERT_EQUAL((size_t) 4, waitSet_.size());
+	waitSet_.remove(*jobs_.back());
+	size_t terminated_ = 0;
+	while (waitSet_.size() > 0)
+		terminated_ += waitSet_.wait(120).size();
+	CPPUNIT_ASSERT_EQUAL((size_t) 3, terminated_);
+	CPPUNIT_ASSERT_THROW(waitSet_.wait(0), InvalidStateException);
+	delete &waitSet_;
+
+	// Every wait after a timeout blocks for its own timeout again
+	jt_.args.front().assign("60");
+	const Job &long_ = jobSessionObj_.runJob(jt_);
+	JobWaitSet &timeoutSet_ = jobSessionObj_.createWaitSet(true);
+	timeoutSet_.add(long_);
+	CPPUNIT_ASSERT_THROW(timeoutSet_.wait(1), TimeoutException);
+	time_t started_ = time(NULL);
+	CPPUNIT_ASSERT_THROW(timeoutSet_.wait(2), TimeoutException);
+	CPPUNIT_ASSERT(time(NULL) - started_ >= 1);
+	delete &timeoutSet_;
+	const_cast<Job&>(long_).terminate();
+	sessionManagerObj_->destroyJobSession(session_);
+}
+
+/**
+ * @brief Records the last state and session name notified per job
+ */
+class RecordingCallback : public DrmaaCallback {
+	pthread_mutex_t _mutex;
+	map<string, JobState> _states;
+	map<string, string> _sessions;
+public:
+	RecordingCallback() {
+		pthread_mutex_init(&_mutex, NULL);
+	}
+	~RecordingCallback() {
+		pthread_mutex_destroy(&_mutex);
+	}
+	void notify(DrmaaNotification notification_) {
+		pthread_mutex_lock(&_mutex);
+		if (notification_.event == NEW_STATE) {
+			_states[notification_.jobId] = notification_.jobState;
+			_sessions[notification_.jobId] = notification_.sessionName;
+		}
+		pthread_mutex_unlock(&_mutex);
+	}
+	string getSessionName(const string& jobId_) {
+		pthread_mutex_lock(&_mutex);
+		string sessionName_ = _sessions[jobId_];
+		pthread_mutex_unlock(&_mutex);
+		return sessionName_;
+	}
+	JobState getState(const string& jobId_) {
+		pthread_mutex_lock(&_mutex);
+		map<string, JobState>::iterator it = _states.find(jobId_);
+		JobState state_ = it == _states.end() ? UNDETERMINED : it->second;
+		pthread_mutex_unlock(&_mutex);
+		return state_;
+	}
+};
+
+void JobSessionTest::TestEventNotification() {
+	string session_("SessionEventNotification"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	sessionManagerObj_->initialize();
+	JobSession &jobSessionObj_ = const_cast<JobSession&>(
+			sessionManagerObj_->createJobSession(session_, contact_));
+	RecordingCallback recordingCallback;
+	sessionManagerObj_->registerEventNotification(recordingCallback);
+	sleep(2);
+	JobTemplate jt_;
+	jt_.remoteCommand.assign("/bin/sleep");
+	jt_.args.push_back("1");
+	const Job &job_ = jobSessionObj_.runJob(jt_);
+	JobState state_ = UNDETERMINED;
+	for (int i = 0; i < 120 && state_ != DONE; i++) {
+		sleep(1);
+		state_ = recordingCallback.getState(job_.getJobId());
+	}
+	CPPUNIT_ASSERT_EQUAL(DONE, state_);
+	CPPUNIT_ASSERT_EQUAL(session_,
+			recordingCallback.getSessionName(job_.getJobId()));
+	// No notify runs on recordingCallback once this returns
+	sessionManagerObj_->unregisterEventNotification();
+	sessionManagerObj_->destroyJobSession(session_);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include "../inc/JobStateCacheTest.h"
+
+#include <cppunit/extensions/AutoRegisterSuite.h>
+#include <cppunit/TestAssert.h>
+#include <JobStateCache.h>
+
+using namespace drmaa2;
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JobStateCacheTest);
+
+/**
+ * @brief - Builds the JobInfo of a changed job
+ */
+static JobInfo changedJob(const string& jobId_, const JobState jobState_) {
+	JobInfo info_;
+	info_.jobId = jobId_;
+	info_.jobState = jobState_;
+	return info_;
+}
+
+void JobStateCacheTest::TestPatch() {
+	JobStateCache cache_(0);
+	JobInfo info_;
+	CPPUNIT_ASSERT(!cache_.lookup("1.cachetest", info_));
+	map<string, JobInfo> changed_;
+	changed_["1.cachetest"] = changedJob("1.cachetest", QUEUED);
+	changed_["2.cachetest"] = changedJob("2.cachetest", RUNNING);
+	cache_.update(changed_, 1492510517);
+	CPPUNIT_ASSERT(cache_.lookup("1.cachetest", info_));
+	CPPUNIT_ASSERT_EQUAL(QUEUED, info_.jobState);
+	// Only the job modified since is in the next delta
+	changed_.clear();
+	changed_["1.cachetest"] = changedJob("1.cachetest", DONE);
+	cache_.update(changed_, 1492510547);
+	CPPUNIT_ASSERT(cache_.lookup("1.cachetest", info_));
+	CPPUNIT_ASSERT_EQUAL(DONE, info_.jobState);
+	CPPUNIT_ASSERT(cache_.lookup("2.cachetest", info_));
+	CPPUNIT_ASSERT_EQUAL(RUNNING, info_.jobState);
+}
+
+void JobStateCacheTest::TestSynced() {
+	JobStateCache cache_(0);
+	map<string, JobInfo> changed_;
+	cache_.update(changed_, 1492510600);
+	CPPUNIT_ASSERT_EQUAL((time_t) 1492510600, cache_.getSynced());
+	// An empty delta reports the previous sync point, never goes back
+	cache_.update(changed_, 1492510500);
+	CPPUNIT_ASSERT_EQUAL((time_t) 1492510600, cache_.getSynced());
+}
+
+void JobStateCacheTest::TestSweep() {
+	JobStateCache cache_(0);
+	JobInfo info_;
+	map<string, JobInfo> changed_;
+	changed_["1.cachetest"] = changedJob("1.cachetest", RUNNING);
+	changed_["2.cachetest"] = changedJob("2.cachetest", RUNNING);
+	changed_["3.cachetest"] = changedJob("3.cachetest", RUNNING);
+	cache_.update(changed_, 1492510517);
+	// 1 left the server without a final delta, 3 was submitted after the
+	// ids were listed
+	changed_.clear();
+	changed_["3.cachetest"] = changedJob("3.cachetest", QUEUED);
+	set<string> known_;
+	known_.insert("2.cachetest");
+	cache_.update(changed_, 1492510547, &known_);
+	CPPUNIT_ASSERT(!cache_.lookup("1.cachetest", info_));
+	CPPUNIT_ASSERT(cache_.lookup("2.cachetest", info_));
+	CPPUNIT_ASSERT_EQUAL(RUNNING, info_.jobState);
+	CPPUNIT_ASSERT(cache_.lookup("3.cachetest", info_));
+	CPPUNIT_ASSERT_EQUAL(QUEUED, info_.jobState);
+}
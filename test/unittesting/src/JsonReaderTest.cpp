@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include "../inc/JsonReaderTest.h"
+
+#include <cppunit/extensions/AutoRegisterSuite.h>
+#include <cppunit/TestAssert.h>
+#include <JsonReader.h>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JsonReaderTest);
+
+/**
+ * @brief - Tells whether text_ is rejected as a job template
+ */
+static bool rejected(const string& text_) {
+	drmaa2_jtemplate jt_ = drmaa2_jtemplate_create();
+	bool rejected_ = false;
+	try {
+		JsonReader(text_).readTemplate(jt_);
+	} catch (const JsonError &ex) {
+		rejected_ = true;
+	}
+	drmaa2_jtemplate_free(&jt_);
+	return rejected_;
+}
+
+void JsonReaderTest::TestTemplate() {
+	string text_("{ \"remoteCommand\" : \"/bin/sleep\", \"args\": [\"10\", \"x\"],"
+			" \"jobEnvironment\": {\"A\": \"1\"}, \"priority\": -3,"
+			" \"submitAsHold\": true, \"email\": [], \"stageInFiles\": {} }");
+	drmaa2_jtemplate jt_ = drmaa2_jtemplate_create();
+	JsonReader(text_).readTemplate(jt_);
+	CPPUNIT_ASSERT_EQUAL(string("/bin/sleep"), string(jt_->remoteCommand));
+	CPPUNIT_ASSERT_EQUAL(2L, drmaa2_list_size(jt_->args));
+	CPPUNIT_ASSERT_EQUAL(string("10"),
+			string((const char *) drmaa2_list_get(jt_->args, 0)));
+	CPPUNIT_ASSERT_EQUAL(string("x"),
+			string((const char *) drmaa2_list_get(jt_->args, 1)));
+	CPPUNIT_ASSERT_EQUAL(string("1"),
+			string(drmaa2_dict_get(jt_->jobEnvironment, "A")));
+	CPPUNIT_ASSERT_EQUAL(-3LL, jt_->priority);
+	CPPUNIT_ASSERT_EQUAL(DRMAA2_TRUE, jt_->submitAsHold);
+	CPPUNIT_ASSERT_EQUAL(0L, drmaa2_list_size(jt_->email));
+	drmaa2_jtemplate_free(&jt_);
+	CPPUNIT_ASSERT(!rejected("{}"));
+}
+
+void JsonReaderTest::TestMalformed() {
+	// Trailing commas
+	CPPUNIT_ASSERT(rejected("{\"jobName\":\"a\",}"));
+	CPPUNIT_ASSERT(rejected("{\"args\":[\"a\",]}"));
+	CPPUNIT_ASSERT(rejected("{\"jobEnvironment\":{\"A\":\"1\",}}"));
+	CPPUNIT_ASSERT(rejected("{,}"));
+	CPPUNIT_ASSERT(rejected("{\"args\":[,]}"));
+	// Structure and values
+	CPPUNIT_ASSERT(rejected(""));
+	CPPUNIT_ASSERT(rejected("{\"jobName\":\"a\""));
+	CPPUNIT_ASSERT(rejected("{\"jobName\" \"a\"}"));
+	CPPUNIT_ASSERT(rejected("{\"jobName\":\"a\"} x"));
+	CPPUNIT_ASSERT(rejected("{\"jobName\":\"a}"));
+	CPPUNIT_ASSERT(rejected("{\"priority\":1.5}"));
+	CPPUNIT_ASSERT(rejected("{\"priority\":+1}"));
+	CPPUNIT_ASSERT(rejected("{\"submitAsHold\":1}"));
+	CPPUNIT_ASSERT(rejected("{\"noSuchMember\":\"a\"}"));
+}
+
+void JsonReaderTest::TestEscapes() {
+	string text_("{\"jobName\":\"q\\\"b\\\\s\\/t\\tn\\nu\\u00e9\\ud83d\\ude00\"}");
+	drmaa2_jtemplate jt_ = drmaa2_jtemplate_create();
+	JsonReader(text_).readTemplate(jt_);
+	CPPUNIT_ASSERT_EQUAL(string("q\"b\\s/t\tn\nu\xc3\xa9\xf0\x9f\x98\x80"),
+			string(jt_->jobName));
+	drmaa2_jtemplate_free(&jt_);
+	CPPUNIT_ASSERT(rejected("{\"jobName\":\"\\x\"}"));
+	CPPUNIT_ASSERT(rejected("{\"jobName\":\"\\u00g0\"}"));
+	CPPUNIT_ASSERT(rejected("{\"jobName\":\"\\u00\"}"));
+	CPPUNIT_ASSERT(rejected("{\"jobName\":\"\\ud83d\"}"));
+	CPPUNIT_ASSERT(rejected("{\"jobName\":\"\\ude00\"}"));
+	CPPUNIT_ASSERT(rejected("{\"jobName\":\"a\tb\"}"));
+}
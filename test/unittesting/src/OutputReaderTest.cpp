@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include "../inc/OutputReaderTest.h"
+#include "../inc/TempDirectory.h"
+
+#include <cppunit/extensions/AutoRegisterSuite.h>
+#include <cppunit/TestAssert.h>
+#include <OutputReader.h>
+#include <InvalidArgumentException.h>
+#include <cstdio>
+#include <fstream>
+#include <pthread.h>
+#include <unistd.h>
+
+using namespace drmaa2;
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OutputReaderTest);
+
+void OutputReaderTest::setUp() {
+	_directory = createTempDirectory("drmaa2_output");
+}
+
+void OutputReaderTest::tearDown() {
+	CPPUNIT_ASSERT(removeTempDirectory(_directory));
+}
+
+void OutputReaderTest::write(const string& file_, const string& text_,
+		const bool append_) {
+	ofstream out_((_directory + "/" + file_).c_str(),
+			append_ ? ios::app : ios::trunc);
+	out_ << text_;
+}
+
+void OutputReaderTest::TestIncremental() {
+	OutputReader reader_("host:" + _directory + "/job.out", "7.server", 'o');
+	OutputCursor cursor_;
+	CPPUNIT_ASSERT_EQUAL(string(), reader_.read(cursor_, 1024, 0));
+	write("job.out", "first line\n");
+	CPPUNIT_ASSERT_EQUAL(string("first"), reader_.read(cursor_, 5, 0));
+	CPPUNIT_ASSERT_EQUAL(string(" line\n"), reader_.read(cursor_, 1024, 0));
+	CPPUNIT_ASSERT_EQUAL(string(), reader_.read(cursor_, 1024, 0));
+	write("job.out", "second\n");
+	CPPUNIT_ASSERT_EQUAL(string("second\n"), reader_.read(cursor_, 1024, 0));
+	CPPUNIT_ASSERT_EQUAL(18ULL, cursor_.offset);
+}
+
+void OutputReaderTest::TestTruncation() {
+	OutputReader reader_(_directory + "/job.out", "7.server", 'o');
+	OutputCursor cursor_;
+	write("job.out", "a long first version\n");
+	reader_.read(cursor_, 1024, 0);
+	write("job.out", "short\n", false);
+	CPPUNIT_ASSERT_EQUAL(string("short\n"), reader_.read(cursor_, 1024, 0));
+}
+
+void OutputReaderTest::TestReplaced() {
+	OutputReader reader_(_directory + "/job.out", "7.server", 'o');
+	OutputCursor cursor_;
+	write("job.out", "old\n");
+	CPPUNIT_ASSERT_EQUAL(string("old\n"), reader_.read(cursor_, 1024, 0));
+	write("job.new", "rotated file\n");
+	CPPUNIT_ASSERT_EQUAL(0, rename((_directory + "/job.new").c_str(),
+			(_directory + "/job.out").c_str()));
+	CPPUNIT_ASSERT_EQUAL(string("rotated file\n"),
+			reader_.read(cursor_, 1024, 0));
+}
+
+void OutputReaderTest::TestDefaultName() {
+	write("STDIN.o17", "output\n");
+	write("STDIN.e17", "error\n");
+	write("STDIN.o170", "other job\n");
+	OutputCursor output_, error_;
+	CPPUNIT_ASSERT_EQUAL(string("output\n"), OutputReader(_directory,
+			"17.server", 'o').read(output_, 1024, 0));
+	CPPUNIT_ASSERT_EQUAL(string("error\n"), OutputReader(_directory,
+			"17.server", 'e').read(error_, 1024, 0));
+	CPPUNIT_ASSERT_THROW(OutputReader("host:", "17.server", 'o'),
+			InvalidArgumentException);
+}
+
+/**
+ * @brief - Appends to the file of OutputReaderTest::TestWaitForData late
+ */
+static void* lateWriter(void *path_) {
+	usleep(300000);
+	ofstream out_(static_cast<string*>(path_)->c_str(), ios::app);
+	out_ << "late\n";
+	return NULL;
+}
+
+void OutputReaderTest::TestWaitForData() {
+	string path_(_directory + "/job.out");
+	OutputReader reader_(path_, "7.server", 'o');
+	OutputCursor cursor_;
+	CPPUNIT_ASSERT_EQUAL(string(), reader_.read(cursor_, 1024, 1));
+	pthread_t writer_;
+	CPPUNIT_ASSERT_EQUAL(0, pthread_create(&writer_, NULL, lateWriter,
+			&path_));
+	CPPUNIT_ASSERT_EQUAL(string("late\n"), reader_.read(cursor_, 1024, 10));
+	pthread_join(writer_, NULL);
+}
@@ -70,3 +70,32 @@ void ReservationSessionTest::TestReservationSession() {
 	res.terminate();
 	sessionManagerObj_->destroyReservationSession(session_);
 }
+
+void ReservationSessionTest::TestReservationBatch() {
+	string session_("ReservationBatch"), contact_(pbs_default());
+	SessionManager *sessionManagerObj_ = Singleton<SessionManager, SessionManagerImpl>::getInstance();
+	const ReservationSession &resSessionObj_ = sessionManagerObj_->createReservationSession(session_, contact_);
+	list<ReservationTemplate> templates_;
+	for (int i = 0; i < 3; i++) {
+		ReservationTemplate rt_;
+		rt_.reservationName.assign("DRMAA2BATCH");
+		rt_.startTime = time(NULL) + 300 + i * 2000;
+		rt_.duration = 1000;
+		rt_.endTime = 0;
+		rt_.minSlots = 1;
+		templates_.push_back(rt_);
+	}
+	ReservationList requested_ = resSessionObj_.requestReservations(templates_);
+	CPPUNIT_ASSERT_EQUAL((size_t) 3, requested_.size());
+	ReservationList confirmed_ = resSessionObj_.waitConfirmed(requested_, 60);
+	// Disjoint one slot windows, every request is confirmed in order
+	CPPUNIT_ASSERT_EQUAL(requested_.size(), confirmed_.size());
+	ReservationList::iterator confirmedIt_ = confirmed_.begin();
+	for (ReservationList::iterator it = requested_.begin();
+			it != requested_.end(); ++it, ++confirmedIt_)
+		CPPUNIT_ASSERT_EQUAL((*it)->getReservationId(),
+				(*confirmedIt_)->getReservationId());
+	ReservationList failed_ = resSessionObj_.terminateReservations(requested_);
+	CPPUNIT_ASSERT(failed_.empty());
+	sessionManagerObj_->destroyReservationSession(session_);
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include "../inc/TempDirectory.h"
+
+#include <cppunit/TestAssert.h>
+#include <cstdlib>
+#include <ftw.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+#define TEMP_DIRECTORY_FDS 16
+
+/**
+ * @brief - nftw callback removing one entry, children before their directory
+ */
+static int removeEntry(const char *path_, const struct stat *, int type_,
+		struct FTW *) {
+	return (type_ == FTW_DP) ? rmdir(path_) : unlink(path_);
+}
+
+string createTempDirectory(const string& prefix_) {
+	string path_("/tmp/" + prefix_ + "XXXXXX");
+	vector<char> template_(path_.begin(), path_.end());
+	template_.push_back('\0');
+	CPPUNIT_ASSERT(mkdtemp(&template_[0]) != NULL);
+	return string(&template_[0]);
+}
+
+bool removeTempDirectory(const string& path_) {
+	return nftw(path_.c_str(), removeEntry, TEMP_DIRECTORY_FDS,
+			FTW_DEPTH | FTW_PHYS) == 0;
+}
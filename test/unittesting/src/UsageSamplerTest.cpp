@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include "../inc/UsageSamplerTest.h"
+
+#include <cppunit/extensions/AutoRegisterSuite.h>
+#include <cppunit/TestAssert.h>
+#include <UsageSampler.h>
+#include <PBSProSystem.h>
+
+using namespace drmaa2;
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UsageSamplerTest);
+
+/**
+ * @brief - Builds a sample
+ */
+static UsageSample sample(const time_t time_, const long cpuTime_,
+		const long long memory_, const time_t wallclockTime_) {
+	UsageSample sample_;
+	sample_.time = time_;
+	sample_.cpuTime = cpuTime_;
+	sample_.memory = memory_;
+	sample_.wallclockTime = wallclockTime_;
+	return sample_;
+}
+
+void UsageSamplerTest::TestRoundTrip() {
+	UsageRing ring_;
+	CPPUNIT_ASSERT(ring_.samples().empty());
+	ring_.push(sample(1492510517, 0, 2048, 0));
+	ring_.push(sample(1492510547, 29, 1048576, 30));
+	// Memory shrinks, a negative delta
+	ring_.push(sample(1492510577, 58, 512, 60));
+	UsageSampleList samples_ = ring_.samples();
+	CPPUNIT_ASSERT_EQUAL((size_t) 3, samples_.size());
+	CPPUNIT_ASSERT_EQUAL((time_t) 1492510547, samples_[1].time);
+	CPPUNIT_ASSERT_EQUAL(29L, samples_[1].cpuTime);
+	CPPUNIT_ASSERT_EQUAL(1048576LL, samples_[1].memory);
+	CPPUNIT_ASSERT_EQUAL(512LL, samples_[2].memory);
+	CPPUNIT_ASSERT_EQUAL((time_t) 60, samples_[2].wallclockTime);
+}
+
+void UsageSamplerTest::TestCapacity() {
+	UsageRing ring_(3);
+	for (long i = 0; i < 10; i++)
+		ring_.push(sample(1000 + i * 30, i * 30, 100 + i, i * 30));
+	UsageSampleList samples_ = ring_.samples();
+	CPPUNIT_ASSERT_EQUAL((size_t) 3, ring_.size());
+	CPPUNIT_ASSERT_EQUAL((size_t) 3, samples_.size());
+	CPPUNIT_ASSERT_EQUAL((time_t) 1210, samples_[0].time);
+	CPPUNIT_ASSERT_EQUAL(109LL, samples_[2].memory);
+	CPPUNIT_ASSERT_EQUAL(270L, samples_[2].cpuTime);
+}
+
+void UsageSamplerTest::TestCompactDeltas() {
+	UsageRing ring_;
+	for (long i = 0; i < 100; i++)
+		ring_.push(sample(1492510517 + i * 30, i * 30, 4194304, i * 30));
+	// Steady 30 second steps and flat memory, one byte per field
+	CPPUNIT_ASSERT_EQUAL((size_t) 99 * 4, ring_.bytes());
+}
+
+void UsageSamplerTest::TestParseUsage() {
+	CPPUNIT_ASSERT_EQUAL(3610L, PBSProSystem::parseDuration("01:00:10"));
+	CPPUNIT_ASSERT_EQUAL(65L, PBSProSystem::parseDuration("01:05"));
+	CPPUNIT_ASSERT_EQUAL(42L, PBSProSystem::parseDuration("42"));
+	CPPUNIT_ASSERT_EQUAL(2048LL, PBSProSystem::parseSize("2048kb"));
+	CPPUNIT_ASSERT_EQUAL(3072LL, PBSProSystem::parseSize("3mb"));
+	CPPUNIT_ASSERT_EQUAL(1048576LL, PBSProSystem::parseSize("1gb"));
+	CPPUNIT_ASSERT_EQUAL(2LL, PBSProSystem::parseSize("1025b"));
+	CPPUNIT_ASSERT_EQUAL(1LL, PBSProSystem::parseSize("1000"));
+}
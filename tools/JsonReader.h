@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef TOOLS_JSONREADER_H
+#define TOOLS_JSONREADER_H
+
+#include <drmaa2.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Malformed input line
+ */
+class JsonError {
+	string _message;
+public:
+	JsonError(const string& message_) : _message(message_) {
+	}
+	const string& getMessage() const {
+		return _message;
+	}
+};
+
+/**
+ * @brief Recursive descent reader for one JSON job template. Values are
+ * 		decoded straight into the drmaa2_jtemplate, no document is built.
+ */
+class JsonReader {
+	const string &_text;
+	size_t _pos;
+
+	void skipSpace() {
+		while (_pos < _text.size() && strchr(" \t\r\n", _text[_pos]) != NULL)
+			_pos++;
+	}
+
+	void expect(const char c_) {
+		skipSpace();
+		if (_pos >= _text.size() || _text[_pos] != c_)
+			throw JsonError(string("expected '") + c_ + "'");
+		_pos++;
+	}
+
+	bool peek(const char c_) {
+		skipSpace();
+		return _pos < _text.size() && _text[_pos] == c_;
+	}
+
+	/**
+	 * @brief consumes c_ if it comes next
+	 */
+	bool accept(const char c_) {
+		if (!peek(c_))
+			return false;
+		_pos++;
+		return true;
+	}
+
+	/**
+	 * @brief appends code point cp_ as UTF-8
+	 */
+	static void appendUtf8(string& out_, unsigned long cp_) {
+		if (cp_ < 0x80) {
+			out_ += (char) cp_;
+		} else if (cp_ < 0x800) {
+			out_ += (char) (0xC0 | (cp_ >> 6));
+			out_ += (char) (0x80 | (cp_ & 0x3F));
+		} else if (cp_ < 0x10000) {
+			out_ += (char) (0xE0 | (cp_ >> 12));
+			out_ += (char) (0x80 | ((cp_ >> 6) & 0x3F));
+			out_ += (char) (0x80 | (cp_ & 0x3F));
+		} else {
+			out_ += (char) (0xF0 | (cp_ >> 18));
+			out_ += (char) (0x80 | ((cp_ >> 12) & 0x3F));
+			out_ += (char) (0x80 | ((cp_ >> 6) & 0x3F));
+			out_ += (char) (0x80 | (cp_ & 0x3F));
+		}
+	}
+
+	unsigned long readHex4() {
+		if (_pos + 4 > _text.size())
+			throw JsonError("truncated \\u escape");
+		string hex_(_text, _pos, 4);
+		if (hex_.find_first_not_of("0123456789abcdefABCDEF") != string::npos)
+			throw JsonError("bad \\u escape");
+		unsigned long cp_ = strtoul(hex_.c_str(), NULL, 16);
+		_pos += 4;
+		return cp_;
+	}
+
+public:
+	JsonReader(const string& text_) : _text(text_), _pos(0) {
+	}
+
+	string readString() {
+		string out_;
+		expect('"');
+		while (_pos < _text.size() && _text[_pos] != '"') {
+			char c_ = _text[_pos++];
+			if ((unsigned char) c_ < 0x20)
+				throw JsonError("control character in string");
+			if (c_ != '\\') {
+				out_ += c_;
+				continue;
+			}
+			if (_pos >= _text.size())
+				break;
+			c_ = _text[_pos++];
+			switch (c_) {
+			case '"': out_ += '"'; break;
+			case '\\': out_ += '\\'; break;
+			case '/': out_ += '/'; break;
+			case 'b': out_ += '\b'; break;
+			case 'f': out_ += '\f'; break;
+			case 'n': out_ += '\n'; break;
+			case 'r': out_ += '\r'; break;
+			case 't': out_ += '\t'; break;
+			case 'u': {
+				unsigned long cp_ = readHex4();
+				if (cp_ >= 0xDC00 && cp_ < 0xE000)
+					throw JsonError("unpaired surrogate");
+				if (cp_ >= 0xD800 && cp_ < 0xDC00) {
+					if (_text.compare(_pos, 2, "\\u") != 0)
+						throw JsonError("unpaired surrogate");
+					_pos += 2;
+					unsigned long low_ = readHex4();
+					if (low_ < 0xDC00 || low_ >= 0xE000)
+						throw JsonError("unpaired surrogate");
+					cp_ = 0x10000 + ((cp_ - 0xD800) << 10) + (low_ - 0xDC00);
+				}
+				appendUtf8(out_, cp_);
+				break;
+			}
+			default:
+				throw JsonError(string("bad escape \\") + c_);
+			}
+		}
+		if (_pos >= _text.size())
+			throw JsonError("unterminated string");
+		_pos++;
+		return out_;
+	}
+
+	long long readInteger() {
+		skipSpace();
+		if (_pos < _text.size() && _text[_pos] == '+')
+			throw JsonError("expected an integer");
+		const char *begin_ = _text.c_str() + _pos;
+		char *end_ = NULL;
+		errno = 0;
+		long long value_ = strtoll(begin_, &end_, 10);
+		if (end_ == begin_ || errno != 0 || *end_ == '.' || *end_ == 'e'
+				|| *end_ == 'E')
+			throw JsonError("expected an integer");
+		_pos += end_ - begin_;
+		return value_;
+	}
+
+	drmaa2_bool readBool() {
+		skipSpace();
+		if (_text.compare(_pos, 4, "true") == 0) {
+			_pos += 4;
+			return DRMAA2_TRUE;
+		}
+		if (_text.compare(_pos, 5, "false") == 0) {
+			_pos += 5;
+			return DRMAA2_FALSE;
+		}
+		throw JsonError("expected true or false");
+	}
+
+	/**
+	 * @brief reads an array of strings into a new string list
+	 */
+	drmaa2_string_list readStringList() {
+		vector<string> items_;
+		expect('[');
+		// A comma always announces another element
+		if (!peek(']')) {
+			do {
+				items_.push_back(readString());
+			} while (accept(','));
+		}
+		expect(']');
+		drmaa2_string_list list_ = drmaa2_list_create(DRMAA2_STRINGLIST,
+				drmaa2_string_list_default_callback);
+		// drmaa2_list_add prepends, add from the back to keep the order
+		for (vector<string>::reverse_iterator it = items_.rbegin();
+				it != items_.rend(); ++it)
+			drmaa2_list_add(list_, strdup(it->c_str()));
+		return list_;
+	}
+
+	/**
+	 * @brief reads an object of strings into a new dictionary
+	 */
+	drmaa2_dict readStringDict() {
+		map<string, string> items_;
+		expect('{');
+		if (!peek('}')) {
+			do {
+				string key_ = readString();
+				expect(':');
+				items_[key_] = readString();
+			} while (accept(','));
+		}
+		expect('}');
+		drmaa2_dict dict_ = drmaa2_dict_create(drmaa2_dict_default_callback);
+		for (map<string, string>::iterator it = items_.begin();
+				it != items_.end(); ++it)
+			drmaa2_dict_set(dict_, strdup(it->first.c_str()),
+					strdup(it->second.c_str()));
+		return dict_;
+	}
+
+	/**
+	 * @brief reads the whole line as a job template object
+	 */
+	void readTemplate(drmaa2_jtemplate jt_) {
+		expect('{');
+		if (!peek('}')) {
+			do {
+				readMember(jt_, readString());
+			} while (accept(','));
+		}
+		expect('}');
+		skipSpace();
+		if (_pos != _text.size())
+			throw JsonError("trailing data after the template");
+	}
+
+	/**
+	 * @brief reads the value of one template member
+	 */
+	void readMember(drmaa2_jtemplate jt_, const string& name_) {
+		expect(':');
+		struct {
+			const char *name;
+			drmaa2_string *field;
+		} strings_[] = {
+			{ "remoteCommand", &jt_->remoteCommand },
+			{ "workingDirectory", &jt_->workingDirectory },
+			{ "jobCategory", &jt_->jobCategory },
+			{ "jobName", &jt_->jobName },
+			{ "inputPath", &jt_->inputPath },
+			{ "outputPath", &jt_->outputPath },
+			{ "errorPath", &jt_->errorPath },
+			{ "reservationId", &jt_->reservationId },
+			{ "queueName", &jt_->queueName },
+			{ "accountingId", &jt_->accountingId }
+		};
+		for (size_t i = 0; i < sizeof(strings_) / sizeof(strings_[0]); i++) {
+			if (name_ == strings_[i].name) {
+				string value_ = readString();
+				free(*strings_[i].field);
+				*strings_[i].field = strdup(value_.c_str());
+				return;
+			}
+		}
+		struct {
+			const char *name;
+			drmaa2_bool *field;
+		} bools_[] = {
+			{ "submitAsHold", &jt_->submitAsHold },
+			{ "rerunnable", &jt_->rerunnable },
+			{ "emailOnStarted", &jt_->emailOnStarted },
+			{ "emailOnTerminated", &jt_->emailOnTerminated },
+			{ "joinFiles", &jt_->joinFiles }
+		};
+		for (size_t i = 0; i < sizeof(bools_) / sizeof(bools_[0]); i++) {
+			if (name_ == bools_[i].name) {
+				*bools_[i].field = readBool();
+				return;
+			}
+		}
+		struct {
+			const char *name;
+			long long *field;
+		} numbers_[] = {
+			{ "minSlots", &jt_->minSlots },
+			{ "maxSlots", &jt_->maxSlots },
+			{ "priority", &jt_->priority },
+			{ "minPhysMemory", &jt_->minPhysMemory }
+		};
+		for (size_t i = 0; i < sizeof(numbers_) / sizeof(numbers_[0]); i++) {
+			if (name_ == numbers_[i].name) {
+				*numbers_[i].field = readInteger();
+				return;
+			}
+		}
+		if (name_ == "startTime") {
+			jt_->startTime = (time_t) readInteger();
+		} else if (name_ == "deadlineTime") {
+			jt_->deadlineTime = (time_t) readInteger();
+		} else if (name_ == "args") {
+			drmaa2_list_free(&jt_->args);
+			jt_->args = readStringList();
+		} else if (name_ == "email") {
+			drmaa2_list_free(&jt_->email);
+			jt_->email = readStringList();
+		} else if (name_ == "candidateMachines") {
+			drmaa2_list_free(&jt_->candidateMachines);
+			jt_->candidateMachines = readStringList();
+		} else if (name_ == "jobEnvironment") {
+			drmaa2_dict_free(&jt_->jobEnvironment);
+			jt_->jobEnvironment = readStringDict();
+		} else if (name_ == "stageInFiles") {
+			drmaa2_dict_free(&jt_->stageInFiles);
+			jt_->stageInFiles = readStringDict();
+		} else if (name_ == "stageOutFiles") {
+			drmaa2_dict_free(&jt_->stageOutFiles);
+			jt_->stageOutFiles = readStringDict();
+		} else if (name_ == "resourceLimits") {
+			drmaa2_dict_free(&jt_->resourceLimits);
+			jt_->resourceLimits = readStringDict();
+		} else {
+			throw JsonError("unsupported attribute " + name_);
+		}
+	}
+};
+
+#endif
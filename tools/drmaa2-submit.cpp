@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 1994-2017 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * The PBS Pro software is licensed under the terms of the GNU Affero General
+ * Public License agreement ("AGPL"), except where a separate commercial license
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and distribute
+ * them - whether embedded or bundled with other software - under a commercial
+ * license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+/*
+ * drmaa2-submit reads one JSON job template per line and submits them
+ * through the asynchronous job API with a bounded number of submissions
+ * in flight. One JSON result per input line is written to stdout in
+ * input order.
+ *
+ * 	Input:	{"remoteCommand":"/bin/sleep","args":["10"],"jobName":"a"}
+ * 	Output:	{"line":1,"jobId":"123.server"}
+ * 			{"line":2,"error":"DRMAA2_INVALID_ARGUMENT","message":"..."}
+ */
+
+#include <drmaa2.h>
+#include <pbs_ifl.h>
+#include <JsonReader.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace std;
+
+#define SUBMIT_DEFAULT_PIPELINES 16
+#define SUBMIT_REORDER_FACTOR 4
+#define SUBMIT_DEFAULT_REPORT 5
+
+/**
+ * @brief Names of the drmaa2_error codes, indexed by code
+ */
+static const char *submitErrorNames[] = {
+	"DRMAA2_SUCCESS",
+	"DRMAA2_DENIED_BY_DRMS",
+	"DRMAA2_DRM_COMMUNICATION",
+	"DRMAA2_TRY_LATER",
+	"DRMAA2_SESSION_MANAGEMENT",
+	"DRMAA2_TIMEOUT",
+	"DRMAA2_INTERNAL",
+	"DRMAA2_INVALID_ARGUMENT",
+	"DRMAA2_INVALID_SESSION",
+	"DRMAA2_INVALID_STATE",
+	"DRMAA2_OUT_OF_RESOURCE",
+	"DRMAA2_UNSUPPORTED_ATTRIBUTE",
+	"DRMAA2_UNSUPPORTED_OPERATION",
+	"DRMAA2_IMPLEMENTATION_SPECIFIC"
+};
+
+/**
+ * @brief returns value_ as a quoted JSON string
+ */
+static string jsonQuote(const string& value_) {
+	string out_("\"");
+	for (string::const_iterator it = value_.begin(); it != value_.end(); ++it) {
+		unsigned char c_ = *it;
+		if (c_ == '"' || c_ == '\\') {
+			out_ += '\\';
+			out_ += c_;
+		} else if (c_ < 0x20) {
+			char escape_[8];
+			snprintf(escape_, sizeof(escape_), "\\u%04x", c_);
+			out_ += escape_;
+		} else {
+			out_ += c_;
+		}
+	}
+	out_ += '"';
+	return out_;
+}
+
+/**
+ * @brief formats the result line of a failed input line
+ */
+static string errorResult(const long line_, const drmaa2_error error_,
+		const string& message_) {
+	stringstream out_;
+	out_ << "{\"line\":" << line_ << ",\"error\":"
+			<< jsonQuote(error_ >= DRMAA2_SUCCESS
+					&& error_ < DRMAA2_LASTERROR ?
+					submitErrorNames[error_] : "DRMAA2_UNSET_ERROR");
+	if (!message_.empty())
+		out_ << ",\"message\":" << jsonQuote(message_);
+	out_ << "}";
+	return out_.str();
+}
+
+/**
+ * @brief seconds since the epoch with microsecond resolution
+ */
+static double submitNow() {
+	struct timeval now_;
+	gettimeofday(&now_, NULL);
+	return now_.tv_sec + now_.tv_usec / 1e6;
+}
+
+/**
+ * @brief Submission pipeline. Lines are read only while fewer than
+ * 		pipelines submissions are in flight and the oldest unwritten line is
+ * 		less than pipelines * SUBMIT_REORDER_FACTOR lines behind, so memory
+ * 		stays bounded whatever the input size.
+ */
+class SubmitPipeline {
+	drmaa2_jsession _session;
+	drmaa2_cq _queue;
+	long _pipelines;
+	long _report;
+	long _inFlight;
+	long _nextLine;
+	long _nextWrite;
+	long _jobs;
+	long _errors;
+	double _started;
+	double _reported;
+	map<long, string> _results;
+
+	/**
+	 * @brief keeps the result of line_ and writes every result now in
+	 * 		order, an empty result writes nothing
+	 */
+	void complete(const long line_, const string& result_) {
+		_results[line_] = result_;
+		map<long, string>::iterator it;
+		while ((it = _results.find(_nextWrite)) != _results.end()) {
+			if (!it->second.empty()) {
+				fputs(it->second.c_str(), stdout);
+				fputc('\n', stdout);
+			}
+			_results.erase(it);
+			_nextWrite++;
+		}
+		reportProgress(false);
+	}
+
+	/**
+	 * @brief collects one completion, waiting at most one second
+	 */
+	void collect() {
+		fflush(stdout);
+		drmaa2_completion c_ = drmaa2_cq_wait(_queue, 1);
+		if (c_ == NULL) {
+			reportProgress(false);
+			return;
+		}
+		_inFlight--;
+		long line_ = (long) (intptr_t) c_->tag;
+		if (c_->error == DRMAA2_SUCCESS && c_->job != NULL) {
+			drmaa2_string id_ = drmaa2_j_get_id(c_->job);
+			stringstream out_;
+			out_ << "{\"line\":" << line_ << ",\"jobId\":"
+					<< jsonQuote(id_ ? id_ : "") << "}";
+			drmaa2_string_free(&id_);
+			drmaa2_j_free(&c_->job);
+			_jobs++;
+			complete(line_, out_.str());
+		} else {
+			_errors++;
+			complete(line_, errorResult(line_, c_->error, string()));
+		}
+		drmaa2_completion_free(&c_);
+	}
+
+	/**
+	 * @brief parses and submits one input line
+	 */
+	void submit(const string& text_) {
+		long line_ = _nextLine++;
+		drmaa2_jtemplate jt_ = drmaa2_jtemplate_create();
+		try {
+			JsonReader(text_).readTemplate(jt_);
+		} catch (const JsonError &ex) {
+			drmaa2_jtemplate_free(&jt_);
+			_errors++;
+			complete(line_, errorResult(line_, DRMAA2_INVALID_ARGUMENT,
+					ex.getMessage()));
+			return;
+		}
+		// The template is copied before the call returns
+		drmaa2_error error_ = drmaa2_jsession_run_job_async(_session, jt_,
+				_queue, (void *) (intptr_t) line_);
+		drmaa2_jtemplate_free(&jt_);
+		if (error_ != DRMAA2_SUCCESS) {
+			_errors++;
+			complete(line_, errorResult(line_, error_, string()));
+		} else {
+			_inFlight++;
+		}
+	}
+
+public:
+	SubmitPipeline(drmaa2_jsession session_, drmaa2_cq queue_,
+			const long pipelines_, const long report_) :
+			_session(session_), _queue(queue_), _pipelines(pipelines_),
+			_report(report_), _inFlight(0), _nextLine(1), _nextWrite(1),
+			_jobs(0), _errors(0) {
+		_started = _reported = submitNow();
+	}
+
+	/**
+	 * @brief writes the throughput to stderr, at most every _report
+	 * 		seconds unless final_ is set
+	 */
+	void reportProgress(const bool final_) {
+		double now_ = submitNow();
+		if (!final_ && (_report <= 0 || now_ - _reported < _report))
+			return;
+		_reported = now_;
+		double elapsed_ = now_ - _started;
+		fprintf(stderr, "drmaa2-submit: %ld lines, %ld jobs, %ld errors, "
+				"%.1f jobs/s\n", _nextWrite - 1, _jobs, _errors,
+				elapsed_ > 0 ? _jobs / elapsed_ : 0.0);
+	}
+
+	/**
+	 * @brief submits every line of in_ and waits for all of them
+	 */
+	void run(istream& in_) {
+		string text_;
+		long window_ = _pipelines * SUBMIT_REORDER_FACTOR;
+		while (getline(in_, text_)) {
+			while (_inFlight >= _pipelines || _nextLine - _nextWrite >= window_)
+				collect();
+			if (text_.find_first_not_of(" \t\r") == string::npos) {
+				// Blank lines keep their number but produce no job
+				complete(_nextLine++, string());
+				continue;
+			}
+			submit(text_);
+		}
+		while (_inFlight > 0)
+			collect();
+		fflush(stdout);
+	}
+
+	long getErrors() const {
+		return _errors;
+	}
+};
+
+/**
+ * @brief prints the usage
+ */
+static void usage(const char *program_) {
+	fprintf(stderr, "usage: %s [-p pipelines] [-s session] [-c contact] "
+			"[-r seconds] [file]\n"
+			"  -p  submissions in flight, default %d\n"
+			"  -s  job session name, default drmaa2-submit.<pid>\n"
+			"  -c  DRMS contact, default server\n"
+			"  -r  seconds between progress reports, 0 to disable, "
+			"default %d\n", program_, SUBMIT_DEFAULT_PIPELINES,
+			SUBMIT_DEFAULT_REPORT);
+}
+
+int main(int argc, char *argv[]) {
+	long pipelines_ = SUBMIT_DEFAULT_PIPELINES;
+	long report_ = SUBMIT_DEFAULT_REPORT;
+	string session_, contact_;
+	int opt_;
+	while ((opt_ = getopt(argc, argv, "p:s:c:r:h")) != -1) {
+		switch (opt_) {
+		case 'p':
+			pipelines_ = atol(optarg);
+			break;
+		case 's':
+			session_.assign(optarg);
+			break;
+		case 'c':
+			contact_.assign(optarg);
+			break;
+		case 'r':
+			report_ = atol(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	if (pipelines_ <= 0 || optind + 1 < argc) {
+		usage(argv[0]);
+		return 2;
+	}
+	ifstream file_;
+	if (optind < argc && strcmp(argv[optind], "-") != 0) {
+		file_.open(argv[optind]);
+		if (!file_) {
+			fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[optind]);
+			return 2;
+		}
+	}
+	if (session_.empty()) {
+		stringstream name_;
+		name_ << "drmaa2-submit." << getpid();
+		session_.assign(name_.str());
+	}
+
+	drmaa2_jsession js_ = drmaa2_create_jsession(session_.c_str(),
+			contact_.c_str());
+	drmaa2_cq cq_ = js_ ? drmaa2_cq_create() : NULL;
+	if (cq_ == NULL) {
+		drmaa2_string text_ = drmaa2_lasterror_text();
+		fprintf(stderr, "%s: cannot create the job session: %s\n", argv[0],
+				text_ ? text_ : "unknown error");
+		// The session is persistent, do not leave it behind
+		if (js_) {
+			drmaa2_close_jsession(js_);
+			drmaa2_jsession_free(&js_);
+			drmaa2_destroy_jsession(session_.c_str());
+		}
+		return 2;
+	}
+	SubmitPipeline pipeline_(js_, cq_, pipelines_, report_);
+	pipeline_.run(file_.is_open() ? (istream&) file_ : cin);
+	if (report_ > 0)
+		pipeline_.reportProgress(true);
+	drmaa2_cq_free(&cq_);
+	drmaa2_close_jsession(js_);
+	drmaa2_jsession_free(&js_);
+	drmaa2_destroy_jsession(session_.c_str());
+	return pipeline_.getErrors() > 0 ? 1 : 0;
+}